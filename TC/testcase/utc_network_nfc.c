@@ -14,6 +14,8 @@
 * limitations under the License.
 */
 
+#include <stdlib.h>
+#include <unistd.h>
 #include <tet_api.h>
 #include <nfc.h>
 
@@ -55,6 +57,44 @@ static void nfc_manager_set_se_transaction_event_cb_p(void);
 static void nfc_manager_set_se_transaction_event_cb_n(void);
 static void nfc_manager_set_system_handler_enable_p(void);
 static void nfc_manager_set_system_handler_enable_n(void);
+static void nfc_manager_set_callback_pool_size_p(void);
+static void nfc_manager_set_callback_pool_size_n(void);
+static void nfc_manager_get_callback_pool_stats_p(void);
+static void nfc_manager_get_callback_pool_stats_n(void);
+static void nfc_manager_set_request_timeout_p(void);
+static void nfc_manager_set_request_timeout_n(void);
+static void nfc_tag_cancel_n(void);
+static void nfc_tag_get_last_request_id_n(void);
+static void nfc_manager_set_log_level_p(void);
+static void nfc_manager_set_log_level_n(void);
+static void nfc_manager_dump_log_p(void);
+static void nfc_manager_dump_log_n(void);
+static void nfc_mifare_read_sector_n(void);
+static void nfc_mifare_write_sector_n(void);
+static void nfc_mifare_dump_n(void);
+static void nfc_tag_get_information_n(void);
+static void nfc_tag_retain_n(void);
+static void nfc_tag_release_n(void);
+static void nfc_manager_set_callback_executor_p(void);
+static void nfc_manager_set_callback_executor_n(void);
+static void nfc_manager_set_callback_main_context_p(void);
+static void nfc_manager_unset_callback_main_context_p(void);
+static void nfc_manager_get_event_fd_p(void);
+static void nfc_manager_drain_events_p(void);
+static void nfc_manager_drain_events_n(void);
+static void nfc_tag_transceive_batch_n(void);
+static void nfc_tag_transceive_sync_n(void);
+static void nfc_tag_read_ndef_sync_n(void);
+static void nfc_p2p_get_send_queue_depth_n(void);
+static void nfc_manager_get_stats_p(void);
+static void nfc_manager_get_stats_n(void);
+static void nfc_manager_reset_stats_p(void);
+static void nfc_manager_set_stats_snapshot_cb_n(void);
+static void nfc_manager_get_counters_p(void);
+static void nfc_manager_get_counters_n(void);
+static void nfc_manager_reset_counters_p(void);
+static void nfc_manager_start_trace_p(void);
+static void nfc_manager_start_trace_n(void);
 
 
 void _activation_changed_cb(bool activated , void *user_data);
@@ -86,6 +126,44 @@ struct tet_testlist tet_testlist[] = {
 	{ nfc_manager_set_se_transaction_event_cb_n , NEGATIVE_TC_IDX },
 	{ nfc_manager_set_system_handler_enable_p , POSITIVE_TC_IDX },
 	{ nfc_manager_set_system_handler_enable_n , NEGATIVE_TC_IDX },
+	{ nfc_manager_set_callback_pool_size_p , POSITIVE_TC_IDX },
+	{ nfc_manager_set_callback_pool_size_n , NEGATIVE_TC_IDX },
+	{ nfc_manager_get_callback_pool_stats_p , POSITIVE_TC_IDX },
+	{ nfc_manager_get_callback_pool_stats_n , NEGATIVE_TC_IDX },
+	{ nfc_manager_set_request_timeout_p , POSITIVE_TC_IDX },
+	{ nfc_manager_set_request_timeout_n , NEGATIVE_TC_IDX },
+	{ nfc_tag_cancel_n , NEGATIVE_TC_IDX },
+	{ nfc_tag_get_last_request_id_n , NEGATIVE_TC_IDX },
+	{ nfc_manager_set_log_level_p , POSITIVE_TC_IDX },
+	{ nfc_manager_set_log_level_n , NEGATIVE_TC_IDX },
+	{ nfc_manager_dump_log_p , POSITIVE_TC_IDX },
+	{ nfc_manager_dump_log_n , NEGATIVE_TC_IDX },
+	{ nfc_mifare_read_sector_n , NEGATIVE_TC_IDX },
+	{ nfc_mifare_write_sector_n , NEGATIVE_TC_IDX },
+	{ nfc_mifare_dump_n , NEGATIVE_TC_IDX },
+	{ nfc_tag_get_information_n , NEGATIVE_TC_IDX },
+	{ nfc_tag_retain_n , NEGATIVE_TC_IDX },
+	{ nfc_tag_release_n , NEGATIVE_TC_IDX },
+	{ nfc_manager_set_callback_executor_p , POSITIVE_TC_IDX },
+	{ nfc_manager_set_callback_executor_n , NEGATIVE_TC_IDX },
+	{ nfc_manager_set_callback_main_context_p , POSITIVE_TC_IDX },
+	{ nfc_manager_unset_callback_main_context_p , POSITIVE_TC_IDX },
+	{ nfc_manager_get_event_fd_p , POSITIVE_TC_IDX },
+	{ nfc_manager_drain_events_p , POSITIVE_TC_IDX },
+	{ nfc_manager_drain_events_n , NEGATIVE_TC_IDX },
+	{ nfc_tag_transceive_batch_n , NEGATIVE_TC_IDX },
+	{ nfc_tag_transceive_sync_n , NEGATIVE_TC_IDX },
+	{ nfc_tag_read_ndef_sync_n , NEGATIVE_TC_IDX },
+	{ nfc_p2p_get_send_queue_depth_n , NEGATIVE_TC_IDX },
+	{ nfc_manager_get_stats_p , POSITIVE_TC_IDX },
+	{ nfc_manager_get_stats_n , NEGATIVE_TC_IDX },
+	{ nfc_manager_reset_stats_p , POSITIVE_TC_IDX },
+	{ nfc_manager_set_stats_snapshot_cb_n , NEGATIVE_TC_IDX },
+	{ nfc_manager_get_counters_p , POSITIVE_TC_IDX },
+	{ nfc_manager_get_counters_n , NEGATIVE_TC_IDX },
+	{ nfc_manager_reset_counters_p , POSITIVE_TC_IDX },
+	{ nfc_manager_start_trace_p , POSITIVE_TC_IDX },
+	{ nfc_manager_start_trace_n , NEGATIVE_TC_IDX },
 
 	{ NULL, 0 },
 };
@@ -307,3 +385,385 @@ static void nfc_manager_set_system_handler_enable_n ()
 
 	dts_pass(__func__, "PASS");
 }
+
+static void nfc_manager_set_callback_pool_size_p()
+{
+	int ret = NFC_ERROR_NONE;
+
+	ret = nfc_manager_set_callback_pool_size(128);
+
+	dts_check_eq(__func__, ret, NFC_ERROR_NONE, "nfc_manager_set_callback_pool_size_p is faild");
+}
+
+static void nfc_manager_set_callback_pool_size_n()
+{
+	int ret = NFC_ERROR_NONE;
+
+	ret = nfc_manager_set_callback_pool_size(0);
+
+	dts_check_ne(__func__, ret, NFC_ERROR_NONE, "nfc_manager_set_callback_pool_size_n not allow zero");
+}
+
+static void nfc_manager_get_callback_pool_stats_p()
+{
+	int ret = NFC_ERROR_NONE;
+	nfc_callback_pool_stats_s stats;
+
+	ret = nfc_manager_get_callback_pool_stats(&stats);
+
+	MY_ASSERT(__func__, stats.in_use <= stats.capacity, "in_use exceeds capacity");
+	dts_check_eq(__func__, ret, NFC_ERROR_NONE, "nfc_manager_get_callback_pool_stats_p is faild");
+}
+
+static void nfc_manager_get_callback_pool_stats_n()
+{
+	int ret = NFC_ERROR_NONE;
+
+	ret = nfc_manager_get_callback_pool_stats(NULL);
+
+	dts_check_ne(__func__, ret, NFC_ERROR_NONE, "nfc_manager_get_callback_pool_stats_n not allow null");
+}
+
+static void nfc_manager_set_request_timeout_p()
+{
+	int ret = NFC_ERROR_NONE;
+
+	ret = nfc_manager_set_request_timeout(3000);
+
+	dts_check_eq(__func__, ret, NFC_ERROR_NONE, "nfc_manager_set_request_timeout_p is faild");
+}
+
+static void nfc_manager_set_request_timeout_n()
+{
+	int ret = NFC_ERROR_NONE;
+
+	ret = nfc_manager_set_request_timeout(-1);
+
+	dts_check_ne(__func__, ret, NFC_ERROR_NONE, "nfc_manager_set_request_timeout_n not allow negative timeout");
+}
+
+static void nfc_tag_cancel_n()
+{
+	int ret = NFC_ERROR_NONE;
+
+	ret = nfc_tag_cancel(0);
+
+	dts_check_ne(__func__, ret, NFC_ERROR_NONE, "nfc_tag_cancel_n not allow unknown request");
+}
+
+static void nfc_tag_get_last_request_id_n()
+{
+	int ret = NFC_ERROR_NONE;
+
+	ret = nfc_tag_get_last_request_id(NULL);
+
+	dts_check_eq(__func__, ret, NFC_ERROR_INVALID_PARAMETER, "nfc_tag_get_last_request_id_n not allow null");
+}
+
+static void nfc_manager_set_log_level_p()
+{
+	int ret = NFC_ERROR_NONE;
+
+	ret = nfc_manager_set_log_level(NFC_LOG_LEVEL_DEBUG);
+	nfc_manager_set_log_level(NFC_LOG_LEVEL_ERROR);
+
+	dts_check_eq(__func__, ret, NFC_ERROR_NONE, "nfc_manager_set_log_level_p is faild");
+}
+
+static void nfc_manager_set_log_level_n()
+{
+	int ret = NFC_ERROR_NONE;
+
+	ret = nfc_manager_set_log_level(NFC_LOG_LEVEL_DEBUG + 1);
+
+	dts_check_ne(__func__, ret, NFC_ERROR_NONE, "nfc_manager_set_log_level_n not allow unknown level");
+}
+
+static bool _log_cb(nfc_log_level_e level, unsigned long long timestamp_ms, const char *message, void *user_data)
+{
+	return true;
+}
+
+static void nfc_manager_dump_log_p()
+{
+	int ret = NFC_ERROR_NONE;
+
+	nfc_manager_set_log_buffer_level(NFC_LOG_LEVEL_DEBUG);
+	ret = nfc_manager_dump_log(_log_cb, NULL);
+	nfc_manager_set_log_buffer_level(NFC_LOG_LEVEL_NONE);
+
+	dts_check_eq(__func__, ret, NFC_ERROR_NONE, "nfc_manager_dump_log_p is faild");
+}
+
+static void nfc_manager_dump_log_n()
+{
+	int ret = NFC_ERROR_NONE;
+
+	ret = nfc_manager_dump_log(NULL, NULL);
+
+	dts_check_ne(__func__, ret, NFC_ERROR_NONE, "nfc_manager_dump_log_n not allow null callback");
+}
+
+static void nfc_mifare_read_sector_n()
+{
+	int ret = NFC_ERROR_NONE;
+
+	ret = nfc_mifare_read_sector(NULL, 0, NFC_MIFARE_KEY_A, (unsigned char *)NFC_TAG_MIFARE_KEY_DEFAULT, NULL, NULL);
+
+	dts_check_ne(__func__, ret, NFC_ERROR_NONE, "nfc_mifare_read_sector_n not allow null tag");
+}
+
+static void nfc_mifare_write_sector_n()
+{
+	int ret = NFC_ERROR_NONE;
+	unsigned char buffer[48] = { 0, };
+
+	ret = nfc_mifare_write_sector(NULL, 1, NFC_MIFARE_KEY_A, (unsigned char *)NFC_TAG_MIFARE_KEY_DEFAULT, buffer, sizeof(buffer), NULL, NULL);
+
+	dts_check_ne(__func__, ret, NFC_ERROR_NONE, "nfc_mifare_write_sector_n not allow null tag");
+}
+
+static void nfc_mifare_dump_n()
+{
+	int ret = NFC_ERROR_NONE;
+
+	ret = nfc_mifare_dump(NULL, NFC_MIFARE_KEY_A, (unsigned char *)NFC_TAG_MIFARE_KEY_DEFAULT, NULL, NULL);
+
+	dts_check_ne(__func__, ret, NFC_ERROR_NONE, "nfc_mifare_dump_n not allow null tag");
+}
+
+static void nfc_tag_get_information_n()
+{
+	int ret = NFC_ERROR_NONE;
+	unsigned char *value = NULL;
+	int value_size = 0;
+
+	ret = nfc_tag_get_information(NULL, "UID", &value, &value_size);
+
+	dts_check_ne(__func__, ret, NFC_ERROR_NONE, "nfc_tag_get_information_n not allow null tag");
+}
+
+static void nfc_tag_retain_n()
+{
+	int ret = NFC_ERROR_NONE;
+
+	ret = nfc_tag_retain(NULL);
+
+	dts_check_ne(__func__, ret, NFC_ERROR_NONE, "nfc_tag_retain_n not allow null tag");
+}
+
+static void nfc_tag_release_n()
+{
+	int ret = NFC_ERROR_NONE;
+
+	ret = nfc_tag_release(NULL);
+
+	dts_check_ne(__func__, ret, NFC_ERROR_NONE, "nfc_tag_release_n not allow null tag");
+}
+
+static void nfc_manager_set_callback_executor_p()
+{
+	int ret = NFC_ERROR_NONE;
+
+	ret = nfc_manager_set_callback_executor(2, 16);
+	if( ret == NFC_ERROR_NONE )
+		ret = nfc_manager_set_callback_executor(0, 0);
+
+	dts_check_eq(__func__, ret, NFC_ERROR_NONE, "nfc_manager_set_callback_executor is faild");
+}
+
+static void nfc_manager_set_callback_executor_n()
+{
+	int ret = NFC_ERROR_NONE;
+
+	ret = nfc_manager_set_callback_executor(2, 0);
+
+	dts_check_ne(__func__, ret, NFC_ERROR_NONE, "nfc_manager_set_callback_executor_n not allow empty queue");
+}
+
+static void nfc_manager_set_callback_main_context_p()
+{
+	int ret = NFC_ERROR_NONE;
+
+	ret = nfc_manager_set_callback_main_context(NULL);
+	nfc_manager_unset_callback_main_context();
+
+	dts_check_eq(__func__, ret, NFC_ERROR_NONE, "nfc_manager_set_callback_main_context is faild");
+}
+
+static void nfc_manager_unset_callback_main_context_p()
+{
+	int ret = NFC_ERROR_NONE;
+
+	ret = nfc_manager_unset_callback_main_context();
+
+	dts_check_eq(__func__, ret, NFC_ERROR_NONE, "nfc_manager_unset_callback_main_context is faild");
+}
+
+static void nfc_manager_get_event_fd_p()
+{
+	int ret = NFC_ERROR_NONE;
+	int fd = -1;
+
+	ret = nfc_manager_get_event_fd(&fd);
+
+	dts_check_eq(__func__, ret, NFC_ERROR_NONE, "nfc_manager_get_event_fd is faild");
+}
+
+static void nfc_manager_drain_events_p()
+{
+	int ret = NFC_ERROR_NONE;
+	nfc_event_s events[8];
+	int fd = -1;
+	int count = 0;
+
+	ret = nfc_manager_get_event_fd(&fd);
+	if( ret == NFC_ERROR_NONE )
+		ret = nfc_manager_drain_events(events, 8, &count);
+
+	dts_check_eq(__func__, ret, NFC_ERROR_NONE, "nfc_manager_drain_events is faild");
+}
+
+static void nfc_manager_drain_events_n()
+{
+	int ret = NFC_ERROR_NONE;
+	nfc_event_s events[8];
+
+	ret = nfc_manager_drain_events(events, 8, NULL);
+
+	dts_check_ne(__func__, ret, NFC_ERROR_NONE, "nfc_manager_drain_events_n not allow null parameter");
+}
+
+static void nfc_tag_transceive_batch_n()
+{
+	int ret = NFC_ERROR_NONE;
+	unsigned char select[] = { 0x00, 0xa4, 0x04, 0x00, 0x00 };
+	nfc_tag_apdu_s commands[1] = { { select, sizeof(select) } };
+
+	ret = nfc_tag_transceive_batch(NULL, commands, 1, NFC_TAG_APDU_RULE_STOP_ON_ERROR, NULL, NULL);
+
+	dts_check_ne(__func__, ret, NFC_ERROR_NONE, "nfc_tag_transceive_batch_n not allow null parameter");
+}
+
+static void nfc_tag_transceive_sync_n()
+{
+	int ret = NFC_ERROR_NONE;
+	unsigned char *response = NULL;
+	int response_size = 0;
+
+	ret = nfc_tag_transceive_sync(NULL, NULL, 0, 1000, &response, &response_size);
+
+	dts_check_ne(__func__, ret, NFC_ERROR_NONE, "nfc_tag_transceive_sync_n not allow null parameter");
+}
+
+static void nfc_tag_read_ndef_sync_n()
+{
+	int ret = NFC_ERROR_NONE;
+
+	ret = nfc_tag_read_ndef_sync(NULL, 1000, NULL);
+
+	dts_check_ne(__func__, ret, NFC_ERROR_NONE, "nfc_tag_read_ndef_sync_n not allow null parameter");
+}
+
+static void nfc_p2p_get_send_queue_depth_n()
+{
+	int ret = NFC_ERROR_NONE;
+	int depth = 0;
+
+	ret = nfc_p2p_get_send_queue_depth(NULL, &depth);
+
+	dts_check_ne(__func__, ret, NFC_ERROR_NONE, "nfc_p2p_get_send_queue_depth_n not allow null parameter");
+}
+
+static void nfc_manager_get_stats_p()
+{
+	int ret = NFC_ERROR_NONE;
+	nfc_message_stats_s *stats = NULL;
+	int count = -1;
+
+	ret = nfc_manager_get_stats(&stats, &count);
+	free(stats);
+
+	MY_ASSERT(__func__, count >= 0, "negative count");
+	dts_check_eq(__func__, ret, NFC_ERROR_NONE, "nfc_manager_get_stats_p is faild");
+}
+
+static void nfc_manager_get_stats_n()
+{
+	int ret = NFC_ERROR_NONE;
+	int count = 0;
+
+	ret = nfc_manager_get_stats(NULL, &count);
+
+	dts_check_ne(__func__, ret, NFC_ERROR_NONE, "nfc_manager_get_stats_n not allow null");
+}
+
+static void nfc_manager_reset_stats_p()
+{
+	int ret = NFC_ERROR_NONE;
+
+	ret = nfc_manager_reset_stats();
+
+	dts_check_eq(__func__, ret, NFC_ERROR_NONE, "nfc_manager_reset_stats_p is faild");
+}
+
+static void nfc_manager_set_stats_snapshot_cb_n()
+{
+	int ret = NFC_ERROR_NONE;
+
+	ret = nfc_manager_set_stats_snapshot_cb(0, NULL, NULL);
+
+	dts_check_ne(__func__, ret, NFC_ERROR_NONE, "nfc_manager_set_stats_snapshot_cb_n not allow invalid parameter");
+}
+
+static void nfc_manager_get_counters_p()
+{
+	int ret = NFC_ERROR_NONE;
+	nfc_counters_s counters;
+
+	ret = nfc_manager_get_counters(&counters);
+
+	MY_ASSERT(__func__, counters.failures_by_error[0].error == NFC_ERROR_OUT_OF_MEMORY, "unexpected error order");
+	dts_check_eq(__func__, ret, NFC_ERROR_NONE, "nfc_manager_get_counters_p is faild");
+}
+
+static void nfc_manager_get_counters_n()
+{
+	int ret = NFC_ERROR_NONE;
+
+	ret = nfc_manager_get_counters(NULL);
+
+	dts_check_ne(__func__, ret, NFC_ERROR_NONE, "nfc_manager_get_counters_n not allow null");
+}
+
+static void nfc_manager_reset_counters_p()
+{
+	int ret = NFC_ERROR_NONE;
+	nfc_counters_s counters;
+
+	ret = nfc_manager_reset_counters();
+	nfc_manager_get_counters(&counters);
+
+	MY_ASSERT(__func__, counters.transceives == 0 && counters.failures == 0, "counters not reset");
+	dts_check_eq(__func__, ret, NFC_ERROR_NONE, "nfc_manager_reset_counters_p is faild");
+}
+
+static void nfc_manager_start_trace_p()
+{
+	int ret = NFC_ERROR_NONE;
+
+	ret = nfc_manager_start_trace("/tmp/utc_network_nfc.trace", 16);
+	nfc_manager_stop_trace();
+	unlink("/tmp/utc_network_nfc.trace");
+
+	dts_check_eq(__func__, ret, NFC_ERROR_NONE, "nfc_manager_start_trace_p is faild");
+}
+
+static void nfc_manager_start_trace_n()
+{
+	int ret = NFC_ERROR_NONE;
+
+	ret = nfc_manager_start_trace(NULL, 16);
+
+	dts_check_ne(__func__, ret, NFC_ERROR_NONE, "nfc_manager_start_trace_n not allow null");
+}
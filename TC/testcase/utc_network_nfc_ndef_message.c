@@ -14,6 +14,8 @@
 * limitations under the License.
 */
 
+#include <stdlib.h>
+#include <string.h>
 #include <tet_api.h>
 #include <nfc.h>
 
@@ -53,6 +55,17 @@ static void utc_nfc_ndef_message_remove_record_p(void);
 static void utc_nfc_ndef_message_remove_record_n(void);
 static void utc_nfc_ndef_message_get_record_p(void);
 static void utc_nfc_ndef_message_get_record_n(void);
+static void utc_nfc_ndef_record_view_next_p(void);
+static void utc_nfc_ndef_record_view_next_n(void);
+static void utc_nfc_ndef_message_foreach_record_view_p(void);
+static void utc_nfc_ndef_message_foreach_record_view_n(void);
+static void utc_nfc_ndef_parser_create_p(void);
+static void utc_nfc_ndef_parser_create_n(void);
+static void utc_nfc_ndef_parser_feed_p(void);
+static void utc_nfc_ndef_parser_feed_n(void);
+static void utc_nfc_ndef_message_view_get_record_p(void);
+static void utc_nfc_ndef_message_view_get_record_n(void);
+static void utc_nfc_ndef_message_view_detach_rawdata_p(void);
 
 
 struct tet_testlist tet_testlist[] = {
@@ -74,6 +87,17 @@ struct tet_testlist tet_testlist[] = {
 	{ utc_nfc_ndef_message_remove_record_n , NEGATIVE_TC_IDX },
 	{ utc_nfc_ndef_message_get_record_p , POSITIVE_TC_IDX },
 	{ utc_nfc_ndef_message_get_record_n , NEGATIVE_TC_IDX },
+	{ utc_nfc_ndef_record_view_next_p , POSITIVE_TC_IDX },
+	{ utc_nfc_ndef_record_view_next_n , NEGATIVE_TC_IDX },
+	{ utc_nfc_ndef_message_foreach_record_view_p , POSITIVE_TC_IDX },
+	{ utc_nfc_ndef_message_foreach_record_view_n , NEGATIVE_TC_IDX },
+	{ utc_nfc_ndef_parser_create_p , POSITIVE_TC_IDX },
+	{ utc_nfc_ndef_parser_create_n , NEGATIVE_TC_IDX },
+	{ utc_nfc_ndef_parser_feed_p , POSITIVE_TC_IDX },
+	{ utc_nfc_ndef_parser_feed_n , NEGATIVE_TC_IDX },
+	{ utc_nfc_ndef_message_view_get_record_p , POSITIVE_TC_IDX },
+	{ utc_nfc_ndef_message_view_get_record_n , NEGATIVE_TC_IDX },
+	{ utc_nfc_ndef_message_view_detach_rawdata_p , POSITIVE_TC_IDX },
 
 	{ NULL, 0 },
 };
@@ -280,3 +304,140 @@ static void utc_nfc_ndef_message_get_record_n(void)
 	dts_pass(__func__, "PASS");
 }
 
+static void utc_nfc_ndef_record_view_next_p(void)
+{
+	int ret ;
+	int offset = 0;
+	unsigned char rawdata[] = { 0xd1, 0x01, 0x03, 'U', 0x01, 'a', 'b' };
+	nfc_ndef_record_view_s record;
+	ret = nfc_ndef_record_view_next(rawdata, sizeof(rawdata), &offset, &record);
+	MY_ASSERT(__func__ , ret == NFC_ERROR_NONE , "FAIL");
+	MY_ASSERT(__func__ , record.payload == rawdata + 4 && record.payload_size == 3 , "FAIL");
+	dts_pass(__func__, "PASS");
+}
+
+static void utc_nfc_ndef_record_view_next_n(void)
+{
+	int ret ;
+	int offset = 0;
+	unsigned char rawdata[] = { 0xd1, 0x01, 0xc8, 'U', 0x01 };
+	nfc_ndef_record_view_s record;
+	ret = nfc_ndef_record_view_next(rawdata, sizeof(rawdata), &offset, &record);
+	MY_ASSERT(__func__,  ret != NFC_ERROR_NONE , "FAIL");
+	dts_pass(__func__, "PASS");
+}
+
+static bool _record_view_cb(const nfc_ndef_record_view_s *record, void *user_data)
+{
+	(*(int *)user_data)++;
+	return true;
+}
+
+static void utc_nfc_ndef_message_foreach_record_view_p(void)
+{
+	int ret ;
+	int count = 0;
+	unsigned char rawdata[] = { 0x91, 0x01, 0x03, 'U', 0x01, 'a', 'b', 0x51, 0x01, 0x03, 'T', 0x02, 'e', 'n' };
+	ret = nfc_ndef_message_foreach_record_view(rawdata, sizeof(rawdata), _record_view_cb, &count);
+	MY_ASSERT(__func__ , ret == NFC_ERROR_NONE && count == 2 , "FAIL");
+	dts_pass(__func__, "PASS");
+}
+
+static void utc_nfc_ndef_message_foreach_record_view_n(void)
+{
+	int ret ;
+	ret = nfc_ndef_message_foreach_record_view(NULL, 0, NULL, NULL);
+	MY_ASSERT(__func__,  ret != NFC_ERROR_NONE , "FAIL");
+	dts_pass(__func__, "PASS");
+}
+
+static void utc_nfc_ndef_parser_create_p(void)
+{
+	int ret ;
+	nfc_ndef_parser_h parser;
+	ret = nfc_ndef_parser_create(&parser, 1024, _record_view_cb, NULL);
+	MY_ASSERT(__func__ , ret == NFC_ERROR_NONE , "FAIL");
+	nfc_ndef_parser_destroy(parser);
+	dts_pass(__func__, "PASS");
+}
+
+static void utc_nfc_ndef_parser_create_n(void)
+{
+	int ret ;
+	ret = nfc_ndef_parser_create(NULL, 0, NULL, NULL);
+	MY_ASSERT(__func__,  ret != NFC_ERROR_NONE , "FAIL");
+	dts_pass(__func__, "PASS");
+}
+
+static void utc_nfc_ndef_parser_feed_p(void)
+{
+	int ret ;
+	int i;
+	int count = 0;
+	bool completed = false;
+	unsigned char rawdata[] = { 0xb1, 0x01, 0x02, 'T', 0x02, 'e', 0x56, 0x00, 0x01, 'n' };
+	nfc_ndef_parser_h parser;
+	nfc_ndef_parser_create(&parser, 1024, _record_view_cb, &count);
+	for( i = 0; i < sizeof(rawdata); i++ ){
+		ret = nfc_ndef_parser_feed(parser, rawdata + i, 1);
+		MY_ASSERT(__func__ , ret == NFC_ERROR_NONE , "FAIL");
+	}
+	nfc_ndef_parser_is_completed(parser, &completed);
+	nfc_ndef_parser_destroy(parser);
+	MY_ASSERT(__func__ , completed && count == 1 , "FAIL");
+	dts_pass(__func__, "PASS");
+}
+
+static void utc_nfc_ndef_parser_feed_n(void)
+{
+	int ret ;
+	unsigned char rawdata[] = { 0x16, 0x00, 0x01, 'n' };
+	nfc_ndef_parser_h parser;
+	nfc_ndef_parser_create(&parser, 1024, _record_view_cb, NULL);
+	ret = nfc_ndef_parser_feed(parser, rawdata, sizeof(rawdata));
+	nfc_ndef_parser_destroy(parser);
+	MY_ASSERT(__func__,  ret != NFC_ERROR_NONE , "FAIL");
+	dts_pass(__func__, "PASS");
+}
+
+static void utc_nfc_ndef_message_view_get_record_p(void)
+{
+	int ret ;
+	int count = 0;
+	unsigned char rawdata[] = { 0x91, 0x01, 0x03, 'U', 0x01, 'a', 'b', 0x51, 0x01, 0x03, 'T', 0x02, 'e', 'n' };
+	nfc_ndef_message_view_h view;
+	nfc_ndef_record_view_s record;
+	nfc_ndef_message_view_create(&view, rawdata, sizeof(rawdata));
+	ret = nfc_ndef_message_view_get_record(view, 1, &record);
+	nfc_ndef_message_view_get_record_count(view, &count);
+	nfc_ndef_message_view_destroy(view);
+	MY_ASSERT(__func__ , ret == NFC_ERROR_NONE && record.type_size == 1 && record.payload_size == 3 && count == 2 , "FAIL");
+	dts_pass(__func__, "PASS");
+}
+
+static void utc_nfc_ndef_message_view_get_record_n(void)
+{
+	int ret ;
+	unsigned char rawdata[] = { 0xd1, 0x01, 0x03, 'U', 0x01, 'a', 'b' };
+	nfc_ndef_message_view_h view;
+	nfc_ndef_record_view_s record;
+	nfc_ndef_message_view_create(&view, rawdata, sizeof(rawdata));
+	ret = nfc_ndef_message_view_get_record(view, 1, &record);
+	nfc_ndef_message_view_destroy(view);
+	MY_ASSERT(__func__,  ret != NFC_ERROR_NONE , "FAIL");
+	dts_pass(__func__, "PASS");
+}
+
+static void utc_nfc_ndef_message_view_detach_rawdata_p(void)
+{
+	int ret ;
+	int size = 0;
+	unsigned char *bytes = NULL;
+	unsigned char rawdata[] = { 0xd1, 0x01, 0x03, 'U', 0x01, 'a', 'b' };
+	nfc_ndef_message_view_h view;
+	nfc_ndef_message_view_create(&view, rawdata, sizeof(rawdata));
+	ret = nfc_ndef_message_view_detach_rawdata(view, &bytes, &size);
+	MY_ASSERT(__func__ , ret == NFC_ERROR_NONE && size == sizeof(rawdata) && memcmp(bytes, rawdata, size) == 0 , "FAIL");
+	free(bytes);
+	dts_pass(__func__, "PASS");
+}
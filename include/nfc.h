@@ -19,6 +19,7 @@
 #define __NFC_H__
 
 #include <tizen.h>
+#include <glib.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -106,6 +107,15 @@ typedef enum {
 	NFC_NFCIP1_INITIATOR,	/**< NFCIP1_INITIATOR */
 } nfc_tag_type_e;
 
+/**
+ * @brief Enumerations for the key used to authenticate a MIFARE classic sector
+ * @ingroup CAPI_NETWORK_NFC_TAG_MIFARE_MODULE
+ */
+typedef enum {
+	NFC_MIFARE_KEY_A = 0x00,	/**< Authenticate with key A */
+	NFC_MIFARE_KEY_B,	/**< Authenticate with key B */
+} nfc_mifare_key_type_e;
+
 
 
 /**
@@ -168,6 +178,49 @@ typedef enum {
 	NFC_AC_TYPE_UNKNOWN, /* No selected preferd AC */
 } nfc_ac_type_e ;
 
+/**
+ * @brief Enumerations for the verbosity of the library log
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ *
+ * @see nfc_manager_set_log_level()
+ */
+typedef enum {
+	NFC_LOG_LEVEL_NONE = 0, /**< Nothing is logged */
+	NFC_LOG_LEVEL_ERROR, /**< Failed operations */
+	NFC_LOG_LEVEL_WARN, /**< Recoverable problems such as timed out requests */
+	NFC_LOG_LEVEL_INFO, /**< One line per event received from the NFC daemon */
+	NFC_LOG_LEVEL_DEBUG, /**< Successful operations and internal state changes */
+} nfc_log_level_e;
+
+/**
+ * @brief Enumerations for the events read with nfc_manager_drain_events()
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ *
+ * @see nfc_event_s
+ */
+typedef enum {
+	NFC_EVENT_TYPE_ACTIVATION_CHANGED = 0, /**< NFC was switched on or off, @a arg is @c true when activated */
+	NFC_EVENT_TYPE_TAG_DISCOVERED, /**< A tag was attached, @a handle is its #nfc_tag_h */
+	NFC_EVENT_TYPE_TAG_DETACHED, /**< A tag was detached, @a handle is its #nfc_tag_h */
+	NFC_EVENT_TYPE_NDEF_DISCOVERED, /**< An attached tag holds an NDEF message, @a handle is its #nfc_tag_h and the payload is the raw message */
+	NFC_EVENT_TYPE_P2P_DISCOVERED, /**< A P2P target was attached, @a handle is its #nfc_p2p_target_h */
+	NFC_EVENT_TYPE_P2P_DETACHED, /**< A P2P target was detached, @a handle is its #nfc_p2p_target_h */
+	NFC_EVENT_TYPE_P2P_DATA_RECEIVED, /**< A P2P target sent data, @a handle is its #nfc_p2p_target_h and the payload is the raw NDEF message */
+	NFC_EVENT_TYPE_SE_EVENT, /**< A secure element event, @a arg is the #nfc_se_event_e */
+	NFC_EVENT_TYPE_SE_TRANSACTION, /**< A secure element transaction, the payload is the AID followed by the parameter and @a arg is the size of the AID */
+} nfc_event_type_e;
+
+/**
+ * @brief Enumerations for the continuation rules of nfc_tag_transceive_batch()
+ * @details The values are flags and can be combined.
+ * @ingroup CAPI_NETWORK_NFC_TAG_MODULE
+ */
+typedef enum {
+	NFC_TAG_APDU_RULE_NONE = 0x00, /**< Every command is sent whatever the previous responses were */
+	NFC_TAG_APDU_RULE_STOP_ON_ERROR = 0x01, /**< The script stops after a response whose status word is not 9000 */
+	NFC_TAG_APDU_RULE_FOLLOW_GET_RESPONSE = 0x02, /**< A 61xx status word is answered with GET RESPONSE and the data are joined into one response */
+} nfc_tag_apdu_rule_e;
+
 
 
 
@@ -183,6 +236,58 @@ typedef struct ndef_record_s *nfc_ndef_record_h;
  */
 typedef struct ndef_message_s *nfc_ndef_message_h;
 
+/**
+ * @brief A record of a raw NDEF message, referring to the message bytes in place
+ * @details The pointers point into the buffer the view was taken from and are valid as long as that buffer is.
+ * A field which is absent from the record has a NULL pointer and a size of 0.
+ * @ingroup CAPI_NETWORK_NFC_NDEF_MESSAGE_MODULE
+ *
+ * @see nfc_ndef_record_view_next()
+ * @see nfc_ndef_message_foreach_record_view()
+ */
+typedef struct {
+	nfc_record_tnf_e tnf;	/**< The TNF (Type Name Format) of the record */
+	bool message_begin;	/**< The MB (Message Begin) flag */
+	bool message_end;	/**< The ME (Message End) flag */
+	bool chunked;	/**< The CF (Chunk Flag), the payload continues in the next record */
+	const unsigned char *type;	/**< The record type */
+	int type_size;	/**< The size of @a type in bytes */
+	const unsigned char *id;	/**< The record id */
+	int id_size;	/**< The size of @a id in bytes */
+	const unsigned char *payload;	/**< The record payload */
+	int payload_size;	/**< The size of @a payload in bytes */
+} nfc_ndef_record_view_s;
+
+/**
+ * @brief Called for each record of a raw NDEF message.
+ * @ingroup CAPI_NETWORK_NFC_NDEF_MESSAGE_MODULE
+ *
+ * @param [in] record The record, valid only inside the callback
+ * @param [in] user_data The user data passed from nfc_ndef_message_foreach_record_view()
+ *
+ * @return @c true to continue with the next record, \n @c false to stop the iteration.
+ * @pre nfc_ndef_message_foreach_record_view() invokes this callback.
+ *
+ * @see nfc_ndef_message_foreach_record_view()
+ */
+typedef bool (*nfc_ndef_record_view_cb)(const nfc_ndef_record_view_s *record, void *user_data);
+
+/**
+ * @brief The handle to an incremental NDEF parser
+ * @ingroup CAPI_NETWORK_NFC_NDEF_MESSAGE_MODULE
+ *
+ * @see nfc_ndef_parser_create()
+ */
+typedef struct nfc_ndef_parser_s *nfc_ndef_parser_h;
+
+/**
+ * @brief The handle to a raw NDEF message whose records are parsed when they are accessed
+ * @ingroup CAPI_NETWORK_NFC_NDEF_MESSAGE_MODULE
+ *
+ * @see nfc_ndef_message_view_create()
+ */
+typedef struct nfc_ndef_message_view_s *nfc_ndef_message_view_h;
+
 /**
  * @brief The handle to the NFC tag
  * @ingroup CAPI_NETWORK_NFC_TAG_MODULE
@@ -196,6 +301,116 @@ typedef struct net_nfc_target_info_s *nfc_tag_h;
  */
 typedef void* nfc_p2p_target_h;
 
+/**
+ * @brief Statistics of the pool of asynchronous operation contexts
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ *
+ * @see nfc_manager_get_callback_pool_stats()
+ */
+typedef struct {
+	int capacity;	/**< Number of contexts held by the pool */
+	int in_use;	/**< Number of contexts currently used by pending operations */
+	int high_water;	/**< Highest value of @a in_use since the pool was created */
+	unsigned int exhausted;	/**< Number of operations which found the pool empty and fell back to the heap */
+} nfc_callback_pool_stats_s;
+
+/**
+ * @brief Latency distribution of one stage of handling a message of the NFC daemon
+ * @details Percentiles and extremes are bucketed, they are at most 1/16 above the exact value.
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ *
+ * @see nfc_message_stats_s
+ */
+typedef struct {
+	unsigned long long count;	/**< Number of samples, the other members are 0 without samples */
+	unsigned long long min_ns;	/**< Shortest sample in nanoseconds */
+	unsigned long long mean_ns;	/**< Average of the samples in nanoseconds */
+	unsigned long long p50_ns;	/**< Median in nanoseconds */
+	unsigned long long p90_ns;	/**< 90th percentile in nanoseconds */
+	unsigned long long p99_ns;	/**< 99th percentile in nanoseconds */
+	unsigned long long p999_ns;	/**< 99.9th percentile in nanoseconds */
+	unsigned long long max_ns;	/**< Longest sample in nanoseconds */
+} nfc_latency_stats_s;
+
+/**
+ * @brief Latencies of one kind of message of the NFC daemon, such as a tag discovery or the response to a transceive
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ *
+ * @see nfc_manager_get_stats()
+ */
+typedef struct {
+	int message;	/**< The message number of the NFC daemon */
+	const char *name;	/**< The name of the message, such as "TRANSCEIVE" or "TAG_DISCOVERED" */
+	nfc_latency_stats_s response;	/**< From issuing a tag operation to the arrival of its response, only for responses to tag operations */
+	nfc_latency_stats_s dispatch;	/**< From the arrival of the message until the library returns to the daemon, including callbacks invoked on the event thread */
+	nfc_latency_stats_s callback;	/**< Until each callback invoked for the message returns, from issuing the operation for responses to tag operations and from the arrival of the message otherwise */
+} nfc_message_stats_s;
+
+/**
+ * @brief The number of error codes counted by #nfc_counters_s
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ */
+#define NFC_COUNTERS_ERROR_COUNT 16
+
+/**
+ * @brief Number of operations which failed with one error code
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ *
+ * @see nfc_counters_s
+ */
+typedef struct {
+	nfc_error_e error;	/**< The error code */
+	unsigned long long count;	/**< Number of operations which failed with the error */
+} nfc_error_count_s;
+
+/**
+ * @brief Operations of the process since the library started or since nfc_manager_reset_counters()
+ * @details An operation is counted when it is requested, including requests the NFC daemon refuses.
+ * Bytes are counted when the NFC daemon accepts the request or delivers the data.
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ *
+ * @see nfc_manager_get_counters()
+ */
+typedef struct {
+	unsigned long long transceives;	/**< Calls of nfc_tag_transceive() */
+	unsigned long long ndef_reads;	/**< Calls of nfc_tag_read_ndef() */
+	unsigned long long ndef_writes;	/**< Calls of nfc_tag_write_ndef() */
+	unsigned long long ndef_formats;	/**< Calls of nfc_tag_format_ndef() */
+	unsigned long long mifare_operations;	/**< Calls of the nfc_mifare_* operations */
+	unsigned long long p2p_sends;	/**< Calls of nfc_p2p_send() */
+	unsigned long long p2p_receives;	/**< Messages received from peers */
+	unsigned long long se_events;	/**< Events of the secure element */
+	unsigned long long bytes_sent;	/**< Bytes sent to tags and peers */
+	unsigned long long bytes_received;	/**< Bytes received from tags and peers */
+	unsigned long long failures;	/**< Operations which failed, when requested or by their result */
+	nfc_error_count_s failures_by_error[NFC_COUNTERS_ERROR_COUNT];	/**< The failures by error code, in the order of #nfc_error_e */
+} nfc_counters_s;
+
+/**
+ * @brief An event read with nfc_manager_drain_events()
+ * @details The handle and the payload stay valid until the next call of nfc_manager_drain_events().
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ *
+ * @see nfc_manager_drain_events()
+ */
+typedef struct {
+	nfc_event_type_e type;	/**< The type of the event */
+	int result;	/**< The result of the event, #NFC_ERROR_NONE or a negative error value */
+	void *handle;	/**< The tag or P2P target the event concerns, NULL for other events */
+	int arg;	/**< A value depending on @a type */
+	const unsigned char *payload;	/**< The data of the event, NULL when it has none */
+	int payload_size;	/**< The size of @a payload in bytes */
+} nfc_event_s;
+
+/**
+ * @brief An APDU command of a script passed to nfc_tag_transceive_batch()
+ * @ingroup CAPI_NETWORK_NFC_TAG_MODULE
+ */
+typedef struct {
+	const unsigned char *command;	/**< The command APDU */
+	int command_size;	/**< The size of @a command in bytes */
+} nfc_tag_apdu_s;
+
 /**
  * @brief The default factory key.
  * @details The key is 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
@@ -356,6 +571,25 @@ typedef bool (*nfc_tag_information_cb)(const char *key, const unsigned char *val
  */
 typedef void (* nfc_tag_transceive_completed_cb)(nfc_error_e result, unsigned char *buffer, int buffer_size, void *user_data);
 
+/**
+ * @brief Called after nfc_tag_transceive_batch() has completed.
+ * @details The responses are packed in the order of their commands. Each one is preceded by its size as two bytes, most significant first,
+ * and ends with its status word.
+ * @ingroup CAPI_NETWORK_NFC_TAG_MODULE
+ *
+ * @remarks @a responses will be automatically destroyed when the callback function returns. (Do not release @a responses.)\n
+ * When the script stopped early, @a response_count is less than the number of commands.
+ *
+ * @param [in] result The result of the exchange, #NFC_ERROR_NONE unless the tag could not be reached
+ * @param [in] response_count The number of responses in @a responses
+ * @param [in] responses The packed responses
+ * @param [in] responses_size The size of @a responses in bytes
+ * @param [in] user_data The user data passed from nfc_tag_transceive_batch()
+ *
+ * @see nfc_tag_transceive_batch()
+ */
+typedef void (* nfc_tag_transceive_batch_completed_cb)(nfc_error_e result, int response_count, unsigned char *responses, int responses_size, void *user_data);
+
 /**
  * @brief Called after the nfc_tag_write_ndef() has completed.
  * @ingroup CAPI_NETWORK_NFC_TAG_MODULE
@@ -493,6 +727,43 @@ typedef void (* nfc_mifare_transfer_completed_cb)(nfc_error_e result, void *user
  */
 typedef void (* nfc_mifare_restore_completed_cb)(nfc_error_e result, void *user_data);
 
+/**
+ * @brief Called after nfc_mifare_read_sector() has completed
+ * @ingroup CAPI_NETWORK_NFC_TAG_MIFARE_MODULE
+ *
+ * @remarks @a buffer is valid only inside the callback. It is NULL if the sector could not be read.
+ *
+ * @param [in] result The result of nfc_mifare_read_sector()
+ * @param [in] buffer The blocks of the sector, including the sector trailer
+ * @param [in] buffer_size The size of @a buffer in bytes
+ * @param [in] user_data The user data passed from nfc_mifare_read_sector()
+ * @see nfc_mifare_read_sector()
+ */
+typedef void (* nfc_mifare_read_sector_completed_cb)(nfc_error_e result, unsigned char *buffer, int buffer_size, void *user_data);
+
+/**
+ * @brief Called after nfc_mifare_write_sector() has completed
+ * @ingroup CAPI_NETWORK_NFC_TAG_MIFARE_MODULE
+ * @param [in] result The result of nfc_mifare_write_sector()
+ * @param [in] user_data The user data passed from nfc_mifare_write_sector()
+ * @see nfc_mifare_write_sector()
+ */
+typedef void (* nfc_mifare_write_sector_completed_cb)(nfc_error_e result, void *user_data);
+
+/**
+ * @brief Called after nfc_mifare_dump() has completed
+ * @ingroup CAPI_NETWORK_NFC_TAG_MIFARE_MODULE
+ *
+ * @remarks @a buffer is valid only inside the callback. It is NULL if the card could not be read.
+ *
+ * @param [in] result The result of nfc_mifare_dump()
+ * @param [in] buffer Every block of the card in block order
+ * @param [in] buffer_size The size of @a buffer in bytes
+ * @param [in] user_data The user data passed from nfc_mifare_dump()
+ * @see nfc_mifare_dump()
+ */
+typedef void (* nfc_mifare_dump_completed_cb)(nfc_error_e result, unsigned char *buffer, int buffer_size, void *user_data);
+
 
 
 /**
@@ -562,6 +833,21 @@ typedef void (*nfc_p2p_send_completed_cb)(nfc_error_e result, void *user_data);
  */
 typedef void (*nfc_p2p_data_recived_cb)(nfc_p2p_target_h target, nfc_ndef_message_h message, void *user_data);
 
+/**
+ * @brief Called when data has been received from the peer-to-peer target, with the message left unparsed.
+ * @ingroup CAPI_NETWORK_NFC_P2P_MODULE
+ *
+ * @remarks @a message belongs to the application, which may keep it after the callback returns and must release it with nfc_ndef_message_view_destroy().
+ *
+ * @param [in] target The handle to p2p target
+ * @param [in] message The received message
+ * @param [in] user_data The user data passed from nfc_p2p_set_message_view_received_cb()
+ *
+ * @see nfc_p2p_set_message_view_received_cb()
+ * @see nfc_p2p_unset_message_view_received_cb()
+ */
+typedef void (*nfc_p2p_message_view_received_cb)(nfc_p2p_target_h target, nfc_ndef_message_view_h message, void *user_data);
+
 
 /**
  * @brief Called after nfc_p2p_connection_handover() has completed.
@@ -581,6 +867,38 @@ typedef void (*nfc_p2p_data_recived_cb)(nfc_p2p_target_h target, nfc_ndef_messag
  */
 typedef void (*nfc_p2p_connection_handover_completed_cb)(nfc_error_e result, nfc_ac_type_e carrior, void * ac_data, int ac_data_size , void *user_data);
 
+/**
+ * @brief Called for each line held by the in-memory log buffer.
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ *
+ * @remarks @a message is valid only inside the callback. (Do not release @a message.)
+ *
+ * @param [in] level The level the line was logged with
+ * @param [in] timestamp_ms The monotonic time the line was logged at, in milliseconds
+ * @param [in] message The formatted line
+ * @param [in] user_data The user data passed from nfc_manager_dump_log()
+ *
+ * @return @c true to continue with the next line, \n @c false to stop the dump.
+ * @pre nfc_manager_dump_log() invokes this callback.
+ *
+ * @see nfc_manager_dump_log()
+ */
+typedef bool (*nfc_log_cb)(nfc_log_level_e level, unsigned long long timestamp_ms, const char *message, void *user_data);
+
+/**
+ * @brief Called periodically with the latencies of the last interval.
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ *
+ * @remarks @a stats is valid only inside the callback. (Do not release @a stats.)
+ *
+ * @param [in] stats The latencies of the messages which were handled since the library started, the samples only cover the interval
+ * @param [in] count The number of elements of @a stats
+ * @param [in] user_data The user data passed from nfc_manager_set_stats_snapshot_cb()
+ *
+ * @see nfc_manager_set_stats_snapshot_cb()
+ */
+typedef void (*nfc_stats_snapshot_cb)(const nfc_message_stats_s *stats, int count, void *user_data);
+
 /**
  * @brief Gets the value that indicates whether NFC is supported.
  * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
@@ -849,6 +1167,9 @@ int nfc_manager_get_tag_filter(void);
  * @brief Gets current connected tag.
  * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
  *
+ * @remarks When several tags are attached, the one attached last is returned.
+ * @remarks The tag is returned retained, the caller must release it with nfc_tag_release() when it no longer uses it.
+ *
  * @param [out] tag The connected tag
  *
  * @return 0 on success, otherwise a negative error value.
@@ -856,6 +1177,7 @@ int nfc_manager_get_tag_filter(void);
  * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
  * @retval #NFC_ERROR_NO_DEVICE There is no connected tag
  *
+ * @see nfc_tag_release()
  */
 int nfc_manager_get_connected_tag(nfc_tag_h *tag);
 
@@ -900,179 +1222,498 @@ int nfc_manager_set_system_handler_enable(bool enable);
  */
 bool nfc_manager_is_system_handler_enabled(void);
 
-
 /**
- * @brief Creates a record with given parameter value.
- * @ingroup CAPI_NETWORK_NFC_NDEF_RECORD_MODULE
- *
- * @remarks Every data buffer is deeply copied.\n
- * Every data is a byte array(binary data).
+ * @brief Sets the number of contexts preallocated for asynchronous tag operations.
+ * @details Every tag, NDEF and MIFARE operation issued with a callback needs a context until its completion is delivered.\n
+ * Contexts are taken from a fixed-size pool so that the hot path does not touch the heap. When the pool is empty the context is allocated from the heap instead.
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ * @remarks In default, the pool holds 64 contexts.\n
+ * This function must not be called while other threads are issuing tag operations.
  *
- * @param [out] record A handle to record
- * @param [in] tnf The type name format
- * @param [in] type The specified type name
- * @param [in] type_size The byte size of type
- * @param [in] id The record ID
- * @param [in] id_size The byte size of ID
- * @param [in] payload The payload of this record
- * @param [in] payload_size The byte size of payload
+ * @param [in] size The number of contexts, from 1 to 65535
  *
  * @return 0 on success, otherwise a negative error value.
  * @retval #NFC_ERROR_NONE Successful
  * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
  * @retval #NFC_ERROR_OUT_OF_MEMORY Out of memory
- * @see nfc_ndef_record_create_text()
- * @see nfc_ndef_record_create_uri()
- * @see nfc_ndef_record_create_mime()
- * @see nfc_ndef_record_destroy()
+ * @retval #NFC_ERROR_DEVICE_BUSY Operations using the current pool are still pending
+ *
+ * @see nfc_manager_get_callback_pool_stats()
  */
-int nfc_ndef_record_create(nfc_ndef_record_h *record, nfc_record_tnf_e tnf, const unsigned char *type, int type_size, const unsigned char *id, int id_size, const unsigned char *payload, int payload_size);
-
+int nfc_manager_set_callback_pool_size(int size);
 
 /**
- * @brief Creates a record with text type payload
- * @ingroup CAPI_NETWORK_NFC_NDEF_RECORD_MODULE
- *
- * @remarks This function does not encode the text. @a text will be assumed as that it is already encoded with encode type.\n
- * The text buffer will be deeply copied.\n
- * The record is created in this format\n
- * - TNF : NFC_RECORD_TNF_WELL_KNOWN\n
- * - type : "T"\n
- * - payload : encode and header information + language code + text \n
- * Defined in Record Type Definition Technical Specifications.
+ * @brief Gets the usage statistics of the asynchronous operation context pool.
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
  *
- * @param [out] record A handle to record
- * @param [in] text The encoded text
- * @param [in] lang_code The language code string value followed by IANA[RFC 3066] (ex: en-US, ko-KR)
- * @param [in] encode The encoding type
+ * @param [out] stats The statistics of the pool
  *
  * @return 0 on success, otherwise a negative error value.
  * @retval #NFC_ERROR_NONE Successful
  * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
  * @retval #NFC_ERROR_OUT_OF_MEMORY Out of memory
- * @see nfc_ndef_record_create()
- * @see nfc_ndef_record_create_uri()
- * @see nfc_ndef_record_create_mime()
- * @see nfc_ndef_record_destroy()
- * @see nfc_ndef_record_get_text()
- * @see nfc_ndef_record_get_langcode()
- * @see nfc_ndef_record_get_encode_type()
+ *
+ * @see nfc_manager_set_callback_pool_size()
  */
-int nfc_ndef_record_create_text(nfc_ndef_record_h *record, const char *text, const char *lang_code, nfc_encode_type_e encode);
+int nfc_manager_get_callback_pool_stats(nfc_callback_pool_stats_s *stats);
 
 /**
- * @brief Creates a record with URI type payload
- * @ingroup CAPI_NETWORK_NFC_NDEF_RECORD_MODULE
- *
- * @remarks The uri string will be deep copied.\n
- * The record is created in this format\n
- * - TNF : NFC_RECORD_TNF_WELL_KNOWN\n
- * - type : "U"\n
- * - payload : procotol scheme + uri\n
- * Defined in Record Type Definition Technical Specifications.
+ * @brief Sets the time after which an unanswered tag operation is given up.
+ * @details When the timeout expires the completed callback of the operation is invoked with #NFC_ERROR_TIMED_OUT.\n
+ * The deadline is taken when the operation is issued. Changing the timeout does not affect operations already issued.
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ * @remarks In default, the timeout is 10000 milliseconds.\n
+ * Timeouts are processed by a thread of the library, no main loop has to run for them. The callbacks of expired operations are delivered like the other callbacks, see nfc_manager_set_callback_executor() and nfc_manager_set_callback_main_context(); by default they are invoked on that thread.
  *
- * @param [out] record A handle to record
- * @param [in] protocol_scheme	The protocol scheme
- * @param [in] uri	The URI string that will be stored in the payload
+ * @param [in] timeout_ms The timeout in milliseconds, 0 to wait forever
  *
  * @return 0 on success, otherwise a negative error value.
  * @retval #NFC_ERROR_NONE Successful
  * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
- * @retval #NFC_ERROR_OUT_OF_MEMORY Out of memory
- * @see nfc_ndef_record_create()
- * @see nfc_ndef_record_create_text()
- * @see nfc_ndef_record_create_mime()
- * @see nfc_ndef_record_destroy()
- * @see nfc_ndef_record_get_uri()
+ *
+ * @see nfc_tag_cancel()
  */
-int nfc_ndef_record_create_uri(nfc_ndef_record_h* record, const char *uri);
-
+int nfc_manager_set_request_timeout(int timeout_ms);
 
 /**
- * @brief Creates a record with MIME type payload
- * @ingroup CAPI_NETWORK_NFC_NDEF_RECORD_MODULE
- *
- * @remarks The data buffer will be deep copied.\n
- * The data are bytes array(binary data).\n
- * The mime_type string will deep copied.\n
- * The record is created in this format\n
- * - TNF : NFC_RECORD_TNF_MIME_MEDIA\n
- * - type : mime type\n
- * - payload : data\n
- * Defined in Record Type Definition Technical Specifications.
+ * @brief Sets the threads on which callbacks are invoked.
+ * @details By default callbacks are invoked on the thread which receives the events of the NFC daemon, so a slow callback delays every later event.\n
+ * With @a worker_count greater than 0, callbacks are handed to that many worker threads of the library instead.
+ * Callbacks concerning the same tag or P2P target, the callbacks of SE events and those of the manager are each invoked in the order of their events,
+ * unrelated callbacks may run in parallel.\n
+ * Each worker queues at most @a queue_size callbacks. When a queue is full the delivery of events waits for the worker.
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ * @remarks Data passed to a deferred callback is copied, it is valid until the callback returns like in the default mode.\n
+ * Switching the mode waits until the callbacks already queued have run. It fails when called from a callback.
  *
- * @param [out] record A handle to record
- * @param [in] mime_type	The mime type [RFC 2046] (ex. text/plain, image/jpeg )\nThis value is stored in type field
- * @param [in] data	The pointer of data
- * @param [in] data_size	The size of data
+ * @param [in] worker_count The number of worker threads, 0 to invoke callbacks on the event thread
+ * @param [in] queue_size The number of callbacks each worker can queue, ignored when @a worker_count is 0
  *
  * @return 0 on success, otherwise a negative error value.
  * @retval #NFC_ERROR_NONE Successful
  * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
  * @retval #NFC_ERROR_OUT_OF_MEMORY Out of memory
- * @see nfc_ndef_record_create()
- * @see nfc_ndef_record_create_uri()
- * @see nfc_ndef_record_create_text()
- * @see nfc_ndef_record_destroy()
- * @see nfc_ndef_record_get_mime_type()
+ * @retval #NFC_ERROR_OPERATION_FAILED Called from a callback
  */
-int nfc_ndef_record_create_mime(nfc_ndef_record_h* record, const char *mime_type, const unsigned char *data, int data_size);
-
+int nfc_manager_set_callback_executor(int worker_count, int queue_size);
 
 /**
- * @brief Destroys the record handle
- * @ingroup CAPI_NETWORK_NFC_NDEF_RECORD_MODULE
+ * @brief Invokes callbacks from a GLib main context of the application.
+ * @details Events are queued and delivered from a source attached to @a context, so callbacks run on the thread which iterates that context.
+ * All events which arrive before the context gets to run are delivered by one dispatch of the source, in the order of their events.
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ * @remarks While a main context is set it takes precedence over the workers of nfc_manager_set_callback_executor().\n
+ * Data passed to a callback is copied, it is valid until the callback returns like in the default mode.\n
+ * Setting another context first invokes the callbacks still queued for the previous one. It fails when called from a callback which is not invoked from a main context.
  *
- * @param [in] record The handle to record
+ * @param [in] context The main context to invoke callbacks from, NULL for the default main context
  *
  * @return 0 on success, otherwise a negative error value.
  * @retval #NFC_ERROR_NONE Successful
- * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
- * @see nfc_ndef_record_create()
- * @see nfc_ndef_record_create_text()
- * @see nfc_ndef_record_create_uri()
- * @see nfc_ndef_record_create_mime()
+ * @retval #NFC_ERROR_OPERATION_FAILED Called from a callback or out of file descriptors
+ *
+ * @see nfc_manager_unset_callback_main_context()
  */
-int nfc_ndef_record_destroy(nfc_ndef_record_h record);
+int nfc_manager_set_callback_main_context(GMainContext *context);
 
 /**
- * @brief Sets record ID
- * @ingroup CAPI_NETWORK_NFC_NDEF_RECORD_MODULE
- *
- * @remarks The ID buffer are deep copied.
+ * @brief Stops invoking callbacks from the main context set by nfc_manager_set_callback_main_context().
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ * @remarks Callbacks still queued are invoked on the calling thread before this function returns, after the callbacks the main context is invoking at that time.
+ * Called from a callback of the main context, the callbacks still queued are invoked by the main context after that callback.
  *
- * @param [in] record The handle to record
- * @param [in] id The record ID
- * @param [in] id_size The size of ID in bytes
  * @return 0 on success, otherwise a negative error value.
- * @retval	#NFC_ERROR_NONE Successful
- * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
- * @see nfc_ndef_record_get_id()
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_OPERATION_FAILED Called from a callback which is not invoked from a main context
+ *
+ * @see nfc_manager_set_callback_main_context()
  */
-int nfc_ndef_record_set_id(nfc_ndef_record_h record, unsigned char *id, int id_size);
+int nfc_manager_unset_callback_main_context(void);
 
 /**
- * @brief Gets record ID
- * @ingroup CAPI_NETWORK_NFC_NDEF_RECORD_MODULE
- *
- * @remarks It may return NULL pointer if the ID is not exist\n
- *  This function gives you  the pointer of ID that is contained by record\n
- *  Do not free the ID. It will be released when @a record is destroyed by nfc_ndef_record_destroy().
+ * @brief Gets a file descriptor which becomes readable when events are queued for nfc_manager_drain_events().
+ * @details The first call starts queueing events, from then on every event listed in #nfc_event_type_e is queued in addition to invoking the callbacks which are set.
+ * The descriptor can be added to poll, select or epoll, it stays readable while queued events are left.
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ * @remarks The descriptor is owned by the library, it must not be read or closed.\n
+ * Completions of requests such as nfc_tag_transceive() are still reported to their callbacks only.
  *
- * @param [in] record The handle to record
- * @param [out] id The record ID ( do not free )
- * @param [out] id_size The size of ID in bytes
+ * @param [out] fd The file descriptor
  *
  * @return 0 on success, otherwise a negative error value.
  * @retval #NFC_ERROR_NONE Successful
  * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
- * @see nfc_ndef_record_set_id()
+ * @retval #NFC_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval #NFC_ERROR_OPERATION_FAILED Out of file descriptors
+ *
+ * @see nfc_manager_drain_events()
  */
-int nfc_ndef_record_get_id(nfc_ndef_record_h record, unsigned char **id, int *size);
+int nfc_manager_get_event_fd(int *fd);
 
 /**
- * @brief Gets record payload.
- * @ingroup CAPI_NETWORK_NFC_NDEF_RECORD_MODULE
+ * @brief Takes the oldest queued events.
+ * @details Events are copied into @a events in the order they arrived. Handles and payloads of the returned events are kept valid until the next call,
+ * which releases them; a call with @a max 0 only releases them.
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ * @remarks Events must be drained from one thread at a time.\n
+ * When the queue is full, new events are dropped and logged until it is drained.
+ *
+ * @param [out] events The array to fill
+ * @param [in] max The number of elements of @a events
+ * @param [out] count The number of events filled in, 0 when none is queued
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #NFC_ERROR_OPERATION_FAILED nfc_manager_get_event_fd() was not called
+ *
+ * @see nfc_manager_get_event_fd()
+ */
+int nfc_manager_drain_events(nfc_event_s *events, int max, int *count);
+
+/**
+ * @brief Gets the latencies of the messages of the NFC daemon handled since the library started or since nfc_manager_reset_stats().
+ * @details Each message is timed when it arrives and when the library returns to the daemon, each callback when it returns, and tag operations when they are issued.
+ * Every kind of message which was handled has one element.
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ * @remarks @a stats must be released with free() by you.
+ *
+ * @param [out] stats The latencies
+ * @param [out] count The number of elements of @a stats
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #NFC_ERROR_OUT_OF_MEMORY Out of memory
+ *
+ * @see nfc_manager_reset_stats()
+ * @see nfc_manager_set_stats_snapshot_cb()
+ */
+int nfc_manager_get_stats(nfc_message_stats_s **stats, int *count);
+
+/**
+ * @brief Restarts the latencies reported by nfc_manager_get_stats().
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ * @remarks The snapshots of nfc_manager_set_stats_snapshot_cb() are not affected.
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_OUT_OF_MEMORY Out of memory
+ *
+ * @see nfc_manager_get_stats()
+ */
+int nfc_manager_reset_stats(void);
+
+/**
+ * @brief Registers a callback function which receives the latencies of every interval.
+ * @details The first interval starts with this call, each snapshot covers the samples since the previous one.
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ * @remarks The interval is timed by a thread of the library, no main loop has to run for it. The callback is delivered like the other callbacks, see nfc_manager_set_callback_executor() and nfc_manager_set_callback_main_context(); by default it is invoked on that thread.\n
+ * Registering again replaces the callback and restarts the interval.
+ *
+ * @param [in] interval_ms The interval in milliseconds
+ * @param [in] callback The callback function to invoke after each interval
+ * @param [in] user_data The user data to be passed to the callback function
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #NFC_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval #NFC_ERROR_OPERATION_FAILED The thread of the library could not be started
+ *
+ * @see nfc_manager_unset_stats_snapshot_cb()
+ * @see nfc_stats_snapshot_cb()
+ */
+int nfc_manager_set_stats_snapshot_cb(int interval_ms, nfc_stats_snapshot_cb callback, void *user_data);
+
+/**
+ * @brief Unregisters the callback function.
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ *
+ * @see nfc_manager_set_stats_snapshot_cb()
+ */
+void nfc_manager_unset_stats_snapshot_cb(void);
+
+/**
+ * @brief Gets the operation counters of the process.
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ * @remarks Counting takes no locks. Operations in progress on other threads may be left out of the snapshot.
+ *
+ * @param [out] counters The counters since the library started or since nfc_manager_reset_counters()
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ *
+ * @see nfc_manager_reset_counters()
+ */
+int nfc_manager_get_counters(nfc_counters_s *counters);
+
+/**
+ * @brief Restarts the counters reported by nfc_manager_get_counters() from 0.
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ *
+ * @see nfc_manager_get_counters()
+ */
+int nfc_manager_reset_counters(void);
+
+/**
+ * @brief Starts recording the calls of tag and P2P operations and the messages of the NFC daemon to a file.
+ * @details The file holds @a record_count records of fixed size used as a ring, so it keeps the latest ones.
+ * Each record has a timestamp and the first bytes of the data it carries.
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ * @remarks The file is written through a shared mapping and is complete even if the process ends without nfc_manager_stop_trace().
+ * Starting again replaces the file being written.\n
+ * The trace may contain the data exchanged with tags and peers.
+ *
+ * @param [in] path The file to create or truncate
+ * @param [in] record_count The number of records the file holds, each taking 64 bytes
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #NFC_ERROR_OPERATION_FAILED The file can not be created
+ *
+ * @see nfc_manager_stop_trace()
+ */
+int nfc_manager_start_trace(const char *path, int record_count);
+
+/**
+ * @brief Stops recording and closes the file of nfc_manager_start_trace().
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ *
+ * @see nfc_manager_start_trace()
+ */
+void nfc_manager_stop_trace(void);
+
+/**
+ * @brief Sets the most verbose level which is written to the system log.
+ * @details Lines above @a level are discarded before they are formatted.
+ * Each log statement is additionally rate limited, lines dropped by the limit are counted and reported with the next line of that statement.
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ * @remarks In default, the level is #NFC_LOG_LEVEL_ERROR.\n
+ * Levels above the one the library was built with (NFC_LOG_LEVEL_MAX) are never logged.
+ *
+ * @param [in] level The log level
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ *
+ * @see nfc_manager_set_log_buffer_level()
+ */
+int nfc_manager_set_log_level(nfc_log_level_e level);
+
+/**
+ * @brief Sets the most verbose level which is kept in the in-memory log buffer.
+ * @details The buffer holds the most recent lines and is not rate limited. It can be read back with nfc_manager_dump_log().
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ * @remarks In default, the level is #NFC_LOG_LEVEL_NONE and the buffer is not used.
+ *
+ * @param [in] level The log level
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ *
+ * @see nfc_manager_dump_log()
+ */
+int nfc_manager_set_log_buffer_level(nfc_log_level_e level);
+
+/**
+ * @brief Retrieves the lines held by the in-memory log buffer, oldest first.
+ * @ingroup CAPI_NETWORK_NFC_MANAGER_MODULE
+ * @remarks Lines which are overwritten while the dump is running are skipped.
+ *
+ * @param [in] callback The callback function to invoke for each line
+ * @param [in] user_data The user data to be passed to the callback function
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ *
+ * @post It invokes nfc_log_cb() for each line.
+ *
+ * @see nfc_manager_set_log_buffer_level()
+ */
+int nfc_manager_dump_log(nfc_log_cb callback, void *user_data);
+
+
+/**
+ * @brief Creates a record with given parameter value.
+ * @ingroup CAPI_NETWORK_NFC_NDEF_RECORD_MODULE
+ *
+ * @remarks Every data buffer is deeply copied.\n
+ * Every data is a byte array(binary data).
+ *
+ * @param [out] record A handle to record
+ * @param [in] tnf The type name format
+ * @param [in] type The specified type name
+ * @param [in] type_size The byte size of type
+ * @param [in] id The record ID
+ * @param [in] id_size The byte size of ID
+ * @param [in] payload The payload of this record
+ * @param [in] payload_size The byte size of payload
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #NFC_ERROR_OUT_OF_MEMORY Out of memory
+ * @see nfc_ndef_record_create_text()
+ * @see nfc_ndef_record_create_uri()
+ * @see nfc_ndef_record_create_mime()
+ * @see nfc_ndef_record_destroy()
+ */
+int nfc_ndef_record_create(nfc_ndef_record_h *record, nfc_record_tnf_e tnf, const unsigned char *type, int type_size, const unsigned char *id, int id_size, const unsigned char *payload, int payload_size);
+
+
+/**
+ * @brief Creates a record with text type payload
+ * @ingroup CAPI_NETWORK_NFC_NDEF_RECORD_MODULE
+ *
+ * @remarks This function does not encode the text. @a text will be assumed as that it is already encoded with encode type.\n
+ * The text buffer will be deeply copied.\n
+ * The record is created in this format\n
+ * - TNF : NFC_RECORD_TNF_WELL_KNOWN\n
+ * - type : "T"\n
+ * - payload : encode and header information + language code + text \n
+ * Defined in Record Type Definition Technical Specifications.
+ *
+ * @param [out] record A handle to record
+ * @param [in] text The encoded text
+ * @param [in] lang_code The language code string value followed by IANA[RFC 3066] (ex: en-US, ko-KR)
+ * @param [in] encode The encoding type
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #NFC_ERROR_OUT_OF_MEMORY Out of memory
+ * @see nfc_ndef_record_create()
+ * @see nfc_ndef_record_create_uri()
+ * @see nfc_ndef_record_create_mime()
+ * @see nfc_ndef_record_destroy()
+ * @see nfc_ndef_record_get_text()
+ * @see nfc_ndef_record_get_langcode()
+ * @see nfc_ndef_record_get_encode_type()
+ */
+int nfc_ndef_record_create_text(nfc_ndef_record_h *record, const char *text, const char *lang_code, nfc_encode_type_e encode);
+
+/**
+ * @brief Creates a record with URI type payload
+ * @ingroup CAPI_NETWORK_NFC_NDEF_RECORD_MODULE
+ *
+ * @remarks The uri string will be deep copied.\n
+ * The record is created in this format\n
+ * - TNF : NFC_RECORD_TNF_WELL_KNOWN\n
+ * - type : "U"\n
+ * - payload : procotol scheme + uri\n
+ * Defined in Record Type Definition Technical Specifications.
+ *
+ * @param [out] record A handle to record
+ * @param [in] protocol_scheme	The protocol scheme
+ * @param [in] uri	The URI string that will be stored in the payload
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #NFC_ERROR_OUT_OF_MEMORY Out of memory
+ * @see nfc_ndef_record_create()
+ * @see nfc_ndef_record_create_text()
+ * @see nfc_ndef_record_create_mime()
+ * @see nfc_ndef_record_destroy()
+ * @see nfc_ndef_record_get_uri()
+ */
+int nfc_ndef_record_create_uri(nfc_ndef_record_h* record, const char *uri);
+
+
+/**
+ * @brief Creates a record with MIME type payload
+ * @ingroup CAPI_NETWORK_NFC_NDEF_RECORD_MODULE
+ *
+ * @remarks The data buffer will be deep copied.\n
+ * The data are bytes array(binary data).\n
+ * The mime_type string will deep copied.\n
+ * The record is created in this format\n
+ * - TNF : NFC_RECORD_TNF_MIME_MEDIA\n
+ * - type : mime type\n
+ * - payload : data\n
+ * Defined in Record Type Definition Technical Specifications.
+ *
+ * @param [out] record A handle to record
+ * @param [in] mime_type	The mime type [RFC 2046] (ex. text/plain, image/jpeg )\nThis value is stored in type field
+ * @param [in] data	The pointer of data
+ * @param [in] data_size	The size of data
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #NFC_ERROR_OUT_OF_MEMORY Out of memory
+ * @see nfc_ndef_record_create()
+ * @see nfc_ndef_record_create_uri()
+ * @see nfc_ndef_record_create_text()
+ * @see nfc_ndef_record_destroy()
+ * @see nfc_ndef_record_get_mime_type()
+ */
+int nfc_ndef_record_create_mime(nfc_ndef_record_h* record, const char *mime_type, const unsigned char *data, int data_size);
+
+
+/**
+ * @brief Destroys the record handle
+ * @ingroup CAPI_NETWORK_NFC_NDEF_RECORD_MODULE
+ *
+ * @param [in] record The handle to record
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @see nfc_ndef_record_create()
+ * @see nfc_ndef_record_create_text()
+ * @see nfc_ndef_record_create_uri()
+ * @see nfc_ndef_record_create_mime()
+ */
+int nfc_ndef_record_destroy(nfc_ndef_record_h record);
+
+/**
+ * @brief Sets record ID
+ * @ingroup CAPI_NETWORK_NFC_NDEF_RECORD_MODULE
+ *
+ * @remarks The ID buffer are deep copied.
+ *
+ * @param [in] record The handle to record
+ * @param [in] id The record ID
+ * @param [in] id_size The size of ID in bytes
+ * @return 0 on success, otherwise a negative error value.
+ * @retval	#NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @see nfc_ndef_record_get_id()
+ */
+int nfc_ndef_record_set_id(nfc_ndef_record_h record, unsigned char *id, int id_size);
+
+/**
+ * @brief Gets record ID
+ * @ingroup CAPI_NETWORK_NFC_NDEF_RECORD_MODULE
+ *
+ * @remarks It may return NULL pointer if the ID is not exist\n
+ *  This function gives you  the pointer of ID that is contained by record\n
+ *  Do not free the ID. It will be released when @a record is destroyed by nfc_ndef_record_destroy().
+ *
+ * @param [in] record The handle to record
+ * @param [out] id The record ID ( do not free )
+ * @param [out] id_size The size of ID in bytes
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @see nfc_ndef_record_set_id()
+ */
+int nfc_ndef_record_get_id(nfc_ndef_record_h record, unsigned char **id, int *size);
+
+/**
+ * @brief Gets record payload.
+ * @ingroup CAPI_NETWORK_NFC_NDEF_RECORD_MODULE
  *
  * @remarks This function gives you  the pointer of pyaload that is contained by record\n
  * Do not free the payload. it will be freed when @a record is destroyed by nfc_ndef_record_destroy().
@@ -1296,79 +1937,337 @@ int nfc_ndef_message_get_record_count(nfc_ndef_message_h ndef_message, int *coun
  * @retval #NFC_ERROR_OUT_OF_MEMORY Out of memory
  * @retval #NFC_ERROR_INVALID_NDEF_MESSAGE Invalid NDEF message
  *
- * @see nfc_ndef_message_create_from_rawdata()
+ * @see nfc_ndef_message_create_from_rawdata()
+ */
+int nfc_ndef_message_get_rawdata(nfc_ndef_message_h ndef_message, unsigned char **rawdata, int *rawdata_size);
+
+/**
+ * @brief Appends a record into NDEF message
+ * @ingroup CAPI_NETWORK_NFC_NDEF_MESSAGE_MODULE
+ *
+ * @remarks Appended record is handled by frameworks. The record is released by frameworks when message is released.
+ *
+ * @param [in] ndef_message The handle to NDEF message
+ * @param [in] record The record that will be appended into NDEF message
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @see nfc_ndef_message_insert_record()
+ * @see nfc_ndef_message_remove_record()
+ */
+int nfc_ndef_message_append_record(nfc_ndef_message_h ndef_message, nfc_ndef_record_h record);
+
+/**
+ * @brief Inserts a record at index into NDEF message
+ * @ingroup CAPI_NETWORK_NFC_NDEF_MESSAGE_MODULE
+ *
+ * @remarks Appended record is handled by frameworks. The record is released by frameworks when message is released.\n
+ * The index value should not bigger than nfc_ndef_message_get_record_count()
+ *
+ * @param [in] ndef_message The handle to NDEF message
+ * @param [in] index The index of record ( starts from 0 )
+ * @param [in] record The record that will be appended into NDEF message
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #NFC_ERROR_INVALID_NDEF_MESSAGE	Invalid NDEF message
+ * @see nfc_ndef_message_append_record()
+ * @see nfc_ndef_message_remove_record()
+ */
+int nfc_ndef_message_insert_record(nfc_ndef_message_h ndef_message, int index, nfc_ndef_record_h record);
+
+/**
+ * @brief Removes the record that indicated by index number and this deleted record will be freed.
+ * @ingroup CAPI_NETWORK_NFC_NDEF_MESSAGE_MODULE
+ *
+ * @param [in] ndef_message The handle to NDEF message
+ * @param [in] index	The index of record ( starts from 0 )
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #NFC_ERROR_INVALID_NDEF_MESSAGE	Invalid NDEF message
+ * @see nfc_ndef_message_append_record()
+ * @see nfc_ndef_message_insert_record()
+ */
+int nfc_ndef_message_remove_record(nfc_ndef_message_h ndef_message, int index);
+
+/**
+ * @brief Gets record by index.
+ * @ingroup CAPI_NETWORK_NFC_NDEF_MESSAGE_MODULE
+ *
+ * @remarks This function just return the pointer of record. if you change the record value it directly affects the NDEF message
+ *
+ * @param [in] ndef_message The handle to NDEF message
+ * @param [in] index The index of record ( starts from 0 )
+ * @param [out] record The handle to record
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ *
+ */
+int nfc_ndef_message_get_record(nfc_ndef_message_h ndef_message, int index, nfc_ndef_record_h *record);
+
+/**
+ * @brief Parses the next record of a raw NDEF message without copying it.
+ * @ingroup CAPI_NETWORK_NFC_NDEF_MESSAGE_MODULE
+ *
+ * @remarks Nothing is allocated. @a record refers to @a rawdata, which must stay valid while the record is used.\n
+ * Set @a offset to 0 before the first call. It is advanced past the parsed record, and to @a rawdata_size after the record with the ME flag.
+ * Use nfc_ndef_message_create_from_rawdata() when the message has to be modified.
+ *
+ * @param [in] rawdata The NDEF message in form of bytes array
+ * @param [in] rawdata_size The size of bytes array
+ * @param [in,out] offset The position of the record in @a rawdata
+ * @param [out] record The parsed record
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #NFC_ERROR_INVALID_NDEF_MESSAGE The record is malformed or the message ends without the ME flag
+ * @retval #NFC_ERROR_NO_NDEF_MESSAGE There are no more records
+ *
+ * @see nfc_ndef_message_foreach_record_view()
+ */
+int nfc_ndef_record_view_next(const unsigned char *rawdata, int rawdata_size, int *offset, nfc_ndef_record_view_s *record);
+
+/**
+ * @brief Retrieves all records of a raw NDEF message without copying them.
+ * @ingroup CAPI_NETWORK_NFC_NDEF_MESSAGE_MODULE
+ *
+ * @remarks Nothing is allocated. Each record is checked before it is passed to the callback, so the records before a malformed one are still reported.
+ *
+ * @param [in] rawdata The NDEF message in form of bytes array
+ * @param [in] rawdata_size The size of bytes array
+ * @param [in] callback The callback function to invoke for each record
+ * @param [in] user_data The user data to be passed to the callback function
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #NFC_ERROR_INVALID_NDEF_MESSAGE A record is malformed or the message ends without the ME flag
+ *
+ * @post It invokes nfc_ndef_record_view_cb() for each record.
+ * @see nfc_ndef_record_view_next()
+ */
+int nfc_ndef_message_foreach_record_view(const unsigned char *rawdata, int rawdata_size, nfc_ndef_record_view_cb callback, void *user_data);
+
+/**
+ * @brief Creates a parser which takes an NDEF message in slices of any size.
+ * @details The callback is invoked as soon as a record is complete, while the rest of the message may still be arriving.
+ * Chunked records are reassembled and reported once, with the type and id of the first chunk and the concatenated payload.\n
+ * After a record with the ME flag the parser expects the next message.
+ * @ingroup CAPI_NETWORK_NFC_NDEF_MESSAGE_MODULE
+ *
+ * @remarks Records which are contained in a single slice are reported in place without being copied.
+ * Records split over slices and chunked records are collected in buffers of @a max_record_size bytes, which bounds the memory of the parser.\n
+ * If the callback returns @c false, the remaining input is ignored until nfc_ndef_parser_reset() is called.
+ *
+ * @param [out] parser The handle to the parser
+ * @param [in] max_record_size The largest payload accepted, after reassembly of chunks
+ * @param [in] callback The callback function to invoke for each record
+ * @param [in] user_data The user data to be passed to the callback function
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #NFC_ERROR_OUT_OF_MEMORY Out of memory
+ *
+ * @see nfc_ndef_parser_feed()
+ * @see nfc_ndef_parser_destroy()
+ */
+int nfc_ndef_parser_create(nfc_ndef_parser_h *parser, int max_record_size, nfc_ndef_record_view_cb callback, void *user_data);
+
+/**
+ * @brief Passes the next slice of an NDEF message to the parser.
+ * @ingroup CAPI_NETWORK_NFC_NDEF_MESSAGE_MODULE
+ *
+ * @remarks @a data is not referenced after the function returns.\n
+ * Once an error is returned, the parser keeps returning it until nfc_ndef_parser_reset() is called.
+ *
+ * @param [in] parser The handle to the parser
+ * @param [in] data The bytes following the previous slice
+ * @param [in] data_size The size of @a data in bytes
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #NFC_ERROR_INVALID_NDEF_MESSAGE The message is malformed
+ * @retval #NFC_ERROR_OUT_OF_MEMORY A record is larger than the maximum record size of the parser
+ *
+ * @post It invokes nfc_ndef_record_view_cb() for each completed record.
+ * @see nfc_ndef_parser_is_completed()
+ */
+int nfc_ndef_parser_feed(nfc_ndef_parser_h parser, const unsigned char *data, int data_size);
+
+/**
+ * @brief Gets whether the data fed so far ends with a complete message.
+ * @ingroup CAPI_NETWORK_NFC_NDEF_MESSAGE_MODULE
+ *
+ * @param [in] parser The handle to the parser
+ * @param [out] completed @c true if the last record reported had the ME flag and no partial record is pending
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ */
+int nfc_ndef_parser_is_completed(nfc_ndef_parser_h parser, bool *completed);
+
+/**
+ * @brief Discards partial input and errors, the next byte fed starts a new message.
+ * @ingroup CAPI_NETWORK_NFC_NDEF_MESSAGE_MODULE
+ *
+ * @param [in] parser The handle to the parser
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ */
+int nfc_ndef_parser_reset(nfc_ndef_parser_h parser);
+
+/**
+ * @brief Destroys the parser.
+ * @ingroup CAPI_NETWORK_NFC_NDEF_MESSAGE_MODULE
+ *
+ * @param [in] parser The handle to the parser
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ *
+ * @see nfc_ndef_parser_create()
+ */
+int nfc_ndef_parser_destroy(nfc_ndef_parser_h parser);
+
+/**
+ * @brief Creates a message view holding a copy of a raw NDEF message.
+ * @details Nothing is parsed until records are accessed, and then only up to the record asked for.
+ * @ingroup CAPI_NETWORK_NFC_NDEF_MESSAGE_MODULE
+ *
+ * @remarks The view and its bytes are a single allocation. A view must not be used from several threads at once.
+ *
+ * @param [out] view The handle to the message view
+ * @param [in] rawdata The NDEF message in form of bytes array
+ * @param [in] rawdata_size The size of bytes array
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #NFC_ERROR_OUT_OF_MEMORY Out of memory
+ *
+ * @see nfc_ndef_message_view_destroy()
+ */
+int nfc_ndef_message_view_create(nfc_ndef_message_view_h *view, const unsigned char *rawdata, int rawdata_size);
+
+/**
+ * @brief Destroys a message view.
+ * @ingroup CAPI_NETWORK_NFC_NDEF_MESSAGE_MODULE
+ *
+ * @param [in] view The handle to the message view
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ *
+ * @see nfc_ndef_message_view_create()
+ */
+int nfc_ndef_message_view_destroy(nfc_ndef_message_view_h view);
+
+/**
+ * @brief Gets the bytes of a message view.
+ * @ingroup CAPI_NETWORK_NFC_NDEF_MESSAGE_MODULE
+ *
+ * @remarks @a rawdata belongs to the view and is valid until the view is destroyed.
+ *
+ * @param [in] view The handle to the message view
+ * @param [out] rawdata The NDEF message in form of bytes array
+ * @param [out] rawdata_size The size of bytes array
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ *
+ * @see nfc_ndef_message_view_detach_rawdata()
  */
-int nfc_ndef_message_get_rawdata(nfc_ndef_message_h ndef_message, unsigned char **rawdata, int *rawdata_size);
+int nfc_ndef_message_view_get_rawdata(nfc_ndef_message_view_h view, const unsigned char **rawdata, int *rawdata_size);
 
 /**
- * @brief Appends a record into NDEF message
+ * @brief Takes the bytes over from a message view and destroys the view.
  * @ingroup CAPI_NETWORK_NFC_NDEF_MESSAGE_MODULE
  *
- * @remarks Appended record is handled by frameworks. The record is released by frameworks when message is released.
+ * @remarks Nothing is copied. @a rawdata must be released using free().
  *
- * @param [in] ndef_message The handle to NDEF message
- * @param [in] record The record that will be appended into NDEF message
+ * @param [in] view The handle to the message view
+ * @param [out] rawdata The NDEF message in form of bytes array
+ * @param [out] rawdata_size The size of bytes array
  *
  * @return 0 on success, otherwise a negative error value.
  * @retval #NFC_ERROR_NONE Successful
  * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
- * @see nfc_ndef_message_insert_record()
- * @see nfc_ndef_message_remove_record()
+ *
+ * @see nfc_ndef_message_view_get_rawdata()
  */
-int nfc_ndef_message_append_record(nfc_ndef_message_h ndef_message, nfc_ndef_record_h record);
+int nfc_ndef_message_view_detach_rawdata(nfc_ndef_message_view_h view, unsigned char **rawdata, int *rawdata_size);
 
 /**
- * @brief Inserts a record at index into NDEF message
+ * @brief Gets the number of records of a message view.
  * @ingroup CAPI_NETWORK_NFC_NDEF_MESSAGE_MODULE
  *
- * @remarks Appended record is handled by frameworks. The record is released by frameworks when message is released.\n
- * The index value should not bigger than nfc_ndef_message_get_record_count()
+ * @remarks The record headers are walked once and the count is kept.
  *
- * @param [in] ndef_message The handle to NDEF message
- * @param [in] index The index of record ( starts from 0 )
- * @param [in] record The record that will be appended into NDEF message
+ * @param [in] view The handle to the message view
+ * @param [out] count The number of records
  *
  * @return 0 on success, otherwise a negative error value.
  * @retval #NFC_ERROR_NONE Successful
  * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
- * @retval #NFC_ERROR_INVALID_NDEF_MESSAGE	Invalid NDEF message
- * @see nfc_ndef_message_append_record()
- * @see nfc_ndef_message_remove_record()
+ * @retval #NFC_ERROR_INVALID_NDEF_MESSAGE A record is malformed or the message ends without the ME flag
+ *
+ * @see nfc_ndef_message_view_get_record()
  */
-int nfc_ndef_message_insert_record(nfc_ndef_message_h ndef_message, int index, nfc_ndef_record_h record);
+int nfc_ndef_message_view_get_record_count(nfc_ndef_message_view_h view, int *count);
 
 /**
- * @brief Removes the record that indicated by index number and this deleted record will be freed.
+ * @brief Gets a record of a message view without copying it.
  * @ingroup CAPI_NETWORK_NFC_NDEF_MESSAGE_MODULE
  *
- * @param [in] ndef_message The handle to NDEF message
- * @param [in] index	The index of record ( starts from 0 )
+ * @remarks @a record refers to the bytes of the view and is valid until the view is destroyed.
+ * The view remembers where the last record was found, so reading the records in order parses each of them once.
+ *
+ * @param [in] view The handle to the message view
+ * @param [in] index The index of the record, starting from 0
+ * @param [out] record The parsed record
  *
  * @return 0 on success, otherwise a negative error value.
  * @retval #NFC_ERROR_NONE Successful
- * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
- * @retval #NFC_ERROR_INVALID_NDEF_MESSAGE	Invalid NDEF message
- * @see nfc_ndef_message_append_record()
- * @see nfc_ndef_message_insert_record()
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter or @a index is out of range
+ * @retval #NFC_ERROR_INVALID_NDEF_MESSAGE A record up to @a index is malformed
+ *
+ * @see nfc_ndef_message_view_get_record_count()
  */
-int nfc_ndef_message_remove_record(nfc_ndef_message_h ndef_message, int index);
+int nfc_ndef_message_view_get_record(nfc_ndef_message_view_h view, int index, nfc_ndef_record_view_s *record);
 
 /**
- * @brief Gets record by index.
+ * @brief Parses all records of a message view into an NDEF message.
  * @ingroup CAPI_NETWORK_NFC_NDEF_MESSAGE_MODULE
  *
- * @remarks This function just return the pointer of record. if you change the record value it directly affects the NDEF message
+ * @remarks @a ndef_message must be released using nfc_ndef_message_destroy(). The view is left unchanged.
  *
- * @param [in] ndef_message The handle to NDEF message
- * @param [in] index The index of record ( starts from 0 )
- * @param [out] record The handle to record
+ * @param [in] view The handle to the message view
+ * @param [out] ndef_message The handle to the NDEF message
  *
  * @return 0 on success, otherwise a negative error value.
  * @retval #NFC_ERROR_NONE Successful
  * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #NFC_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval #NFC_ERROR_INVALID_NDEF_MESSAGE The message is malformed
  *
+ * @see nfc_ndef_message_create_from_rawdata()
  */
-int nfc_ndef_message_get_record(nfc_ndef_message_h ndef_message, int index, nfc_ndef_record_h *record);
+int nfc_ndef_message_view_to_message(nfc_ndef_message_view_h view, nfc_ndef_message_h *ndef_message);
 
 /**
  * @brief Gets the type of NFC tag
@@ -1445,6 +2344,59 @@ int nfc_tag_get_ndef_size(nfc_tag_h tag, unsigned int *ndef_bytes_size);
  */
 int nfc_tag_foreach_information(nfc_tag_h tag, nfc_tag_information_cb callback, void *user_data);
 
+/**
+ * @brief Gets the tag information of a given key
+ * @details The keys are indexed when the tag is discovered, so the lookup does not walk every key.
+ * @ingroup CAPI_NETWORK_NFC_TAG_MODULE
+ *
+ * @remarks @a value points into the tag and is valid as long as @a tag is. (Do not release @a value.)
+ *
+ * @param[in] tag The handle to NFC tag
+ * @param[in] key The key of information, as passed to nfc_tag_information_cb()
+ * @param[out] value The value of information
+ * @param[out] value_size The size of @a value in bytes
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #NFC_ERROR_NOT_SUPPORTED The tag has no information for @a key
+ *
+ * @see nfc_tag_foreach_information()
+ */
+int nfc_tag_get_information(nfc_tag_h tag, const char *key, unsigned char **value, int *value_size);
+
+/**
+ * @brief Keeps a tag handle valid after the tag is detached.
+ * @details A tag handle is released when the tag is detached, right after nfc_tag_discovered_cb() returns with #NFC_DISCOVERED_TYPE_DETACHED.
+ * Each call of this function defers that until a matching nfc_tag_release(). Every tag attached at the same time has its own handle.
+ * @ingroup CAPI_NETWORK_NFC_TAG_MODULE
+ *
+ * @remarks The information of a retained tag stays readable after it is detached, operations on it fail with #NFC_ERROR_NO_DEVICE.
+ *
+ * @param[in] tag The handle to NFC tag
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ *
+ * @see nfc_tag_release()
+ */
+int nfc_tag_retain(nfc_tag_h tag);
+
+/**
+ * @brief Releases a tag handle kept by nfc_tag_retain().
+ * @ingroup CAPI_NETWORK_NFC_TAG_MODULE
+ *
+ * @param[in] tag The handle to NFC tag
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ *
+ * @see nfc_tag_retain()
+ */
+int nfc_tag_release(nfc_tag_h tag);
+
 
 /**
  * @brief Transceives the data of the raw format card.
@@ -1467,6 +2419,7 @@ int nfc_tag_foreach_information(nfc_tag_h tag, nfc_tag_information_cb callback,
 * @retval #NFC_ERROR_OPERATION_FAILED Operation failed
 * @retval #NFC_ERROR_TIMED_OUT Timeout is reached while communicating with tag
 * @retval #NFC_ERROR_NOT_ACTIVATED NFC is not activated
+* @retval #NFC_ERROR_NO_DEVICE The tag was detached
 *
 * @post It invokes nfc_tag_transceive_completed_cb() when it has completed to t
 * @see nfc_tag_read_ndef()
@@ -1474,6 +2427,35 @@ int nfc_tag_foreach_information(nfc_tag_h tag, nfc_tag_information_cb callback,
 */
 int nfc_tag_transceive(nfc_tag_h tag, unsigned char *buffer, int buffer_size, nfc_tag_transceive_completed_cb callback, void *user_data);
 
+/**
+ * @brief Sends a script of APDU commands to an ISO-DEP tag and collects all responses.
+ * @details The commands are sent one after another by the library, following @a rules, and the responses are delivered together once the script has ended.
+ * @ingroup CAPI_NETWORK_NFC_TAG_MODULE
+ *
+ * @remarks The commands are copied, @a commands can be released when this function returns.\n
+ * The tag is retained until the callback returns.
+ *
+ * @param [in] tag The handle to NFC tag
+ * @param [in] commands The commands, in the order to send them
+ * @param [in] command_count The number of commands
+ * @param [in] rules The continuation rules, a combination of #nfc_tag_apdu_rule_e
+ * @param [in] callback The callback function to invoke after the script has ended
+ * @param [in] user_data	The user data to be passed to the callback funcation
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #NFC_ERROR_DEVICE_BUSY Device is too busy to handle your request
+ * @retval #NFC_ERROR_OPERATION_FAILED Operation failed
+ * @retval #NFC_ERROR_NOT_ACTIVATED NFC is not activated
+ * @retval #NFC_ERROR_NO_DEVICE The tag was detached
+ *
+ * @post It invokes nfc_tag_transceive_batch_completed_cb() when the script has ended.
+ * @see nfc_tag_transceive()
+ */
+int nfc_tag_transceive_batch(nfc_tag_h tag, const nfc_tag_apdu_s *commands, int command_count, int rules, nfc_tag_transceive_batch_completed_cb callback, void *user_data);
+
 /**
  * @brief Reads NDEF formatted data from NFC tag.
  * @ingroup CAPI_NETWORK_NFC_TAG_MODULE
@@ -1490,6 +2472,7 @@ int nfc_tag_transceive(nfc_tag_h tag, unsigned char *buffer, int buffer_size, nf
  * @retval #NFC_ERROR_OPERATION_FAILED Operation failed
  * @retval #NFC_ERROR_TIMED_OUT Timeout is reached while communicating with tag
  * @retval #NFC_ERROR_NOT_ACTIVATED NFC is not activated
+ * @retval #NFC_ERROR_NO_DEVICE The tag was detached
  * @retval #NFC_ERROR_NOT_NDEF_FORMAT Not ndef format tag
  *
  * @post It invokes nfc_tag_read_completed_cb() when it has completed to read NDEF formatted data.
@@ -1518,6 +2501,7 @@ int nfc_tag_read_ndef(nfc_tag_h tag, nfc_tag_read_completed_cb callback, void *u
  * @retval #NFC_ERROR_OPERATION_FAILED Operation failed
  * @retval #NFC_ERROR_TIMED_OUT Timeout is reached while communicating with tag
  * @retval #NFC_ERROR_NOT_ACTIVATED NFC is not activated
+ * @retval #NFC_ERROR_NO_DEVICE The tag was detached
  * @retval #NFC_ERROR_NOT_NDEF_FORMAT Not ndef format tag
  *
  * @post It invokes nfc_tag_write_completed_cb() when it has completed to write NDEF data.
@@ -1545,6 +2529,7 @@ int nfc_tag_write_ndef(nfc_tag_h tag, nfc_ndef_message_h msg, nfc_tag_write_comp
  * @retval #NFC_ERROR_OPERATION_FAILED Operation failed
  * @retval #NFC_ERROR_TIMED_OUT Timeout is reached while communicating with tag
  * @retval #NFC_ERROR_NOT_ACTIVATED NFC is not activated
+ * @retval #NFC_ERROR_NO_DEVICE The tag was detached
  * @retval #NFC_ERROR_NOT_NDEF_FORMAT Not ndef format tag
  *
  * @post It invokes nfc_tag_format_completed_cb() when it has completed to format the NFC tag.
@@ -1553,6 +2538,127 @@ int nfc_tag_write_ndef(nfc_tag_h tag, nfc_ndef_message_h msg, nfc_tag_write_comp
  */
 int nfc_tag_format_ndef(nfc_tag_h tag, unsigned char *key, int key_size, nfc_tag_format_completed_cb callback, void *user_data);
 
+/**
+ * @brief Gets the identifier of the last tag operation issued from the calling thread.
+ * @details Every tag, NDEF and MIFARE operation issued with a callback is given an identifier. It can be used to cancel the operation.\n
+ * An operation made of several commands, like nfc_mifare_dump(), has one identifier for all of them.
+ * @ingroup CAPI_NETWORK_NFC_TAG_MODULE
+ * @remarks The identifier is kept per thread: it is the one of the last operation issued by the calling thread, operations issued by other threads, callbacks included, do not change it.
+ *
+ * @param [out] request_id The identifier of the operation
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #NFC_ERROR_OPERATION_FAILED No operation has been issued from the calling thread
+ *
+ * @see nfc_tag_cancel()
+ */
+int nfc_tag_get_last_request_id(int *request_id);
+
+/**
+ * @brief Cancels a pending tag operation.
+ * @details The completed callback of the operation will not be invoked. A response arriving later from the tag is discarded.\n
+ * nfc_tag_transceive_batch(), nfc_mifare_read_sector(), nfc_mifare_write_sector() and nfc_mifare_dump() are made of several commands and have one identifier for all of them.
+ * Cancelling such an operation stops it: no further command is sent and its completed callback is invoked with #NFC_ERROR_OPERATION_FAILED, unless it has already completed.
+ * @ingroup CAPI_NETWORK_NFC_TAG_MODULE
+ * @remarks Pending operations are also completed with #NFC_ERROR_NO_DEVICE when the tag is detached.
+ *
+ * @param [in] request_id The identifier of the operation
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	The operation is not pending, it has already completed, expired or been cancelled
+ *
+ * @see nfc_tag_get_last_request_id()
+ * @see nfc_manager_set_request_timeout()
+ */
+int nfc_tag_cancel(int request_id);
+
+/**
+ * @brief Transceives data with the tag and waits for the response.
+ * @details This is the blocking form of nfc_tag_transceive().
+ * @ingroup CAPI_NETWORK_NFC_TAG_MODULE
+ * @remarks @a response must be released with free().\n
+ * The operation is cancelled when @a timeout_ms passes, the timeout set by nfc_manager_set_request_timeout() applies as well. A completion which could no longer be cancelled is waited for a short while longer, then the call fails with #NFC_ERROR_TIMED_OUT and the completion is discarded when it arrives.\n
+ * It fails with #NFC_ERROR_OPERATION_FAILED when called from a thread which delivers callbacks, since the response could never be delivered. With nfc_manager_set_callback_main_context() this includes the thread owning that context.
+ *
+ * @param [in] tag The handle to NFC tag
+ * @param [in] buffer The binary data for parameter or additional commands
+ * @param [in] buffer_size The size of buffer in bytes
+ * @param [in] timeout_ms The longest time to wait, in milliseconds
+ * @param [out] response The response data
+ * @param [out] response_size The size of @a response in bytes
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #NFC_ERROR_DEVICE_BUSY Device is too busy to handle your request
+ * @retval #NFC_ERROR_OPERATION_FAILED Operation failed
+ * @retval #NFC_ERROR_TIMED_OUT Timeout is reached while communicating with tag
+ * @retval #NFC_ERROR_NOT_ACTIVATED NFC is not activated
+ * @retval #NFC_ERROR_NO_DEVICE The tag was detached
+ *
+ * @see nfc_tag_transceive()
+ */
+int nfc_tag_transceive_sync(nfc_tag_h tag, unsigned char *buffer, int buffer_size, int timeout_ms, unsigned char **response, int *response_size);
+
+/**
+ * @brief Reads NDEF formatted data from NFC tag and waits for it.
+ * @details This is the blocking form of nfc_tag_read_ndef().
+ * @ingroup CAPI_NETWORK_NFC_TAG_MODULE
+ * @remarks @a ndef_message must be released with nfc_ndef_message_destroy().\n
+ * The operation is cancelled when @a timeout_ms passes, the timeout set by nfc_manager_set_request_timeout() applies as well. A completion which could no longer be cancelled is waited for a short while longer, then the call fails with #NFC_ERROR_TIMED_OUT and the completion is discarded when it arrives.\n
+ * It fails with #NFC_ERROR_OPERATION_FAILED when called from a thread which delivers callbacks, with nfc_manager_set_callback_main_context() this includes the thread owning that context.
+ *
+ * @param [in] tag The handle to NFC tag
+ * @param [in] timeout_ms The longest time to wait, in milliseconds
+ * @param [out] ndef_message The NDEF message read from the tag
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #NFC_ERROR_DEVICE_BUSY Device is too busy to handle your request
+ * @retval #NFC_ERROR_OPERATION_FAILED Operation failed
+ * @retval #NFC_ERROR_TIMED_OUT Timeout is reached while communicating with tag
+ * @retval #NFC_ERROR_NOT_ACTIVATED NFC is not activated
+ * @retval #NFC_ERROR_NO_DEVICE The tag was detached
+ * @retval #NFC_ERROR_NOT_NDEF_FORMAT Not ndef format tag
+ * @retval #NFC_ERROR_NO_NDEF_MESSAGE No NDEF message on the tag
+ *
+ * @see nfc_tag_read_ndef()
+ */
+int nfc_tag_read_ndef_sync(nfc_tag_h tag, int timeout_ms, nfc_ndef_message_h *ndef_message);
+
+/**
+ * @brief Writes an NDEF message to NFC tag and waits until it is written.
+ * @details This is the blocking form of nfc_tag_write_ndef().
+ * @ingroup CAPI_NETWORK_NFC_TAG_MODULE
+ * @remarks The operation is cancelled when @a timeout_ms passes, the timeout set by nfc_manager_set_request_timeout() applies as well. A completion which could no longer be cancelled is waited for a short while longer, then the call fails with #NFC_ERROR_TIMED_OUT and the completion is discarded when it arrives.\n
+ * It fails with #NFC_ERROR_OPERATION_FAILED when called from a thread which delivers callbacks, with nfc_manager_set_callback_main_context() this includes the thread owning that context.
+ *
+ * @param [in] tag The handle to NFC tag
+ * @param [in] msg The message to write
+ * @param [in] timeout_ms The longest time to wait, in milliseconds
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #NFC_ERROR_DEVICE_BUSY Device is too busy to handle your request
+ * @retval #NFC_ERROR_OPERATION_FAILED Operation failed
+ * @retval #NFC_ERROR_TIMED_OUT Timeout is reached while communicating with tag
+ * @retval #NFC_ERROR_NOT_ACTIVATED NFC is not activated
+ * @retval #NFC_ERROR_NO_DEVICE The tag was detached
+ * @retval #NFC_ERROR_READ_ONLY_NDEF Read only tag
+ * @retval #NFC_ERROR_NO_SPACE_ON_NDEF No enough space on tag
+ *
+ * @see nfc_tag_write_ndef()
+ */
+int nfc_tag_write_ndef_sync(nfc_tag_h tag, nfc_ndef_message_h msg, int timeout_ms);
+
 /**
  * @ingroup CAPI_NETWORK_NFC_TAG_MIFARE_MODULE
  * @brief Authenticates a sector with key A.
@@ -1583,6 +2689,7 @@ int nfc_tag_format_ndef(nfc_tag_h tag, unsigned char *key, int key_size, nfc_tag
  * @retval #NFC_ERROR_OPERATION_FAILED Operation failed
  * @retval #NFC_ERROR_TIMED_OUT Timeout is reached while communicating with tag
  * @retval #NFC_ERROR_NOT_ACTIVATED NFC is not activated
+ * @retval #NFC_ERROR_NO_DEVICE The tag was detached
  *
  * @post It invokes nfc_mifare_authenticate_with_keyA_completed_cb() when it has completed to authenticate the given sector with key A.
  * @see nfc_mifare_authenticate_with_keyB()
@@ -1626,6 +2733,7 @@ int nfc_mifare_authenticate_with_keyA(nfc_tag_h tag, int sector_index, unsigned
  * @retval #NFC_ERROR_OPERATION_FAILED Operation failed
  * @retval #NFC_ERROR_TIMED_OUT Timeout is reached while communicating with tag
  * @retval #NFC_ERROR_NOT_ACTIVATED NFC is not activated
+ * @retval #NFC_ERROR_NO_DEVICE The tag was detached
  *
  * @post It invokes nfc_mifare_authenticate_with_keyB_completed_cb() when it has completed to authenticate the given sector with key B.
  * @see nfc_mifare_authenticate_with_keyA()
@@ -1657,6 +2765,7 @@ int nfc_mifare_authenticate_with_keyB(nfc_tag_h tag, int sector_index, unsigned
  * @retval #NFC_ERROR_OPERATION_FAILED Operation failed
  * @retval #NFC_ERROR_TIMED_OUT Timeout is reached while communicating with tag
  * @retval #NFC_ERROR_NOT_ACTIVATED NFC is not activated
+ * @retval #NFC_ERROR_NO_DEVICE The tag was detached
  *
  * @post It invokes nfc_mifare_read_block_completed_cb() when it has completed to read a block.
  * @see nfc_mifare_read_page()
@@ -1684,6 +2793,7 @@ int nfc_mifare_read_block(nfc_tag_h tag, int block_index, nfc_mifare_read_block_
  * @retval #NFC_ERROR_OPERATION_FAILED Operation failed
  * @retval #NFC_ERROR_TIMED_OUT Timeout is reached while communicating with tag
  * @retval #NFC_ERROR_NOT_ACTIVATED NFC is not activated
+ * @retval #NFC_ERROR_NO_DEVICE The tag was detached
  *
  * @post It invokes nfc_mifare_read_page_completed_cb() when it has completed to read a page.
  * @see nfc_mifare_read_block()
@@ -1712,6 +2822,7 @@ int nfc_mifare_read_page(nfc_tag_h tag, int page_index, nfc_mifare_read_page_com
  * @retval #NFC_ERROR_OPERATION_FAILED Operation failed
  * @retval #NFC_ERROR_TIMED_OUT Timeout is reached while communicating with tag
  * @retval #NFC_ERROR_NOT_ACTIVATED NFC is not activated
+ * @retval #NFC_ERROR_NO_DEVICE The tag was detached
  *
  * @post It invokes nfc_mifare_write_block_completed_cb() when it hase completed to write a block.
  *
@@ -1740,6 +2851,7 @@ int nfc_mifare_write_block(nfc_tag_h tag, int block_index, unsigned char *buffer
  * @retval #NFC_ERROR_OPERATION_FAILED Operation failed
  * @retval #NFC_ERROR_TIMED_OUT Timeout is reached while communicating with tag
  * @retval #NFC_ERROR_NOT_ACTIVATED NFC is not activated
+ * @retval #NFC_ERROR_NO_DEVICE The tag was detached
  *
  * @post It invokes nfc_mifare_write_page_completed_cb() when it has completed to write a page.
  *
@@ -1768,6 +2880,7 @@ int nfc_mifare_write_page(nfc_tag_h tag, int page_index, unsigned char *buffer,
  * @retval #NFC_ERROR_OPERATION_FAILED Operation failed
  * @retval #NFC_ERROR_TIMED_OUT Timeout is reached while communicating with tag
  * @retval #NFC_ERROR_NOT_ACTIVATED NFC is not activated
+ * @retval #NFC_ERROR_NO_DEVICE The tag was detached
  *
  * @see nfc_mifare_decrement()
  * @see nfc_mifare_write_block()
@@ -1793,6 +2906,7 @@ int nfc_mifare_increment(nfc_tag_h tag, int block_index, int value, nfc_mifare_i
  * @retval #NFC_ERROR_OPERATION_FAILED Operation failed
  * @retval #NFC_ERROR_TIMED_OUT Timeout is reached while communicating with tag
  * @retval #NFC_ERROR_NOT_ACTIVATED NFC is not activated
+ * @retval #NFC_ERROR_NO_DEVICE The tag was detached
  *
  * @see nfc_mifare_increment()
  * @see nfc_mifare_write_block()
@@ -1817,6 +2931,7 @@ int nfc_mifare_decrement(nfc_tag_h tag, int block_index, int value, nfc_mifare_d
  * @retval #NFC_ERROR_OPERATION_FAILED Operation failed
  * @retval #NFC_ERROR_TIMED_OUT Timeout is reached while communicating with tag
  * @retval #NFC_ERROR_NOT_ACTIVATED NFC is not activated
+ * @retval #NFC_ERROR_NO_DEVICE The tag was detached
  *
  * @see nfc_mifare_restore()
 */
@@ -1840,11 +2955,100 @@ int nfc_mifare_transfer(nfc_tag_h tag, int block_index, nfc_mifare_transfer_comp
  * @retval #NFC_ERROR_OPERATION_FAILED Operation failed
  * @retval #NFC_ERROR_TIMED_OUT Timeout is reached while communicating with tag
  * @retval #NFC_ERROR_NOT_ACTIVATED NFC is not activated
+ * @retval #NFC_ERROR_NO_DEVICE The tag was detached
  *
  * @see nfc_mifare_transfer()
 */
 int nfc_mifare_restore(nfc_tag_h tag, int block_index, nfc_mifare_restore_completed_cb callback, void *user_data);
 
+/**
+ * @ingroup CAPI_NETWORK_NFC_TAG_MIFARE_MODULE
+ * @brief Reads every block of a sector.
+ * @details The sector is authenticated once and all of its blocks are requested without waiting for each other.
+ * Sectors 0 to 31 have 4 blocks, sectors 32 to 39 (MIFARE classic 4K) have 16 blocks.
+ * @remarks This function is only available for MIFARE classic
+ *
+ * @param [in] tag The handle to NFC tag
+ * @param [in] sector_index The index of sector to read, starting from 0
+ * @param [in] key_type The key @a auth_key is
+ * @param [in] auth_key 6-byte authentication key
+ * @param [in] callback The callback function to invoke after this function has completed
+ * @param [in] user_data The user data to be passed to the callback funcation
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #NFC_ERROR_DEVICE_BUSY Device is too busy to handle your request
+ * @retval #NFC_ERROR_OPERATION_FAILED Operation failed
+ * @retval #NFC_ERROR_NOT_ACTIVATED NFC is not activated
+ * @retval #NFC_ERROR_NO_DEVICE The tag was detached
+ *
+ * @post It invokes nfc_mifare_read_sector_completed_cb() when every block has been read or the first one has failed.
+ * @see nfc_mifare_write_sector()
+ * @see nfc_mifare_dump()
+*/
+int nfc_mifare_read_sector(nfc_tag_h tag, int sector_index, nfc_mifare_key_type_e key_type, unsigned char *auth_key, nfc_mifare_read_sector_completed_cb callback, void *user_data);
+
+/**
+ * @ingroup CAPI_NETWORK_NFC_TAG_MIFARE_MODULE
+ * @brief Writes the data blocks of a sector.
+ * @details The sector is authenticated once and all of its blocks are written without waiting for each other.\n
+ * The sector trailer holding the keys and access bits is never written, neither is the manufacturer block of sector 0.
+ * @a buffer holds the remaining blocks in block order, so it is 32 bytes for sector 0, 48 bytes for sectors 1 to 31 and 240 bytes for sectors 32 to 39.
+ * @remarks This function is only available for MIFARE classic
+ *
+ * @param [in] tag The handle to NFC tag
+ * @param [in] sector_index The index of sector to write, starting from 0
+ * @param [in] key_type The key @a auth_key is
+ * @param [in] auth_key 6-byte authentication key
+ * @param [in] buffer The data to write
+ * @param [in] buffer_size The size of @a buffer in bytes
+ * @param [in] callback The callback function to invoke after this function has completed\n It can be null if notification is not required
+ * @param [in] user_data The user data to be passed to the callback funcation
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #NFC_ERROR_DEVICE_BUSY Device is too busy to handle your request
+ * @retval #NFC_ERROR_OPERATION_FAILED Operation failed
+ * @retval #NFC_ERROR_NOT_ACTIVATED NFC is not activated
+ * @retval #NFC_ERROR_NO_DEVICE The tag was detached
+ *
+ * @post It invokes nfc_mifare_write_sector_completed_cb() when every block has been written or the first one has failed.
+ * @see nfc_mifare_read_sector()
+*/
+int nfc_mifare_write_sector(nfc_tag_h tag, int sector_index, nfc_mifare_key_type_e key_type, unsigned char *auth_key, unsigned char *buffer, int buffer_size, nfc_mifare_write_sector_completed_cb callback, void *user_data);
+
+/**
+ * @ingroup CAPI_NETWORK_NFC_TAG_MIFARE_MODULE
+ * @brief Reads every sector of the card with the same key.
+ * @details The size of the card is taken from the tag type: 5 sectors for MIFARE mini, 16 for 1K and 40 for 4K.
+ * Up to two sectors are kept in flight, each authenticated once.
+ * @remarks This function is only available for MIFARE classic
+ *
+ * @param [in] tag The handle to NFC tag
+ * @param [in] key_type The key @a auth_key is
+ * @param [in] auth_key 6-byte authentication key
+ * @param [in] callback The callback function to invoke after this function has completed
+ * @param [in] user_data The user data to be passed to the callback funcation
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_OUT_OF_MEMORY Out of memory
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ * @retval #NFC_ERROR_DEVICE_BUSY Device is too busy to handle your request
+ * @retval #NFC_ERROR_OPERATION_FAILED Operation failed
+ * @retval #NFC_ERROR_NOT_ACTIVATED NFC is not activated
+ * @retval #NFC_ERROR_NO_DEVICE The tag was detached
+ * @retval #NFC_ERROR_NOT_SUPPORTED The tag is not a MIFARE classic card
+ *
+ * @post It invokes nfc_mifare_dump_completed_cb() when every sector has been read or the first block has failed.
+ * @see nfc_mifare_read_sector()
+*/
+int nfc_mifare_dump(nfc_tag_h tag, nfc_mifare_key_type_e key_type, unsigned char *auth_key, nfc_mifare_dump_completed_cb callback, void *user_data);
+
 
 /**
  * @brief Registers a callback function for receiving data from NFC peer-to-peer target.
@@ -1880,9 +3084,45 @@ int nfc_p2p_set_data_received_cb(nfc_p2p_target_h target, nfc_p2p_data_recived_c
  */
 int nfc_p2p_unset_data_received_cb(nfc_p2p_target_h target);
 
+/**
+ * @brief Registers a callback function for receiving data from NFC peer-to-peer target without parsing it.
+ * @ingroup CAPI_NETWORK_NFC_P2P_MODULE
+ *
+ * @remarks The received bytes are copied once into a message view which is handed over to the application, and no record is parsed until it is accessed.
+ * It may be registered together with nfc_p2p_set_data_received_cb(), each callback is then invoked.
+ *
+ * @param [in] target The handle to peer target
+ * @param [in] callback The callback function to invoke when data is received
+ * @param [in] user_data The user data to be passed to the callback function
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ *
+ * @see nfc_p2p_unset_message_view_received_cb()
+ * @see nfc_p2p_message_view_received_cb()
+ */
+int nfc_p2p_set_message_view_received_cb(nfc_p2p_target_h target, nfc_p2p_message_view_received_cb callback, void *user_data);
+
+/**
+ * @brief Unregisters the callback function.
+ * @ingroup CAPI_NETWORK_NFC_P2P_MODULE
+ *
+ * @param [in] target The handle to peer target
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ *
+ * @see nfc_p2p_set_message_view_received_cb()
+ */
+int nfc_p2p_unset_message_view_received_cb(nfc_p2p_target_h target);
+
 /**
  * @brief Sends data to NFC peer-to-peer target
  * @ingroup CAPI_NETWORK_NFC_P2P_MODULE
+ * @remarks Messages sent to a target before the previous ones have completed are queued and sent in order, each invoking its own callback.
+ * Queued messages are completed with #NFC_ERROR_NO_DEVICE when the target is detached.
  *
  * @param [in] tag The handle to NFC tag
  * @param [in] message The message to send
@@ -1902,6 +3142,22 @@ int nfc_p2p_unset_data_received_cb(nfc_p2p_target_h target);
 */
 int nfc_p2p_send(nfc_p2p_target_h target, nfc_ndef_message_h message, nfc_p2p_send_completed_cb callback, void *user_data);
 
+/**
+ * @brief Gets the number of messages sent to a P2P target which have not completed yet.
+ * @details The count includes the message being transferred. It can be used to stop producing messages while the link is behind.
+ * @ingroup CAPI_NETWORK_NFC_P2P_MODULE
+ *
+ * @param [in] target The handle to p2p target
+ * @param [out] depth The number of pending messages
+ *
+ * @return 0 on success, otherwise a negative error value.
+ * @retval #NFC_ERROR_NONE Successful
+ * @retval #NFC_ERROR_INVALID_PARAMETER	Invalid parameter
+ *
+ * @see nfc_p2p_send()
+ */
+int nfc_p2p_get_send_queue_depth(nfc_p2p_target_h target, int *depth);
+
 
 
 
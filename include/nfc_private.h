@@ -25,52 +25,368 @@
 typedef enum {
 	_NFC_CALLBACK_TYPE_RESULT=0,
 	_NFC_CALLBACK_TYPE_DATA=1,
+	_NFC_CALLBACK_TYPE_MESSAGE=2,
 } _nfc_callback_type;
 
 
+/*
+ * An application callback and its user data, published as one pointer so
+ * that dispatch reads both without a lock. See nfc_callback.c.
+ */
+typedef struct _nfc_callback_s {
+	void * callback;
+	void * user_data;
+	unsigned int retire_epoch;
+	struct _nfc_callback_s *retire_next;
+} _nfc_callback_s;
+
+typedef _nfc_callback_s * volatile _nfc_callback_cell;
+
+unsigned int _nfc_callback_read_lock(void);
+void _nfc_callback_read_unlock(unsigned int epoch);
+int _nfc_callback_set(_nfc_callback_cell *slot, void *callback, void *user_data);
+bool _nfc_callback_take(_nfc_callback_cell *slot, void **callback, void **user_data);
+const _nfc_callback_s * _nfc_callback_get(_nfc_callback_cell *slot);
+bool _nfc_callback_in_read_section(void);
+void _nfc_callback_synchronize(void);
+
+/*
+ * One invocation of an application callback. Event handlers do their
+ * bookkeeping on the thread delivering the event and hand the callback
+ * over as a closure, which runs right away or, in executor mode, on a
+ * worker thread. Borrowed data is copied only when the closure is
+ * deferred. See nfc_executor.c.
+ */
+typedef struct _nfc_closure_s {
+	void (*run)(const struct _nfc_closure_s *closure);
+	void * callback;
+	void * user_data;
+	int result;
+	int arg;
+	void * handle;
+	void * object;
+	void * (*object_copy)(void *object);	/* set for a borrowed object, copies it when deferred */
+	void (*object_free)(void *object);	/* frees an owned object, or the copy, after the callback */
+	const unsigned char * buffer;	/* borrowed */
+	int buffer_size;
+	const unsigned char * buffer2;	/* borrowed */
+	int buffer2_size;
+} _nfc_closure_s;
+
+/*
+ * When the message being handled on this thread arrived and, for the
+ * response to a tag operation, when the operation was issued. See
+ * nfc_stats.c.
+ */
 typedef struct {
-	nfc_tag_discovered_cb 			on_tag_discovered_cb;
-	void *						on_tag_discovered_user_data;
-	nfc_ndef_discovered_cb 		on_ndef_discovered_cb;
-	void * 						on_ndef_discovered_user_data;
-	net_nfc_target_info_s 			current_tag;
+	int message;	/* -1 outside of a message */
+	unsigned long long arrived;	/* ns on CLOCK_MONOTONIC */
+	unsigned long long issued;	/* 0 unless the message answers an operation */
+} _nfc_stats_stamp_s;
 
-	//net_nfc_target_handle_s 		current_target;
-	net_nfc_target_handle_h		current_target;
+unsigned long long _nfc_stats_now(void);
+void _nfc_stats_event_begin(int message, _nfc_stats_stamp_s *saved);
+void _nfc_stats_event_end(const _nfc_stats_stamp_s *saved);
+void _nfc_stats_request_answered(unsigned long long issued);
+void _nfc_stats_stamp_get(_nfc_stats_stamp_s *stamp);
+/* NULL stands for the message being handled on this thread */
+void _nfc_stats_callback_done(const _nfc_stats_stamp_s *stamp);
 
-	nfc_p2p_target_discovered_cb	on_p2p_discovered_cb;
-	void *						on_p2p_discovered_user_data;
+/* a closure queued for later, owning the copies of its borrowed data */
+typedef struct _nfc_deferred_closure_s {
+	_nfc_closure_s closure;
+	void * copy;
+	bool object_copied;
+	_nfc_stats_stamp_s stamp;
+	struct _nfc_deferred_closure_s *next;
+} _nfc_deferred_closure_s;
 
-	nfc_se_event_cb				on_se_event_cb;
-	void *						on_se_event_user_data;
+void _nfc_executor_dispatch(const void *key, const _nfc_closure_s *closure);
+bool _nfc_closure_defer(_nfc_deferred_closure_s *deferred, const _nfc_closure_s *closure);
+void _nfc_closure_run_deferred(_nfc_deferred_closure_s *deferred);
+bool _nfc_main_loop_is_attached(void);
+bool _nfc_main_loop_is_owner(void);
+bool _nfc_main_loop_dispatch(const _nfc_closure_s *closure);
+void _nfc_dispatch_enter(void);
+void _nfc_dispatch_leave(void);
+bool _nfc_is_dispatch_thread(void);
+void * _nfc_closure_ndef_message_copy(void *message);
+void _nfc_closure_ndef_message_free(void *message);
 
-	nfc_p2p_send_completed_cb 	on_p2p_send_completed_cb;
-	void *						on_p2p_send_completed_user_data;
+/* queue read with nfc_manager_drain_events(), a no-op until nfc_manager_get_event_fd() is called */
+void _nfc_event_queue_post(nfc_event_type_e type, int result, void *handle, int arg,
+	const unsigned char *payload, int payload_size, const unsigned char *payload2, int payload2_size);
 
-	nfc_p2p_data_recived_cb		on_p2p_recv_cb;
-	void * 						on_p2p_recv_user_data;
+int _convert_error_code(const char *func, int native_error_code);
 
-	nfc_p2p_connection_handover_completed_cb 		on_p2p_connection_handover_completed_cb;
-	void *										on_p2p_connection_handover_completed_user_data;
+/*
+ * Operation counters, see nfc_counters.c. _NFC_COUNTERS_ADD() costs a
+ * thread local load and an increment once the thread has its slot.
+ */
+typedef enum {
+	_NFC_COUNTER_TRANSCEIVES,
+	_NFC_COUNTER_NDEF_READS,
+	_NFC_COUNTER_NDEF_WRITES,
+	_NFC_COUNTER_NDEF_FORMATS,
+	_NFC_COUNTER_MIFARE_OPERATIONS,
+	_NFC_COUNTER_P2P_SENDS,
+	_NFC_COUNTER_P2P_RECEIVES,
+	_NFC_COUNTER_SE_EVENTS,
+	_NFC_COUNTER_BYTES_SENT,
+	_NFC_COUNTER_BYTES_RECEIVED,
+	_NFC_COUNTER_FAILURES,	/* followed by one counter per error code */
+	_NFC_COUNTER_MAX = _NFC_COUNTER_FAILURES + 1 + NFC_COUNTERS_ERROR_COUNT
+} _nfc_counter_e;
 
-	nfc_initialize_completed_cb	 	on_initialize_completed_cb;
+typedef struct _nfc_counters_slot_s {
+	unsigned long long values[_NFC_COUNTER_MAX];	/* only written by the owning thread */
+	volatile int owned;
+	struct _nfc_counters_slot_s *next;
+} __attribute__((aligned(64))) _nfc_counters_slot_s;
 
-	nfc_se_transaction_event_cb		on_se_transaction_event_cb;
-	void *						on_se_transaction_event_user_data;
+extern __thread _nfc_counters_slot_s *g_nfc_counters_slot;
 
-	nfc_activation_changed_cb	on_activation_changed_cb;
-	void *						on_activation_changed_user_data;
+_nfc_counters_slot_s * _nfc_counters_slot_claim(void);
+/* counts an operation whose request returned result, and the bytes it sends when it was accepted */
+void _nfc_counters_issued(_nfc_counter_e counter, int bytes_sent, int result);
+void _nfc_counters_failed(int error);
 
-	nfc_activation_completed_cb	on_activation_completed_cb;
-	void *						on_activation_completed_user_data;
-	bool                        on_activation_doing;
+#define _NFC_COUNTERS_ADD(counter, value) \
+	do { \
+		_nfc_counters_slot_s *_nfc_counters_slot = g_nfc_counters_slot; \
+		if( _nfc_counters_slot != NULL || (_nfc_counters_slot = _nfc_counters_slot_claim()) != NULL ) \
+			__atomic_store_n(&_nfc_counters_slot->values[(counter)], \
+				__atomic_load_n(&_nfc_counters_slot->values[(counter)], __ATOMIC_RELAXED) + (value), __ATOMIC_RELAXED); \
+	} while(0)
+
+/*
+ * Session trace, see nfc_trace.c. The file is a header followed by
+ * record_count records used as a ring; test/nfc_mock_trace_replay.c reads
+ * it back. Both structures are 64 bytes and the layout is the file format,
+ * so a change bumps _NFC_TRACE_VERSION.
+ */
+#define _NFC_TRACE_MAGIC	"NFCTRACE"
+#define _NFC_TRACE_VERSION	1
+#define _NFC_TRACE_PAYLOAD	24
+
+typedef enum {
+	_NFC_TRACE_EVENT = 1,	/* _nfc_response_handler() was entered, id is the net_nfc_message_e */
+	_NFC_TRACE_EVENT_END,	/* the handler of the message returned */
+	_NFC_TRACE_CALL,	/* an operation was requested, id is the _nfc_trace_call_e */
+} _nfc_trace_kind_e;
+
+typedef enum {
+	_NFC_TRACE_CALL_TRANSCEIVE,
+	_NFC_TRACE_CALL_READ_NDEF,
+	_NFC_TRACE_CALL_WRITE_NDEF,
+	_NFC_TRACE_CALL_FORMAT_NDEF,
+	_NFC_TRACE_CALL_MIFARE_AUTHENTICATE_A,
+	_NFC_TRACE_CALL_MIFARE_AUTHENTICATE_B,
+	_NFC_TRACE_CALL_MIFARE_READ,
+	_NFC_TRACE_CALL_MIFARE_WRITE_BLOCK,
+	_NFC_TRACE_CALL_MIFARE_WRITE_PAGE,
+	_NFC_TRACE_CALL_MIFARE_INCREMENT,
+	_NFC_TRACE_CALL_MIFARE_DECREMENT,
+	_NFC_TRACE_CALL_MIFARE_TRANSFER,
+	_NFC_TRACE_CALL_MIFARE_RESTORE,
+	_NFC_TRACE_CALL_P2P_SEND,
+	_NFC_TRACE_CALL_MAX
+} _nfc_trace_call_e;
+
+typedef struct {
+	char magic[8];	/* _NFC_TRACE_MAGIC, without the terminating 0 */
+	unsigned int version;
+	unsigned int record_size;
+	unsigned int record_count;
+	unsigned int reserved;
+	volatile unsigned long long written;	/* records appended, the next one goes to written % record_count */
+	unsigned long long started;	/* ns on CLOCK_MONOTONIC */
+	unsigned char padding[24];
+} _nfc_trace_header_s;
+
+typedef struct {
+	unsigned long long time;	/* ns on CLOCK_MONOTONIC */
+	volatile unsigned int sequence;	/* position in the trace + 1, 0 while the record is written */
+	unsigned char kind;
+	unsigned char kept;	/* bytes of the payload holding data, fewer than length when only the size is known */
+	unsigned short id;
+	int result;	/* net_nfc_error_e of an event, nfc_error_e of a call */
+	int request_id;	/* the trans_data */
+	unsigned long long handle;	/* the target */
+	unsigned int length;	/* size of the data, of which the first _NFC_TRACE_PAYLOAD bytes are kept */
+	int arg;	/* the block or sector of a call, the target type of a tag event, ... */
+	unsigned char payload[_NFC_TRACE_PAYLOAD];
+} _nfc_trace_record_s;
+
+/* NULL unless nfc_manager_start_trace() is in effect, checked by the macros below */
+extern _nfc_trace_header_s * volatile g_nfc_trace_ring;
+
+void _nfc_trace_event(net_nfc_message_e message, net_nfc_error_e result, void *data, void *trans_data);
+void _nfc_trace_event_end(net_nfc_message_e message);
+void _nfc_trace_call(_nfc_trace_call_e call, net_nfc_target_handle_h handle, int arg, void *trans_data,
+	const unsigned char *buffer, int buffer_size, int result);
+
+#define _NFC_TRACE_EVENT(message, result, data, trans_data) \
+	do { \
+		if( g_nfc_trace_ring != NULL ) \
+			_nfc_trace_event((message), (result), (data), (trans_data)); \
+	} while(0)
+
+#define _NFC_TRACE_EVENT_END(message) \
+	do { \
+		if( g_nfc_trace_ring != NULL ) \
+			_nfc_trace_event_end((message)); \
+	} while(0)
+
+#define _NFC_TRACE_CALL(call, handle, arg, trans_data, buffer, buffer_size, result) \
+	do { \
+		if( g_nfc_trace_ring != NULL ) \
+			_nfc_trace_call((call), (handle), (arg), (trans_data), (buffer), (buffer_size), (result)); \
+	} while(0)
+
+int _nfc_p2p_exchanger_data_create(nfc_ndef_message_h message, net_nfc_exchanger_data_h *data);
+int _nfc_p2p_send_enqueue(net_nfc_target_handle_h target, net_nfc_exchanger_data_h data, nfc_p2p_send_completed_cb callback, void *user_data);
+void _nfc_p2p_send_complete(net_nfc_target_handle_h current_target, int result);
+void _nfc_p2p_send_fail_all(int result);
 
-} _nfc_context_s;
 
 typedef struct {
+	_nfc_callback_cell			on_tag_discovered;
+	_nfc_callback_cell			on_ndef_discovered;
+
+	//net_nfc_target_handle_s 		current_target;
+	net_nfc_target_handle_h		current_target;
+
+	_nfc_callback_cell			on_p2p_discovered;
+	_nfc_callback_cell			on_se_event;
+	_nfc_callback_cell			on_p2p_recv;
+	_nfc_callback_cell			on_p2p_recv_view;
+	_nfc_callback_cell			on_p2p_connection_handover_completed;
+	_nfc_callback_cell			on_initialize_completed;
+	_nfc_callback_cell			on_se_transaction_event;
+	_nfc_callback_cell			on_activation_changed;
+	_nfc_callback_cell			on_activation_completed;
+	volatile bool				on_activation_doing;
+
+} _nfc_context_s;
+
+/*
+ * An operation made of several pending ones, like a sector job. The steps
+ * are issued between _nfc_pending_job_enter() and _nfc_pending_job_leave()
+ * and the job id stands for all of them: it is the last request id of the
+ * thread starting the job and what nfc_tag_cancel() takes. Cancelling
+ * completes the steps in flight with NFC_ERROR_OPERATION_FAILED, the job
+ * must not issue more once cancelled is set.
+ */
+typedef struct _nfc_pending_job_s {
+	int id;
+	volatile bool cancelled;
+	struct _nfc_pending_job_s *next;
+} _nfc_pending_job_s;
+
+typedef struct _async_callback_data_s {
 	void * callback;
 	void * user_data;
 	int callback_type;
+
+	/* pending operation bookkeeping, owned by nfc_pending.c */
+	int request_id;
+	_nfc_pending_job_s *job;	/* NULL unless the operation is a step of a job */
+	net_nfc_target_handle_h handle;
+	unsigned long long issued;	/* ns, see nfc_stats.c */
+	unsigned int deadline;
+	struct _async_callback_data_s *hash_next;
+	struct _async_callback_data_s *wheel_prev;
+	struct _async_callback_data_s *wheel_next;
 } _async_callback_data;
 
+void _nfc_response_handler(net_nfc_message_e message, net_nfc_error_e result, void* data, void* user_param, void * trans_data);
+
+#define NFC_CALLBACK_POOL_DEFAULT_SIZE	64
+#define NFC_CALLBACK_POOL_MAX_SIZE	0xffff
+
+_async_callback_data * _nfc_callback_pool_alloc(void);
+void _nfc_callback_pool_free(_async_callback_data *data);
+
+/* a periodic timer run on the timer thread of the library, see nfc_timer.c */
+typedef struct _nfc_timer_s {
+	void (*run)(void);
+	unsigned long long interval;	/* ns */
+	unsigned long long due;	/* ns on CLOCK_MONOTONIC */
+	bool armed;
+	struct _nfc_timer_s *next;
+} _nfc_timer_s;
+
+/* arming an armed timer restarts its period */
+int _nfc_timer_arm(_nfc_timer_s *timer, int interval_ms);
+void _nfc_timer_disarm(_nfc_timer_s *timer);
+
+#define NFC_REQUEST_TIMEOUT_DEFAULT	10000
+
+int _nfc_pending_register(_async_callback_data *op);
+_async_callback_data * _nfc_pending_take(int request_id);
+void _nfc_pending_fail(net_nfc_target_handle_h handle, int error);
+void _nfc_pending_complete(_async_callback_data *op, int result, const unsigned char *buffer, int buffer_size, ndef_message_h message);
+void _nfc_pending_job_begin(_nfc_pending_job_s *job);
+void _nfc_pending_job_end(_nfc_pending_job_s *job);
+void _nfc_pending_job_enter(_nfc_pending_job_s *job);
+void _nfc_pending_job_leave(void);
+
+/*
+ * One session per attached tag, nfc_tag_h points at it. The table holds a
+ * reference while the tag is attached, nfc_tag_retain() adds more so a
+ * handle outlives the detach event.
+ */
+typedef struct _nfc_tag_session_s {
+	net_nfc_target_info_s info;	/* must be first, nfc_tag_h is cast to it */
+	net_nfc_tag_info_s **index;	/* keys of info sorted by strcmp */
+	int index_size;
+	volatile int refcount;
+	volatile bool attached;
+	struct _nfc_tag_session_s *next;
+} _nfc_tag_session_s;
+
+_nfc_tag_session_s * _nfc_tag_session_attach(const net_nfc_target_info_s *target_info);
+_nfc_tag_session_s * _nfc_tag_session_detach(net_nfc_target_handle_h handle);
+void _nfc_tag_session_detach_all(void);
+_nfc_tag_session_s * _nfc_tag_session_current(void);
+void _nfc_tag_session_unref(_nfc_tag_session_s *session);
+const net_nfc_tag_info_s * _nfc_tag_session_lookup(const _nfc_tag_session_s *session, const char *key);
+
+#define NFC_NDEF_RECORD_HEADER_MAX	(1 + 1 + 4 + 1 + 255 + 255)
+
+int _nfc_ndef_record_parse(const unsigned char *rawdata, int rawdata_size, nfc_ndef_record_view_s *record, int *record_size);
+bool _nfc_ndef_record_measure(const unsigned char *rawdata, int rawdata_size, unsigned int *header_size, unsigned int *payload_size);
+
+/*
+ * Library logging. NFC_LOG_LEVEL_MAX removes the statements above it at
+ * compile time, g_nfc_log_threshold is the larger of the runtime system
+ * log and log buffer levels so a disabled statement costs one load and a
+ * compare. Every statement owns a rate limiting bucket.
+ */
+#ifndef NFC_LOG_LEVEL_MAX
+#define NFC_LOG_LEVEL_MAX	NFC_LOG_LEVEL_DEBUG
+#endif
+
+typedef struct {
+	volatile unsigned int tat;	/* ms at which the bucket is full again, 0 when unused */
+	volatile unsigned int suppressed;
+} _nfc_log_site_s;
+
+extern int g_nfc_log_threshold;
+
+void _nfc_log_print(_nfc_log_site_s *site, int level, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+
+#define _NFC_LOG(level, fmt, args...) \
+	do { \
+		static _nfc_log_site_s _nfc_log_site; \
+		if( (level) <= NFC_LOG_LEVEL_MAX && (level) <= g_nfc_log_threshold ) \
+			_nfc_log_print(&_nfc_log_site, (level), fmt, ##args); \
+	} while(0)
+
+#define NFC_LOGE(fmt, args...)	_NFC_LOG(NFC_LOG_LEVEL_ERROR, fmt, ##args)
+#define NFC_LOGW(fmt, args...)	_NFC_LOG(NFC_LOG_LEVEL_WARN, fmt, ##args)
+#define NFC_LOGI(fmt, args...)	_NFC_LOG(NFC_LOG_LEVEL_INFO, fmt, ##args)
+#define NFC_LOGD(fmt, args...)	_NFC_LOG(NFC_LOG_LEVEL_DEBUG, fmt, ##args)
+
 #endif // __NET_NFC_PRIVATE_H__
@@ -16,10 +16,11 @@
 
 #include <net_nfc.h>
 #include <net_nfc_typedef_private.h>
-#include <dlog.h>
 #include <nfc.h>
 #include <nfc_private.h>
 #include <net_nfc_exchanger.h>
+#include <stdio.h>
+#include <stdint.h>
 
 
 /**
@@ -82,119 +83,186 @@ const unsigned char NFC_RECORD_HANDOVER_REQUEST_TYPE[2] = { 'H','r' };
 const unsigned char NFC_RECORD_HANDOVER_SELECT_TYPE[2] = { 'H','s' };
 
 
-#ifdef LOG_TAG
-#undef LOG_TAG
-#endif
-#define LOG_TAG "TIZEN_N_NFC"
-
-
 static int _return_invalid_param(const char *func){
-	LOGE( "[%s] INVALID_PARAMETER (0x%08x)",func, NFC_ERROR_INVALID_PARAMETER);
+	NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)",func, NFC_ERROR_INVALID_PARAMETER);
 	return NFC_ERROR_INVALID_PARAMETER;
 }
 
-static int _convert_error_code(const char *func, int native_error_code)
-{
-	int error_code = NFC_ERROR_NONE;
-	char * errorstr = NULL;
-	switch(native_error_code){
-		case 0 :
-			error_code = NFC_ERROR_NONE;
-			errorstr  = "ERROR_NONE";
-			break;
+/* the tag of a retained handle was detached, its target handle may already belong to another tag */
+static int _return_no_device(const char *func){
+	NFC_LOGE("[%s] NO_DEVICE (0x%08x)",func, NFC_ERROR_NO_DEVICE);
+	return NFC_ERROR_NO_DEVICE;
+}
+
+typedef struct {
+	int error_code;
+	const char *errorstr;
+} _nfc_error_map_s;
+
+/* distinct C API results, _nfc_error_index[] points into this table */
+enum {
+	_NFC_ERROR_MAP_OPERATION_FAILED = 0,
+	_NFC_ERROR_MAP_NONE,
+	_NFC_ERROR_MAP_OUT_OF_MEMORY,
+	_NFC_ERROR_MAP_INVALID_PARAMETER,
+	_NFC_ERROR_MAP_INVALID_RECORD_TYPE,
+	_NFC_ERROR_MAP_TIMED_OUT,
+	_NFC_ERROR_MAP_INVALID_NDEF_MESSAGE,
+	_NFC_ERROR_MAP_NO_NDEF_MESSAGE,
+	_NFC_ERROR_MAP_DEVICE_BUSY,
+	_NFC_ERROR_MAP_NOT_NDEF_FORMAT,
+};
+
+static const _nfc_error_map_s _nfc_error_map[] = {
+	[_NFC_ERROR_MAP_OPERATION_FAILED] = { NFC_ERROR_OPERATION_FAILED, "OPERATION_FAILED" },
+	[_NFC_ERROR_MAP_NONE] = { NFC_ERROR_NONE, "ERROR_NONE" },
+	[_NFC_ERROR_MAP_OUT_OF_MEMORY] = { NFC_ERROR_OUT_OF_MEMORY, "OUT_OF_MEMORY" },
+	[_NFC_ERROR_MAP_INVALID_PARAMETER] = { NFC_ERROR_INVALID_PARAMETER, "INVALID_PARAMETER" },
+	[_NFC_ERROR_MAP_INVALID_RECORD_TYPE] = { NFC_ERROR_INVALID_RECORD_TYPE, "INVALID_RECORD_TYPE" },
+	[_NFC_ERROR_MAP_TIMED_OUT] = { NFC_ERROR_TIMED_OUT, "TIMED_OUT" },
+	[_NFC_ERROR_MAP_INVALID_NDEF_MESSAGE] = { NFC_ERROR_INVALID_NDEF_MESSAGE, "INVALID_NDEF_MESSAGE" },
+	[_NFC_ERROR_MAP_NO_NDEF_MESSAGE] = { NFC_ERROR_NO_NDEF_MESSAGE, "NO_NDEF_MESSAGE" },
+	[_NFC_ERROR_MAP_DEVICE_BUSY] = { NFC_ERROR_DEVICE_BUSY, "DEVICE_BUSY" },
+	[_NFC_ERROR_MAP_NOT_NDEF_FORMAT] = { NFC_ERROR_NOT_NDEF_FORMAT, "NOT_SUPPORTED" },
+};
 
-		case NET_NFC_ALLOC_FAIL:
-			error_code = NFC_ERROR_OUT_OF_MEMORY;
-			errorstr  = "OUT_OF_MEMORY";
-			break;
+/*
+ * Indexed by the negated net_nfc_error_e. Codes which are not listed
+ * (zero entries) map to OPERATION_FAILED, like the default branch of the
+ * switch this table replaces.
+ */
+static const unsigned char _nfc_error_index[] = {
+	[-NET_NFC_OK] = _NFC_ERROR_MAP_NONE,
 
-		case NET_NFC_UNKNOWN_ERROR:
-		case NET_NFC_THREAD_CREATE_FAIL:
-		case NET_NFC_INVALID_STATE:
-		case NET_NFC_IPC_FAIL:
-		case NET_NFC_BUFFER_TOO_SMALL:
-		case NET_NFC_COMMUNICATE_WITH_CONTROLLER_FAILED:
-		case NET_NFC_RF_ERROR:
-		case NET_NFC_NOT_SUPPORTED:
-		case NET_NFC_TAG_READ_FAILED:
-		case NET_NFC_TAG_WRITE_FAILED:
-		case NET_NFC_OPERATION_FAIL:
-		case NET_NFC_SECURITY_FAIL:
-		case NET_NFC_INSUFFICIENT_STORAGE:
-		case NET_NFC_NOT_CONNECTED:
-		case NET_NFC_NOT_INITIALIZED:
-		case NET_NFC_NOT_REGISTERED:
-			error_code = NFC_ERROR_OPERATION_FAILED;
-			errorstr  = "OPERATION_FAILED";
-			break;
+	[-NET_NFC_ALLOC_FAIL] = _NFC_ERROR_MAP_OUT_OF_MEMORY,
 
-		case NET_NFC_OUT_OF_BOUND:
-		case NET_NFC_NULL_PARAMETER:
-		case NET_NFC_NOT_ALLOWED_OPERATION:
-		case NET_NFC_LLCP_INVALID_SOCKET:
-		case NET_NFC_NO_DATA_FOUND:
-			error_code = NFC_ERROR_INVALID_PARAMETER;
-			errorstr  = "INVALID_PARAMETER";
-			break;
-		case NET_NFC_NDEF_RECORD_IS_NOT_EXPECTED_TYPE:
-			error_code = NFC_ERROR_INVALID_RECORD_TYPE;
-			errorstr  = "INVALID_RECORD_TYPE";
-			break;
+	[-NET_NFC_UNKNOWN_ERROR] = _NFC_ERROR_MAP_OPERATION_FAILED,
+	[-NET_NFC_THREAD_CREATE_FAIL] = _NFC_ERROR_MAP_OPERATION_FAILED,
+	[-NET_NFC_INVALID_STATE] = _NFC_ERROR_MAP_OPERATION_FAILED,
+	[-NET_NFC_IPC_FAIL] = _NFC_ERROR_MAP_OPERATION_FAILED,
+	[-NET_NFC_BUFFER_TOO_SMALL] = _NFC_ERROR_MAP_OPERATION_FAILED,
+	[-NET_NFC_COMMUNICATE_WITH_CONTROLLER_FAILED] = _NFC_ERROR_MAP_OPERATION_FAILED,
+	[-NET_NFC_RF_ERROR] = _NFC_ERROR_MAP_OPERATION_FAILED,
+	[-NET_NFC_NOT_SUPPORTED] = _NFC_ERROR_MAP_OPERATION_FAILED,
+	[-NET_NFC_TAG_READ_FAILED] = _NFC_ERROR_MAP_OPERATION_FAILED,
+	[-NET_NFC_TAG_WRITE_FAILED] = _NFC_ERROR_MAP_OPERATION_FAILED,
+	[-NET_NFC_OPERATION_FAIL] = _NFC_ERROR_MAP_OPERATION_FAILED,
+	[-NET_NFC_SECURITY_FAIL] = _NFC_ERROR_MAP_OPERATION_FAILED,
+	[-NET_NFC_INSUFFICIENT_STORAGE] = _NFC_ERROR_MAP_OPERATION_FAILED,
+	[-NET_NFC_NOT_CONNECTED] = _NFC_ERROR_MAP_OPERATION_FAILED,
+	[-NET_NFC_NOT_INITIALIZED] = _NFC_ERROR_MAP_OPERATION_FAILED,
+	[-NET_NFC_NOT_REGISTERED] = _NFC_ERROR_MAP_OPERATION_FAILED,
 
-		case NET_NFC_ALREADY_INITIALIZED:
-		case NET_NFC_ALREADY_REGISTERED:
-			error_code = NFC_ERROR_NONE;
-			errorstr  = "ERROR_NONE";
-			break;
+	[-NET_NFC_OUT_OF_BOUND] = _NFC_ERROR_MAP_INVALID_PARAMETER,
+	[-NET_NFC_NULL_PARAMETER] = _NFC_ERROR_MAP_INVALID_PARAMETER,
+	[-NET_NFC_NOT_ALLOWED_OPERATION] = _NFC_ERROR_MAP_INVALID_PARAMETER,
+	[-NET_NFC_LLCP_INVALID_SOCKET] = _NFC_ERROR_MAP_INVALID_PARAMETER,
+	[-NET_NFC_NO_DATA_FOUND] = _NFC_ERROR_MAP_INVALID_PARAMETER,
 
-		case NET_NFC_RF_TIMEOUT:
-			error_code = NFC_ERROR_TIMED_OUT;
-			errorstr  = "TIMED_OUT";
-			break;
-		case NET_NFC_INVALID_FORMAT:
-		case NET_NFC_NDEF_TYPE_LENGTH_IS_NOT_OK:
-		case NET_NFC_NDEF_ID_LENGTH_IS_NOT_OK:
-		case NET_NFC_NDEF_BUF_END_WITHOUT_ME:
-			error_code = NFC_ERROR_INVALID_NDEF_MESSAGE;
-			errorstr  = "INVALID_NDEF_MESSAGE";
-			break;
-		case NET_NFC_NO_NDEF_MESSAGE:
-			error_code = NFC_ERROR_NO_NDEF_MESSAGE;
-			errorstr  = "NO_NDEF_MESSAGE";
-			break;
-		case NET_NFC_BUSY :
-			error_code = NFC_ERROR_DEVICE_BUSY;
-			errorstr  = "DEVICE_BUSY";
-			break;
-		case NET_NFC_NO_NDEF_SUPPORT:
-			error_code = NFC_ERROR_NOT_NDEF_FORMAT;
-			errorstr  = "NOT_SUPPORTED";
-			break;
-		default :
-			error_code = NFC_ERROR_OPERATION_FAILED;
-			errorstr  = "OPERATION_FAILED";
-	}
+	[-NET_NFC_NDEF_RECORD_IS_NOT_EXPECTED_TYPE] = _NFC_ERROR_MAP_INVALID_RECORD_TYPE,
+
+	[-NET_NFC_ALREADY_INITIALIZED] = _NFC_ERROR_MAP_NONE,
+	[-NET_NFC_ALREADY_REGISTERED] = _NFC_ERROR_MAP_NONE,
+
+	[-NET_NFC_RF_TIMEOUT] = _NFC_ERROR_MAP_TIMED_OUT,
+
+	[-NET_NFC_INVALID_FORMAT] = _NFC_ERROR_MAP_INVALID_NDEF_MESSAGE,
+	[-NET_NFC_NDEF_TYPE_LENGTH_IS_NOT_OK] = _NFC_ERROR_MAP_INVALID_NDEF_MESSAGE,
+	[-NET_NFC_NDEF_ID_LENGTH_IS_NOT_OK] = _NFC_ERROR_MAP_INVALID_NDEF_MESSAGE,
+	[-NET_NFC_NDEF_BUF_END_WITHOUT_ME] = _NFC_ERROR_MAP_INVALID_NDEF_MESSAGE,
+
+	[-NET_NFC_NO_NDEF_MESSAGE] = _NFC_ERROR_MAP_NO_NDEF_MESSAGE,
+
+	[-NET_NFC_BUSY] = _NFC_ERROR_MAP_DEVICE_BUSY,
+
+	[-NET_NFC_NO_NDEF_SUPPORT] = _NFC_ERROR_MAP_NOT_NDEF_FORMAT,
+};
+
+static const _nfc_error_map_s * _lookup_error_code(int native_error_code)
+{
+	unsigned int index = -(unsigned int)native_error_code;
+
+	if( index >= sizeof(_nfc_error_index) / sizeof(_nfc_error_index[0]) )
+		return &_nfc_error_map[_NFC_ERROR_MAP_OPERATION_FAILED];
+
+	return &_nfc_error_map[_nfc_error_index[index]];
+}
 
-	LOGE( "NFC [%s] %s(0x%08x)",func, errorstr, error_code);
+int _convert_error_code(const char *func, int native_error_code)
+{
+	const _nfc_error_map_s *map = _lookup_error_code(native_error_code);
 
-	return error_code;
+	if( native_error_code != NET_NFC_OK )
+		NFC_LOGE("NFC [%s] %s(0x%08x)",func, map->errorstr, map->error_code);
 
+	return map->error_code;
 }
 
 _nfc_context_s g_nfc_context;
 
+/* the callbacks may still be read by a dispatch in flight, so they are retired rather than cleared */
+static void _nfc_context_reset(void)
+{
+	_nfc_callback_set(&g_nfc_context.on_tag_discovered, NULL, NULL);
+	_nfc_callback_set(&g_nfc_context.on_ndef_discovered, NULL, NULL);
+	_nfc_callback_set(&g_nfc_context.on_p2p_discovered, NULL, NULL);
+	_nfc_callback_set(&g_nfc_context.on_se_event, NULL, NULL);
+	_nfc_callback_set(&g_nfc_context.on_p2p_recv, NULL, NULL);
+	_nfc_callback_set(&g_nfc_context.on_p2p_recv_view, NULL, NULL);
+	_nfc_callback_set(&g_nfc_context.on_p2p_connection_handover_completed, NULL, NULL);
+	_nfc_callback_set(&g_nfc_context.on_initialize_completed, NULL, NULL);
+	_nfc_callback_set(&g_nfc_context.on_se_transaction_event, NULL, NULL);
+	_nfc_callback_set(&g_nfc_context.on_activation_changed, NULL, NULL);
+	_nfc_callback_set(&g_nfc_context.on_activation_completed, NULL, NULL);
+	g_nfc_context.current_target = NULL;
+	g_nfc_context.on_activation_doing = false;
+}
+
+/*
+ * Activation state as last reported by the daemon: -1 while unknown,
+ * otherwise 0 or 1. It is kept from the INIT/DEINIT events, so only the
+ * first check after (de)initialization has to ask the daemon.
+ */
+static volatile int g_nfc_activated = -1;
+
+static void _nfc_activation_cache_set(int activated)
+{
+	g_nfc_activated = activated;
+	__sync_synchronize();
+}
+
+static void * _nfc_async_request_create(net_nfc_target_handle_h handle, void *callback, void *user_data, int callback_type)
+{
+	_async_callback_data *trans_data;
+
+	trans_data = _nfc_callback_pool_alloc();
+	if( trans_data == NULL )
+		return NULL;
+
+	trans_data->callback = callback;
+	trans_data->user_data = user_data;
+	trans_data->callback_type = callback_type;
+	trans_data->handle = handle;
+
+	/* the daemon only gets the request id, see nfc_pending.c */
+	return (void *)(intptr_t)_nfc_pending_register(trans_data);
+}
+
+static void _nfc_async_request_abort(void *trans_data)
+{
+	_nfc_callback_pool_free(_nfc_pending_take((int)(intptr_t)trans_data));
+}
+
 
 static void nfc_manager_set_activation_completed_cb(nfc_activation_completed_cb callback , void *user_data)
 {
-	g_nfc_context.on_activation_completed_cb = callback;
-	g_nfc_context.on_activation_completed_user_data = user_data;
+	_nfc_callback_set(&g_nfc_context.on_activation_completed, callback, user_data);
 	g_nfc_context.on_activation_doing = true;
 }
 
 static void nfc_manager_unset_activation_completed_cb(void)
 {
-	g_nfc_context.on_activation_completed_cb = NULL;
-	g_nfc_context.on_activation_completed_user_data = NULL;
+	_nfc_callback_set(&g_nfc_context.on_activation_completed, NULL, NULL);
 	g_nfc_context.on_activation_doing = false;
 }
 
@@ -204,403 +272,508 @@ static bool nfc_manager_check_activation(void)
 }
 
 
-void _nfc_response_handler(net_nfc_message_e message, net_nfc_error_e result, void* data, void* user_param, void * trans_data)
+typedef void (*_nfc_event_handler)(net_nfc_message_e message, net_nfc_error_e result, int capi_result, void *data, void *trans_data);
+
+static void _nfc_on_transceive(net_nfc_message_e message, net_nfc_error_e result, int capi_result, void *data, void *trans_data)
 {
-	LOGI("NFC [%s] message %d - start result[%d] ", __func__, message, result);
+	_async_callback_data *user_cb = _nfc_pending_take((int)(intptr_t)trans_data);
+	data_s *arg = (data_s*) data;
 
-	int capi_result = _convert_error_code("EVENT", result);
+	if( result == 0 && arg != NULL )
+		_NFC_COUNTERS_ADD(_NFC_COUNTER_BYTES_RECEIVED, arg->length);
 
-	switch ( message ){
-		case NET_NFC_MESSAGE_TRANSCEIVE:
-		{
-			if( trans_data != NULL ){
-				_async_callback_data *user_cb = (_async_callback_data*)trans_data;
-
-				if( user_cb->callback_type == _NFC_CALLBACK_TYPE_DATA ){
-					unsigned char * buffer = NULL;
-					int buffer_size = 0;
-					if( result == 0 && data != NULL){
-						data_s *arg = (data_s*) data;
-						buffer = arg->buffer;
-						buffer_size = arg->length;
-					}
-					void (* data_type_callback)(int result , unsigned char * buffer, int buffer_size,  void * user_data);
-					data_type_callback = user_cb->callback;
-					data_type_callback(capi_result, buffer, buffer_size, user_cb->user_data);
-				}else if ( user_cb->callback_type == _NFC_CALLBACK_TYPE_RESULT){
-					void (* result_type_callback)(int result , void * user_data);
-					result_type_callback = user_cb->callback;
-					result_type_callback(capi_result, user_cb->user_data);
-				}
-				free(user_cb);
-			}
-			break;
-		}
-		case NET_NFC_MESSAGE_READ_NDEF:
-		{
-			if( trans_data != NULL ) {
-				ndef_message_h ndef_message = (ndef_message_h)data;
-				_async_callback_data *user_cb = (_async_callback_data*)trans_data;
-				((nfc_tag_read_completed_cb)user_cb->callback)(capi_result, ndef_message, user_cb->user_data);
-				free(user_cb);
-			}
-			break;
-		}
-		case NET_NFC_MESSAGE_WRITE_NDEF:
-		{
-			if( trans_data != NULL ){
-				_async_callback_data *user_cb = (_async_callback_data*)trans_data;
-				((nfc_tag_write_completed_cb)user_cb->callback)(capi_result, user_cb->user_data);
-				free(user_cb);
-			}
-			break;
-		}
-		case NET_NFC_MESSAGE_TAG_DISCOVERED:
-		{
-			int i;
-			net_nfc_target_info_s *target_info = (net_nfc_target_info_s*)data;
+	if( user_cb == NULL )
+		return;
 
-			memset(&g_nfc_context.current_tag , 0 , sizeof( g_nfc_context.current_tag ));
-			g_nfc_context.current_tag = * target_info;
-			net_nfc_tag_info_s *list = g_nfc_context.current_tag.tag_info_list;
-			net_nfc_tag_info_s *newlist ;
-			newlist = (net_nfc_tag_info_s *)calloc(g_nfc_context.current_tag.number_of_keys, sizeof(net_nfc_tag_info_s));
+	_nfc_stats_request_answered(user_cb->issued);
 
+	if( result == 0 && arg != NULL )
+		_nfc_pending_complete(user_cb, capi_result, arg->buffer, arg->length, NULL);
+	else
+		_nfc_pending_complete(user_cb, capi_result, NULL, 0, NULL);
+}
 
-			//copy info list
-			for(i = 0; i < g_nfc_context.current_tag.number_of_keys ; i++){
-				if( list[i].key ){
-					newlist[i].key = strdup(list[i].key);
-				}
-				if ( list[i].value ){
-					net_nfc_create_data(&newlist[i].value , ((data_s*)list[i].value)->buffer, ((data_s*)list[i].value)->length);
-				}
-			}
-			g_nfc_context.current_tag.tag_info_list = newlist;
+static void _nfc_on_read_ndef(net_nfc_message_e message, net_nfc_error_e result, int capi_result, void *data, void *trans_data)
+{
+	_async_callback_data *user_cb = _nfc_pending_take((int)(intptr_t)trans_data);
+	int size;
 
-			if( g_nfc_context.on_tag_discovered_cb ){
+	if( result == 0 && data != NULL && net_nfc_get_ndef_message_byte_length((ndef_message_h)data, &size) == NET_NFC_OK )
+		_NFC_COUNTERS_ADD(_NFC_COUNTER_BYTES_RECEIVED, size);
 
-				g_nfc_context.on_tag_discovered_cb( NFC_DISCOVERED_TYPE_ATTACHED, (nfc_tag_h)&g_nfc_context.current_tag , g_nfc_context.on_tag_discovered_user_data );
-			}
+	if( user_cb == NULL )
+		return;
 
-			//ndef discovered cb
-			if( g_nfc_context.on_ndef_discovered_cb && target_info->raw_data.buffer != NULL ){
-				ndef_message_h ndef_message ;
-				net_nfc_create_ndef_message_from_rawdata (&ndef_message, (data_h)&(target_info->raw_data) );
-				g_nfc_context.on_ndef_discovered_cb(ndef_message , g_nfc_context.on_ndef_discovered_user_data);
-				net_nfc_free_ndef_message(ndef_message);
-			}
-			break;
-		}
-		case NET_NFC_MESSAGE_NOTIFY:
-		{
-			break;
-		}
-		case NET_NFC_MESSAGE_TAG_DETACHED:
-		{
-			if( g_nfc_context.on_tag_discovered_cb ){
-				g_nfc_context.on_tag_discovered_cb( NFC_DISCOVERED_TYPE_DETACHED,  (nfc_tag_h)&g_nfc_context.current_tag , g_nfc_context.on_tag_discovered_user_data );
-			}
+	_nfc_stats_request_answered(user_cb->issued);
 
-			net_nfc_tag_info_s* list  = g_nfc_context.current_tag.tag_info_list;
+	_nfc_pending_complete(user_cb, capi_result, NULL, 0, (ndef_message_h)data);
+}
 
-			//delete key list
-			if(list != NULL)
-			{
-				int i = 0;
-				for(i=0 ; i < g_nfc_context.current_tag.number_of_keys ; i++)	{
-					if(list[i].key != NULL)
-						free(list[i].key );
-					if(list[i].value != NULL)
-						net_nfc_free_data(list[i].value);
-				}
-				free(list);
-			}
-			if(  g_nfc_context.current_tag.keylist != NULL )
-				free( g_nfc_context.current_tag.keylist);
+static void _nfc_on_write_ndef(net_nfc_message_e message, net_nfc_error_e result, int capi_result, void *data, void *trans_data)
+{
+	_async_callback_data *user_cb = _nfc_pending_take((int)(intptr_t)trans_data);
+	if( user_cb == NULL )
+		return;
 
-			memset(&g_nfc_context.current_tag , 0 , sizeof( g_nfc_context.current_tag ));
-			break;
-		}
-		case NET_NFC_MESSAGE_P2P_DISCOVERED:
-		{
-			g_nfc_context.current_target = (net_nfc_target_handle_h)data;
-			g_nfc_context.on_p2p_recv_cb = NULL;
-			g_nfc_context.on_p2p_recv_user_data = NULL;
-			g_nfc_context.on_p2p_send_completed_cb = NULL;
-			g_nfc_context.on_p2p_send_completed_user_data = NULL;
-
-			if( g_nfc_context.on_p2p_discovered_cb ){
-				g_nfc_context.on_p2p_discovered_cb(NFC_DISCOVERED_TYPE_ATTACHED , (nfc_p2p_target_h)g_nfc_context.current_target, g_nfc_context.on_p2p_discovered_user_data );
-			}
+	_nfc_stats_request_answered(user_cb->issued);
 
-			break;
-		}
-		case NET_NFC_MESSAGE_P2P_DETACHED:
-		{
-			if( g_nfc_context.on_p2p_discovered_cb ){
-				g_nfc_context.on_p2p_discovered_cb( NFC_DISCOVERED_TYPE_DETACHED,  (nfc_p2p_target_h)(g_nfc_context.current_target) , g_nfc_context.on_p2p_discovered_user_data );
-			}
-			memset(&g_nfc_context.current_target , 0 , sizeof( g_nfc_context.current_target ));
-			g_nfc_context.on_p2p_recv_cb = NULL;
-			g_nfc_context.on_p2p_recv_user_data = NULL;
-			g_nfc_context.on_p2p_send_completed_cb = NULL;
-			g_nfc_context.on_p2p_send_completed_user_data = NULL;
+	_nfc_pending_complete(user_cb, capi_result, NULL, 0, NULL);
+}
 
-			break;
-		}
-		case NET_NFC_MESSAGE_P2P_SEND :
-		{
-			if( g_nfc_context.on_p2p_send_completed_cb != NULL ){
+static void _nfc_on_format_ndef(net_nfc_message_e message, net_nfc_error_e result, int capi_result, void *data, void *trans_data)
+{
+	_async_callback_data *user_cb = _nfc_pending_take((int)(intptr_t)trans_data);
+	if( user_cb == NULL )
+		return;
 
-				nfc_p2p_send_completed_cb 	cb = g_nfc_context.on_p2p_send_completed_cb;
-				void *						user_data = g_nfc_context.on_p2p_send_completed_user_data;
-				g_nfc_context.on_p2p_send_completed_cb = NULL;
-				g_nfc_context.on_p2p_send_completed_user_data = NULL;
-				cb(capi_result , user_data );
-			}
-			break;
-		}
-		case NET_NFC_MESSAGE_P2P_RECEIVE :
-		{
-			if( g_nfc_context.on_p2p_recv_cb != NULL ){
-				ndef_message_h ndef_message ;
-				net_nfc_create_ndef_message_from_rawdata (&ndef_message, (data_h)(data) );
-				g_nfc_context.on_p2p_recv_cb( (nfc_p2p_target_h)(g_nfc_context.current_target) , ndef_message ,g_nfc_context.on_p2p_recv_user_data );
-				net_nfc_free_ndef_message(ndef_message);
-			}
+	_nfc_stats_request_answered(user_cb->issued);
 
-			break;
-		}
-		case NET_NFC_MESSAGE_FORMAT_NDEF:
-		{
-			if( trans_data != NULL) {
-				_async_callback_data *user_cb = (_async_callback_data*)trans_data;
-				((nfc_tag_format_completed_cb)user_cb->callback)(capi_result, user_cb->user_data);
-				free(user_cb);
-			}
-			break;
-		}
+	_nfc_pending_complete(user_cb, capi_result, NULL, 0, NULL);
+}
 
-		case NET_NFC_MESSAGE_CONNECTION_HANDOVER :
-		{
-			if( g_nfc_context.on_p2p_connection_handover_completed_cb != NULL ){
+/*
+ * Closures of the application callbacks registered on the context. The
+ * callback and its user data are copied into the closure, so a deferred
+ * closure does not depend on the registration any more.
+ */
+static void _nfc_closure_init(_nfc_closure_s *closure, void (*run)(const _nfc_closure_s *closure), const void *callback, const void *user_data)
+{
+	memset(closure, 0, sizeof(*closure));
+	closure->run = run;
+	closure->callback = (void *)callback;
+	closure->user_data = (void *)user_data;
+}
 
-				net_nfc_conn_handover_carrier_type_e type = NET_NFC_CONN_HANDOVER_CARRIER_UNKNOWN;
-				nfc_ac_type_e carrior_type = NFC_AC_TYPE_UNKNOWN;
-				char * ac_data = NULL;
-				int ac_data_size = 0;
-				char * temp = NULL;
-				char buffer[50] = {0,};
-				data_h ac_info = NULL;
+static void _nfc_run_tag_discovered(const _nfc_closure_s *closure)
+{
+	((nfc_tag_discovered_cb)closure->callback)((nfc_discovered_type_e)closure->arg, (nfc_tag_h)closure->object, closure->user_data);
+}
 
+static void _nfc_run_ndef_discovered(const _nfc_closure_s *closure)
+{
+	((nfc_ndef_discovered_cb)closure->callback)((nfc_ndef_message_h)closure->object, closure->user_data);
+}
 
-				net_nfc_exchanger_get_alternative_carrier_type((net_nfc_connection_handover_info_h)data, &type);
-				if (type == NET_NFC_CONN_HANDOVER_CARRIER_BT)
-				{
-					carrior_type = NFC_AC_TYPE_BT;
-					if(net_nfc_exchanger_get_alternative_carrier_data((net_nfc_connection_handover_info_h)data, &ac_info)== 0)
-					{
-						temp = (char *)net_nfc_get_data_buffer(ac_info);
-						if( temp != NULL)
-						{
-
-							snprintf(buffer, 50, "%02x:%02x:%02x:%02x:%02x:%02x",temp[0], temp[1], temp[2], temp[3], temp[4], temp[5]);
-
-							 ac_data = (strdup(buffer));
-							 ac_data_size = strlen(ac_data ) +1;
-						}
-						net_nfc_free_data(ac_info);
-					}
-				}
+static void _nfc_run_p2p_discovered(const _nfc_closure_s *closure)
+{
+	((nfc_p2p_target_discovered_cb)closure->callback)((nfc_discovered_type_e)closure->arg, (nfc_p2p_target_h)closure->handle, closure->user_data);
+}
 
-				nfc_p2p_connection_handover_completed_cb	cb = g_nfc_context.on_p2p_connection_handover_completed_cb;
-				void *										user_data = g_nfc_context.on_p2p_connection_handover_completed_user_data;
-				g_nfc_context.on_p2p_connection_handover_completed_cb = NULL;
-				g_nfc_context.on_p2p_connection_handover_completed_user_data = NULL;
-				cb(capi_result , carrior_type, (void *)ac_data, ac_data_size, user_data );
+static void _nfc_run_p2p_data_received(const _nfc_closure_s *closure)
+{
+	((nfc_p2p_data_recived_cb)closure->callback)((nfc_p2p_target_h)closure->handle, (nfc_ndef_message_h)closure->object, closure->user_data);
+}
 
-				net_nfc_exchanger_free_alternative_carrier_data((net_nfc_connection_handover_info_h)data);
-				free(ac_data);
-			}
-			break;
+static void _nfc_run_p2p_message_view_received(const _nfc_closure_s *closure)
+{
+	((nfc_p2p_message_view_received_cb)closure->callback)((nfc_p2p_target_h)closure->handle, (nfc_ndef_message_view_h)closure->object, closure->user_data);
+}
+
+static void _nfc_run_connection_handover_completed(const _nfc_closure_s *closure)
+{
+	((nfc_p2p_connection_handover_completed_cb)closure->callback)(closure->result, (nfc_ac_type_e)closure->arg, (void *)closure->buffer, closure->buffer_size, closure->user_data);
+}
+
+static void _nfc_run_initialize_completed(const _nfc_closure_s *closure)
+{
+	((nfc_initialize_completed_cb)closure->callback)(closure->result, closure->user_data);
+}
+
+static void _nfc_run_activation_changed(const _nfc_closure_s *closure)
+{
+	((nfc_activation_changed_cb)closure->callback)(closure->arg, closure->user_data);
+}
+
+static void _nfc_run_activation_completed(const _nfc_closure_s *closure)
+{
+	((nfc_activation_completed_cb)closure->callback)(closure->result, closure->user_data);
+}
+
+static void _nfc_run_se_event(const _nfc_closure_s *closure)
+{
+	((nfc_se_event_cb)closure->callback)((nfc_se_event_e)closure->arg, closure->user_data);
+}
+
+static void _nfc_run_se_transaction_event(const _nfc_closure_s *closure)
+{
+	((nfc_se_transaction_event_cb)closure->callback)((unsigned char *)closure->buffer, closure->buffer_size, (unsigned char *)closure->buffer2, closure->buffer2_size, closure->user_data);
+}
+
+static void * _nfc_closure_tag_retain(void *tag)
+{
+	nfc_tag_retain((nfc_tag_h)tag);
+	return tag;
+}
+
+static void _nfc_closure_tag_release(void *tag)
+{
+	_nfc_tag_session_unref((_nfc_tag_session_s *)tag);
+}
+
+static void _nfc_on_tag_discovered(net_nfc_message_e message, net_nfc_error_e result, int capi_result, void *data, void *trans_data)
+{
+	net_nfc_target_info_s *target_info = (net_nfc_target_info_s*)data;
+	const _nfc_callback_s *cb;
+	_nfc_closure_s closure;
+	_nfc_tag_session_s *session;
+
+	if( target_info == NULL )
+		return;
+
+	session = _nfc_tag_session_attach(target_info);
+	if( session != NULL ){
+		_nfc_event_queue_post(NFC_EVENT_TYPE_TAG_DISCOVERED, capi_result, session, 0, NULL, 0, NULL, 0);
+		if( target_info->raw_data.buffer != NULL )
+			_nfc_event_queue_post(NFC_EVENT_TYPE_NDEF_DISCOVERED, capi_result, session, 0,
+				target_info->raw_data.buffer, target_info->raw_data.length, NULL, 0);
+	}
+
+	cb = _nfc_callback_get(&g_nfc_context.on_tag_discovered);
+	if( session != NULL && cb != NULL ){
+		_nfc_closure_init(&closure, _nfc_run_tag_discovered, cb->callback, cb->user_data);
+		closure.arg = NFC_DISCOVERED_TYPE_ATTACHED;
+		closure.object = session;
+		closure.object_copy = _nfc_closure_tag_retain;
+		closure.object_free = _nfc_closure_tag_release;
+		_nfc_executor_dispatch(target_info->handle, &closure);
+	}
+
+	//ndef discovered cb
+	cb = _nfc_callback_get(&g_nfc_context.on_ndef_discovered);
+	if( cb != NULL && target_info->raw_data.buffer != NULL ){
+		ndef_message_h ndef_message ;
+		net_nfc_create_ndef_message_from_rawdata (&ndef_message, (data_h)&(target_info->raw_data) );
+		_nfc_closure_init(&closure, _nfc_run_ndef_discovered, cb->callback, cb->user_data);
+		closure.object = ndef_message;
+		closure.object_free = _nfc_closure_ndef_message_free;
+		_nfc_executor_dispatch(target_info->handle, &closure);
+	}
+}
+
+static void _nfc_on_tag_detached(net_nfc_message_e message, net_nfc_error_e result, int capi_result, void *data, void *trans_data)
+{
+	_nfc_tag_session_s *session = _nfc_tag_session_detach((net_nfc_target_handle_h)data);
+	const _nfc_callback_s *cb;
+	_nfc_closure_s closure;
+
+	if( session == NULL )
+		return;
+
+	/* the tag is gone, nothing issued against it will ever be answered */
+	_nfc_pending_fail(session->info.handle, NFC_ERROR_NO_DEVICE);
+	_nfc_event_queue_post(NFC_EVENT_TYPE_TAG_DETACHED, capi_result, session, 0, NULL, 0, NULL, 0);
+
+	cb = _nfc_callback_get(&g_nfc_context.on_tag_discovered);
+	if( cb == NULL ){
+		_nfc_tag_session_unref(session);
+		return;
+	}
+
+	/* the closure takes over the reference of the table */
+	_nfc_closure_init(&closure, _nfc_run_tag_discovered, cb->callback, cb->user_data);
+	closure.arg = NFC_DISCOVERED_TYPE_DETACHED;
+	closure.object = session;
+	closure.object_free = _nfc_closure_tag_release;
+	_nfc_executor_dispatch(session->info.handle, &closure);
+}
+
+static void _nfc_on_p2p_discovered(net_nfc_message_e message, net_nfc_error_e result, int capi_result, void *data, void *trans_data)
+{
+	const _nfc_callback_s *cb;
+	_nfc_closure_s closure;
+
+	/* sends still queued for a previous link will not be answered */
+	_nfc_p2p_send_fail_all(NFC_ERROR_NO_DEVICE);
+	g_nfc_context.current_target = (net_nfc_target_handle_h)data;
+	_nfc_callback_set(&g_nfc_context.on_p2p_recv, NULL, NULL);
+	_nfc_callback_set(&g_nfc_context.on_p2p_recv_view, NULL, NULL);
+	_nfc_event_queue_post(NFC_EVENT_TYPE_P2P_DISCOVERED, capi_result, data, 0, NULL, 0, NULL, 0);
+
+	cb = _nfc_callback_get(&g_nfc_context.on_p2p_discovered);
+	if( cb != NULL ){
+		_nfc_closure_init(&closure, _nfc_run_p2p_discovered, cb->callback, cb->user_data);
+		closure.arg = NFC_DISCOVERED_TYPE_ATTACHED;
+		closure.handle = data;
+		_nfc_executor_dispatch(data, &closure);
+	}
+}
+
+static void _nfc_on_p2p_detached(net_nfc_message_e message, net_nfc_error_e result, int capi_result, void *data, void *trans_data)
+{
+	const _nfc_callback_s *cb = _nfc_callback_get(&g_nfc_context.on_p2p_discovered);
+	_nfc_closure_s closure;
+
+	_nfc_event_queue_post(NFC_EVENT_TYPE_P2P_DETACHED, capi_result, g_nfc_context.current_target, 0, NULL, 0, NULL, 0);
+
+	if( cb != NULL ){
+		_nfc_closure_init(&closure, _nfc_run_p2p_discovered, cb->callback, cb->user_data);
+		closure.arg = NFC_DISCOVERED_TYPE_DETACHED;
+		closure.handle = g_nfc_context.current_target;
+		_nfc_executor_dispatch(g_nfc_context.current_target, &closure);
+	}
+	memset(&g_nfc_context.current_target , 0 , sizeof( g_nfc_context.current_target ));
+	_nfc_callback_set(&g_nfc_context.on_p2p_recv, NULL, NULL);
+	_nfc_callback_set(&g_nfc_context.on_p2p_recv_view, NULL, NULL);
+	_nfc_p2p_send_fail_all(NFC_ERROR_NO_DEVICE);
+}
+
+static void _nfc_on_p2p_send(net_nfc_message_e message, net_nfc_error_e result, int capi_result, void *data, void *trans_data)
+{
+	_nfc_p2p_send_complete(g_nfc_context.current_target, capi_result);
+}
+
+static void _nfc_on_p2p_receive(net_nfc_message_e message, net_nfc_error_e result, int capi_result, void *data, void *trans_data)
+{
+	const _nfc_callback_s *cb = _nfc_callback_get(&g_nfc_context.on_p2p_recv);
+	_nfc_closure_s closure;
+
+	_NFC_COUNTERS_ADD(_NFC_COUNTER_P2P_RECEIVES, 1);
+	if( data != NULL ){
+		_NFC_COUNTERS_ADD(_NFC_COUNTER_BYTES_RECEIVED, ((data_s *)data)->length);
+		_nfc_event_queue_post(NFC_EVENT_TYPE_P2P_DATA_RECEIVED, capi_result, g_nfc_context.current_target, 0,
+			((data_s *)data)->buffer, ((data_s *)data)->length, NULL, 0);
+	}
+
+	if( cb != NULL ){
+		ndef_message_h ndef_message ;
+		net_nfc_create_ndef_message_from_rawdata (&ndef_message, (data_h)(data) );
+		_nfc_closure_init(&closure, _nfc_run_p2p_data_received, cb->callback, cb->user_data);
+		closure.handle = g_nfc_context.current_target;
+		closure.object = ndef_message;
+		closure.object_free = _nfc_closure_ndef_message_free;
+		_nfc_executor_dispatch(g_nfc_context.current_target, &closure);
+	}
+
+	/* the view is handed over, so the closure does not free it */
+	cb = _nfc_callback_get(&g_nfc_context.on_p2p_recv_view);
+	if( cb != NULL && data != NULL && ((data_s *)data)->length > 0 ){
+		nfc_ndef_message_view_h view;
+		if( nfc_ndef_message_view_create(&view, ((data_s *)data)->buffer, ((data_s *)data)->length) == NFC_ERROR_NONE ){
+			_nfc_closure_init(&closure, _nfc_run_p2p_message_view_received, cb->callback, cb->user_data);
+			closure.handle = g_nfc_context.current_target;
+			closure.object = view;
+			_nfc_executor_dispatch(g_nfc_context.current_target, &closure);
 		}
+	}
+}
 
+static void _nfc_on_connection_handover(net_nfc_message_e message, net_nfc_error_e result, int capi_result, void *data, void *trans_data)
+{
+	_nfc_closure_s closure;
+	void *callback;
+	void *user_data;
 
-		case NET_NFC_MESSAGE_IS_TAG_CONNECTED :
-		{
-			net_nfc_target_type_e  devType = *(net_nfc_target_type_e *)data;
+	if( _nfc_callback_take(&g_nfc_context.on_p2p_connection_handover_completed, &callback, &user_data) ){
 
-			if( (devType == NET_NFC_NFCIP1_TARGET )||(devType == NET_NFC_NFCIP1_INITIATOR ))
-			{
-				net_nfc_get_current_target_handle(trans_data);
-			}
-			else if( (devType > NET_NFC_UNKNOWN_TARGET )&&(devType < NET_NFC_NFCIP1_TARGET ))
-			{
-				net_nfc_get_current_tag_info(trans_data);
-			}
-			else
+		net_nfc_conn_handover_carrier_type_e type = NET_NFC_CONN_HANDOVER_CARRIER_UNKNOWN;
+		nfc_ac_type_e carrior_type = NFC_AC_TYPE_UNKNOWN;
+		int ac_data_size = 0;
+		char * temp = NULL;
+		char buffer[50] = {0,};
+		data_h ac_info = NULL;
+
+
+		net_nfc_exchanger_get_alternative_carrier_type((net_nfc_connection_handover_info_h)data, &type);
+		if (type == NET_NFC_CONN_HANDOVER_CARRIER_BT)
+		{
+			carrior_type = NFC_AC_TYPE_BT;
+			if(net_nfc_exchanger_get_alternative_carrier_data((net_nfc_connection_handover_info_h)data, &ac_info)== 0)
 			{
-				if (result == NET_NFC_NOT_CONNECTED)
+				temp = (char *)net_nfc_get_data_buffer(ac_info);
+				if( temp != NULL)
 				{
-					capi_result = NFC_ERROR_NONE;
-				}
 
-				if( g_nfc_context.on_initialize_completed_cb ){
-					nfc_initialize_completed_cb	 	cb = g_nfc_context.on_initialize_completed_cb;
-					g_nfc_context.on_initialize_completed_cb = NULL;
-					cb( capi_result,trans_data );
+					snprintf(buffer, 50, "%02x:%02x:%02x:%02x:%02x:%02x",temp[0], temp[1], temp[2], temp[3], temp[4], temp[5]);
+
+					 ac_data_size = strlen(buffer ) +1;
 				}
+				net_nfc_free_data(ac_info);
 			}
-			break;
 		}
 
-		case NET_NFC_MESSAGE_GET_CURRENT_TAG_INFO :
-		{
-			int i;
-			net_nfc_target_info_s *target_info = (net_nfc_target_info_s*)data;
-
-			memset(&g_nfc_context.current_tag , 0 , sizeof( g_nfc_context.current_tag ));
-			g_nfc_context.current_tag = * target_info;
-			net_nfc_tag_info_s *list = g_nfc_context.current_tag.tag_info_list;
-			net_nfc_tag_info_s *newlist ;
-			newlist = (net_nfc_tag_info_s *)calloc(g_nfc_context.current_tag.number_of_keys, sizeof(net_nfc_tag_info_s));
-
-			//copy info list
-			for(i = 0; i < g_nfc_context.current_tag.number_of_keys ; i++){
-				if( list[i].key ){
-					newlist[i].key = strdup(list[i].key);
-				}
-				if ( list[i].value ){
-					net_nfc_create_data(&newlist[i].value , ((data_s*)list[i].value)->buffer, ((data_s*)list[i].value)->length);
-				}
-			}
-			g_nfc_context.current_tag.tag_info_list = newlist;
+		_nfc_closure_init(&closure, _nfc_run_connection_handover_completed, callback, user_data);
+		closure.result = capi_result;
+		closure.arg = carrior_type;
+		closure.buffer = ac_data_size ? (unsigned char *)buffer : NULL;
+		closure.buffer_size = ac_data_size;
+		_nfc_executor_dispatch(g_nfc_context.current_target, &closure);
 
-			nfc_initialize_completed_cb	 	cb = g_nfc_context.on_initialize_completed_cb;
-			g_nfc_context.on_initialize_completed_cb = NULL;
-			if( cb ){
-				cb( capi_result, trans_data );
-			}
-			break;
-		}
+		net_nfc_exchanger_free_alternative_carrier_data((net_nfc_connection_handover_info_h)data);
+	}
+}
 
-		case NET_NFC_MESSAGE_GET_CURRENT_TARGET_HANDLE :
-		{
-			g_nfc_context.current_target = (net_nfc_target_handle_h)data;
+/* the user data of nfc_manager_initialize() travels as trans_data */
+static void _nfc_on_initialize_completed(int capi_result, void *trans_data)
+{
+	_nfc_closure_s closure;
+	void *callback;
+	void *user_data;
 
-			nfc_initialize_completed_cb	 	cb = g_nfc_context.on_initialize_completed_cb;
-			g_nfc_context.on_initialize_completed_cb = NULL;
-			if( cb ){
-				cb( capi_result, trans_data );
-			}
+	if( _nfc_callback_take(&g_nfc_context.on_initialize_completed, &callback, &user_data) ){
+		_nfc_closure_init(&closure, _nfc_run_initialize_completed, callback, trans_data);
+		closure.result = capi_result;
+		_nfc_executor_dispatch(&g_nfc_context, &closure);
+	}
+}
 
-			break;
+static void _nfc_on_is_tag_connected(net_nfc_message_e message, net_nfc_error_e result, int capi_result, void *data, void *trans_data)
+{
+	net_nfc_target_type_e  devType = *(net_nfc_target_type_e *)data;
+
+	if( (devType == NET_NFC_NFCIP1_TARGET )||(devType == NET_NFC_NFCIP1_INITIATOR ))
+	{
+		net_nfc_get_current_target_handle(trans_data);
+	}
+	else if( (devType > NET_NFC_UNKNOWN_TARGET )&&(devType < NET_NFC_NFCIP1_TARGET ))
+	{
+		net_nfc_get_current_tag_info(trans_data);
+	}
+	else
+	{
+		if (result == NET_NFC_NOT_CONNECTED)
+		{
+			capi_result = NFC_ERROR_NONE;
 		}
 
+		_nfc_on_initialize_completed(capi_result, trans_data);
+	}
+}
 
-		case NET_NFC_MESSAGE_INIT :
-		{
-			bool activated = true;
+static void _nfc_on_get_current_tag_info(net_nfc_message_e message, net_nfc_error_e result, int capi_result, void *data, void *trans_data)
+{
+	if( data != NULL )
+		_nfc_tag_session_attach((net_nfc_target_info_s*)data);
 
-			LOGE( "_nfc_response_handler NET_NFC_MESSAGE_INIT\n");
+	_nfc_on_initialize_completed(capi_result, trans_data);
+}
 
-			if (result == NET_NFC_OK){
-				if( g_nfc_context.on_activation_changed_cb != NULL ){
-					g_nfc_context.on_activation_changed_cb(activated , g_nfc_context.on_activation_changed_user_data);
-					LOGE( "_nfc_response_handler changed call back NET_NFC_MESSAGE_INIT NET_NFC_OK\n");
-				}
+static void _nfc_on_get_current_target_handle(net_nfc_message_e message, net_nfc_error_e result, int capi_result, void *data, void *trans_data)
+{
+	g_nfc_context.current_target = (net_nfc_target_handle_h)data;
 
-				if( g_nfc_context.on_activation_completed_cb != NULL ){
-					g_nfc_context.on_activation_completed_cb(result , g_nfc_context.on_activation_completed_user_data);
-					LOGE( "_nfc_response_handler completed call back NET_NFC_MESSAGE_INIT NET_NFC_OK\n");
+	_nfc_on_initialize_completed(capi_result, trans_data);
+}
 
-					nfc_manager_unset_activation_completed_cb();
-				}
-				else
-				{
-					g_nfc_context.on_activation_doing = false;
-					LOGE( "g_nfc_context.on_activation_doing\n");
-				}
+static void _nfc_on_activation(net_nfc_message_e message, net_nfc_error_e result, int capi_result, void *data, void *trans_data)
+{
+	bool activated = (message == NET_NFC_MESSAGE_INIT);
+	const _nfc_callback_s *cb;
+	_nfc_closure_s closure;
+	void *callback;
+	void *user_data;
 
+	_nfc_activation_cache_set(result == NET_NFC_OK ? activated : -1);
 
-			}
+	if (result == NET_NFC_OK){
+		_nfc_event_queue_post(NFC_EVENT_TYPE_ACTIVATION_CHANGED, capi_result, NULL, activated, NULL, 0, NULL, 0);
 
-			break;
+		cb = _nfc_callback_get(&g_nfc_context.on_activation_changed);
+		if( cb != NULL ){
+			_nfc_closure_init(&closure, _nfc_run_activation_changed, cb->callback, cb->user_data);
+			closure.arg = activated;
+			_nfc_executor_dispatch(&g_nfc_context, &closure);
 		}
 
-		case NET_NFC_MESSAGE_DEINIT :
-		{
-			bool activated = false;
+		if( _nfc_callback_take(&g_nfc_context.on_activation_completed, &callback, &user_data) ){
+			_nfc_closure_init(&closure, _nfc_run_activation_completed, callback, user_data);
+			closure.result = result;
+			_nfc_executor_dispatch(&g_nfc_context, &closure);
+		}
+		g_nfc_context.on_activation_doing = false;
+	}
+}
 
-			if (result == NET_NFC_OK){
-				if( g_nfc_context.on_activation_changed_cb != NULL ){
-					g_nfc_context.on_activation_changed_cb(activated , g_nfc_context.on_activation_changed_user_data);
-					LOGE( "_nfc_response_handler NET_NFC_MESSAGE_DEINIT NET_NFC_OK\n");
-				}
+static const nfc_se_event_e _nfc_se_events[] = {
+	[NET_NFC_MESSAGE_SE_START_TRANSACTION] = NFC_SE_EVENT_START_TRANSACTION,
+	[NET_NFC_MESSAGE_SE_END_TRANSACTION] = NFC_SE_EVENT_END_TRANSACTION,
+	[NET_NFC_MESSAGE_SE_CONNECTIVITY] = NFC_SE_EVENT_CONNECTIVITY,
+	[NET_NFC_MESSAGE_SE_FIELD_ON] = NFC_SE_EVENT_FIELD_ON,
+	[NET_NFC_MESSAGE_SE_FIELD_OFF] = NFC_SE_EVENT_FIELD_OFF,
+	[NET_NFC_MESSAGE_SE_TYPE_TRANSACTION] = NFC_SE_EVENT_TRANSACTION,
+};
 
-				if( g_nfc_context.on_activation_completed_cb != NULL ){
-					g_nfc_context.on_activation_completed_cb(result , g_nfc_context.on_activation_completed_user_data);
-					LOGE( "_nfc_response_handler completed call back NET_NFC_MESSAGE_INIT NET_NFC_OK\n");
+/* all SE events share one key, so they are delivered in order */
+static void _nfc_on_se_event(net_nfc_message_e message, net_nfc_error_e result, int capi_result, void *data, void *trans_data)
+{
+	nfc_se_event_e event = _nfc_se_events[message];
+	const _nfc_callback_s *cb = _nfc_callback_get(&g_nfc_context.on_se_event);
+	_nfc_closure_s closure;
 
-					nfc_manager_unset_activation_completed_cb();
-				}
-				else
-				{
-					g_nfc_context.on_activation_doing = false;
-					LOGE( "g_nfc_context.on_activation_doing\n");
-				}
-			}
+	_NFC_COUNTERS_ADD(_NFC_COUNTER_SE_EVENTS, 1);
+	_nfc_event_queue_post(NFC_EVENT_TYPE_SE_EVENT, capi_result, NULL, event, NULL, 0, NULL, 0);
 
-			break;
+	if( cb != NULL ){
+		_nfc_closure_init(&closure, _nfc_run_se_event, cb->callback, cb->user_data);
+		closure.arg = event;
+		_nfc_executor_dispatch(_nfc_se_events, &closure);
+	}
+	if( message == NET_NFC_MESSAGE_SE_TYPE_TRANSACTION){
+		net_nfc_se_event_info_s* transaction_data = (net_nfc_se_event_info_s*)data;
+		if( transaction_data != NULL )
+			_nfc_event_queue_post(NFC_EVENT_TYPE_SE_TRANSACTION, capi_result, NULL,
+				transaction_data->aid.buffer != NULL ? transaction_data->aid.length : 0,
+				transaction_data->aid.buffer, transaction_data->aid.length,
+				transaction_data->param.buffer, transaction_data->param.length);
+		cb = _nfc_callback_get(&g_nfc_context.on_se_transaction_event);
+		if( cb != NULL && transaction_data != NULL){
+			_nfc_closure_init(&closure, _nfc_run_se_transaction_event, cb->callback, cb->user_data);
+			closure.buffer = transaction_data->aid.buffer;
+			closure.buffer_size = transaction_data->aid.length;
+			closure.buffer2 = transaction_data->param.buffer;
+			closure.buffer2_size = transaction_data->param.length;
+			_nfc_executor_dispatch(_nfc_se_events, &closure);
 		}
+	}
+}
 
-		case NET_NFC_MESSAGE_SE_START_TRANSACTION :
-		case NET_NFC_MESSAGE_SE_END_TRANSACTION :
-		case NET_NFC_MESSAGE_SE_TYPE_TRANSACTION:
-		case NET_NFC_MESSAGE_SE_CONNECTIVITY :
-		case NET_NFC_MESSAGE_SE_FIELD_ON :
-		case NET_NFC_MESSAGE_SE_FIELD_OFF :
-		{
-			nfc_se_event_e event = NFC_SE_EVENT_START_TRANSACTION;
-			switch( message ){
-				case NET_NFC_MESSAGE_SE_START_TRANSACTION:
-					event = NFC_SE_EVENT_START_TRANSACTION;
-					break;
-				case NET_NFC_MESSAGE_SE_END_TRANSACTION:
-					event = NFC_SE_EVENT_END_TRANSACTION;
-					break;
-				case NET_NFC_MESSAGE_SE_CONNECTIVITY:
-					event = NFC_SE_EVENT_CONNECTIVITY;
-					break;
-				case NET_NFC_MESSAGE_SE_FIELD_ON :
-					event = NFC_SE_EVENT_FIELD_ON;
-					break;
-				case NET_NFC_MESSAGE_SE_FIELD_OFF :
-					event = NFC_SE_EVENT_FIELD_OFF;
-					break;
-				case NET_NFC_MESSAGE_SE_TYPE_TRANSACTION:
-					event = NFC_SE_EVENT_TRANSACTION;
-					break;
-					default:
-						break;
-			}
+/* messages without an entry, NET_NFC_MESSAGE_NOTIFY among them, are ignored */
+static const _nfc_event_handler _nfc_event_handlers[] = {
+	[NET_NFC_MESSAGE_TRANSCEIVE] = _nfc_on_transceive,
+	[NET_NFC_MESSAGE_READ_NDEF] = _nfc_on_read_ndef,
+	[NET_NFC_MESSAGE_WRITE_NDEF] = _nfc_on_write_ndef,
+	[NET_NFC_MESSAGE_TAG_DISCOVERED] = _nfc_on_tag_discovered,
+	[NET_NFC_MESSAGE_TAG_DETACHED] = _nfc_on_tag_detached,
+	[NET_NFC_MESSAGE_P2P_DISCOVERED] = _nfc_on_p2p_discovered,
+	[NET_NFC_MESSAGE_P2P_DETACHED] = _nfc_on_p2p_detached,
+	[NET_NFC_MESSAGE_P2P_SEND] = _nfc_on_p2p_send,
+	[NET_NFC_MESSAGE_P2P_RECEIVE] = _nfc_on_p2p_receive,
+	[NET_NFC_MESSAGE_FORMAT_NDEF] = _nfc_on_format_ndef,
+	[NET_NFC_MESSAGE_CONNECTION_HANDOVER] = _nfc_on_connection_handover,
+	[NET_NFC_MESSAGE_IS_TAG_CONNECTED] = _nfc_on_is_tag_connected,
+	[NET_NFC_MESSAGE_GET_CURRENT_TAG_INFO] = _nfc_on_get_current_tag_info,
+	[NET_NFC_MESSAGE_GET_CURRENT_TARGET_HANDLE] = _nfc_on_get_current_target_handle,
+	[NET_NFC_MESSAGE_INIT] = _nfc_on_activation,
+	[NET_NFC_MESSAGE_DEINIT] = _nfc_on_activation,
+	[NET_NFC_MESSAGE_SE_START_TRANSACTION] = _nfc_on_se_event,
+	[NET_NFC_MESSAGE_SE_END_TRANSACTION] = _nfc_on_se_event,
+	[NET_NFC_MESSAGE_SE_TYPE_TRANSACTION] = _nfc_on_se_event,
+	[NET_NFC_MESSAGE_SE_CONNECTIVITY] = _nfc_on_se_event,
+	[NET_NFC_MESSAGE_SE_FIELD_ON] = _nfc_on_se_event,
+	[NET_NFC_MESSAGE_SE_FIELD_OFF] = _nfc_on_se_event,
+};
 
-			if( g_nfc_context.on_se_event_cb ){
-				g_nfc_context.on_se_event_cb(event, g_nfc_context.on_se_event_user_data);
-			}
-			if( message == NET_NFC_MESSAGE_SE_TYPE_TRANSACTION){
-				net_nfc_se_event_info_s* transaction_data = (net_nfc_se_event_info_s*)data;
-				if( g_nfc_context.on_se_transaction_event_cb && transaction_data != NULL){
-					g_nfc_context.on_se_transaction_event_cb(transaction_data->aid.buffer,transaction_data->aid.length, transaction_data->param.buffer,transaction_data->param.length  , g_nfc_context.on_se_transaction_event_user_data);
-				}
-			}
-		}
+void _nfc_response_handler(net_nfc_message_e message, net_nfc_error_e result, void* data, void* user_param, void * trans_data)
+{
+	NFC_LOGI("NFC [%s] message %d - start result[%d] ", __func__, message, result);
 
-		default :
-			break;
-	}
+	if( (unsigned int)message >= sizeof(_nfc_event_handlers) / sizeof(_nfc_event_handlers[0]) || _nfc_event_handlers[message] == NULL )
+		return;
+
+	/* only handled messages are traced, every EVENT record is closed by an EVENT_END */
+	_NFC_TRACE_EVENT(message, result, data, trans_data);
 
+	int capi_result = _convert_error_code("EVENT", result);
+	_nfc_stats_stamp_s saved_stamp;
+
+	_nfc_stats_event_begin(message, &saved_stamp);
+
+	/* keeps the callbacks read by the handler alive while they run */
+	unsigned int epoch = _nfc_callback_read_lock();
+	_nfc_event_handlers[message](message, result, capi_result, data, trans_data);
+	_nfc_callback_read_unlock(epoch);
+
+	_nfc_stats_event_end(&saved_stamp);
+	_NFC_TRACE_EVENT_END(message);
 }
 
 
@@ -627,7 +800,7 @@ int nfc_manager_set_activation(bool activation, nfc_activation_completed_cb call
 
 	if(nfc_check_activation == true)
 	{
-		LOGE( "nfc_manager_check_activation BUSY!!!!!\n");
+		NFC_LOGE("nfc_manager_check_activation BUSY!!!!!\n");
 		return NFC_ERROR_DEVICE_BUSY;
 	}
 
@@ -661,13 +834,13 @@ int nfc_manager_set_activation(bool activation, nfc_activation_completed_cb call
 			if (ret == NET_NFC_OK)
 			{
 				ret = NFC_ERROR_NONE;
-				LOGE( "nfc_manager_set_activation net_nfc_set_state success\n");
+				NFC_LOGD("nfc_manager_set_activation net_nfc_set_state success\n");
 			}
 			else
 			{
 				nfc_manager_unset_activation_completed_cb();
 				ret = NFC_ERROR_OPERATION_FAILED;
-				LOGE( "nfc_manager_set_activation net_nfc_set_state fail\n");
+				NFC_LOGE("nfc_manager_set_activation net_nfc_set_state fail\n");
 			}
 		}
 	}
@@ -679,15 +852,12 @@ int nfc_manager_set_activation_changed_cb(nfc_activation_changed_cb callback , v
 {
 	if( callback == NULL)
 		return _return_invalid_param(__func__);
-	g_nfc_context.on_activation_changed_cb = callback;
-	g_nfc_context.on_activation_changed_user_data = user_data;
-	return 0;
+	return _nfc_callback_set(&g_nfc_context.on_activation_changed, callback, user_data);
 }
 
 void nfc_manager_unset_activation_changed_cb(void)
 {
-	g_nfc_context.on_activation_changed_cb = NULL;
-	g_nfc_context.on_activation_changed_user_data = NULL;
+	_nfc_callback_set(&g_nfc_context.on_activation_changed, NULL, NULL);
 }
 
 
@@ -695,9 +865,17 @@ void nfc_manager_unset_activation_changed_cb(void)
 
 bool nfc_manager_is_activated(void)
 {
-	int activated = 0;
+	int activated = g_nfc_activated;
+
+	if( activated >= 0 )
+		return activated;
 
+	activated = 0;
 	net_nfc_get_state(&activated);
+	activated = activated ? 1 : 0;
+
+	/* an INIT/DEINIT event which arrived meanwhile is more recent */
+	__sync_bool_compare_and_swap(&g_nfc_activated, -1, activated);
 
 	if(activated)
 	{
@@ -719,10 +897,11 @@ int nfc_manager_initialize (nfc_initialize_completed_cb callback, void *user_dat
 	if( ret != NET_NFC_OK )
 		return _convert_error_code(__func__, ret);
 
-	memset( &g_nfc_context , 0 , sizeof( g_nfc_context));
+	_nfc_context_reset();
+	_nfc_activation_cache_set(-1);
 	net_nfc_set_response_callback( _nfc_response_handler , &g_nfc_context);
 	net_nfc_state_activate (1);
-	g_nfc_context.on_initialize_completed_cb = callback;
+	_nfc_callback_set(&g_nfc_context.on_initialize_completed, callback, NULL);
 	ret = net_nfc_is_tag_connected(user_data);
 	if( ret != NET_NFC_OK )
 		return _convert_error_code(__func__, ret);
@@ -737,6 +916,12 @@ int nfc_manager_deinitialize (void)
 
 	ret = net_nfc_deinitialize();
 
+	_nfc_pending_fail(NULL, NFC_ERROR_OPERATION_FAILED);
+	_nfc_p2p_send_fail_all(NFC_ERROR_OPERATION_FAILED);
+	_nfc_tag_session_detach_all();
+
+	/* no more INIT/DEINIT events will keep the cache up to date */
+	_nfc_activation_cache_set(-1);
 
 	if( ret == 0)
 		net_nfc_unset_response_callback();
@@ -748,30 +933,24 @@ int nfc_manager_set_tag_discovered_cb( nfc_tag_discovered_cb callback , void * u
 {
 	if( callback == NULL)
 		return _return_invalid_param(__func__);
-	g_nfc_context.on_tag_discovered_cb = callback;
-	g_nfc_context.on_tag_discovered_user_data = user_data;
-	return 0;
+	return _nfc_callback_set(&g_nfc_context.on_tag_discovered, callback, user_data);
 }
 void nfc_manager_unset_tag_discovered_cb( void )
 {
-	g_nfc_context.on_tag_discovered_cb = NULL;
-	g_nfc_context.on_tag_discovered_user_data = NULL;
+	_nfc_callback_set(&g_nfc_context.on_tag_discovered, NULL, NULL);
 }
 
 int nfc_manager_set_ndef_discovered_cb( nfc_ndef_discovered_cb callback , void *user_data)
 {
 	if( callback == NULL)
 		return _return_invalid_param(__func__);
-	g_nfc_context.on_ndef_discovered_cb= callback;
-	g_nfc_context.on_ndef_discovered_user_data= user_data;
-	return 0;
+	return _nfc_callback_set(&g_nfc_context.on_ndef_discovered, callback, user_data);
 }
 
 void nfc_manager_unset_ndef_discovered_cb( void )
 {
 
-	g_nfc_context.on_ndef_discovered_cb = NULL;
-	g_nfc_context.on_ndef_discovered_user_data = NULL;
+	_nfc_callback_set(&g_nfc_context.on_ndef_discovered, NULL, NULL);
 }
 
 
@@ -795,13 +974,13 @@ int nfc_manager_get_connected_tag(nfc_tag_h * tag)
 	if( tag == NULL )
 		return _return_invalid_param(__func__);
 
-	if(g_nfc_context.current_tag.handle == NULL)
+	*tag = (nfc_tag_h)_nfc_tag_session_current();
+	if(*tag == NULL)
 	{
 		ret = NFC_ERROR_NO_DEVICE;
 	}
 	else
 	{
-		*tag = (nfc_tag_h)&g_nfc_context.current_tag;
 		ret = NFC_ERROR_NONE;
 	}
 	return ret;
@@ -917,7 +1096,7 @@ int nfc_ndef_record_get_mime_type(nfc_ndef_record_h record , char **mime_type){
 
 	*mime_type = malloc(length+1);
 	if( *mime_type == NULL ){
-		LOGE( "[%s] OUT_OF_MEMORY (0x%08x)",__func__ , NFC_ERROR_OUT_OF_MEMORY);
+		NFC_LOGE("[%s] OUT_OF_MEMORY (0x%08x)",__func__ , NFC_ERROR_OUT_OF_MEMORY);
 		return NFC_ERROR_OUT_OF_MEMORY;
 	}
 
@@ -1195,12 +1374,12 @@ int nfc_tag_foreach_information(nfc_tag_h tag , nfc_tag_information_cb callback
 {
 	int i;
 
-	net_nfc_tag_info_s *taglist = g_nfc_context.current_tag.tag_info_list;
-
 	if( tag == NULL || callback == NULL )
 		return _return_invalid_param(__func__);
 
-	for(i=0; i<g_nfc_context.current_tag.number_of_keys; i++){
+	net_nfc_tag_info_s *taglist = ((net_nfc_target_info_s*)tag)->tag_info_list;
+
+	for(i=0; i<((net_nfc_target_info_s*)tag)->number_of_keys; i++){
 		bool cont;
 		cont = callback(taglist[i].key, net_nfc_get_data_buffer(taglist[i].value), net_nfc_get_data_length(taglist[i].value), user_data);
 		if( !cont )
@@ -1210,6 +1389,23 @@ int nfc_tag_foreach_information(nfc_tag_h tag , nfc_tag_information_cb callback
 	return 0;
 }
 
+int nfc_tag_get_information(nfc_tag_h tag, const char *key, unsigned char **value, int *value_size)
+{
+	const net_nfc_tag_info_s *info;
+
+	if( tag == NULL || key == NULL || value == NULL || value_size == NULL )
+		return _return_invalid_param(__func__);
+
+	info = _nfc_tag_session_lookup((_nfc_tag_session_s*)tag, key);
+	if( info == NULL )
+		return NFC_ERROR_NOT_SUPPORTED;
+
+	*value = net_nfc_get_data_buffer(info->value);
+	*value_size = net_nfc_get_data_length(info->value);
+
+	return NFC_ERROR_NONE;
+}
+
 
 int nfc_tag_transceive( nfc_tag_h tag, unsigned char * buffer, int buffer_size,  nfc_tag_transceive_completed_cb callback , void * user_data )
 {
@@ -1222,25 +1418,27 @@ int nfc_tag_transceive( nfc_tag_h tag, unsigned char * buffer, int buffer_size,
 		return NFC_ERROR_NOT_ACTIVATED;
 	}
 
+	if( !((_nfc_tag_session_s *)tag)->attached )
+		return _return_no_device(__func__);
+
 	int ret=0;
 	data_s rawdata = { buffer, buffer_size };
 	net_nfc_target_info_s *tag_info = (net_nfc_target_info_s*)tag;
 
 
-	_async_callback_data * trans_data = NULL;
+	void * trans_data = NULL;
 	if( callback != NULL ){
-	 	trans_data = (_async_callback_data*)malloc( sizeof(_async_callback_data));
+		trans_data = _nfc_async_request_create((net_nfc_target_handle_h)tag_info->handle, callback, user_data, _NFC_CALLBACK_TYPE_DATA);
 		if(trans_data == NULL )
 			return NFC_ERROR_OUT_OF_MEMORY;
-		memset(trans_data , 0 , sizeof(_async_callback_data));
-		trans_data->callback = callback;
-		trans_data->user_data = user_data;
-		trans_data->callback_type = _NFC_CALLBACK_TYPE_DATA;
 	}
 	ret = net_nfc_transceive((net_nfc_target_handle_h)tag_info->handle , (data_h) &rawdata, trans_data );
-
-
-	return _convert_error_code(__func__, ret);
+	if( ret != NET_NFC_OK )
+		_nfc_async_request_abort(trans_data);
+	ret = _convert_error_code(__func__, ret);
+	_nfc_counters_issued(_NFC_COUNTER_TRANSCEIVES, buffer_size, ret);
+	_NFC_TRACE_CALL(_NFC_TRACE_CALL_TRANSCEIVE, tag_info->handle, 0, trans_data, buffer, buffer_size, ret);
+	return ret;
 }
 
 int nfc_tag_read_ndef( nfc_tag_h tag, nfc_tag_read_completed_cb callback , void * user_data)
@@ -1254,21 +1452,26 @@ int nfc_tag_read_ndef( nfc_tag_h tag, nfc_tag_read_completed_cb callback , void
 		return NFC_ERROR_NOT_ACTIVATED;
 	}
 
+	if( !((_nfc_tag_session_s *)tag)->attached )
+		return _return_no_device(__func__);
+
 	int ret=0;
-	_async_callback_data * trans_data = NULL;
+	void * trans_data = NULL;
 	net_nfc_target_info_s *tag_info = (net_nfc_target_info_s*)tag;
 
 
 	if( callback != NULL ){
-	 	trans_data = (_async_callback_data*)malloc( sizeof(_async_callback_data));
+		trans_data = _nfc_async_request_create((net_nfc_target_handle_h)tag_info->handle, callback, user_data, _NFC_CALLBACK_TYPE_MESSAGE);
 		if(trans_data == NULL )
 			return NFC_ERROR_OUT_OF_MEMORY;
-		memset(trans_data , 0 , sizeof(_async_callback_data));
-		trans_data->callback = callback;
-		trans_data->user_data = user_data;
 	}
 	ret = net_nfc_read_tag((net_nfc_target_handle_h)tag_info->handle , trans_data );
-	return _convert_error_code(__func__, ret);
+	if( ret != NET_NFC_OK )
+		_nfc_async_request_abort(trans_data);
+	ret = _convert_error_code(__func__, ret);
+	_nfc_counters_issued(_NFC_COUNTER_NDEF_READS, 0, ret);
+	_NFC_TRACE_CALL(_NFC_TRACE_CALL_READ_NDEF, tag_info->handle, 0, trans_data, NULL, 0, ret);
+	return ret;
 }
 int nfc_tag_write_ndef(nfc_tag_h tag, nfc_ndef_message_h msg , nfc_tag_write_completed_cb callback ,  void *user_data)
 {
@@ -1281,8 +1484,11 @@ int nfc_tag_write_ndef(nfc_tag_h tag, nfc_ndef_message_h msg , nfc_tag_write_com
 		return NFC_ERROR_NOT_ACTIVATED;
 	}
 
+	if( !((_nfc_tag_session_s *)tag)->attached )
+		return _return_no_device(__func__);
+
 	int ret=0;
-	_async_callback_data * trans_data = NULL;
+	void * trans_data = NULL;
 	net_nfc_target_info_s *tag_info = (net_nfc_target_info_s*)tag;
 
 	if (tag_info->ndefCardState == NET_NFC_NDEF_CARD_READ_ONLY )
@@ -1302,15 +1508,17 @@ int nfc_tag_write_ndef(nfc_tag_h tag, nfc_ndef_message_h msg , nfc_tag_write_com
 
 
 	if( callback != NULL ){
-	 	trans_data = (_async_callback_data*)malloc( sizeof(_async_callback_data));
+		trans_data = _nfc_async_request_create((net_nfc_target_handle_h)tag_info->handle, callback, user_data, _NFC_CALLBACK_TYPE_RESULT);
 		if(trans_data == NULL )
 			return NFC_ERROR_OUT_OF_MEMORY;
-		memset(trans_data , 0 , sizeof(_async_callback_data));
-		trans_data->callback = callback;
-		trans_data->user_data = user_data;
 	}
 	ret = net_nfc_write_ndef( (net_nfc_target_handle_h)tag_info->handle , msg , trans_data );
-	return _convert_error_code(__func__, ret);
+	if( ret != NET_NFC_OK )
+		_nfc_async_request_abort(trans_data);
+	ret = _convert_error_code(__func__, ret);
+	_nfc_counters_issued(_NFC_COUNTER_NDEF_WRITES, byte_size, ret);
+	_NFC_TRACE_CALL(_NFC_TRACE_CALL_WRITE_NDEF, tag_info->handle, 0, trans_data, NULL, byte_size, ret);
+	return ret;
 }
 
 int nfc_tag_format_ndef(nfc_tag_h tag , unsigned char * key, int key_size , nfc_tag_format_completed_cb callback, void * user_data )
@@ -1324,22 +1532,27 @@ int nfc_tag_format_ndef(nfc_tag_h tag , unsigned char * key, int key_size , nfc_
 		return NFC_ERROR_NOT_ACTIVATED;
 	}
 
+	if( !((_nfc_tag_session_s *)tag)->attached )
+		return _return_no_device(__func__);
+
 	data_s key_data = { key, key_size };
 	int ret=0;
 	net_nfc_target_info_s *tag_info = (net_nfc_target_info_s*)tag;
 
-	_async_callback_data * trans_data = NULL;
+	void * trans_data = NULL;
 	if( callback != NULL ){
-	 	trans_data = (_async_callback_data*)malloc( sizeof(_async_callback_data));
+		trans_data = _nfc_async_request_create((net_nfc_target_handle_h)tag_info->handle, callback, user_data, _NFC_CALLBACK_TYPE_RESULT);
 		if(trans_data == NULL )
 			return NFC_ERROR_OUT_OF_MEMORY;
-		memset(trans_data , 0 , sizeof(_async_callback_data));
-		trans_data->callback = callback;
-		trans_data->user_data = user_data;
 	}
 
 	ret = net_nfc_format_ndef( (net_nfc_target_handle_h)tag_info->handle, (data_h)&key_data, trans_data );
-	return _convert_error_code(__func__, ret);
+	if( ret != NET_NFC_OK )
+		_nfc_async_request_abort(trans_data);
+	ret = _convert_error_code(__func__, ret);
+	_nfc_counters_issued(_NFC_COUNTER_NDEF_FORMATS, 0, ret);
+	_NFC_TRACE_CALL(_NFC_TRACE_CALL_FORMAT_NDEF, tag_info->handle, 0, trans_data, NULL, 0, ret);
+	return ret;
 }
 
 
@@ -1354,23 +1567,27 @@ int nfc_mifare_authenticate_with_keyA(nfc_tag_h tag,  int sector_index, unsigned
 		return NFC_ERROR_NOT_ACTIVATED;
 	}
 
+	if( !((_nfc_tag_session_s *)tag)->attached )
+		return _return_no_device(__func__);
+
 	data_s auth_key_data = { auth_key , 6};
 	int ret = 0;
 	net_nfc_target_info_s *tag_info = (net_nfc_target_info_s*)tag;
 
-	_async_callback_data * trans_data = NULL;
+	void * trans_data = NULL;
 	if( callback != NULL ){
-	 	trans_data = (_async_callback_data*)malloc( sizeof(_async_callback_data));
+		trans_data = _nfc_async_request_create((net_nfc_target_handle_h)tag_info->handle, callback, user_data, _NFC_CALLBACK_TYPE_RESULT);
 		if(trans_data == NULL )
 			return NFC_ERROR_OUT_OF_MEMORY;
-		memset(trans_data , 0 , sizeof(_async_callback_data));
-		trans_data->callback = callback;
-		trans_data->user_data = user_data;
-		trans_data->callback_type = _NFC_CALLBACK_TYPE_RESULT;
 	}
 
 	ret = net_nfc_mifare_authenticate_with_keyA( (net_nfc_target_handle_h)tag_info->handle, sector_index, (data_h)&auth_key_data, trans_data);
-	return _convert_error_code(__func__, ret);
+	if( ret != NET_NFC_OK )
+		_nfc_async_request_abort(trans_data);
+	ret = _convert_error_code(__func__, ret);
+	_nfc_counters_issued(_NFC_COUNTER_MIFARE_OPERATIONS, 0, ret);
+	_NFC_TRACE_CALL(_NFC_TRACE_CALL_MIFARE_AUTHENTICATE_A, tag_info->handle, sector_index, trans_data, NULL, 0, ret);
+	return ret;
 }
 
 int nfc_mifare_authenticate_with_keyB(nfc_tag_h tag,  int sector_index, unsigned char * auth_key, nfc_mifare_authenticate_with_keyB_completed_cb callback, void *user_data)
@@ -1384,23 +1601,27 @@ int nfc_mifare_authenticate_with_keyB(nfc_tag_h tag,  int sector_index, unsigned
 		return NFC_ERROR_NOT_ACTIVATED;
 	}
 
+	if( !((_nfc_tag_session_s *)tag)->attached )
+		return _return_no_device(__func__);
+
 	data_s auth_key_data = { auth_key , 6};
 	int ret = 0;
-	_async_callback_data * trans_data = NULL;
+	void * trans_data = NULL;
 	net_nfc_target_info_s *tag_info = (net_nfc_target_info_s*)tag;
 
 	if( callback != NULL ){
-	 	trans_data = (_async_callback_data*)malloc( sizeof(_async_callback_data));
+		trans_data = _nfc_async_request_create((net_nfc_target_handle_h)tag_info->handle, callback, user_data, _NFC_CALLBACK_TYPE_RESULT);
 		if(trans_data == NULL )
 			return NFC_ERROR_OUT_OF_MEMORY;
-		memset(trans_data , 0 , sizeof(_async_callback_data));
-		trans_data->callback = callback;
-		trans_data->user_data = user_data;
-		trans_data->callback_type = _NFC_CALLBACK_TYPE_RESULT;
 	}
 
 	ret = net_nfc_mifare_authenticate_with_keyB( (net_nfc_target_handle_h)tag_info->handle, sector_index, (data_h)&auth_key_data, trans_data);
-	return _convert_error_code(__func__, ret);
+	if( ret != NET_NFC_OK )
+		_nfc_async_request_abort(trans_data);
+	ret = _convert_error_code(__func__, ret);
+	_nfc_counters_issued(_NFC_COUNTER_MIFARE_OPERATIONS, 0, ret);
+	_NFC_TRACE_CALL(_NFC_TRACE_CALL_MIFARE_AUTHENTICATE_B, tag_info->handle, sector_index, trans_data, NULL, 0, ret);
+	return ret;
 }
 
 int nfc_mifare_read_block(nfc_tag_h tag, int block_index, nfc_mifare_read_block_completed_cb callback, void *user_data)
@@ -1414,31 +1635,30 @@ int nfc_mifare_read_block(nfc_tag_h tag, int block_index, nfc_mifare_read_block_
 		return NFC_ERROR_NOT_ACTIVATED;
 	}
 
+	if( !((_nfc_tag_session_s *)tag)->attached )
+		return _return_no_device(__func__);
+
 	int ret = 0;
-	_async_callback_data * trans_data = NULL;
+	void * trans_data = NULL;
 	net_nfc_target_info_s *tag_info = (net_nfc_target_info_s*)tag;
 
 	if( callback != NULL ){
-	 	trans_data = (_async_callback_data*)malloc( sizeof(_async_callback_data));
+		trans_data = _nfc_async_request_create((net_nfc_target_handle_h)tag_info->handle, callback, user_data, _NFC_CALLBACK_TYPE_DATA);
 		if(trans_data == NULL )
 			return NFC_ERROR_OUT_OF_MEMORY;
-		memset(trans_data , 0 , sizeof(_async_callback_data));
-		trans_data->callback = callback;
-		trans_data->user_data = user_data;
-		trans_data->callback_type = _NFC_CALLBACK_TYPE_DATA;
 	}
 
 	ret = net_nfc_mifare_read( (net_nfc_target_handle_h)tag_info->handle, block_index, trans_data);
-	return _convert_error_code(__func__, ret);
+	if( ret != NET_NFC_OK )
+		_nfc_async_request_abort(trans_data);
+	ret = _convert_error_code(__func__, ret);
+	_nfc_counters_issued(_NFC_COUNTER_MIFARE_OPERATIONS, 0, ret);
+	_NFC_TRACE_CALL(_NFC_TRACE_CALL_MIFARE_READ, tag_info->handle, block_index, trans_data, NULL, 0, ret);
+	return ret;
 }
 
 int nfc_mifare_read_page(nfc_tag_h tag, int page_index, nfc_mifare_read_block_completed_cb callback, void *user_data)
 {
-	if(!nfc_manager_is_activated())
-	{
-		return NFC_ERROR_NOT_ACTIVATED;
-	}
-
 	return nfc_mifare_read_block(tag, page_index, callback, user_data);
 }
 
@@ -1453,23 +1673,27 @@ int nfc_mifare_write_block (nfc_tag_h tag, int block_index, unsigned char* buffe
 		return NFC_ERROR_NOT_ACTIVATED;
 	}
 
+	if( !((_nfc_tag_session_s *)tag)->attached )
+		return _return_no_device(__func__);
+
 	int ret = 0;
 	data_s block_data = { buffer , buffer_size};
-	_async_callback_data * trans_data = NULL;
+	void * trans_data = NULL;
 	net_nfc_target_info_s *tag_info = (net_nfc_target_info_s*)tag;
 
 	if( callback != NULL ){
-	 	trans_data = (_async_callback_data*)malloc( sizeof(_async_callback_data));
+		trans_data = _nfc_async_request_create((net_nfc_target_handle_h)tag_info->handle, callback, user_data, _NFC_CALLBACK_TYPE_RESULT);
 		if(trans_data == NULL )
 			return NFC_ERROR_OUT_OF_MEMORY;
-		memset(trans_data , 0 , sizeof(_async_callback_data));
-		trans_data->callback = callback;
-		trans_data->user_data = user_data;
-		trans_data->callback_type = _NFC_CALLBACK_TYPE_RESULT;
 	}
 
 	ret = net_nfc_mifare_write_block( (net_nfc_target_handle_h)tag_info->handle, block_index, (data_h)&block_data, trans_data);
-	return _convert_error_code(__func__, ret);
+	if( ret != NET_NFC_OK )
+		_nfc_async_request_abort(trans_data);
+	ret = _convert_error_code(__func__, ret);
+	_nfc_counters_issued(_NFC_COUNTER_MIFARE_OPERATIONS, buffer_size, ret);
+	_NFC_TRACE_CALL(_NFC_TRACE_CALL_MIFARE_WRITE_BLOCK, tag_info->handle, block_index, trans_data, buffer, buffer_size, ret);
+	return ret;
 }
 
 int nfc_mifare_write_page(nfc_tag_h tag, int page_index, unsigned char* buffer, int buffer_size, nfc_mifare_write_block_completed_cb callback, void* user_data)
@@ -1483,25 +1707,29 @@ int nfc_mifare_write_page(nfc_tag_h tag, int page_index, unsigned char* buffer,
 		return NFC_ERROR_NOT_ACTIVATED;
 	}
 
+	if( !((_nfc_tag_session_s *)tag)->attached )
+		return _return_no_device(__func__);
+
 	int ret = 0;
 	data_s block_data = { buffer , buffer_size};
-	_async_callback_data * trans_data = NULL;
+	void * trans_data = NULL;
 
 	net_nfc_target_info_s *tag_info = (net_nfc_target_info_s*)tag;
 
 
 	if( callback != NULL ){
-	 	trans_data = (_async_callback_data*)malloc( sizeof(_async_callback_data));
+		trans_data = _nfc_async_request_create((net_nfc_target_handle_h)tag_info->handle, callback, user_data, _NFC_CALLBACK_TYPE_RESULT);
 		if(trans_data == NULL )
 			return NFC_ERROR_OUT_OF_MEMORY;
-		memset(trans_data , 0 , sizeof(_async_callback_data));
-		trans_data->callback = callback;
-		trans_data->user_data = user_data;
-		trans_data->callback_type = _NFC_CALLBACK_TYPE_RESULT;
 	}
 
 	ret = net_nfc_mifare_write_page( (net_nfc_target_handle_h)tag_info->handle, page_index, (data_h)&block_data, trans_data);
-	return _convert_error_code(__func__, ret);
+	if( ret != NET_NFC_OK )
+		_nfc_async_request_abort(trans_data);
+	ret = _convert_error_code(__func__, ret);
+	_nfc_counters_issued(_NFC_COUNTER_MIFARE_OPERATIONS, buffer_size, ret);
+	_NFC_TRACE_CALL(_NFC_TRACE_CALL_MIFARE_WRITE_PAGE, tag_info->handle, page_index, trans_data, buffer, buffer_size, ret);
+	return ret;
 }
 
 int nfc_mifare_increment(nfc_tag_h tag, int block_index, int value, nfc_mifare_increment_completed_cb callback, void *user_data)
@@ -1515,23 +1743,26 @@ int nfc_mifare_increment(nfc_tag_h tag, int block_index, int value, nfc_mifare_i
 		return NFC_ERROR_NOT_ACTIVATED;
 	}
 
+	if( !((_nfc_tag_session_s *)tag)->attached )
+		return _return_no_device(__func__);
+
 	int ret = 0;
-	_async_callback_data * trans_data = NULL;
+	void * trans_data = NULL;
 	net_nfc_target_info_s *tag_info = (net_nfc_target_info_s*)tag;
 
 	if( callback != NULL ){
-	 	trans_data = (_async_callback_data*)malloc( sizeof(_async_callback_data));
+		trans_data = _nfc_async_request_create((net_nfc_target_handle_h)tag_info->handle, callback, user_data, _NFC_CALLBACK_TYPE_RESULT);
 		if(trans_data == NULL )
 			return NFC_ERROR_OUT_OF_MEMORY;
-		memset(trans_data , 0 , sizeof(_async_callback_data));
-		trans_data->callback = callback;
-		trans_data->user_data = user_data;
-		trans_data->callback_type = _NFC_CALLBACK_TYPE_RESULT;
 	}
 
 	ret = net_nfc_mifare_increment( (net_nfc_target_handle_h)tag_info->handle, block_index,value, trans_data);
-	return _convert_error_code(__func__, ret);
-
+	if( ret != NET_NFC_OK )
+		_nfc_async_request_abort(trans_data);
+	ret = _convert_error_code(__func__, ret);
+	_nfc_counters_issued(_NFC_COUNTER_MIFARE_OPERATIONS, 0, ret);
+	_NFC_TRACE_CALL(_NFC_TRACE_CALL_MIFARE_INCREMENT, tag_info->handle, block_index, trans_data, NULL, 0, ret);
+	return ret;
 }
 
 int nfc_mifare_decrement(nfc_tag_h tag, int block_index, int value, nfc_mifare_decrement_completed_cb callback, void *user_data)
@@ -1545,23 +1776,27 @@ int nfc_mifare_decrement(nfc_tag_h tag, int block_index, int value, nfc_mifare_d
 		return NFC_ERROR_NOT_ACTIVATED;
 	}
 
+	if( !((_nfc_tag_session_s *)tag)->attached )
+		return _return_no_device(__func__);
+
 	int ret = 0;
-	_async_callback_data * trans_data = NULL;
+	void * trans_data = NULL;
 	net_nfc_target_info_s *tag_info = (net_nfc_target_info_s*)tag;
 
 
 	if( callback != NULL ){
-	 	trans_data = (_async_callback_data*)malloc( sizeof(_async_callback_data));
+		trans_data = _nfc_async_request_create((net_nfc_target_handle_h)tag_info->handle, callback, user_data, _NFC_CALLBACK_TYPE_RESULT);
 		if(trans_data == NULL )
 			return NFC_ERROR_OUT_OF_MEMORY;
-		memset(trans_data , 0 , sizeof(_async_callback_data));
-		trans_data->callback = callback;
-		trans_data->user_data = user_data;
-		trans_data->callback_type = _NFC_CALLBACK_TYPE_RESULT;
 	}
 
 	ret = net_nfc_mifare_decrement( (net_nfc_target_handle_h)tag_info->handle, block_index,value, trans_data);
-	return _convert_error_code(__func__, ret);
+	if( ret != NET_NFC_OK )
+		_nfc_async_request_abort(trans_data);
+	ret = _convert_error_code(__func__, ret);
+	_nfc_counters_issued(_NFC_COUNTER_MIFARE_OPERATIONS, 0, ret);
+	_NFC_TRACE_CALL(_NFC_TRACE_CALL_MIFARE_DECREMENT, tag_info->handle, block_index, trans_data, NULL, 0, ret);
+	return ret;
 }
 
 int nfc_mifare_transfer(nfc_tag_h tag, int block_index, nfc_mifare_transfer_completed_cb callback, void *user_data)
@@ -1575,23 +1810,27 @@ int nfc_mifare_transfer(nfc_tag_h tag, int block_index, nfc_mifare_transfer_comp
 		return NFC_ERROR_NOT_ACTIVATED;
 	}
 
+	if( !((_nfc_tag_session_s *)tag)->attached )
+		return _return_no_device(__func__);
+
 	int ret = 0;
-	_async_callback_data * trans_data = NULL;
+	void * trans_data = NULL;
 	net_nfc_target_info_s *tag_info = (net_nfc_target_info_s*)tag;
 
 
 	if( callback != NULL ){
-	 	trans_data = (_async_callback_data*)malloc( sizeof(_async_callback_data));
+		trans_data = _nfc_async_request_create((net_nfc_target_handle_h)tag_info->handle, callback, user_data, _NFC_CALLBACK_TYPE_RESULT);
 		if(trans_data == NULL )
 			return NFC_ERROR_OUT_OF_MEMORY;
-		memset(trans_data , 0 , sizeof(_async_callback_data));
-		trans_data->callback = callback;
-		trans_data->user_data = user_data;
-		trans_data->callback_type = _NFC_CALLBACK_TYPE_RESULT;
 	}
 
 	ret = net_nfc_mifare_transfer( (net_nfc_target_handle_h)tag_info->handle, block_index, trans_data);
-	return _convert_error_code(__func__, ret);
+	if( ret != NET_NFC_OK )
+		_nfc_async_request_abort(trans_data);
+	ret = _convert_error_code(__func__, ret);
+	_nfc_counters_issued(_NFC_COUNTER_MIFARE_OPERATIONS, 0, ret);
+	_NFC_TRACE_CALL(_NFC_TRACE_CALL_MIFARE_TRANSFER, tag_info->handle, block_index, trans_data, NULL, 0, ret);
+	return ret;
 }
 
 int nfc_mifare_restore(nfc_tag_h tag, int block_index, nfc_mifare_restore_completed_cb callback, void *user_data)
@@ -1605,23 +1844,27 @@ int nfc_mifare_restore(nfc_tag_h tag, int block_index, nfc_mifare_restore_comple
 		return NFC_ERROR_NOT_ACTIVATED;
 	}
 
+	if( !((_nfc_tag_session_s *)tag)->attached )
+		return _return_no_device(__func__);
+
 
 	int ret = 0;
-	_async_callback_data * trans_data = NULL;
+	void * trans_data = NULL;
 	net_nfc_target_info_s *tag_info = (net_nfc_target_info_s*)tag;
 
 	if( callback != NULL ){
-	 	trans_data = (_async_callback_data*)malloc( sizeof(_async_callback_data));
+		trans_data = _nfc_async_request_create((net_nfc_target_handle_h)tag_info->handle, callback, user_data, _NFC_CALLBACK_TYPE_RESULT);
 		if(trans_data == NULL )
 			return NFC_ERROR_OUT_OF_MEMORY;
-		memset(trans_data , 0 , sizeof(_async_callback_data));
-		trans_data->callback = callback;
-		trans_data->user_data = user_data;
-		trans_data->callback_type = _NFC_CALLBACK_TYPE_RESULT;
 	}
 
 	ret = net_nfc_mifare_restore( (net_nfc_target_handle_h)tag_info->handle, block_index, trans_data);
-	return _convert_error_code(__func__, ret);
+	if( ret != NET_NFC_OK )
+		_nfc_async_request_abort(trans_data);
+	ret = _convert_error_code(__func__, ret);
+	_nfc_counters_issued(_NFC_COUNTER_MIFARE_OPERATIONS, 0, ret);
+	_NFC_TRACE_CALL(_NFC_TRACE_CALL_MIFARE_RESTORE, tag_info->handle, block_index, trans_data, NULL, 0, ret);
+	return ret;
 }
 
 
@@ -1638,26 +1881,21 @@ int nfc_p2p_send(nfc_p2p_target_h target , nfc_ndef_message_h message , nfc_p2p_
 	}
 
 	net_nfc_exchanger_data_h data_handle;
-	data_h rawdata;
-	net_nfc_create_rawdata_from_ndef_message(message, &rawdata);
-	ret = net_nfc_create_exchanger_data(&data_handle,  rawdata);
-	net_nfc_free_data(rawdata);
-
-
-	if( ret != 0)
-		return _convert_error_code(__func__, ret);
-
-	ret = net_nfc_send_exchanger_data(data_handle ,(net_nfc_target_handle_h)target);
-
-	if( ret != 0 ){
-		net_nfc_free_exchanger_data(data_handle);
-		return _convert_error_code(__func__, ret);
+	int size;
+	ret = _nfc_p2p_exchanger_data_create(message, &data_handle);
+	if( ret != 0){
+		ret = _convert_error_code(__func__, ret);
+		_nfc_counters_issued(_NFC_COUNTER_P2P_SENDS, 0, ret);
+		_NFC_TRACE_CALL(_NFC_TRACE_CALL_P2P_SEND, target, 0, NULL, NULL, 0, ret);
+		return ret;
 	}
 
-	g_nfc_context.on_p2p_send_completed_cb = callback;
-	g_nfc_context.on_p2p_send_completed_user_data = user_data;
-
-	return 0;
+	/* the queue takes over the data */
+	size = ((net_nfc_exchanger_data_s *)data_handle)->binary_data.length;
+	ret = _nfc_p2p_send_enqueue((net_nfc_target_handle_h)target, data_handle, callback, user_data);
+	_nfc_counters_issued(_NFC_COUNTER_P2P_SENDS, size, ret);
+	_NFC_TRACE_CALL(_NFC_TRACE_CALL_P2P_SEND, target, 0, NULL, NULL, size, ret);
+	return ret;
 }
 
 
@@ -1698,8 +1936,7 @@ int nfc_p2p_connection_handover(nfc_p2p_target_h target , nfc_ac_type_e type, nf
 		return _convert_error_code(__func__, ret);
 	}
 
-	g_nfc_context.on_p2p_connection_handover_completed_cb = callback;
-	g_nfc_context.on_p2p_connection_handover_completed_user_data = user_data;
+	_nfc_callback_set(&g_nfc_context.on_p2p_connection_handover_completed, callback, user_data);
 
 	return 0;
 }
@@ -1728,9 +1965,7 @@ int nfc_p2p_set_data_received_cb(nfc_p2p_target_h target, nfc_p2p_data_recived_c
 	if(g_nfc_context.current_target != target )
 		return _return_invalid_param(__func__);
 
-	g_nfc_context.on_p2p_recv_cb = callback;
-	g_nfc_context.on_p2p_recv_user_data = user_data;
-	return 0;
+	return _nfc_callback_set(&g_nfc_context.on_p2p_recv, callback, user_data);
 }
 
 int nfc_p2p_unset_data_received_cb(nfc_p2p_target_h target){
@@ -1741,8 +1976,28 @@ int nfc_p2p_unset_data_received_cb(nfc_p2p_target_h target){
 	if(g_nfc_context.current_target != target )
 		return _return_invalid_param(__func__);
 
-	g_nfc_context.on_p2p_recv_cb = NULL;
-	g_nfc_context.on_p2p_recv_user_data = NULL;
+	_nfc_callback_set(&g_nfc_context.on_p2p_recv, NULL, NULL);
+	return 0;
+}
+
+int nfc_p2p_set_message_view_received_cb(nfc_p2p_target_h target, nfc_p2p_message_view_received_cb callback, void *user_data){
+	if( target == NULL || callback == NULL )
+		return _return_invalid_param(__func__);
+
+	if(g_nfc_context.current_target != target )
+		return _return_invalid_param(__func__);
+
+	return _nfc_callback_set(&g_nfc_context.on_p2p_recv_view, callback, user_data);
+}
+
+int nfc_p2p_unset_message_view_received_cb(nfc_p2p_target_h target){
+	if( target == NULL )
+		return _return_invalid_param(__func__);
+
+	if(g_nfc_context.current_target != target )
+		return _return_invalid_param(__func__);
+
+	_nfc_callback_set(&g_nfc_context.on_p2p_recv_view, NULL, NULL);
 	return 0;
 }
 
@@ -1752,14 +2007,11 @@ int nfc_p2p_unset_data_received_cb(nfc_p2p_target_h target){
 int nfc_manager_set_p2p_target_discovered_cb( nfc_p2p_target_discovered_cb callback , void *user_data){
 	if( callback == NULL )
 		return _return_invalid_param(__func__);
-	g_nfc_context.on_p2p_discovered_cb = callback;
-	g_nfc_context.on_p2p_discovered_user_data = user_data;
-	return 0;
+	return _nfc_callback_set(&g_nfc_context.on_p2p_discovered, callback, user_data);
 }
 
 void nfc_manager_unset_p2p_target_discovered_cb( void ){
-	g_nfc_context.on_p2p_discovered_cb = NULL;
-	g_nfc_context.on_p2p_discovered_user_data = NULL;
+	_nfc_callback_set(&g_nfc_context.on_p2p_discovered, NULL, NULL);
 }
 
 
@@ -1767,25 +2019,19 @@ void nfc_manager_unset_p2p_target_discovered_cb( void ){
 int nfc_manager_set_se_event_cb(nfc_se_event_cb callback, void *user_data){
 	if( callback == NULL )
 		return _return_invalid_param(__func__);
-	g_nfc_context.on_se_event_cb = callback;
-	g_nfc_context.on_se_event_user_data = user_data;
-	return 0;
+	return _nfc_callback_set(&g_nfc_context.on_se_event, callback, user_data);
 }
 
 void nfc_manager_unset_se_event_cb(void){
-	g_nfc_context.on_se_event_cb = NULL;
-	g_nfc_context.on_se_event_user_data = NULL;
+	_nfc_callback_set(&g_nfc_context.on_se_event, NULL, NULL);
 }
 
 int nfc_manager_set_se_transaction_event_cb(nfc_se_transaction_event_cb callback, void *user_data){
 	if( callback == NULL )
 		return _return_invalid_param(__func__);
-	g_nfc_context.on_se_transaction_event_cb = callback;
-	g_nfc_context.on_se_transaction_event_user_data = user_data;
-	return 0;
+	return _nfc_callback_set(&g_nfc_context.on_se_transaction_event, callback, user_data);
 }
 
 void nfc_manager_unset_se_transaction_event_cb(void){
-	g_nfc_context.on_se_transaction_event_cb = NULL;
-	g_nfc_context.on_se_transaction_event_user_data = NULL;
+	_nfc_callback_set(&g_nfc_context.on_se_transaction_event, NULL, NULL);
 }
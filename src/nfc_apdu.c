@@ -0,0 +1,261 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <nfc.h>
+#include <nfc_private.h>
+
+/*
+ * APDU scripts.
+ *
+ * A job sends its commands one at a time through nfc_tag_transceive(),
+ * each from the completion of the previous one, since the continuation
+ * rules depend on the last status word. Exactly one command is in flight,
+ * so the job needs no lock: issuing the next command is the last thing a
+ * completion does with it.
+ *
+ * Responses are appended to one growing buffer, each behind a two byte
+ * size which is filled in once its last GET RESPONSE has arrived.
+ *
+ * The commands are the steps of a pending job, so the whole script is
+ * cancelled with one id, see nfc_pending.c.
+ */
+
+#define _NFC_APDU_SIZE_PREFIX		2
+#define _NFC_APDU_STATUS_SIZE		2
+#define _NFC_APDU_MAX_RESPONSE_SIZE	0xffff
+#define _NFC_APDU_MAX_GET_RESPONSE	256	/* guards against a card which never stops answering 61xx */
+#define _NFC_APDU_RULES		(NFC_TAG_APDU_RULE_STOP_ON_ERROR | NFC_TAG_APDU_RULE_FOLLOW_GET_RESPONSE)
+
+typedef struct {
+	_nfc_pending_job_s pending;
+	nfc_tag_h tag;
+	int rules;
+
+	nfc_tag_apdu_s *commands;	/* point into the same allocation as the job */
+	int command_count;
+	int current;
+	int get_response_count;
+	unsigned char get_response[5];
+
+	unsigned char *responses;
+	int responses_size;
+	int responses_capacity;
+	int response_start;	/* offset of the size of the response being collected */
+	int response_count;
+
+	nfc_tag_transceive_batch_completed_cb callback;
+	void *user_data;
+} _nfc_apdu_job_s;
+
+static void _nfc_apdu_on_response(nfc_error_e result, unsigned char *buffer, int buffer_size, void *user_data);
+
+static void _nfc_apdu_job_complete(_nfc_apdu_job_s *job, int result)
+{
+	/* a response cut short by the failure is not delivered */
+	if( result != NFC_ERROR_NONE )
+		job->responses_size = job->response_start;
+
+	job->callback(result, job->response_count, job->responses, job->responses_size, job->user_data);
+
+	_nfc_pending_job_end(&job->pending);
+	nfc_tag_release(job->tag);
+	free(job->responses);
+	free(job);
+}
+
+static bool _nfc_apdu_job_append(_nfc_apdu_job_s *job, const unsigned char *data, int size)
+{
+	unsigned char *responses;
+	int capacity = job->responses_capacity;
+
+	if( job->responses_size + size > capacity ){
+		if( capacity == 0 )
+			capacity = 256;
+		while( capacity < job->responses_size + size )
+			capacity *= 2;
+
+		responses = (unsigned char *)realloc(job->responses, capacity);
+		if( responses == NULL )
+			return false;
+
+		job->responses = responses;
+		job->responses_capacity = capacity;
+	}
+
+	memcpy(job->responses + job->responses_size, data, size);
+	job->responses_size += size;
+	return true;
+}
+
+static int _nfc_apdu_job_transceive(_nfc_apdu_job_s *job, const unsigned char *command, int command_size)
+{
+	int ret;
+
+	if( job->pending.cancelled )
+		return NFC_ERROR_OPERATION_FAILED;
+
+	_nfc_pending_job_enter(&job->pending);
+	ret = nfc_tag_transceive(job->tag, (unsigned char *)command, command_size, _nfc_apdu_on_response, job);
+	_nfc_pending_job_leave();
+
+	return ret;
+}
+
+static int _nfc_apdu_job_issue(_nfc_apdu_job_s *job)
+{
+	nfc_tag_apdu_s *command = &job->commands[job->current];
+	unsigned char prefix[_NFC_APDU_SIZE_PREFIX] = { 0, 0 };
+
+	job->response_start = job->responses_size;
+	job->get_response_count = 0;
+	if( !_nfc_apdu_job_append(job, prefix, sizeof(prefix)) )
+		return NFC_ERROR_OUT_OF_MEMORY;
+
+	return _nfc_apdu_job_transceive(job, command->command, command->command_size);
+}
+
+/* 61xx: xx more bytes are waiting, on the logical channel of the command */
+static int _nfc_apdu_job_get_response(_nfc_apdu_job_s *job, unsigned char length)
+{
+	job->get_response[0] = job->commands[job->current].command[0] & 0x03;
+	job->get_response[1] = 0xc0;
+	job->get_response[2] = 0x00;
+	job->get_response[3] = 0x00;
+	job->get_response[4] = length;
+	job->get_response_count++;
+
+	return _nfc_apdu_job_transceive(job, job->get_response, sizeof(job->get_response));
+}
+
+static void _nfc_apdu_on_response(nfc_error_e result, unsigned char *buffer, int buffer_size, void *user_data)
+{
+	_nfc_apdu_job_s *job = (_nfc_apdu_job_s *)user_data;
+	unsigned char sw1, sw2;
+	int size;
+
+	if( result != NFC_ERROR_NONE ){
+		_nfc_apdu_job_complete(job, result);
+		return;
+	}
+
+	if( buffer == NULL || buffer_size < _NFC_APDU_STATUS_SIZE ){
+		NFC_LOGE("[%s] response without a status word (0x%08x)", __func__, NFC_ERROR_OPERATION_FAILED);
+		_nfc_apdu_job_complete(job, NFC_ERROR_OPERATION_FAILED);
+		return;
+	}
+
+	sw1 = buffer[buffer_size - 2];
+	sw2 = buffer[buffer_size - 1];
+
+	if( (job->rules & NFC_TAG_APDU_RULE_FOLLOW_GET_RESPONSE) && sw1 == 0x61
+			&& job->get_response_count < _NFC_APDU_MAX_GET_RESPONSE ){
+		if( !_nfc_apdu_job_append(job, buffer, buffer_size - _NFC_APDU_STATUS_SIZE) ){
+			_nfc_apdu_job_complete(job, NFC_ERROR_OUT_OF_MEMORY);
+			return;
+		}
+
+		result = _nfc_apdu_job_get_response(job, sw2);
+		if( result != NFC_ERROR_NONE )
+			_nfc_apdu_job_complete(job, result);
+		return;
+	}
+
+	if( !_nfc_apdu_job_append(job, buffer, buffer_size) ){
+		_nfc_apdu_job_complete(job, NFC_ERROR_OUT_OF_MEMORY);
+		return;
+	}
+
+	size = job->responses_size - job->response_start - _NFC_APDU_SIZE_PREFIX;
+	if( size > _NFC_APDU_MAX_RESPONSE_SIZE ){
+		_nfc_apdu_job_complete(job, NFC_ERROR_OPERATION_FAILED);
+		return;
+	}
+	job->responses[job->response_start] = (size >> 8) & 0xff;
+	job->responses[job->response_start + 1] = size & 0xff;
+	job->response_count++;
+	job->current++;
+
+	if( job->current == job->command_count
+			|| ((job->rules & NFC_TAG_APDU_RULE_STOP_ON_ERROR) && !(sw1 == 0x90 && sw2 == 0x00)) ){
+		_nfc_apdu_job_complete(job, NFC_ERROR_NONE);
+		return;
+	}
+
+	result = _nfc_apdu_job_issue(job);
+	if( result != NFC_ERROR_NONE )
+		_nfc_apdu_job_complete(job, result);
+}
+
+int nfc_tag_transceive_batch(nfc_tag_h tag, const nfc_tag_apdu_s *commands, int command_count, int rules, nfc_tag_transceive_batch_completed_cb callback, void *user_data)
+{
+	_nfc_apdu_job_s *job;
+	unsigned char *bytes;
+	size_t size = 0;
+	int i, ret;
+
+	if( tag == NULL || commands == NULL || command_count <= 0 || callback == NULL || (rules & ~_NFC_APDU_RULES) != 0 ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	for( i = 0; i < command_count; i++ ){
+		if( commands[i].command == NULL || commands[i].command_size <= 0 ){
+			NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+			return NFC_ERROR_INVALID_PARAMETER;
+		}
+		size += commands[i].command_size;
+	}
+
+	if( !nfc_manager_is_activated() )
+		return NFC_ERROR_NOT_ACTIVATED;
+
+	/* the job, its command table and the command bytes in one block */
+	job = (_nfc_apdu_job_s *)calloc(1, sizeof(_nfc_apdu_job_s) + command_count * sizeof(nfc_tag_apdu_s) + size);
+	if( job == NULL ){
+		NFC_LOGE("[%s] OUT_OF_MEMORY (0x%08x)", __func__, NFC_ERROR_OUT_OF_MEMORY);
+		return NFC_ERROR_OUT_OF_MEMORY;
+	}
+
+	job->commands = (nfc_tag_apdu_s *)(job + 1);
+	bytes = (unsigned char *)(job->commands + command_count);
+	for( i = 0; i < command_count; i++ ){
+		memcpy(bytes, commands[i].command, commands[i].command_size);
+		job->commands[i].command = bytes;
+		job->commands[i].command_size = commands[i].command_size;
+		bytes += commands[i].command_size;
+	}
+
+	job->tag = tag;
+	job->rules = rules;
+	job->command_count = command_count;
+	job->callback = callback;
+	job->user_data = user_data;
+
+	nfc_tag_retain(tag);
+	_nfc_pending_job_begin(&job->pending);
+
+	ret = _nfc_apdu_job_issue(job);
+	if( ret != NFC_ERROR_NONE ){
+		_nfc_pending_job_end(&job->pending);
+		nfc_tag_release(tag);
+		free(job->responses);
+		free(job);
+	}
+
+	return ret;
+}
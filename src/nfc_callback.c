@@ -0,0 +1,203 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <sched.h>
+#include <pthread.h>
+#include <nfc.h>
+#include <nfc_private.h>
+
+/*
+ * Application callbacks are published as immutable callback/user data
+ * pairs, replaced with one atomic pointer swap. Event dispatch reads them
+ * inside a read section and never takes a lock.
+ *
+ * A replaced pair is retired and freed once no read section which could
+ * have seen it is left. Read sections register in one of two counters
+ * selected by the parity of a global epoch; the epoch only advances when
+ * the counter of the previous epoch has drained, so a pair retired at
+ * epoch E is unreachable once the epoch reaches E + 2. Reclamation never
+ * waits: it advances what it can and leaves the rest for a later call,
+ * which keeps it safe to replace a callback from inside that callback.
+ */
+
+#define _NFC_CALLBACK_CACHE_LINE	64
+
+typedef struct {
+	volatile int count;
+	char padding[_NFC_CALLBACK_CACHE_LINE - sizeof(int)];
+} _nfc_callback_readers_s;
+
+static _nfc_callback_readers_s g_nfc_callback_readers[2] __attribute__((aligned(_NFC_CALLBACK_CACHE_LINE)));
+static volatile unsigned int g_nfc_callback_epoch;
+static _nfc_callback_s * volatile g_nfc_callback_retired;
+static pthread_mutex_t g_nfc_callback_reclaim_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread int g_nfc_callback_read_depth;
+
+unsigned int _nfc_callback_read_lock(void)
+{
+	unsigned int epoch;
+
+	for( ;; ){
+		epoch = g_nfc_callback_epoch;
+		__sync_fetch_and_add(&g_nfc_callback_readers[epoch & 1].count, 1);
+
+		/* the epoch moved before the count was visible, register again */
+		if( epoch == g_nfc_callback_epoch ){
+			g_nfc_callback_read_depth++;
+			return epoch;
+		}
+
+		__sync_fetch_and_sub(&g_nfc_callback_readers[epoch & 1].count, 1);
+	}
+}
+
+/* __sync_lock_test_and_set() is only an acquire barrier, publishing needs a full one */
+static _nfc_callback_s * _nfc_callback_exchange(_nfc_callback_s * volatile *cell, _nfc_callback_s *node)
+{
+	_nfc_callback_s *old;
+
+	do {
+		old = *cell;
+	} while( !__sync_bool_compare_and_swap(cell, old, node) );
+
+	return old;
+}
+
+static void _nfc_callback_push_retired(_nfc_callback_s *node)
+{
+	_nfc_callback_s *head;
+
+	do {
+		head = g_nfc_callback_retired;
+		node->retire_next = head;
+	} while( !__sync_bool_compare_and_swap(&g_nfc_callback_retired, head, node) );
+}
+
+static void _nfc_callback_reclaim(void)
+{
+	_nfc_callback_s *node;
+	_nfc_callback_s *next;
+	unsigned int epoch;
+	int i;
+
+	if( pthread_mutex_trylock(&g_nfc_callback_reclaim_lock) != 0 )
+		return;
+
+	for( i = 0; i < 2; i++ ){
+		epoch = g_nfc_callback_epoch;
+		if( g_nfc_callback_readers[(epoch + 1) & 1].count != 0 )
+			break;
+		__sync_fetch_and_add(&g_nfc_callback_epoch, 1);
+	}
+	epoch = g_nfc_callback_epoch;
+
+	node = _nfc_callback_exchange(&g_nfc_callback_retired, NULL);
+	for( ; node != NULL; node = next ){
+		next = node->retire_next;
+		if( epoch - node->retire_epoch >= 2 )
+			free(node);
+		else
+			_nfc_callback_push_retired(node);
+	}
+
+	pthread_mutex_unlock(&g_nfc_callback_reclaim_lock);
+}
+
+void _nfc_callback_read_unlock(unsigned int epoch)
+{
+	g_nfc_callback_read_depth--;
+	__sync_fetch_and_sub(&g_nfc_callback_readers[epoch & 1].count, 1);
+
+	if( g_nfc_callback_retired != NULL )
+		_nfc_callback_reclaim();
+}
+
+bool _nfc_callback_in_read_section(void)
+{
+	return g_nfc_callback_read_depth > 0;
+}
+
+/*
+ * Waits until every read section entered before the call has been left.
+ * Must not be called from inside a read section.
+ */
+void _nfc_callback_synchronize(void)
+{
+	int i;
+
+	pthread_mutex_lock(&g_nfc_callback_reclaim_lock);
+	for( i = 0; i < 2; i++ ){
+		while( g_nfc_callback_readers[(g_nfc_callback_epoch + 1) & 1].count != 0 )
+			sched_yield();
+		__sync_fetch_and_add(&g_nfc_callback_epoch, 1);
+	}
+	pthread_mutex_unlock(&g_nfc_callback_reclaim_lock);
+}
+
+static void _nfc_callback_retire(_nfc_callback_s *node)
+{
+	if( node == NULL )
+		return;
+
+	/* read after the node was unpublished, the exchange is a full barrier */
+	node->retire_epoch = g_nfc_callback_epoch;
+	_nfc_callback_push_retired(node);
+	_nfc_callback_reclaim();
+}
+
+int _nfc_callback_set(_nfc_callback_cell *slot, void *callback, void *user_data)
+{
+	_nfc_callback_s *node = NULL;
+
+	if( callback != NULL ){
+		node = (_nfc_callback_s *)malloc(sizeof(_nfc_callback_s));
+		if( node == NULL ){
+			NFC_LOGE("[%s] OUT_OF_MEMORY (0x%08x)", __func__, NFC_ERROR_OUT_OF_MEMORY);
+			return NFC_ERROR_OUT_OF_MEMORY;
+		}
+		node->callback = callback;
+		node->user_data = user_data;
+		node->retire_next = NULL;
+	}
+
+	_nfc_callback_retire(_nfc_callback_exchange(slot, node));
+	return NFC_ERROR_NONE;
+}
+
+bool _nfc_callback_take(_nfc_callback_cell *slot, void **callback, void **user_data)
+{
+	_nfc_callback_s *node;
+
+	if( *slot == NULL )
+		return false;
+
+	node = _nfc_callback_exchange(slot, NULL);
+	if( node == NULL )
+		return false;
+
+	*callback = node->callback;
+	*user_data = node->user_data;
+	_nfc_callback_retire(node);
+
+	return true;
+}
+
+/* only valid inside a read section, the pair may be retired right after the load */
+const _nfc_callback_s * _nfc_callback_get(_nfc_callback_cell *slot)
+{
+	return *slot;
+}
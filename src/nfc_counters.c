@@ -0,0 +1,197 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <nfc.h>
+#include <nfc_private.h>
+
+/*
+ * Operation counters.
+ *
+ * Every thread counts into a slot of its own, aligned and padded to a
+ * cache line so that threads never share one. Only the owner writes a
+ * slot, so a count is a relaxed load and store rather than a locked add;
+ * they are atomic all the same so that a reader never sees half of a 64
+ * bit value on a 32 bit target. Readers add up the slots.
+ *
+ * A slot outlives its thread: it goes back to the list and the next new
+ * thread takes it over, so its counts are kept and the list only grows
+ * with the number of concurrent threads.
+ *
+ * Reset keeps the sums read at that time as a base, the counters
+ * themselves are never cleared.
+ */
+
+#define _NFC_COUNTERS_CACHE_LINE	64
+
+__thread _nfc_counters_slot_s *g_nfc_counters_slot;
+
+static struct {
+	_nfc_counters_slot_s * volatile slots;
+	pthread_once_t once;
+	pthread_key_t key;
+
+	pthread_mutex_t lock;	/* the base */
+	unsigned long long base[_NFC_COUNTER_MAX];
+} g_nfc_counters = {
+	.once = PTHREAD_ONCE_INIT,
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/* the failure counters follow the order of nfc_error_e */
+static const nfc_error_e _nfc_counters_errors[NFC_COUNTERS_ERROR_COUNT] = {
+	NFC_ERROR_OUT_OF_MEMORY,
+	NFC_ERROR_OPERATION_FAILED,
+	NFC_ERROR_INVALID_PARAMETER,
+	NFC_ERROR_INVALID_NDEF_MESSAGE,
+	NFC_ERROR_INVALID_RECORD_TYPE,
+	NFC_ERROR_TIMED_OUT,
+	NFC_ERROR_DEVICE_BUSY,
+	NFC_ERROR_NO_DEVICE,
+	NFC_ERROR_NOT_ACTIVATED,
+	NFC_ERROR_NOT_SUPPORTED,
+	NFC_ERROR_ALREADY_ACTIVATED,
+	NFC_ERROR_ALREADY_DEACTIVATED,
+	NFC_ERROR_READ_ONLY_NDEF,
+	NFC_ERROR_NO_SPACE_ON_NDEF,
+	NFC_ERROR_NO_NDEF_MESSAGE,
+	NFC_ERROR_NOT_NDEF_FORMAT,
+};
+
+static void _nfc_counters_slot_release(void *slot)
+{
+	/* a destructor running later on this thread must claim a slot again */
+	g_nfc_counters_slot = NULL;
+	__atomic_store_n(&((_nfc_counters_slot_s *)slot)->owned, 0, __ATOMIC_RELEASE);
+}
+
+static void _nfc_counters_key_create(void)
+{
+	pthread_key_create(&g_nfc_counters.key, _nfc_counters_slot_release);
+}
+
+/* the slow path of _NFC_COUNTERS_ADD(), the first count of a thread */
+_nfc_counters_slot_s * _nfc_counters_slot_claim(void)
+{
+	_nfc_counters_slot_s *slot;
+	void *memory;
+
+	pthread_once(&g_nfc_counters.once, _nfc_counters_key_create);
+
+	for( slot = __atomic_load_n(&g_nfc_counters.slots, __ATOMIC_ACQUIRE); slot != NULL; slot = slot->next ){
+		if( !__atomic_load_n(&slot->owned, __ATOMIC_RELAXED) && __sync_bool_compare_and_swap(&slot->owned, 0, 1) )
+			break;
+	}
+
+	if( slot == NULL ){
+		if( posix_memalign(&memory, _NFC_COUNTERS_CACHE_LINE, sizeof(_nfc_counters_slot_s)) != 0 )
+			return NULL;
+
+		slot = (_nfc_counters_slot_s *)memory;
+		memset(slot, 0, sizeof(*slot));
+		slot->owned = 1;
+		do {
+			slot->next = g_nfc_counters.slots;
+		} while( !__sync_bool_compare_and_swap(&g_nfc_counters.slots, slot->next, slot) );
+	}
+
+	pthread_setspecific(g_nfc_counters.key, slot);
+	g_nfc_counters_slot = slot;
+	return slot;
+}
+
+void _nfc_counters_issued(_nfc_counter_e counter, int bytes_sent, int result)
+{
+	_NFC_COUNTERS_ADD(counter, 1);
+	if( result != NFC_ERROR_NONE )
+		_nfc_counters_failed(result);
+	else if( bytes_sent > 0 )
+		_NFC_COUNTERS_ADD(_NFC_COUNTER_BYTES_SENT, bytes_sent);
+}
+
+void _nfc_counters_failed(int error)
+{
+	int i;
+
+	for( i = 0; i < NFC_COUNTERS_ERROR_COUNT - 1 && _nfc_counters_errors[i] != error; i++ )
+		;
+
+	/* codes which are not an nfc_error_e are reported as OPERATION_FAILED, like _convert_error_code() does */
+	if( _nfc_counters_errors[i] != error )
+		i = 1;
+
+	_NFC_COUNTERS_ADD(_NFC_COUNTER_FAILURES, 1);
+	_NFC_COUNTERS_ADD(_NFC_COUNTER_FAILURES + 1 + i, 1);
+}
+
+static void _nfc_counters_sum(unsigned long long *sums)
+{
+	_nfc_counters_slot_s *slot;
+	int i;
+
+	memset(sums, 0, sizeof(unsigned long long) * _NFC_COUNTER_MAX);
+
+	for( slot = __atomic_load_n(&g_nfc_counters.slots, __ATOMIC_ACQUIRE); slot != NULL; slot = slot->next ){
+		for( i = 0; i < _NFC_COUNTER_MAX; i++ )
+			sums[i] += __atomic_load_n(&slot->values[i], __ATOMIC_RELAXED);
+	}
+}
+
+int nfc_manager_get_counters(nfc_counters_s *counters)
+{
+	unsigned long long sums[_NFC_COUNTER_MAX];
+	int i;
+
+	if( counters == NULL ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	pthread_mutex_lock(&g_nfc_counters.lock);
+	_nfc_counters_sum(sums);
+	for( i = 0; i < _NFC_COUNTER_MAX; i++ )
+		sums[i] -= g_nfc_counters.base[i];
+	pthread_mutex_unlock(&g_nfc_counters.lock);
+
+	counters->transceives = sums[_NFC_COUNTER_TRANSCEIVES];
+	counters->ndef_reads = sums[_NFC_COUNTER_NDEF_READS];
+	counters->ndef_writes = sums[_NFC_COUNTER_NDEF_WRITES];
+	counters->ndef_formats = sums[_NFC_COUNTER_NDEF_FORMATS];
+	counters->mifare_operations = sums[_NFC_COUNTER_MIFARE_OPERATIONS];
+	counters->p2p_sends = sums[_NFC_COUNTER_P2P_SENDS];
+	counters->p2p_receives = sums[_NFC_COUNTER_P2P_RECEIVES];
+	counters->se_events = sums[_NFC_COUNTER_SE_EVENTS];
+	counters->bytes_sent = sums[_NFC_COUNTER_BYTES_SENT];
+	counters->bytes_received = sums[_NFC_COUNTER_BYTES_RECEIVED];
+	counters->failures = sums[_NFC_COUNTER_FAILURES];
+	for( i = 0; i < NFC_COUNTERS_ERROR_COUNT; i++ ){
+		counters->failures_by_error[i].error = _nfc_counters_errors[i];
+		counters->failures_by_error[i].count = sums[_NFC_COUNTER_FAILURES + 1 + i];
+	}
+
+	return NFC_ERROR_NONE;
+}
+
+int nfc_manager_reset_counters(void)
+{
+	pthread_mutex_lock(&g_nfc_counters.lock);
+	_nfc_counters_sum(g_nfc_counters.base);
+	pthread_mutex_unlock(&g_nfc_counters.lock);
+
+	return NFC_ERROR_NONE;
+}
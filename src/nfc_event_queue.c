@@ -0,0 +1,251 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <nfc.h>
+#include <nfc_private.h>
+
+/*
+ * Event queue for applications which poll a file descriptor instead of
+ * taking callbacks. The event thread is the single producer and the
+ * thread calling nfc_manager_drain_events() the single consumer of a ring
+ * of records; payloads are copied into a byte ring next to it, so a
+ * drained record points into the queue until the next drain releases it.
+ *
+ * The eventfd is written when a record is published while nothing is
+ * left to drain, and by the consumer when it leaves records behind: each
+ * side stores its cursor and then checks the other's, so one of them
+ * always sees the other's update and a wakeup is never lost.
+ */
+
+#define _NFC_EVENT_QUEUE_SIZE		256	/* records, a power of 2 */
+#define _NFC_EVENT_QUEUE_PAYLOAD_SIZE	(64 * 1024)
+
+typedef struct {
+	nfc_event_s event;
+	unsigned int payload_end;	/* payload tail once this record was queued */
+} _nfc_event_entry_s;
+
+typedef struct {
+	_nfc_event_entry_s entries[_NFC_EVENT_QUEUE_SIZE];
+	unsigned char payload[_NFC_EVENT_QUEUE_PAYLOAD_SIZE];
+	int fd;
+
+	/* written by the producer */
+	volatile unsigned int tail __attribute__((aligned(64)));
+	unsigned int payload_tail;
+	volatile int producing;
+	unsigned int dropped;
+
+	/* written by the consumer */
+	volatile unsigned int head __attribute__((aligned(64)));	/* records before it are released */
+	volatile unsigned int payload_head;
+	volatile unsigned int read;	/* records before it are drained */
+} _nfc_event_queue_s;
+
+static _nfc_event_queue_s * volatile g_nfc_event_queue;
+static pthread_mutex_t g_nfc_event_queue_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static bool _nfc_event_is_tag(nfc_event_type_e type)
+{
+	return type == NFC_EVENT_TYPE_TAG_DISCOVERED || type == NFC_EVENT_TYPE_TAG_DETACHED
+		|| type == NFC_EVENT_TYPE_NDEF_DISCOVERED;
+}
+
+static void _nfc_event_queue_signal(_nfc_event_queue_s *queue)
+{
+	uint64_t one = 1;
+
+	if( write(queue->fd, &one, sizeof(one)) < 0 )
+		NFC_LOGE("[%s] eventfd write failed", __func__);
+}
+
+/* reserves a contiguous span of the payload ring, NULL when it is full */
+static unsigned char * _nfc_event_queue_reserve(_nfc_event_queue_s *queue, unsigned int size, unsigned int *payload_tail)
+{
+	unsigned int tail = queue->payload_tail;
+	unsigned int offset = tail % _NFC_EVENT_QUEUE_PAYLOAD_SIZE;
+	unsigned int skip = 0;
+
+	/* a payload never wraps, the end of the ring is skipped instead */
+	if( offset + size > _NFC_EVENT_QUEUE_PAYLOAD_SIZE ){
+		skip = _NFC_EVENT_QUEUE_PAYLOAD_SIZE - offset;
+		offset = 0;
+	}
+
+	if( tail - queue->payload_head + skip + size > _NFC_EVENT_QUEUE_PAYLOAD_SIZE )
+		return NULL;
+
+	*payload_tail = tail + skip + size;
+	return queue->payload + offset;
+}
+
+void _nfc_event_queue_post(nfc_event_type_e type, int result, void *handle, int arg,
+	const unsigned char *payload, int payload_size, const unsigned char *payload2, int payload2_size)
+{
+	_nfc_event_queue_s *queue = g_nfc_event_queue;
+	_nfc_event_entry_s *entry;
+	unsigned char *data = NULL;
+	unsigned int payload_tail;
+	unsigned int tail;
+	unsigned int dropped;
+
+	if( queue == NULL )
+		return;
+
+	if( payload == NULL || payload_size < 0 )
+		payload_size = 0;
+	if( payload2 == NULL || payload2_size < 0 )
+		payload2_size = 0;
+
+	/* the daemon has one event thread, this only guards against misuse */
+	while( __sync_lock_test_and_set(&queue->producing, 1) )
+		sched_yield();
+
+	tail = queue->tail;
+	payload_tail = queue->payload_tail;
+
+	if( tail - queue->head == _NFC_EVENT_QUEUE_SIZE
+		|| (payload_size + payload2_size > 0
+			&& (data = _nfc_event_queue_reserve(queue, payload_size + payload2_size, &payload_tail)) == NULL) ){
+		dropped = ++queue->dropped;
+		__sync_lock_release(&queue->producing);
+		NFC_LOGE("[%s] queue full, event %d dropped (%u so far)", __func__, type, dropped);
+		return;
+	}
+
+	if( data != NULL ){
+		memcpy(data, payload, payload_size);
+		memcpy(data + payload_size, payload2, payload2_size);
+	}
+
+	/* the handle stays valid until the record is released */
+	if( handle != NULL && _nfc_event_is_tag(type) )
+		nfc_tag_retain((nfc_tag_h)handle);
+
+	entry = &queue->entries[tail % _NFC_EVENT_QUEUE_SIZE];
+	entry->event.type = type;
+	entry->event.result = result;
+	entry->event.handle = handle;
+	entry->event.arg = arg;
+	entry->event.payload = data;
+	entry->event.payload_size = payload_size + payload2_size;
+	entry->payload_end = payload_tail;
+
+	queue->payload_tail = payload_tail;
+	__sync_synchronize();
+	queue->tail = tail + 1;
+	__sync_synchronize();
+
+	/* the consumer had drained everything, so it may be waiting */
+	if( queue->read == tail )
+		_nfc_event_queue_signal(queue);
+
+	__sync_lock_release(&queue->producing);
+}
+
+int nfc_manager_get_event_fd(int *fd)
+{
+	_nfc_event_queue_s *queue;
+
+	if( fd == NULL ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	pthread_mutex_lock(&g_nfc_event_queue_lock);
+
+	queue = g_nfc_event_queue;
+	if( queue == NULL ){
+		queue = (_nfc_event_queue_s *)calloc(1, sizeof(_nfc_event_queue_s));
+		if( queue == NULL ){
+			pthread_mutex_unlock(&g_nfc_event_queue_lock);
+			NFC_LOGE("[%s] OUT_OF_MEMORY (0x%08x)", __func__, NFC_ERROR_OUT_OF_MEMORY);
+			return NFC_ERROR_OUT_OF_MEMORY;
+		}
+
+		queue->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if( queue->fd < 0 ){
+			pthread_mutex_unlock(&g_nfc_event_queue_lock);
+			free(queue);
+			NFC_LOGE("[%s] eventfd failed (0x%08x)", __func__, NFC_ERROR_OPERATION_FAILED);
+			return NFC_ERROR_OPERATION_FAILED;
+		}
+
+		__sync_synchronize();
+		g_nfc_event_queue = queue;
+	}
+
+	pthread_mutex_unlock(&g_nfc_event_queue_lock);
+
+	*fd = queue->fd;
+	return NFC_ERROR_NONE;
+}
+
+int nfc_manager_drain_events(nfc_event_s *events, int max, int *count)
+{
+	_nfc_event_queue_s *queue = g_nfc_event_queue;
+	_nfc_event_entry_s *entry;
+	unsigned int head, drained, tail;
+	uint64_t value;
+	int n;
+
+	if( count == NULL || max < 0 || (events == NULL && max > 0) ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	if( queue == NULL ){
+		NFC_LOGE("[%s] no event fd (0x%08x)", __func__, NFC_ERROR_OPERATION_FAILED);
+		return NFC_ERROR_OPERATION_FAILED;
+	}
+
+	/* the previous batch is done with */
+	drained = queue->read;
+	for( head = queue->head; head != drained; head++ ){
+		entry = &queue->entries[head % _NFC_EVENT_QUEUE_SIZE];
+		if( entry->event.handle != NULL && _nfc_event_is_tag(entry->event.type) )
+			_nfc_tag_session_unref((_nfc_tag_session_s *)entry->event.handle);
+		queue->payload_head = entry->payload_end;
+	}
+	__sync_synchronize();
+	queue->head = head;
+
+	if( read(queue->fd, &value, sizeof(value)) < 0 )
+		value = 0;
+
+	tail = queue->tail;
+	__sync_synchronize();
+
+	for( n = 0; n < max && drained + n != tail; n++ )
+		events[n] = queue->entries[(drained + n) % _NFC_EVENT_QUEUE_SIZE].event;
+
+	queue->read = drained + n;
+	__sync_synchronize();
+
+	/* keeps the descriptor readable for what is left */
+	if( queue->tail != drained + n )
+		_nfc_event_queue_signal(queue);
+
+	*count = n;
+	return NFC_ERROR_NONE;
+}
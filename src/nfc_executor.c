@@ -0,0 +1,381 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <net_nfc.h>
+#include <nfc.h>
+#include <nfc_private.h>
+
+/*
+ * Executor mode runs application callbacks on worker threads of the
+ * library. Every worker owns a bounded ring of closures; the closures of
+ * one tag or target (or of the SE, or of the manager) always hash to the
+ * same worker, so they run in the order the events arrived while
+ * unrelated ones run in parallel.
+ *
+ * Producers reserve a slot with the slots semaphore, so a full ring makes
+ * the delivering thread wait instead of dropping or reordering events,
+ * then claim a position with an atomic increment and publish the entry
+ * through its sequence word. The worker is the only consumer.
+ *
+ * Producers use the executor inside a callback read section, so that
+ * switching it off only has to wait for a grace period before the workers
+ * are stopped.
+ */
+
+#define _NFC_EXECUTOR_MAX_WORKERS	64
+#define _NFC_EXECUTOR_MAX_QUEUE_SIZE	65536
+
+typedef struct {
+	volatile unsigned int seq;	/* position + 1 once the entry is published */
+	_nfc_deferred_closure_s deferred;
+} _nfc_executor_entry_s;
+
+typedef struct {
+	_nfc_executor_entry_s *ring;
+	unsigned int mask;
+	volatile unsigned int tail;
+	unsigned int head;
+	sem_t items;
+	sem_t slots;
+	pthread_t thread;
+	bool started;
+} _nfc_executor_shard_s;
+
+typedef struct {
+	_nfc_executor_shard_s *shards;
+	int count;
+} _nfc_executor_s;
+
+static _nfc_executor_s * volatile g_nfc_executor;
+static pthread_mutex_t g_nfc_executor_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread bool g_nfc_executor_is_worker;
+static __thread int g_nfc_dispatch_depth;
+
+/* an NDEF message handed out by the daemon only lives during the event */
+void * _nfc_closure_ndef_message_copy(void *message)
+{
+	ndef_message_h copy = NULL;
+	data_h rawdata = NULL;
+
+	if( net_nfc_create_rawdata_from_ndef_message((ndef_message_h)message, &rawdata) != NET_NFC_OK )
+		return NULL;
+
+	if( net_nfc_create_ndef_message_from_rawdata(&copy, rawdata) != NET_NFC_OK )
+		copy = NULL;
+	net_nfc_free_data(rawdata);
+
+	return copy;
+}
+
+void _nfc_closure_ndef_message_free(void *message)
+{
+	net_nfc_free_ndef_message((ndef_message_h)message);
+}
+
+void _nfc_dispatch_enter(void)
+{
+	g_nfc_dispatch_depth++;
+}
+
+void _nfc_dispatch_leave(void)
+{
+	g_nfc_dispatch_depth--;
+}
+
+/* true on a thread which delivers events, blocking it would hold up their delivery */
+bool _nfc_is_dispatch_thread(void)
+{
+	return g_nfc_executor_is_worker || g_nfc_dispatch_depth > 0 || _nfc_callback_in_read_section() || _nfc_main_loop_is_owner();
+}
+
+static void _nfc_closure_finish(const _nfc_closure_s *closure, bool object_copied)
+{
+	if( closure->object != NULL && closure->object_free != NULL && (closure->object_copy == NULL || object_copied) )
+		closure->object_free(closure->object);
+}
+
+void _nfc_closure_run_deferred(_nfc_deferred_closure_s *deferred)
+{
+	deferred->closure.run(&deferred->closure);
+	_nfc_stats_callback_done(&deferred->stamp);
+	_nfc_closure_finish(&deferred->closure, deferred->object_copied);
+	free(deferred->copy);
+}
+
+static void _nfc_executor_sem_wait(sem_t *sem)
+{
+	while( sem_wait(sem) != 0 && errno == EINTR )
+		;
+}
+
+static void *_nfc_executor_worker(void *arg)
+{
+	_nfc_executor_shard_s *shard = (_nfc_executor_shard_s *)arg;
+	_nfc_deferred_closure_s deferred;
+	_nfc_executor_entry_s *slot;
+
+	g_nfc_executor_is_worker = true;
+
+	for( ;; ){
+		_nfc_executor_sem_wait(&shard->items);
+
+		slot = &shard->ring[shard->head & shard->mask];
+
+		/* the producer has claimed the slot but may still be filling it */
+		while( slot->seq != shard->head + 1 )
+			sched_yield();
+
+		deferred = slot->deferred;
+		__sync_synchronize();
+		slot->seq = 0;
+		shard->head++;
+		sem_post(&shard->slots);
+
+		if( deferred.closure.run == NULL )
+			break;
+
+		_nfc_closure_run_deferred(&deferred);
+	}
+
+	return NULL;
+}
+
+static void _nfc_executor_push(_nfc_executor_shard_s *shard, const _nfc_deferred_closure_s *deferred)
+{
+	_nfc_executor_entry_s *slot;
+	unsigned int pos;
+
+	_nfc_executor_sem_wait(&shard->slots);
+
+	pos = __sync_fetch_and_add(&shard->tail, 1);
+	slot = &shard->ring[pos & shard->mask];
+	slot->deferred = *deferred;
+
+	__sync_synchronize();
+	slot->seq = pos + 1;
+
+	sem_post(&shard->items);
+}
+
+/* takes the copies a deferred closure needs, false when out of memory */
+bool _nfc_closure_defer(_nfc_deferred_closure_s *deferred, const _nfc_closure_s *closure)
+{
+	unsigned char *copy = NULL;
+	int size = closure->buffer_size + closure->buffer2_size;
+
+	deferred->closure = *closure;
+	deferred->copy = NULL;
+	deferred->object_copied = false;
+	deferred->next = NULL;
+	_nfc_stats_stamp_get(&deferred->stamp);
+
+	if( size > 0 ){
+		copy = (unsigned char *)malloc(size);
+		if( copy == NULL )
+			return false;
+
+		if( closure->buffer != NULL && closure->buffer_size > 0 ){
+			memcpy(copy, closure->buffer, closure->buffer_size);
+			deferred->closure.buffer = copy;
+		}
+		if( closure->buffer2 != NULL && closure->buffer2_size > 0 ){
+			memcpy(copy + closure->buffer_size, closure->buffer2, closure->buffer2_size);
+			deferred->closure.buffer2 = copy + closure->buffer_size;
+		}
+	}
+
+	if( closure->object_copy != NULL && closure->object != NULL ){
+		deferred->closure.object = closure->object_copy(closure->object);
+		if( deferred->closure.object == NULL ){
+			free(copy);
+			return false;
+		}
+		deferred->object_copied = true;
+	}
+
+	deferred->copy = copy;
+	return true;
+}
+
+static _nfc_executor_shard_s * _nfc_executor_shard(_nfc_executor_s *executor, const void *key)
+{
+	uintptr_t hash = (uintptr_t)key;
+
+	hash ^= hash >> 16;
+	hash *= 0x45d9f3b;
+	hash ^= hash >> 16;
+
+	return &executor->shards[hash % executor->count];
+}
+
+void _nfc_executor_dispatch(const void *key, const _nfc_closure_s *closure)
+{
+	_nfc_deferred_closure_s deferred_closure;
+	_nfc_executor_s *executor;
+	unsigned int epoch;
+	bool deferred = false;
+
+	if( (g_nfc_executor == NULL && !_nfc_main_loop_is_attached()) || g_nfc_executor_is_worker ){
+		closure->run(closure);
+		_nfc_stats_callback_done(NULL);
+		_nfc_closure_finish(closure, false);
+		return;
+	}
+
+	epoch = _nfc_callback_read_lock();
+
+	/* an attached main context takes precedence over the workers */
+	if( _nfc_main_loop_dispatch(closure) ){
+		deferred = true;
+	}
+	else if( (executor = g_nfc_executor) != NULL ){
+		if( _nfc_closure_defer(&deferred_closure, closure) ){
+			_nfc_executor_push(_nfc_executor_shard(executor, key), &deferred_closure);
+			deferred = true;
+		}
+		else {
+			NFC_LOGE("[%s] OUT_OF_MEMORY (0x%08x), callback runs on the event thread", __func__, NFC_ERROR_OUT_OF_MEMORY);
+		}
+	}
+
+	_nfc_callback_read_unlock(epoch);
+
+	if( deferred )
+		return;
+
+	closure->run(closure);
+	_nfc_stats_callback_done(NULL);
+	_nfc_closure_finish(closure, false);
+}
+
+static void _nfc_executor_destroy(_nfc_executor_s *executor)
+{
+	_nfc_deferred_closure_s stop;
+	int i;
+
+	memset(&stop, 0, sizeof(stop));
+
+	/* the stop entry queues behind the callbacks already deferred */
+	for( i = 0; i < executor->count; i++ ){
+		if( executor->shards[i].started )
+			_nfc_executor_push(&executor->shards[i], &stop);
+	}
+
+	for( i = 0; i < executor->count; i++ ){
+		_nfc_executor_shard_s *shard = &executor->shards[i];
+
+		if( shard->started )
+			pthread_join(shard->thread, NULL);
+		if( shard->ring != NULL ){
+			sem_destroy(&shard->items);
+			sem_destroy(&shard->slots);
+		}
+		free(shard->ring);
+	}
+
+	free(executor->shards);
+	free(executor);
+}
+
+static _nfc_executor_s * _nfc_executor_create(int worker_count, int queue_size)
+{
+	_nfc_executor_s *executor;
+	unsigned int capacity = 1;
+	int i;
+
+	while( capacity < (unsigned int)queue_size )
+		capacity <<= 1;
+
+	executor = (_nfc_executor_s *)calloc(1, sizeof(_nfc_executor_s));
+	if( executor == NULL )
+		return NULL;
+
+	executor->shards = (_nfc_executor_shard_s *)calloc(worker_count, sizeof(_nfc_executor_shard_s));
+	if( executor->shards == NULL ){
+		free(executor);
+		return NULL;
+	}
+	executor->count = worker_count;
+
+	for( i = 0; i < worker_count; i++ ){
+		_nfc_executor_shard_s *shard = &executor->shards[i];
+
+		shard->ring = (_nfc_executor_entry_s *)calloc(capacity, sizeof(_nfc_executor_entry_s));
+		if( shard->ring == NULL )
+			break;
+		shard->mask = capacity - 1;
+		sem_init(&shard->items, 0, 0);
+		sem_init(&shard->slots, 0, capacity);
+
+		if( pthread_create(&shard->thread, NULL, _nfc_executor_worker, shard) != 0 )
+			break;
+		shard->started = true;
+	}
+
+	if( i < worker_count ){
+		_nfc_executor_destroy(executor);
+		return NULL;
+	}
+
+	return executor;
+}
+
+int nfc_manager_set_callback_executor(int worker_count, int queue_size)
+{
+	_nfc_executor_s *executor = NULL;
+	_nfc_executor_s *old;
+
+	if( worker_count < 0 || worker_count > _NFC_EXECUTOR_MAX_WORKERS
+		|| (worker_count > 0 && (queue_size <= 0 || queue_size > _NFC_EXECUTOR_MAX_QUEUE_SIZE)) ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	/* waiting for the workers from a callback would never return */
+	if( g_nfc_executor_is_worker || _nfc_callback_in_read_section() ){
+		NFC_LOGE("[%s] called from a callback (0x%08x)", __func__, NFC_ERROR_OPERATION_FAILED);
+		return NFC_ERROR_OPERATION_FAILED;
+	}
+
+	if( worker_count > 0 ){
+		executor = _nfc_executor_create(worker_count, queue_size);
+		if( executor == NULL ){
+			NFC_LOGE("[%s] OUT_OF_MEMORY (0x%08x)", __func__, NFC_ERROR_OUT_OF_MEMORY);
+			return NFC_ERROR_OUT_OF_MEMORY;
+		}
+	}
+
+	pthread_mutex_lock(&g_nfc_executor_lock);
+	do {
+		old = g_nfc_executor;
+	} while( !__sync_bool_compare_and_swap(&g_nfc_executor, old, executor) );
+
+	if( old != NULL ){
+		/* no producer still holds the old executor, then drain it */
+		_nfc_callback_synchronize();
+		_nfc_executor_destroy(old);
+	}
+	pthread_mutex_unlock(&g_nfc_executor_lock);
+
+	return NFC_ERROR_NONE;
+}
@@ -0,0 +1,226 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <dlog.h>
+#include <nfc.h>
+#include <nfc_private.h>
+
+#ifdef LOG_TAG
+#undef LOG_TAG
+#endif
+#define LOG_TAG "TIZEN_N_NFC"
+
+/*
+ * Rate limiting is a token bucket per log statement, kept as the time at
+ * which the bucket would be full again (GCRA) so that it fits one 32 bit
+ * word and is updated with a single compare-and-swap. A statement may
+ * burst _NFC_LOG_BURST lines and then sustain _NFC_LOG_RATE lines per
+ * second.
+ *
+ * The log buffer is a ring of fixed size lines. Writers claim a position
+ * with an atomic increment and own the slot while its sequence word holds
+ * _NFC_LOG_SLOT_BUSY; a line whose slot is still being written by a
+ * lapping writer is dropped rather than waited for. Readers check the
+ * sequence word before and after copying a line.
+ */
+
+#define _NFC_LOG_RATE		10
+#define _NFC_LOG_BURST		20
+#define _NFC_LOG_INTERVAL_MS	(1000 / _NFC_LOG_RATE)
+#define _NFC_LOG_TOLERANCE_MS	((_NFC_LOG_BURST - 1) * _NFC_LOG_INTERVAL_MS)
+
+#define _NFC_LOG_LINE_SIZE	192
+#define _NFC_LOG_RING_SIZE	256	/* power of two */
+#define _NFC_LOG_SLOT_BUSY	0xffffffffU
+
+typedef struct {
+	volatile unsigned int seq;	/* position + 1 of the line held, 0 when empty */
+	int level;
+	unsigned long long timestamp_ms;
+	char text[_NFC_LOG_LINE_SIZE];
+} _nfc_log_line_s;
+
+static int g_nfc_log_level = NFC_LOG_LEVEL_ERROR;
+static int g_nfc_log_buffer_level = NFC_LOG_LEVEL_NONE;
+int g_nfc_log_threshold = NFC_LOG_LEVEL_ERROR;
+
+static _nfc_log_line_s g_nfc_log_ring[_NFC_LOG_RING_SIZE];
+static volatile unsigned int g_nfc_log_ring_head;
+
+static unsigned long long _nfc_log_now_ms(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+static bool _nfc_log_site_allow(_nfc_log_site_s *site, unsigned int now)
+{
+	unsigned int old_tat, tat;
+
+	do {
+		old_tat = site->tat;
+		tat = old_tat;
+		if( tat == 0 || (int)(now - tat) > 0 )
+			tat = now;
+		if( (int)(tat - now) > _NFC_LOG_TOLERANCE_MS ){
+			__sync_fetch_and_add(&site->suppressed, 1);
+			return false;
+		}
+	} while( !__sync_bool_compare_and_swap(&site->tat, old_tat, tat + _NFC_LOG_INTERVAL_MS) );
+
+	return true;
+}
+
+static void _nfc_log_ring_append(int level, unsigned long long timestamp_ms, const char *text)
+{
+	unsigned int pos = __sync_fetch_and_add(&g_nfc_log_ring_head, 1);
+	_nfc_log_line_s *line = &g_nfc_log_ring[pos & (_NFC_LOG_RING_SIZE - 1)];
+	unsigned int seq = line->seq;
+
+	if( seq == _NFC_LOG_SLOT_BUSY || !__sync_bool_compare_and_swap(&line->seq, seq, _NFC_LOG_SLOT_BUSY) )
+		return;
+
+	line->level = level;
+	line->timestamp_ms = timestamp_ms;
+	strncpy(line->text, text, sizeof(line->text) - 1);
+	line->text[sizeof(line->text) - 1] = '\0';
+
+	__sync_synchronize();
+	line->seq = pos + 1;
+}
+
+static void _nfc_log_write_system(int level, const char *text)
+{
+	switch( level ){
+		case NFC_LOG_LEVEL_ERROR:
+			LOGE("%s", text);
+			break;
+		case NFC_LOG_LEVEL_WARN:
+			LOGW("%s", text);
+			break;
+		case NFC_LOG_LEVEL_INFO:
+			LOGI("%s", text);
+			break;
+		default:
+			LOGD("%s", text);
+			break;
+	}
+}
+
+void _nfc_log_print(_nfc_log_site_s *site, int level, const char *fmt, ...)
+{
+	char text[_NFC_LOG_LINE_SIZE];
+	unsigned long long now = _nfc_log_now_ms();
+	unsigned int suppressed = 0;
+	bool to_system = false;
+	bool to_buffer = (level <= g_nfc_log_buffer_level);
+	int len;
+	va_list ap;
+
+	if( level <= g_nfc_log_level ){
+		to_system = _nfc_log_site_allow(site, (unsigned int)now);
+		if( to_system && site->suppressed != 0 )
+			suppressed = __sync_fetch_and_and(&site->suppressed, 0);
+	}
+
+	if( !to_system && !to_buffer )
+		return;
+
+	va_start(ap, fmt);
+	len = vsnprintf(text, sizeof(text), fmt, ap);
+	va_end(ap);
+	if( len < 0 )
+		return;
+
+	if( to_buffer )
+		_nfc_log_ring_append(level, now, text);
+
+	if( to_system ){
+		if( suppressed != 0 && len < (int)sizeof(text) )
+			snprintf(text + len, sizeof(text) - len, " (%u similar lines suppressed)", suppressed);
+		_nfc_log_write_system(level, text);
+	}
+}
+
+static void _nfc_log_update_threshold(void)
+{
+	g_nfc_log_threshold = g_nfc_log_level > g_nfc_log_buffer_level ? g_nfc_log_level : g_nfc_log_buffer_level;
+}
+
+int nfc_manager_set_log_level(nfc_log_level_e level)
+{
+	if( level < NFC_LOG_LEVEL_NONE || level > NFC_LOG_LEVEL_DEBUG ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	g_nfc_log_level = level;
+	_nfc_log_update_threshold();
+	return NFC_ERROR_NONE;
+}
+
+int nfc_manager_set_log_buffer_level(nfc_log_level_e level)
+{
+	if( level < NFC_LOG_LEVEL_NONE || level > NFC_LOG_LEVEL_DEBUG ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	g_nfc_log_buffer_level = level;
+	_nfc_log_update_threshold();
+	return NFC_ERROR_NONE;
+}
+
+int nfc_manager_dump_log(nfc_log_cb callback, void *user_data)
+{
+	_nfc_log_line_s copy;
+	unsigned int head, pos, seq;
+
+	if( callback == NULL ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	head = g_nfc_log_ring_head;
+	pos = head > _NFC_LOG_RING_SIZE ? head - _NFC_LOG_RING_SIZE : 0;
+
+	for( ; pos != head; pos++ ){
+		_nfc_log_line_s *line = &g_nfc_log_ring[pos & (_NFC_LOG_RING_SIZE - 1)];
+
+		seq = line->seq;
+		if( seq != pos + 1 )
+			continue;
+
+		__sync_synchronize();
+		memcpy(&copy, line, sizeof(copy));
+		__sync_synchronize();
+
+		if( line->seq != seq )
+			continue;
+
+		if( !callback(copy.level, copy.timestamp_ms, copy.text, user_data) )
+			break;
+	}
+
+	return NFC_ERROR_NONE;
+}
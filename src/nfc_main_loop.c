@@ -0,0 +1,265 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <glib.h>
+#include <nfc.h>
+#include <nfc_private.h>
+
+/*
+ * Main loop mode delivers callbacks from a GSource attached to an
+ * application GMainContext. Closures are pushed on a lock-free list and
+ * only the push which finds the list empty writes the eventfd, so a burst
+ * of events costs one wakeup; the source then runs everything queued in
+ * one dispatch, in event order.
+ *
+ * A batch runs with the lock of its source held. Releasing the source
+ * takes the lock before it runs what is left, so the leftovers never run
+ * beside a batch or ahead of it; a callback releasing the source of its
+ * own batch leaves them to that batch instead.
+ */
+
+typedef struct _nfc_main_loop_source_s {
+	GSource source;
+	GPollFD poll;
+	GMainContext *context;	/* the context attached to, referenced */
+	_nfc_deferred_closure_s * volatile queued;	/* newest first */
+	pthread_mutex_t lock;	/* held while a batch runs */
+	bool released;
+} _nfc_main_loop_source_s;
+
+static _nfc_main_loop_source_s * volatile g_nfc_main_loop_source;
+static pthread_mutex_t g_nfc_main_loop_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread _nfc_main_loop_source_s *g_nfc_main_loop_dispatching;
+
+/* takes everything queued, oldest first */
+static _nfc_deferred_closure_s * _nfc_main_loop_take(_nfc_main_loop_source_s *source)
+{
+	_nfc_deferred_closure_s *list;
+	_nfc_deferred_closure_s *fifo = NULL;
+	_nfc_deferred_closure_s *next;
+
+	do {
+		list = source->queued;
+	} while( list != NULL && !__sync_bool_compare_and_swap(&source->queued, list, NULL) );
+
+	for( ; list != NULL; list = next ){
+		next = list->next;
+		list->next = fifo;
+		fifo = list;
+	}
+
+	return fifo;
+}
+
+static void _nfc_main_loop_run(_nfc_deferred_closure_s *list)
+{
+	_nfc_deferred_closure_s *next;
+
+	for( ; list != NULL; list = next ){
+		next = list->next;
+		_nfc_closure_run_deferred(list);
+		free(list);
+	}
+}
+
+static gboolean _nfc_main_loop_prepare(GSource *source, gint *timeout)
+{
+	*timeout = -1;
+	return ((_nfc_main_loop_source_s *)source)->queued != NULL;
+}
+
+static gboolean _nfc_main_loop_check(GSource *source)
+{
+	_nfc_main_loop_source_s *nfc_source = (_nfc_main_loop_source_s *)source;
+
+	return (nfc_source->poll.revents & G_IO_IN) || nfc_source->queued != NULL;
+}
+
+static gboolean _nfc_main_loop_dispatch_source(GSource *source, GSourceFunc callback, gpointer user_data)
+{
+	_nfc_main_loop_source_s *nfc_source = (_nfc_main_loop_source_s *)source;
+	uint64_t count;
+
+	/* reset before taking, a push racing with us then signals again */
+	if( nfc_source->poll.revents & G_IO_IN ){
+		if( read(nfc_source->poll.fd, &count, sizeof(count)) < 0 )
+			NFC_LOGD("[%s] eventfd already reset", __func__);
+	}
+
+	pthread_mutex_lock(&nfc_source->lock);
+	g_nfc_main_loop_dispatching = nfc_source;
+	_nfc_dispatch_enter();
+
+	_nfc_main_loop_run(_nfc_main_loop_take(nfc_source));
+	/* released from one of the callbacks, nothing dispatches the source again */
+	while( nfc_source->released && nfc_source->queued != NULL )
+		_nfc_main_loop_run(_nfc_main_loop_take(nfc_source));
+
+	_nfc_dispatch_leave();
+	g_nfc_main_loop_dispatching = NULL;
+	pthread_mutex_unlock(&nfc_source->lock);
+	return TRUE;
+}
+
+static void _nfc_main_loop_finalize(GSource *source)
+{
+	close(((_nfc_main_loop_source_s *)source)->poll.fd);
+	g_main_context_unref(((_nfc_main_loop_source_s *)source)->context);
+	pthread_mutex_destroy(&((_nfc_main_loop_source_s *)source)->lock);
+}
+
+static GSourceFuncs _nfc_main_loop_source_funcs = {
+	_nfc_main_loop_prepare,
+	_nfc_main_loop_check,
+	_nfc_main_loop_dispatch_source,
+	_nfc_main_loop_finalize,
+};
+
+bool _nfc_main_loop_is_attached(void)
+{
+	return g_nfc_main_loop_source != NULL;
+}
+
+/* true on the thread which owns the attached context, the one the callbacks are delivered on */
+bool _nfc_main_loop_is_owner(void)
+{
+	_nfc_main_loop_source_s *source;
+	unsigned int epoch;
+	bool owner;
+
+	/* a source is only finalized once no read section can still see it */
+	epoch = _nfc_callback_read_lock();
+	source = g_nfc_main_loop_source;
+	owner = source != NULL && g_main_context_is_owner(source->context);
+	_nfc_callback_read_unlock(epoch);
+
+	return owner;
+}
+
+/* called inside a callback read section, false when no context is attached */
+bool _nfc_main_loop_dispatch(const _nfc_closure_s *closure)
+{
+	_nfc_main_loop_source_s *source = g_nfc_main_loop_source;
+	_nfc_deferred_closure_s *deferred;
+	_nfc_deferred_closure_s *head;
+	uint64_t one = 1;
+
+	if( source == NULL )
+		return false;
+
+	deferred = (_nfc_deferred_closure_s *)malloc(sizeof(_nfc_deferred_closure_s));
+	if( deferred == NULL || !_nfc_closure_defer(deferred, closure) ){
+		NFC_LOGE("[%s] OUT_OF_MEMORY (0x%08x), callback runs on the event thread", __func__, NFC_ERROR_OUT_OF_MEMORY);
+		free(deferred);
+		return false;
+	}
+
+	do {
+		head = source->queued;
+		deferred->next = head;
+	} while( !__sync_bool_compare_and_swap(&source->queued, head, deferred) );
+
+	/* the source is already due when the list was not empty */
+	if( head == NULL && write(source->poll.fd, &one, sizeof(one)) < 0 )
+		NFC_LOGE("[%s] eventfd write failed", __func__);
+
+	return true;
+}
+
+static _nfc_main_loop_source_s * _nfc_main_loop_exchange(_nfc_main_loop_source_s *source)
+{
+	_nfc_main_loop_source_s *old;
+
+	do {
+		old = g_nfc_main_loop_source;
+	} while( !__sync_bool_compare_and_swap(&g_nfc_main_loop_source, old, source) );
+
+	return old;
+}
+
+/* stops delivering through a source which is no longer published */
+static void _nfc_main_loop_release(_nfc_main_loop_source_s *source)
+{
+	if( source == NULL )
+		return;
+
+	/* no producer still holds it, what it has queued runs after the batch in progress */
+	_nfc_callback_synchronize();
+	g_source_destroy(&source->source);
+	if( g_nfc_main_loop_dispatching == source ){
+		source->released = true;
+	}
+	else {
+		pthread_mutex_lock(&source->lock);
+		source->released = true;
+		_nfc_main_loop_run(_nfc_main_loop_take(source));
+		pthread_mutex_unlock(&source->lock);
+	}
+	g_source_unref(&source->source);
+}
+
+int nfc_manager_set_callback_main_context(GMainContext *context)
+{
+	_nfc_main_loop_source_s *source;
+	int fd;
+
+	if( _nfc_callback_in_read_section() ){
+		NFC_LOGE("[%s] called from a callback (0x%08x)", __func__, NFC_ERROR_OPERATION_FAILED);
+		return NFC_ERROR_OPERATION_FAILED;
+	}
+
+	fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if( fd < 0 ){
+		NFC_LOGE("[%s] eventfd failed (0x%08x)", __func__, NFC_ERROR_OPERATION_FAILED);
+		return NFC_ERROR_OPERATION_FAILED;
+	}
+
+	source = (_nfc_main_loop_source_s *)g_source_new(&_nfc_main_loop_source_funcs, sizeof(_nfc_main_loop_source_s));
+	source->poll.fd = fd;
+	source->poll.events = G_IO_IN;
+	source->poll.revents = 0;
+	source->context = g_main_context_ref(context != NULL ? context : g_main_context_default());
+	source->queued = NULL;
+	pthread_mutex_init(&source->lock, NULL);
+	source->released = false;
+	g_source_add_poll(&source->source, &source->poll);
+	g_source_attach(&source->source, context);
+
+	pthread_mutex_lock(&g_nfc_main_loop_lock);
+	_nfc_main_loop_release(_nfc_main_loop_exchange(source));
+	pthread_mutex_unlock(&g_nfc_main_loop_lock);
+
+	return NFC_ERROR_NONE;
+}
+
+int nfc_manager_unset_callback_main_context(void)
+{
+	if( _nfc_callback_in_read_section() ){
+		NFC_LOGE("[%s] called from a callback (0x%08x)", __func__, NFC_ERROR_OPERATION_FAILED);
+		return NFC_ERROR_OPERATION_FAILED;
+	}
+
+	pthread_mutex_lock(&g_nfc_main_loop_lock);
+	_nfc_main_loop_release(_nfc_main_loop_exchange(NULL));
+	pthread_mutex_unlock(&g_nfc_main_loop_lock);
+
+	return NFC_ERROR_NONE;
+}
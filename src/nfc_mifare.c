@@ -0,0 +1,413 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <nfc.h>
+#include <nfc_private.h>
+
+/*
+ * Sector level MIFARE classic operations.
+ *
+ * A job walks a range of sectors. For each sector it issues the
+ * authentication followed by every block command at once; the daemon
+ * executes requests in the order they were sent, so the blocks reach the
+ * card after its authentication without the library waiting for it. Up to
+ * _NFC_MIFARE_SECTOR_WINDOW sectors are in flight, which keeps the daemon
+ * busy while the completions of the previous sector are delivered. After
+ * the first failure no further sector is issued and the job completes once
+ * the outstanding commands have drained.
+ *
+ * Block commands go through the public single block functions, so they
+ * share the pending table and timeouts with them. They are the steps of a
+ * pending job, which cancels as a whole, see nfc_pending.c. The job keeps
+ * its tag retained, a detach fails the steps instead of freeing the tag.
+ */
+
+#define _NFC_MIFARE_BLOCK_SIZE		16
+#define _NFC_MIFARE_KEY_SIZE		6
+#define _NFC_MIFARE_SECTOR_COUNT_MINI	5
+#define _NFC_MIFARE_SECTOR_COUNT_1K	16
+#define _NFC_MIFARE_SECTOR_COUNT_4K	40
+#define _NFC_MIFARE_SECTOR_WINDOW	2
+
+typedef struct _nfc_mifare_job_s _nfc_mifare_job_s;
+
+typedef struct {
+	_nfc_mifare_job_s *job;
+	int sector;	/* relative to the first sector of the job */
+	int offset;	/* into the job buffer, unused for authentication */
+} _nfc_mifare_command_s;
+
+struct _nfc_mifare_job_s {
+	_nfc_pending_job_s pending;
+	pthread_mutex_t lock;
+	nfc_tag_h tag;
+	nfc_mifare_key_type_e key_type;
+	unsigned char key[_NFC_MIFARE_KEY_SIZE];
+	bool write;
+
+	int first_sector;
+	int sector_count;
+	int next_sector;	/* relative index of the next sector to issue */
+	int done_sectors;
+	int accepted;	/* commands the daemon took */
+	int error;
+
+	int *remaining;	/* outstanding commands per sector */
+	_nfc_mifare_command_s *auth_commands;
+	_nfc_mifare_command_s *block_commands;
+
+	unsigned char *buffer;
+	int buffer_size;
+
+	void *callback;
+	void *user_data;
+};
+
+static int _nfc_mifare_first_block(int sector)
+{
+	return sector < 32 ? sector * 4 : 128 + (sector - 32) * 16;
+}
+
+static int _nfc_mifare_block_count(int sector)
+{
+	return sector < 32 ? 4 : 16;
+}
+
+/* the sector trailer and the manufacturer block are never written */
+static bool _nfc_mifare_is_writable(int sector, int block)
+{
+	return block != 0 && block != _nfc_mifare_first_block(sector) + _nfc_mifare_block_count(sector) - 1;
+}
+
+static int _nfc_mifare_range_size(int first_sector, int sector_count, bool write)
+{
+	int sector, size = 0;
+
+	for( sector = first_sector; sector < first_sector + sector_count; sector++ ){
+		size += _nfc_mifare_block_count(sector) - (write ? 1 : 0);
+		if( write && sector == 0 )
+			size--;
+	}
+
+	return size * _NFC_MIFARE_BLOCK_SIZE;
+}
+
+static void _nfc_mifare_job_destroy(_nfc_mifare_job_s *job)
+{
+	if( job == NULL )
+		return;
+
+	_nfc_pending_job_end(&job->pending);
+	nfc_tag_release(job->tag);
+	pthread_mutex_destroy(&job->lock);
+	free(job->remaining);
+	free(job->auth_commands);
+	free(job->block_commands);
+	free(job->buffer);
+	free(job);
+}
+
+static _nfc_mifare_job_s *_nfc_mifare_job_create(nfc_tag_h tag, int first_sector, int sector_count, nfc_mifare_key_type_e key_type, unsigned char *auth_key, bool write)
+{
+	_nfc_mifare_job_s *job;
+	int block_count;
+
+	job = (_nfc_mifare_job_s *)calloc(1, sizeof(_nfc_mifare_job_s));
+	if( job == NULL )
+		return NULL;
+
+	pthread_mutex_init(&job->lock, NULL);
+	nfc_tag_retain(tag);
+	job->tag = tag;
+	job->key_type = key_type;
+	memcpy(job->key, auth_key, _NFC_MIFARE_KEY_SIZE);
+	job->write = write;
+	job->first_sector = first_sector;
+	job->sector_count = sector_count;
+	job->error = NFC_ERROR_NONE;
+
+	block_count = _nfc_mifare_range_size(first_sector, sector_count, false) / _NFC_MIFARE_BLOCK_SIZE;
+	job->buffer_size = _nfc_mifare_range_size(first_sector, sector_count, write);
+
+	job->remaining = (int *)calloc(sector_count, sizeof(int));
+	job->auth_commands = (_nfc_mifare_command_s *)calloc(sector_count, sizeof(_nfc_mifare_command_s));
+	job->block_commands = (_nfc_mifare_command_s *)calloc(block_count, sizeof(_nfc_mifare_command_s));
+	job->buffer = (unsigned char *)calloc(1, job->buffer_size);
+
+	if( job->remaining == NULL || job->auth_commands == NULL || job->block_commands == NULL || job->buffer == NULL ){
+		_nfc_mifare_job_destroy(job);
+		return NULL;
+	}
+
+	return job;
+}
+
+static void _nfc_mifare_on_result(nfc_error_e result, void *user_data);
+static void _nfc_mifare_on_read(nfc_error_e result, unsigned char *buffer, int buffer_size, void *user_data);
+
+static int _nfc_mifare_job_authenticate(_nfc_mifare_job_s *job, int sector, _nfc_mifare_command_s *command)
+{
+	if( job->key_type == NFC_MIFARE_KEY_B )
+		return nfc_mifare_authenticate_with_keyB(job->tag, sector, job->key, _nfc_mifare_on_result, command);
+
+	return nfc_mifare_authenticate_with_keyA(job->tag, sector, job->key, _nfc_mifare_on_result, command);
+}
+
+/* called with the job locked */
+static void _nfc_mifare_job_issue_sector(_nfc_mifare_job_s *job, int index)
+{
+	int sector = job->first_sector + index;
+	int first_block = _nfc_mifare_first_block(sector);
+	int block_base = (_nfc_mifare_first_block(sector) - _nfc_mifare_first_block(job->first_sector));
+	int offset = _nfc_mifare_range_size(job->first_sector, index, job->write);
+	_nfc_mifare_command_s *command;
+	int block, ret;
+
+	command = &job->auth_commands[index];
+	command->job = job;
+	command->sector = index;
+
+	ret = _nfc_mifare_job_authenticate(job, sector, command);
+	if( ret == NFC_ERROR_NONE ){
+		job->remaining[index]++;
+
+		for( block = first_block; block < first_block + _nfc_mifare_block_count(sector); block++ ){
+			if( job->write && !_nfc_mifare_is_writable(sector, block) )
+				continue;
+
+			command = &job->block_commands[block_base + block - first_block];
+			command->job = job;
+			command->sector = index;
+			command->offset = offset;
+
+			if( job->write )
+				ret = nfc_mifare_write_block(job->tag, block, job->buffer + offset, _NFC_MIFARE_BLOCK_SIZE, _nfc_mifare_on_result, command);
+			else
+				ret = nfc_mifare_read_block(job->tag, block, _nfc_mifare_on_read, command);
+
+			if( ret != NFC_ERROR_NONE )
+				break;
+
+			job->remaining[index]++;
+			offset += _NFC_MIFARE_BLOCK_SIZE;
+		}
+	}
+
+	job->accepted += job->remaining[index];
+
+	if( ret != NFC_ERROR_NONE && job->error == NFC_ERROR_NONE )
+		job->error = ret;
+
+	if( job->remaining[index] == 0 )
+		job->done_sectors++;
+}
+
+/* called with the job locked, returns true once nothing is left in flight */
+static bool _nfc_mifare_job_pump(_nfc_mifare_job_s *job)
+{
+	if( job->pending.cancelled && job->error == NFC_ERROR_NONE )
+		job->error = NFC_ERROR_OPERATION_FAILED;
+
+	_nfc_pending_job_enter(&job->pending);
+	while( job->error == NFC_ERROR_NONE && job->next_sector < job->sector_count
+			&& job->next_sector - job->done_sectors < _NFC_MIFARE_SECTOR_WINDOW )
+		_nfc_mifare_job_issue_sector(job, job->next_sector++);
+	_nfc_pending_job_leave();
+
+	return job->done_sectors == job->next_sector
+		&& (job->error != NFC_ERROR_NONE || job->next_sector == job->sector_count);
+}
+
+static void _nfc_mifare_job_complete(_nfc_mifare_job_s *job)
+{
+	unsigned char *buffer = job->error == NFC_ERROR_NONE ? job->buffer : NULL;
+	int buffer_size = job->error == NFC_ERROR_NONE ? job->buffer_size : 0;
+
+	if( job->callback != NULL ){
+		if( job->write ){
+			nfc_mifare_write_sector_completed_cb cb = job->callback;
+			cb(job->error, job->user_data);
+		}else{
+			/* read sector and dump callbacks share the signature */
+			nfc_mifare_read_sector_completed_cb cb = job->callback;
+			cb(job->error, buffer, buffer_size, job->user_data);
+		}
+	}
+
+	_nfc_mifare_job_destroy(job);
+}
+
+static void _nfc_mifare_command_done(_nfc_mifare_command_s *command, int result)
+{
+	_nfc_mifare_job_s *job = command->job;
+	bool finished;
+
+	pthread_mutex_lock(&job->lock);
+
+	if( result != NFC_ERROR_NONE && job->error == NFC_ERROR_NONE )
+		job->error = result;
+
+	if( --job->remaining[command->sector] == 0 )
+		job->done_sectors++;
+
+	finished = _nfc_mifare_job_pump(job);
+
+	pthread_mutex_unlock(&job->lock);
+
+	if( finished )
+		_nfc_mifare_job_complete(job);
+}
+
+static void _nfc_mifare_on_result(nfc_error_e result, void *user_data)
+{
+	_nfc_mifare_command_done((_nfc_mifare_command_s *)user_data, result);
+}
+
+static void _nfc_mifare_on_read(nfc_error_e result, unsigned char *buffer, int buffer_size, void *user_data)
+{
+	_nfc_mifare_command_s *command = (_nfc_mifare_command_s *)user_data;
+
+	if( result == NFC_ERROR_NONE ){
+		if( buffer == NULL || buffer_size < _NFC_MIFARE_BLOCK_SIZE )
+			result = NFC_ERROR_OPERATION_FAILED;
+		else
+			memcpy(command->job->buffer + command->offset, buffer, _NFC_MIFARE_BLOCK_SIZE);
+	}
+
+	_nfc_mifare_command_done(command, result);
+}
+
+static int _nfc_mifare_job_start(_nfc_mifare_job_s *job, void *callback, void *user_data)
+{
+	int accepted;
+	int ret;
+
+	job->callback = callback;
+	job->user_data = user_data;
+	_nfc_pending_job_begin(&job->pending);
+
+	/* completions wait for the lock, so the first window is fully issued before any of them runs */
+	pthread_mutex_lock(&job->lock);
+	_nfc_mifare_job_pump(job);
+	accepted = job->accepted;
+	ret = job->error;
+	pthread_mutex_unlock(&job->lock);
+
+	/* nothing reached the daemon, report it like the single block calls do */
+	if( accepted == 0 ){
+		_nfc_mifare_job_destroy(job);
+		return ret;
+	}
+
+	return NFC_ERROR_NONE;
+}
+
+static bool _nfc_mifare_is_valid_sector(int sector_index)
+{
+	return sector_index >= 0 && sector_index < _NFC_MIFARE_SECTOR_COUNT_4K;
+}
+
+static bool _nfc_mifare_is_valid_key_type(nfc_mifare_key_type_e key_type)
+{
+	return key_type == NFC_MIFARE_KEY_A || key_type == NFC_MIFARE_KEY_B;
+}
+
+int nfc_mifare_read_sector(nfc_tag_h tag, int sector_index, nfc_mifare_key_type_e key_type, unsigned char *auth_key, nfc_mifare_read_sector_completed_cb callback, void *user_data)
+{
+	_nfc_mifare_job_s *job;
+
+	if( tag == NULL || auth_key == NULL || callback == NULL
+			|| !_nfc_mifare_is_valid_sector(sector_index) || !_nfc_mifare_is_valid_key_type(key_type) ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	if( !nfc_manager_is_activated() )
+		return NFC_ERROR_NOT_ACTIVATED;
+
+	job = _nfc_mifare_job_create(tag, sector_index, 1, key_type, auth_key, false);
+	if( job == NULL )
+		return NFC_ERROR_OUT_OF_MEMORY;
+
+	return _nfc_mifare_job_start(job, callback, user_data);
+}
+
+int nfc_mifare_write_sector(nfc_tag_h tag, int sector_index, nfc_mifare_key_type_e key_type, unsigned char *auth_key, unsigned char *buffer, int buffer_size, nfc_mifare_write_sector_completed_cb callback, void *user_data)
+{
+	_nfc_mifare_job_s *job;
+
+	if( tag == NULL || auth_key == NULL || buffer == NULL
+			|| !_nfc_mifare_is_valid_sector(sector_index) || !_nfc_mifare_is_valid_key_type(key_type)
+			|| buffer_size != _nfc_mifare_range_size(sector_index, 1, true) ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	if( !nfc_manager_is_activated() )
+		return NFC_ERROR_NOT_ACTIVATED;
+
+	job = _nfc_mifare_job_create(tag, sector_index, 1, key_type, auth_key, true);
+	if( job == NULL )
+		return NFC_ERROR_OUT_OF_MEMORY;
+
+	memcpy(job->buffer, buffer, buffer_size);
+
+	return _nfc_mifare_job_start(job, callback, user_data);
+}
+
+int nfc_mifare_dump(nfc_tag_h tag, nfc_mifare_key_type_e key_type, unsigned char *auth_key, nfc_mifare_dump_completed_cb callback, void *user_data)
+{
+	_nfc_mifare_job_s *job;
+	nfc_tag_type_e type;
+	int sector_count;
+	int ret;
+
+	if( tag == NULL || auth_key == NULL || callback == NULL || !_nfc_mifare_is_valid_key_type(key_type) ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	if( !nfc_manager_is_activated() )
+		return NFC_ERROR_NOT_ACTIVATED;
+
+	ret = nfc_tag_get_type(tag, &type);
+	if( ret != NFC_ERROR_NONE )
+		return ret;
+
+	switch( type ){
+		case NFC_MIFARE_MINI_PICC:
+			sector_count = _NFC_MIFARE_SECTOR_COUNT_MINI;
+			break;
+		case NFC_MIFARE_1K_PICC:
+			sector_count = _NFC_MIFARE_SECTOR_COUNT_1K;
+			break;
+		case NFC_MIFARE_4K_PICC:
+			sector_count = _NFC_MIFARE_SECTOR_COUNT_4K;
+			break;
+		default:
+			NFC_LOGE("[%s] tag type %d is not MIFARE classic", __func__, type);
+			return NFC_ERROR_NOT_SUPPORTED;
+	}
+
+	job = _nfc_mifare_job_create(tag, 0, sector_count, key_type, auth_key, false);
+	if( job == NULL )
+		return NFC_ERROR_OUT_OF_MEMORY;
+
+	return _nfc_mifare_job_start(job, callback, user_data);
+}
@@ -0,0 +1,290 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <nfc.h>
+#include <nfc_private.h>
+
+/*
+ * Push parser for NDEF messages arriving in slices.
+ *
+ * A record which lies entirely inside the slice being fed is parsed in
+ * place. Only a record straddling two slices is copied, into a buffer
+ * sized for the largest record accepted. Chunks are appended to a second
+ * buffer of the same bound and reported as one record once the
+ * terminating chunk (CF clear) arrives. Both buffers are allocated the
+ * first time they are needed.
+ */
+
+struct nfc_ndef_parser_s {
+	int max_record_size;
+	nfc_ndef_record_view_cb callback;
+	void *user_data;
+
+	int error;	/* sticky until reset */
+	bool stopped;	/* the callback asked to stop */
+	bool in_message;	/* a record without ME was reported */
+	bool seen_record;
+
+	/* record split over slices */
+	unsigned char *record;
+	unsigned int record_length;
+
+	/* chunked record being reassembled */
+	bool chunking;
+	nfc_record_tnf_e chunk_tnf;
+	bool chunk_begin;
+	unsigned char chunk_type[255];
+	int chunk_type_size;
+	unsigned char chunk_id[255];
+	int chunk_id_size;
+	unsigned char *chunk_payload;
+	int chunk_payload_size;
+};
+
+static void _nfc_ndef_parser_deliver(nfc_ndef_parser_h parser, const nfc_ndef_record_view_s *record)
+{
+	parser->in_message = !record->message_end;
+	parser->seen_record = true;
+
+	if( !parser->callback(record, parser->user_data) )
+		parser->stopped = true;
+}
+
+static int _nfc_ndef_parser_append_chunk(nfc_ndef_parser_h parser, const nfc_ndef_record_view_s *record)
+{
+	if( record->payload_size > parser->max_record_size - parser->chunk_payload_size )
+		return NFC_ERROR_OUT_OF_MEMORY;
+
+	if( parser->chunk_payload == NULL ){
+		parser->chunk_payload = (unsigned char *)malloc(parser->max_record_size);
+		if( parser->chunk_payload == NULL )
+			return NFC_ERROR_OUT_OF_MEMORY;
+	}
+
+	if( record->payload_size > 0 )
+		memcpy(parser->chunk_payload + parser->chunk_payload_size, record->payload, record->payload_size);
+	parser->chunk_payload_size += record->payload_size;
+
+	return NFC_ERROR_NONE;
+}
+
+static int _nfc_ndef_parser_process(nfc_ndef_parser_h parser, const nfc_ndef_record_view_s *record)
+{
+	nfc_ndef_record_view_s assembled;
+	int ret;
+
+	/* MB opens a message, every other record continues one */
+	if( record->message_begin == parser->in_message )
+		return NFC_ERROR_INVALID_NDEF_MESSAGE;
+
+	if( !parser->chunking ){
+		if( record->tnf == NFC_RECORD_TNF_UNCHAGNED )
+			return NFC_ERROR_INVALID_NDEF_MESSAGE;
+
+		if( !record->chunked ){
+			_nfc_ndef_parser_deliver(parser, record);
+			return NFC_ERROR_NONE;
+		}
+
+		if( record->message_end )
+			return NFC_ERROR_INVALID_NDEF_MESSAGE;
+
+		parser->chunking = true;
+		parser->chunk_tnf = record->tnf;
+		parser->chunk_begin = record->message_begin;
+		parser->chunk_type_size = record->type_size;
+		if( record->type_size > 0 )
+			memcpy(parser->chunk_type, record->type, record->type_size);
+		parser->chunk_id_size = record->id_size;
+		if( record->id_size > 0 )
+			memcpy(parser->chunk_id, record->id, record->id_size);
+		parser->chunk_payload_size = 0;
+		parser->in_message = true;
+
+		return _nfc_ndef_parser_append_chunk(parser, record);
+	}
+
+	/* middle and terminating chunks carry neither type nor id */
+	if( record->tnf != NFC_RECORD_TNF_UNCHAGNED || record->type_size != 0 || record->id_size != 0 )
+		return NFC_ERROR_INVALID_NDEF_MESSAGE;
+
+	if( record->chunked && record->message_end )
+		return NFC_ERROR_INVALID_NDEF_MESSAGE;
+
+	ret = _nfc_ndef_parser_append_chunk(parser, record);
+	if( ret != NFC_ERROR_NONE || record->chunked )
+		return ret;
+
+	parser->chunking = false;
+
+	memset(&assembled, 0, sizeof(assembled));
+	assembled.tnf = parser->chunk_tnf;
+	assembled.message_begin = parser->chunk_begin;
+	assembled.message_end = record->message_end;
+	assembled.type = parser->chunk_type_size ? parser->chunk_type : NULL;
+	assembled.type_size = parser->chunk_type_size;
+	assembled.id = parser->chunk_id_size ? parser->chunk_id : NULL;
+	assembled.id_size = parser->chunk_id_size;
+	assembled.payload = parser->chunk_payload_size ? parser->chunk_payload : NULL;
+	assembled.payload_size = parser->chunk_payload_size;
+
+	_nfc_ndef_parser_deliver(parser, &assembled);
+	return NFC_ERROR_NONE;
+}
+
+static int _nfc_ndef_parser_feed(nfc_ndef_parser_h parser, const unsigned char *data, int data_size)
+{
+	nfc_ndef_record_view_s record;
+	unsigned int header_size, payload_size, wanted, length;
+	int record_size;
+	bool known;
+	int ret;
+
+	while( data_size > 0 && !parser->stopped ){
+		if( parser->record_length == 0 ){
+			known = _nfc_ndef_record_measure(data, data_size, &header_size, &payload_size);
+			if( known && payload_size > (unsigned int)parser->max_record_size )
+				return NFC_ERROR_OUT_OF_MEMORY;
+
+			if( known && header_size <= (unsigned int)data_size && payload_size <= data_size - header_size ){
+				ret = _nfc_ndef_record_parse(data, data_size, &record, &record_size);
+				if( ret == NFC_ERROR_NONE )
+					ret = _nfc_ndef_parser_process(parser, &record);
+				if( ret != NFC_ERROR_NONE )
+					return ret;
+
+				data += record_size;
+				data_size -= record_size;
+				continue;
+			}
+
+			if( parser->record == NULL ){
+				parser->record = (unsigned char *)malloc(NFC_NDEF_RECORD_HEADER_MAX + parser->max_record_size);
+				if( parser->record == NULL )
+					return NFC_ERROR_OUT_OF_MEMORY;
+			}
+		}
+
+		known = _nfc_ndef_record_measure(parser->record, parser->record_length, &header_size, &payload_size);
+		if( known && payload_size > (unsigned int)parser->max_record_size )
+			return NFC_ERROR_OUT_OF_MEMORY;
+
+		wanted = known ? header_size + payload_size : header_size;
+		length = wanted - parser->record_length;
+		if( length > (unsigned int)data_size )
+			length = data_size;
+
+		memcpy(parser->record + parser->record_length, data, length);
+		parser->record_length += length;
+		data += length;
+		data_size -= length;
+
+		if( !known || parser->record_length < wanted )
+			continue;
+
+		parser->record_length = 0;
+		ret = _nfc_ndef_record_parse(parser->record, wanted, &record, &record_size);
+		if( ret == NFC_ERROR_NONE )
+			ret = _nfc_ndef_parser_process(parser, &record);
+		if( ret != NFC_ERROR_NONE )
+			return ret;
+	}
+
+	return NFC_ERROR_NONE;
+}
+
+int nfc_ndef_parser_create(nfc_ndef_parser_h *parser, int max_record_size, nfc_ndef_record_view_cb callback, void *user_data)
+{
+	nfc_ndef_parser_h new_parser;
+
+	if( parser == NULL || max_record_size <= 0 || callback == NULL ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	new_parser = (nfc_ndef_parser_h)calloc(1, sizeof(struct nfc_ndef_parser_s));
+	if( new_parser == NULL ){
+		NFC_LOGE("[%s] OUT_OF_MEMORY (0x%08x)", __func__, NFC_ERROR_OUT_OF_MEMORY);
+		return NFC_ERROR_OUT_OF_MEMORY;
+	}
+
+	new_parser->max_record_size = max_record_size;
+	new_parser->callback = callback;
+	new_parser->user_data = user_data;
+	new_parser->error = NFC_ERROR_NONE;
+
+	*parser = new_parser;
+	return NFC_ERROR_NONE;
+}
+
+int nfc_ndef_parser_feed(nfc_ndef_parser_h parser, const unsigned char *data, int data_size)
+{
+	if( parser == NULL || data == NULL || data_size < 0 ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	if( parser->error == NFC_ERROR_NONE )
+		parser->error = _nfc_ndef_parser_feed(parser, data, data_size);
+
+	return parser->error;
+}
+
+int nfc_ndef_parser_is_completed(nfc_ndef_parser_h parser, bool *completed)
+{
+	if( parser == NULL || completed == NULL ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	*completed = parser->error == NFC_ERROR_NONE && parser->seen_record
+		&& !parser->in_message && parser->record_length == 0;
+	return NFC_ERROR_NONE;
+}
+
+int nfc_ndef_parser_reset(nfc_ndef_parser_h parser)
+{
+	if( parser == NULL ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	parser->error = NFC_ERROR_NONE;
+	parser->stopped = false;
+	parser->in_message = false;
+	parser->seen_record = false;
+	parser->record_length = 0;
+	parser->chunking = false;
+	parser->chunk_payload_size = 0;
+
+	return NFC_ERROR_NONE;
+}
+
+int nfc_ndef_parser_destroy(nfc_ndef_parser_h parser)
+{
+	if( parser == NULL ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	free(parser->record);
+	free(parser->chunk_payload);
+	free(parser);
+
+	return NFC_ERROR_NONE;
+}
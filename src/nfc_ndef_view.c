@@ -0,0 +1,323 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <nfc.h>
+#include <nfc_private.h>
+
+/*
+ * In place parsing of raw NDEF messages (NFC Forum NDEF 1.0, 3.2).
+ *
+ * The record header is
+ *   flags/TNF (1) | TYPE LENGTH (1) | PAYLOAD LENGTH (1 or 4, big endian)
+ *   | ID LENGTH (0 or 1) | TYPE | ID | PAYLOAD
+ * and every length is checked against the remaining buffer before a field
+ * is referenced, so a view never points outside of the caller's bytes.
+ */
+
+#define _NFC_NDEF_FLAG_MB	0x80
+#define _NFC_NDEF_FLAG_ME	0x40
+#define _NFC_NDEF_FLAG_CF	0x20
+#define _NFC_NDEF_FLAG_SR	0x10
+#define _NFC_NDEF_FLAG_IL	0x08
+#define _NFC_NDEF_TNF_MASK	0x07
+#define _NFC_NDEF_TNF_RESERVED	0x07
+
+static unsigned int _nfc_ndef_fixed_header_size(unsigned char flags)
+{
+	return (flags & _NFC_NDEF_FLAG_SR ? 3 : 6) + (flags & _NFC_NDEF_FLAG_IL ? 1 : 0);
+}
+
+/*
+ * Decodes the lengths of the record at the start of rawdata. Returns false
+ * while the fixed part of the header is incomplete, header_size is then
+ * the number of bytes needed to decode it.
+ */
+bool _nfc_ndef_record_measure(const unsigned char *rawdata, int rawdata_size, unsigned int *header_size, unsigned int *payload_size)
+{
+	unsigned char flags;
+	unsigned int fixed_size, id_size = 0;
+
+	if( rawdata_size < 3 ){
+		*header_size = 3;
+		return false;
+	}
+
+	flags = rawdata[0];
+	fixed_size = _nfc_ndef_fixed_header_size(flags);
+	if( rawdata_size < (int)fixed_size ){
+		*header_size = fixed_size;
+		return false;
+	}
+
+	if( flags & _NFC_NDEF_FLAG_SR )
+		*payload_size = rawdata[2];
+	else
+		*payload_size = ((uint32_t)rawdata[2] << 24) | ((uint32_t)rawdata[3] << 16) | ((uint32_t)rawdata[4] << 8) | rawdata[5];
+
+	if( flags & _NFC_NDEF_FLAG_IL )
+		id_size = rawdata[fixed_size - 1];
+
+	*header_size = fixed_size + rawdata[1] + id_size;
+	return true;
+}
+
+int _nfc_ndef_record_parse(const unsigned char *rawdata, int rawdata_size, nfc_ndef_record_view_s *record, int *record_size)
+{
+	const unsigned char *p = rawdata;
+	unsigned int header_size, payload_size, type_size, id_size;
+	unsigned char flags;
+
+	if( !_nfc_ndef_record_measure(rawdata, rawdata_size, &header_size, &payload_size) )
+		return NFC_ERROR_INVALID_NDEF_MESSAGE;
+
+	/* the header is at most NFC_NDEF_RECORD_HEADER_MAX bytes, so only the payload can overflow */
+	if( header_size > (unsigned int)rawdata_size || payload_size > (unsigned int)rawdata_size - header_size )
+		return NFC_ERROR_INVALID_NDEF_MESSAGE;
+
+	flags = p[0];
+	type_size = p[1];
+	id_size = header_size - type_size - _nfc_ndef_fixed_header_size(flags);
+
+	record->tnf = flags & _NFC_NDEF_TNF_MASK;
+	if( record->tnf == _NFC_NDEF_TNF_RESERVED )
+		return NFC_ERROR_INVALID_NDEF_MESSAGE;
+	if( record->tnf == NFC_RECORD_TNF_EMPTY && (type_size != 0 || id_size != 0 || payload_size != 0) )
+		return NFC_ERROR_INVALID_NDEF_MESSAGE;
+
+	record->message_begin = (flags & _NFC_NDEF_FLAG_MB) != 0;
+	record->message_end = (flags & _NFC_NDEF_FLAG_ME) != 0;
+	record->chunked = (flags & _NFC_NDEF_FLAG_CF) != 0;
+
+	p += header_size - type_size - id_size;
+	record->type = type_size ? p : NULL;
+	record->type_size = type_size;
+	p += type_size;
+	record->id = id_size ? p : NULL;
+	record->id_size = id_size;
+	p += id_size;
+	record->payload = payload_size ? p : NULL;
+	record->payload_size = payload_size;
+
+	*record_size = header_size + payload_size;
+	return NFC_ERROR_NONE;
+}
+
+int nfc_ndef_record_view_next(const unsigned char *rawdata, int rawdata_size, int *offset, nfc_ndef_record_view_s *record)
+{
+	int record_size;
+	int ret;
+
+	if( rawdata == NULL || rawdata_size <= 0 || offset == NULL || record == NULL || *offset < 0 || *offset > rawdata_size ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	if( *offset == rawdata_size )
+		return NFC_ERROR_NO_NDEF_MESSAGE;
+
+	ret = _nfc_ndef_record_parse(rawdata + *offset, rawdata_size - *offset, record, &record_size);
+	if( ret != NFC_ERROR_NONE )
+		return ret;
+
+	/* MB marks the first record and only the first one */
+	if( record->message_begin != (*offset == 0) )
+		return NFC_ERROR_INVALID_NDEF_MESSAGE;
+
+	if( record->message_end ){
+		*offset = rawdata_size;
+		return NFC_ERROR_NONE;
+	}
+
+	if( *offset + record_size == rawdata_size )
+		return NFC_ERROR_INVALID_NDEF_MESSAGE;
+
+	*offset += record_size;
+	return NFC_ERROR_NONE;
+}
+
+int nfc_ndef_message_foreach_record_view(const unsigned char *rawdata, int rawdata_size, nfc_ndef_record_view_cb callback, void *user_data)
+{
+	nfc_ndef_record_view_s record;
+	int offset = 0;
+	int ret;
+
+	if( rawdata == NULL || rawdata_size <= 0 || callback == NULL ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	while( (ret = nfc_ndef_record_view_next(rawdata, rawdata_size, &offset, &record)) == NFC_ERROR_NONE ){
+		if( !callback(&record, user_data) )
+			return NFC_ERROR_NONE;
+	}
+
+	return ret == NFC_ERROR_NO_NDEF_MESSAGE ? NFC_ERROR_NONE : ret;
+}
+
+/*
+ * A message view keeps the bytes and the view in one block, the bytes
+ * first, so that handing the bytes over is handing the block over.
+ * Records are found by walking the headers from the last record looked
+ * up, or from the start when an earlier one is asked for.
+ */
+
+#define _NFC_NDEF_VIEW_ALIGN	8
+
+struct nfc_ndef_message_view_s {
+	unsigned char *rawdata;	/* the start of the block */
+	int rawdata_size;
+	int record_count;	/* -1 until counted */
+	int cursor_index;	/* the last record looked up */
+	int cursor_offset;
+};
+
+int nfc_ndef_message_view_create(nfc_ndef_message_view_h *view, const unsigned char *rawdata, int rawdata_size)
+{
+	unsigned char *block;
+	size_t offset;
+
+	if( view == NULL || rawdata == NULL || rawdata_size <= 0 ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	offset = ((size_t)rawdata_size + _NFC_NDEF_VIEW_ALIGN - 1) & ~(size_t)(_NFC_NDEF_VIEW_ALIGN - 1);
+	block = (unsigned char *)malloc(offset + sizeof(struct nfc_ndef_message_view_s));
+	if( block == NULL ){
+		NFC_LOGE("[%s] OUT_OF_MEMORY (0x%08x)", __func__, NFC_ERROR_OUT_OF_MEMORY);
+		return NFC_ERROR_OUT_OF_MEMORY;
+	}
+
+	memcpy(block, rawdata, rawdata_size);
+
+	*view = (nfc_ndef_message_view_h)(block + offset);
+	(*view)->rawdata = block;
+	(*view)->rawdata_size = rawdata_size;
+	(*view)->record_count = -1;
+	(*view)->cursor_index = 0;
+	(*view)->cursor_offset = 0;
+	return NFC_ERROR_NONE;
+}
+
+int nfc_ndef_message_view_destroy(nfc_ndef_message_view_h view)
+{
+	if( view == NULL ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	free(view->rawdata);
+	return NFC_ERROR_NONE;
+}
+
+int nfc_ndef_message_view_get_rawdata(nfc_ndef_message_view_h view, const unsigned char **rawdata, int *rawdata_size)
+{
+	if( view == NULL || rawdata == NULL || rawdata_size == NULL ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	*rawdata = view->rawdata;
+	*rawdata_size = view->rawdata_size;
+	return NFC_ERROR_NONE;
+}
+
+int nfc_ndef_message_view_detach_rawdata(nfc_ndef_message_view_h view, unsigned char **rawdata, int *rawdata_size)
+{
+	if( view == NULL || rawdata == NULL || rawdata_size == NULL ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	/* the view lives behind the bytes and goes with them */
+	*rawdata_size = view->rawdata_size;
+	*rawdata = view->rawdata;
+	return NFC_ERROR_NONE;
+}
+
+int nfc_ndef_message_view_get_record_count(nfc_ndef_message_view_h view, int *count)
+{
+	nfc_ndef_record_view_s record;
+	int offset = 0;
+	int n = 0;
+	int ret;
+
+	if( view == NULL || count == NULL ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	if( view->record_count < 0 ){
+		while( (ret = nfc_ndef_record_view_next(view->rawdata, view->rawdata_size, &offset, &record)) == NFC_ERROR_NONE )
+			n++;
+		if( ret != NFC_ERROR_NO_NDEF_MESSAGE )
+			return ret;
+
+		view->record_count = n;
+	}
+
+	*count = view->record_count;
+	return NFC_ERROR_NONE;
+}
+
+int nfc_ndef_message_view_get_record(nfc_ndef_message_view_h view, int index, nfc_ndef_record_view_s *record)
+{
+	int offset, start;
+	int i;
+	int ret;
+
+	if( view == NULL || record == NULL || index < 0 || (view->record_count >= 0 && index >= view->record_count) ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	if( index < view->cursor_index ){
+		view->cursor_index = 0;
+		view->cursor_offset = 0;
+	}
+
+	offset = view->cursor_offset;
+	for( i = view->cursor_index; ; i++ ){
+		start = offset;
+		ret = nfc_ndef_record_view_next(view->rawdata, view->rawdata_size, &offset, record);
+		if( ret == NFC_ERROR_NO_NDEF_MESSAGE ){
+			view->record_count = i;
+			NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+			return NFC_ERROR_INVALID_PARAMETER;
+		}
+		if( ret != NFC_ERROR_NONE )
+			return ret;
+
+		if( i == index ){
+			view->cursor_index = i;
+			view->cursor_offset = start;
+			return NFC_ERROR_NONE;
+		}
+	}
+}
+
+int nfc_ndef_message_view_to_message(nfc_ndef_message_view_h view, nfc_ndef_message_h *ndef_message)
+{
+	if( view == NULL || ndef_message == NULL ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	return nfc_ndef_message_create_from_rawdata(ndef_message, view->rawdata, view->rawdata_size);
+}
@@ -0,0 +1,381 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <net_nfc.h>
+#include <net_nfc_typedef_private.h>
+#include <net_nfc_exchanger.h>
+#include <nfc.h>
+#include <nfc_private.h>
+
+/*
+ * P2P send queues.
+ *
+ * The daemon reports the completion of an exchanger send without saying
+ * which send it was, so every target keeps a FIFO of its sends and only
+ * the head of it is handed to the daemon. The completion of the head
+ * issues the next send before the callback of the head is dispatched,
+ * which keeps the link busy while the application is notified.
+ */
+
+typedef struct _nfc_p2p_send_s {
+	net_nfc_exchanger_data_h data;
+	nfc_p2p_send_completed_cb callback;
+	void *user_data;
+	int result;
+	struct _nfc_p2p_send_s *next;
+} _nfc_p2p_send_s;
+
+typedef struct _nfc_p2p_queue_s {
+	net_nfc_target_handle_h target;
+	_nfc_p2p_send_s *head;	/* with the daemon when issued is set */
+	_nfc_p2p_send_s *tail;
+	int depth;
+	bool issued;
+	struct _nfc_p2p_queue_s *next;
+} _nfc_p2p_queue_s;
+
+static struct {
+	pthread_mutex_t lock;
+	_nfc_p2p_queue_s *queues;
+} g_nfc_p2p = { PTHREAD_MUTEX_INITIALIZER, NULL };
+
+/* the encoded size of a record, -1 when its flags do not match its fields */
+static int _nfc_p2p_record_size(const ndef_record_s *record)
+{
+	if( (record->SR && record->payload_s.length > 0xff) || (!record->IL && record->id_s.length > 0)
+			|| record->type_s.length > 0xff || record->id_s.length > 0xff )
+		return -1;
+
+	return 2 + (record->SR ? 1 : 4) + (record->IL ? 1 : 0)
+		+ record->type_s.length + record->id_s.length + record->payload_s.length;
+}
+
+/* encodes the message into exactly size bytes, false when it does not fit them */
+static bool _nfc_p2p_serialize(const ndef_message_s *message, unsigned char *buffer, int size)
+{
+	const ndef_record_s *record;
+	unsigned char *p = buffer;
+	int record_size;
+
+	for( record = message->records; record != NULL; record = record->next ){
+		record_size = _nfc_p2p_record_size(record);
+		if( record_size < 0 || record_size > size - (p - buffer) )
+			return false;
+
+		*p++ = (record == message->records ? 0x80 : 0) | (record->next == NULL ? 0x40 : 0)
+			| (record->CF ? 0x20 : 0) | (record->SR ? 0x10 : 0) | (record->IL ? 0x08 : 0) | (record->TNF & 0x07);
+		*p++ = record->type_s.length;
+		if( record->SR ){
+			*p++ = record->payload_s.length;
+		}
+		else {
+			*p++ = (record->payload_s.length >> 24) & 0xff;
+			*p++ = (record->payload_s.length >> 16) & 0xff;
+			*p++ = (record->payload_s.length >> 8) & 0xff;
+			*p++ = record->payload_s.length & 0xff;
+		}
+		if( record->IL )
+			*p++ = record->id_s.length;
+
+		if( record->type_s.length > 0 )
+			memcpy(p, record->type_s.buffer, record->type_s.length);
+		p += record->type_s.length;
+		if( record->id_s.length > 0 )
+			memcpy(p, record->id_s.buffer, record->id_s.length);
+		p += record->id_s.length;
+		if( record->payload_s.length > 0 )
+			memcpy(p, record->payload_s.buffer, record->payload_s.length);
+		p += record->payload_s.length;
+	}
+
+	return p - buffer == size;
+}
+
+/*
+ * Builds the exchanger data of a send. The message is encoded straight
+ * into the buffer the exchanger data owns, sized from the length the
+ * daemon library computes, instead of being encoded into raw data which
+ * the exchanger data then copies. A message the encoder does not agree
+ * on the size of goes the old way.
+ */
+int _nfc_p2p_exchanger_data_create(nfc_ndef_message_h message, net_nfc_exchanger_data_h *data)
+{
+	net_nfc_exchanger_data_s *exchanger;
+	data_h rawdata = NULL;
+	int size = 0;
+	int ret;
+
+	if( net_nfc_get_ndef_message_byte_length((ndef_message_h)message, &size) == NET_NFC_OK && size > 0 ){
+		exchanger = (net_nfc_exchanger_data_s *)calloc(1, sizeof(net_nfc_exchanger_data_s));
+		if( exchanger == NULL )
+			return NET_NFC_ALLOC_FAIL;
+
+		exchanger->binary_data.buffer = (uint8_t *)malloc(size);
+		if( exchanger->binary_data.buffer != NULL
+				&& _nfc_p2p_serialize((ndef_message_s *)message, exchanger->binary_data.buffer, size) ){
+			exchanger->type = NET_NFC_EXCHANGER_RAW;
+			exchanger->binary_data.length = size;
+			*data = (net_nfc_exchanger_data_h)exchanger;
+			return NET_NFC_OK;
+		}
+
+		free(exchanger->binary_data.buffer);
+		free(exchanger);
+	}
+
+	ret = net_nfc_create_rawdata_from_ndef_message((ndef_message_h)message, &rawdata);
+	if( ret != NET_NFC_OK )
+		return ret;
+
+	ret = net_nfc_create_exchanger_data(data, rawdata);
+	net_nfc_free_data(rawdata);
+
+	return ret;
+}
+
+static void _nfc_p2p_run_send_completed(const _nfc_closure_s *closure)
+{
+	((nfc_p2p_send_completed_cb)closure->callback)(closure->result, closure->user_data);
+}
+
+/* dispatches the callbacks of a list of finished sends and frees them */
+static void _nfc_p2p_send_finish(net_nfc_target_handle_h target, _nfc_p2p_send_s *list)
+{
+	_nfc_p2p_send_s *next;
+	_nfc_closure_s closure;
+
+	for( ; list != NULL; list = next ){
+		next = list->next;
+		if( list->result != NFC_ERROR_NONE )
+			_nfc_counters_failed(list->result);
+		if( list->callback != NULL ){
+			memset(&closure, 0, sizeof(closure));
+			closure.run = _nfc_p2p_run_send_completed;
+			closure.callback = list->callback;
+			closure.user_data = list->user_data;
+			closure.result = list->result;
+			_nfc_executor_dispatch(target, &closure);
+		}
+		free(list);
+	}
+}
+
+/* called with the lock held */
+static _nfc_p2p_queue_s * _nfc_p2p_queue_find(net_nfc_target_handle_h target)
+{
+	_nfc_p2p_queue_s *queue;
+
+	for( queue = g_nfc_p2p.queues; queue != NULL; queue = queue->next ){
+		if( queue->target == target )
+			return queue;
+	}
+
+	return NULL;
+}
+
+/* called with the lock held */
+static void _nfc_p2p_queue_remove(_nfc_p2p_queue_s *queue)
+{
+	_nfc_p2p_queue_s **link;
+
+	for( link = &g_nfc_p2p.queues; *link != NULL; link = &(*link)->next ){
+		if( *link == queue ){
+			*link = queue->next;
+			break;
+		}
+	}
+}
+
+/* called with the lock held, moves the sends the daemon refused to the failed list */
+static void _nfc_p2p_queue_issue(_nfc_p2p_queue_s *queue, _nfc_p2p_send_s ***failed)
+{
+	_nfc_p2p_send_s *send;
+	int ret;
+
+	while( !queue->issued && (send = queue->head) != NULL ){
+		ret = net_nfc_send_exchanger_data(send->data, queue->target);
+		if( ret == NET_NFC_OK ){
+			queue->issued = true;
+			break;
+		}
+
+		net_nfc_free_exchanger_data(send->data);
+		send->result = _convert_error_code(__func__, ret);
+
+		queue->head = send->next;
+		if( queue->head == NULL )
+			queue->tail = NULL;
+		queue->depth--;
+
+		send->next = NULL;
+		**failed = send;
+		*failed = &send->next;
+	}
+}
+
+/* takes over data, which is freed when the daemon refuses it */
+int _nfc_p2p_send_enqueue(net_nfc_target_handle_h target, net_nfc_exchanger_data_h data, nfc_p2p_send_completed_cb callback, void *user_data)
+{
+	_nfc_p2p_queue_s *queue;
+	_nfc_p2p_send_s *send;
+	_nfc_p2p_send_s *failed = NULL;
+	_nfc_p2p_send_s **failed_tail = &failed;
+	int ret = NFC_ERROR_NONE;
+
+	send = (_nfc_p2p_send_s *)calloc(1, sizeof(_nfc_p2p_send_s));
+	if( send == NULL ){
+		net_nfc_free_exchanger_data(data);
+		NFC_LOGE("[%s] OUT_OF_MEMORY (0x%08x)", __func__, NFC_ERROR_OUT_OF_MEMORY);
+		return NFC_ERROR_OUT_OF_MEMORY;
+	}
+	send->data = data;
+	send->callback = callback;
+	send->user_data = user_data;
+
+	pthread_mutex_lock(&g_nfc_p2p.lock);
+
+	queue = _nfc_p2p_queue_find(target);
+	if( queue == NULL ){
+		queue = (_nfc_p2p_queue_s *)calloc(1, sizeof(_nfc_p2p_queue_s));
+		if( queue == NULL ){
+			pthread_mutex_unlock(&g_nfc_p2p.lock);
+			net_nfc_free_exchanger_data(data);
+			free(send);
+			NFC_LOGE("[%s] OUT_OF_MEMORY (0x%08x)", __func__, NFC_ERROR_OUT_OF_MEMORY);
+			return NFC_ERROR_OUT_OF_MEMORY;
+		}
+		queue->target = target;
+		queue->next = g_nfc_p2p.queues;
+		g_nfc_p2p.queues = queue;
+	}
+
+	if( queue->tail != NULL )
+		queue->tail->next = send;
+	else
+		queue->head = send;
+	queue->tail = send;
+	queue->depth++;
+
+	_nfc_p2p_queue_issue(queue, &failed_tail);
+
+	/* an idle queue refusing the new send reports it to the caller */
+	if( failed == send ){
+		ret = send->result;
+		free(send);
+		failed = NULL;
+	}
+
+	if( queue->head == NULL ){
+		_nfc_p2p_queue_remove(queue);
+		free(queue);
+	}
+
+	pthread_mutex_unlock(&g_nfc_p2p.lock);
+
+	return ret;
+}
+
+/* the daemon finished the send in flight, of the current target when it has one */
+void _nfc_p2p_send_complete(net_nfc_target_handle_h current_target, int result)
+{
+	_nfc_p2p_queue_s *queue;
+	_nfc_p2p_send_s *done;
+	_nfc_p2p_send_s *failed = NULL;
+	_nfc_p2p_send_s **failed_tail = &failed;
+	net_nfc_target_handle_h target;
+
+	pthread_mutex_lock(&g_nfc_p2p.lock);
+
+	queue = _nfc_p2p_queue_find(current_target);
+	if( queue == NULL || !queue->issued ){
+		for( queue = g_nfc_p2p.queues; queue != NULL && !queue->issued; queue = queue->next )
+			;
+	}
+
+	if( queue == NULL ){
+		pthread_mutex_unlock(&g_nfc_p2p.lock);
+		return;
+	}
+
+	done = queue->head;
+	queue->head = done->next;
+	if( queue->head == NULL )
+		queue->tail = NULL;
+	queue->depth--;
+	queue->issued = false;
+	done->next = NULL;
+	done->result = result;
+
+	_nfc_p2p_queue_issue(queue, &failed_tail);
+
+	target = queue->target;
+	if( queue->head == NULL ){
+		_nfc_p2p_queue_remove(queue);
+		free(queue);
+	}
+
+	pthread_mutex_unlock(&g_nfc_p2p.lock);
+
+	done->next = failed;
+	_nfc_p2p_send_finish(target, done);
+}
+
+/* completes every send of every target, the link is gone */
+void _nfc_p2p_send_fail_all(int result)
+{
+	_nfc_p2p_queue_s *queue;
+	_nfc_p2p_queue_s *next;
+	_nfc_p2p_send_s *send;
+
+	pthread_mutex_lock(&g_nfc_p2p.lock);
+	queue = g_nfc_p2p.queues;
+	g_nfc_p2p.queues = NULL;
+	pthread_mutex_unlock(&g_nfc_p2p.lock);
+
+	for( ; queue != NULL; queue = next ){
+		next = queue->next;
+
+		/* the daemon still owns the data of the send it was given */
+		for( send = queue->head; send != NULL; send = send->next ){
+			if( send != queue->head || !queue->issued )
+				net_nfc_free_exchanger_data(send->data);
+			send->result = result;
+		}
+
+		_nfc_p2p_send_finish(queue->target, queue->head);
+		free(queue);
+	}
+}
+
+int nfc_p2p_get_send_queue_depth(nfc_p2p_target_h target, int *depth)
+{
+	_nfc_p2p_queue_s *queue;
+
+	if( target == NULL || depth == NULL ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	pthread_mutex_lock(&g_nfc_p2p.lock);
+	queue = _nfc_p2p_queue_find((net_nfc_target_handle_h)target);
+	*depth = queue != NULL ? queue->depth : 0;
+	pthread_mutex_unlock(&g_nfc_p2p.lock);
+
+	return NFC_ERROR_NONE;
+}
@@ -0,0 +1,428 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <nfc.h>
+#include <nfc_private.h>
+
+/*
+ * Registry of the asynchronous tag operations handed to the daemon.
+ *
+ * The daemon only sees the request id as its trans_data, so a response
+ * arriving after the operation was cancelled or expired finds nothing in
+ * the table and is dropped instead of touching a recycled context.
+ *
+ * Jobs are kept on a list of their own so their id can be cancelled while
+ * none of their steps is pending.
+ *
+ * Deadlines are kept in a hashed timer wheel ticked by a timer of the
+ * library. The timer is only armed while operations with a deadline are
+ * pending.
+ */
+
+#define _NFC_PENDING_HASH_SIZE	64
+#define _NFC_PENDING_WHEEL_SIZE	64
+#define _NFC_PENDING_TICK_MS	100
+
+typedef struct {
+	pthread_mutex_t lock;
+	_async_callback_data *hash[_NFC_PENDING_HASH_SIZE];
+	_async_callback_data *wheel[_NFC_PENDING_WHEEL_SIZE];
+	int wheel_count;
+	unsigned int processed_tick;
+	bool ticking;
+	_nfc_pending_job_s *jobs;
+	int next_id;
+	int timeout_ms;
+} _nfc_pending_table;
+
+static _nfc_pending_table g_nfc_pending = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.timeout_ms = NFC_REQUEST_TIMEOUT_DEFAULT,
+};
+
+static __thread int g_nfc_last_request_id;
+static __thread _nfc_pending_job_s *g_nfc_pending_job;
+
+static unsigned int _nfc_pending_now_tick(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned int)(((uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000) / _NFC_PENDING_TICK_MS);
+}
+
+static void _nfc_pending_wheel_insert(_async_callback_data *op)
+{
+	_async_callback_data **bucket = &g_nfc_pending.wheel[op->deadline % _NFC_PENDING_WHEEL_SIZE];
+
+	op->wheel_prev = NULL;
+	op->wheel_next = *bucket;
+	if( *bucket != NULL )
+		(*bucket)->wheel_prev = op;
+	*bucket = op;
+	g_nfc_pending.wheel_count++;
+}
+
+static void _nfc_pending_wheel_remove(_async_callback_data *op)
+{
+	if( op->deadline == 0 )
+		return;
+
+	if( op->wheel_prev != NULL )
+		op->wheel_prev->wheel_next = op->wheel_next;
+	else
+		g_nfc_pending.wheel[op->deadline % _NFC_PENDING_WHEEL_SIZE] = op->wheel_next;
+	if( op->wheel_next != NULL )
+		op->wheel_next->wheel_prev = op->wheel_prev;
+
+	op->wheel_prev = op->wheel_next = NULL;
+	op->deadline = 0;
+	g_nfc_pending.wheel_count--;
+}
+
+static _async_callback_data *_nfc_pending_unlink(int request_id)
+{
+	_async_callback_data **link = &g_nfc_pending.hash[request_id % _NFC_PENDING_HASH_SIZE];
+	_async_callback_data *op;
+
+	for( op = *link; op != NULL; link = &op->hash_next, op = op->hash_next ){
+		if( op->request_id == request_id ){
+			*link = op->hash_next;
+			op->hash_next = NULL;
+			_nfc_pending_wheel_remove(op);
+			return op;
+		}
+	}
+	return NULL;
+}
+
+/* called with the table locked */
+static int _nfc_pending_next_id(void)
+{
+	int id;
+
+	do {
+		id = ++g_nfc_pending.next_id & 0x7fffffff;
+	} while( id == 0 );
+	return id;
+}
+
+/* called with the table locked, prepends the steps of the job to list */
+static _async_callback_data *_nfc_pending_unlink_job(_nfc_pending_job_s *job, _async_callback_data *list)
+{
+	_async_callback_data *op, *next;
+	int i;
+
+	for( i = 0; i < _NFC_PENDING_HASH_SIZE; i++ ){
+		for( op = g_nfc_pending.hash[i]; op != NULL; op = next ){
+			next = op->hash_next;
+			if( op->job != job )
+				continue;
+			op = _nfc_pending_unlink(op->request_id);
+			op->hash_next = list;
+			list = op;
+		}
+	}
+	return list;
+}
+
+static void _nfc_pending_run(const _nfc_closure_s *closure)
+{
+	switch( closure->arg ){
+		case _NFC_CALLBACK_TYPE_DATA :
+			((nfc_tag_transceive_completed_cb)closure->callback)(closure->result, (unsigned char *)closure->buffer, closure->buffer_size, closure->user_data);
+			break;
+		case _NFC_CALLBACK_TYPE_MESSAGE :
+			((nfc_tag_read_completed_cb)closure->callback)(closure->result, (nfc_ndef_message_h)closure->object, closure->user_data);
+			break;
+		case _NFC_CALLBACK_TYPE_RESULT :
+		default :
+			((nfc_tag_write_completed_cb)closure->callback)(closure->result, closure->user_data);
+			break;
+	}
+}
+
+/*
+ * Invokes the completed callback of an operation taken out of the table
+ * and returns the operation to the pool. buffer and message are borrowed
+ * from the event and only passed to DATA and MESSAGE callbacks.
+ */
+void _nfc_pending_complete(_async_callback_data *op, int result, const unsigned char *buffer, int buffer_size, ndef_message_h message)
+{
+	_nfc_closure_s closure;
+	net_nfc_target_handle_h handle = op->handle;
+
+	if( result != NFC_ERROR_NONE )
+		_nfc_counters_failed(result);
+
+	memset(&closure, 0, sizeof(closure));
+	closure.run = _nfc_pending_run;
+	closure.callback = op->callback;
+	closure.user_data = op->user_data;
+	closure.result = result;
+	closure.arg = op->callback_type;
+
+	if( op->callback_type == _NFC_CALLBACK_TYPE_DATA ){
+		closure.buffer = buffer;
+		closure.buffer_size = buffer != NULL ? buffer_size : 0;
+	}
+	else if( op->callback_type == _NFC_CALLBACK_TYPE_MESSAGE && message != NULL ){
+		closure.object = message;
+		closure.object_copy = _nfc_closure_ndef_message_copy;
+		closure.object_free = _nfc_closure_ndef_message_free;
+	}
+
+	_nfc_callback_pool_free(op);
+	_nfc_executor_dispatch(handle, &closure);
+}
+
+static void _nfc_pending_complete_list(_async_callback_data *list, int error)
+{
+	_async_callback_data *next;
+
+	for( ; list != NULL; list = next ){
+		next = list->hash_next;
+		list->hash_next = NULL;
+		_nfc_pending_complete(list, error, NULL, 0, NULL);
+	}
+}
+
+static void _nfc_pending_tick(void);
+
+static _nfc_timer_s g_nfc_pending_timer = {
+	.run = _nfc_pending_tick,
+};
+
+static void _nfc_pending_tick(void)
+{
+	_async_callback_data *expired = NULL;
+	_async_callback_data *op, *next;
+	unsigned int now, tick, count;
+
+	pthread_mutex_lock(&g_nfc_pending.lock);
+
+	now = _nfc_pending_now_tick();
+	count = now - g_nfc_pending.processed_tick;
+	if( count > _NFC_PENDING_WHEEL_SIZE )
+		count = _NFC_PENDING_WHEEL_SIZE;
+
+	for( tick = now - count + 1; count > 0; tick++, count-- ){
+		for( op = g_nfc_pending.wheel[tick % _NFC_PENDING_WHEEL_SIZE]; op != NULL; op = next ){
+			next = op->wheel_next;
+			if( (int)(op->deadline - now) > 0 )
+				continue;
+			op = _nfc_pending_unlink(op->request_id);
+			op->hash_next = expired;
+			expired = op;
+		}
+	}
+	g_nfc_pending.processed_tick = now;
+
+	if( g_nfc_pending.wheel_count == 0 ){
+		_nfc_timer_disarm(&g_nfc_pending_timer);
+		g_nfc_pending.ticking = false;
+	}
+
+	pthread_mutex_unlock(&g_nfc_pending.lock);
+
+	if( expired != NULL )
+		NFC_LOGW("[%s] request timed out", __func__);
+	_nfc_pending_complete_list(expired, NFC_ERROR_TIMED_OUT);
+}
+
+int _nfc_pending_register(_async_callback_data *op)
+{
+	int id;
+
+	pthread_mutex_lock(&g_nfc_pending.lock);
+
+	id = _nfc_pending_next_id();
+	op->request_id = id;
+	op->job = g_nfc_pending_job;
+	op->issued = _nfc_stats_now();
+	op->hash_next = g_nfc_pending.hash[id % _NFC_PENDING_HASH_SIZE];
+	g_nfc_pending.hash[id % _NFC_PENDING_HASH_SIZE] = op;
+
+	op->deadline = 0;
+	if( g_nfc_pending.timeout_ms > 0 ){
+		unsigned int now = _nfc_pending_now_tick();
+
+		if( g_nfc_pending.wheel_count == 0 )
+			g_nfc_pending.processed_tick = now;
+		/* round up and never land in the bucket currently being processed */
+		op->deadline = now + (g_nfc_pending.timeout_ms + _NFC_PENDING_TICK_MS - 1) / _NFC_PENDING_TICK_MS + 1;
+		_nfc_pending_wheel_insert(op);
+
+		/* without the timer the operation still completes, only it cannot expire */
+		if( !g_nfc_pending.ticking )
+			g_nfc_pending.ticking = _nfc_timer_arm(&g_nfc_pending_timer, _NFC_PENDING_TICK_MS) == NFC_ERROR_NONE;
+	}
+
+	pthread_mutex_unlock(&g_nfc_pending.lock);
+
+	/* a step is reported through the id of its job */
+	if( op->job == NULL )
+		g_nfc_last_request_id = id;
+	return id;
+}
+
+_async_callback_data *_nfc_pending_take(int request_id)
+{
+	_async_callback_data *op;
+
+	if( request_id <= 0 )
+		return NULL;
+
+	pthread_mutex_lock(&g_nfc_pending.lock);
+	op = _nfc_pending_unlink(request_id);
+	pthread_mutex_unlock(&g_nfc_pending.lock);
+
+	return op;
+}
+
+void _nfc_pending_fail(net_nfc_target_handle_h handle, int error)
+{
+	_async_callback_data *failed = NULL;
+	_async_callback_data *op, *next;
+	int i;
+
+	pthread_mutex_lock(&g_nfc_pending.lock);
+	for( i = 0; i < _NFC_PENDING_HASH_SIZE; i++ ){
+		for( op = g_nfc_pending.hash[i]; op != NULL; op = next ){
+			next = op->hash_next;
+			if( handle != NULL && op->handle != handle )
+				continue;
+			op = _nfc_pending_unlink(op->request_id);
+			op->hash_next = failed;
+			failed = op;
+		}
+	}
+	pthread_mutex_unlock(&g_nfc_pending.lock);
+
+	_nfc_pending_complete_list(failed, error);
+}
+
+void _nfc_pending_job_begin(_nfc_pending_job_s *job)
+{
+	pthread_mutex_lock(&g_nfc_pending.lock);
+	job->id = _nfc_pending_next_id();
+	job->cancelled = false;
+	job->next = g_nfc_pending.jobs;
+	g_nfc_pending.jobs = job;
+	pthread_mutex_unlock(&g_nfc_pending.lock);
+
+	g_nfc_last_request_id = job->id;
+}
+
+/* the job may be freed once this returns, none of its steps may be pending */
+void _nfc_pending_job_end(_nfc_pending_job_s *job)
+{
+	_nfc_pending_job_s **link;
+
+	pthread_mutex_lock(&g_nfc_pending.lock);
+	for( link = &g_nfc_pending.jobs; *link != NULL; link = &(*link)->next ){
+		if( *link == job ){
+			*link = job->next;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&g_nfc_pending.lock);
+}
+
+void _nfc_pending_job_enter(_nfc_pending_job_s *job)
+{
+	g_nfc_pending_job = job;
+}
+
+void _nfc_pending_job_leave(void)
+{
+	g_nfc_pending_job = NULL;
+}
+
+int nfc_manager_set_request_timeout(int timeout_ms)
+{
+	if( timeout_ms < 0 ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	pthread_mutex_lock(&g_nfc_pending.lock);
+	g_nfc_pending.timeout_ms = timeout_ms;
+	pthread_mutex_unlock(&g_nfc_pending.lock);
+
+	return NFC_ERROR_NONE;
+}
+
+int nfc_tag_get_last_request_id(int *request_id)
+{
+	if( request_id == NULL ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	if( g_nfc_last_request_id == 0 ){
+		NFC_LOGE("[%s] OPERATION_FAILED (0x%08x) no request issued from this thread", __func__, NFC_ERROR_OPERATION_FAILED);
+		return NFC_ERROR_OPERATION_FAILED;
+	}
+
+	*request_id = g_nfc_last_request_id;
+	return NFC_ERROR_NONE;
+}
+
+int nfc_tag_cancel(int request_id)
+{
+	_async_callback_data *cancelled = NULL;
+	_async_callback_data *op;
+	_nfc_pending_job_s *job;
+
+	pthread_mutex_lock(&g_nfc_pending.lock);
+
+	for( job = g_nfc_pending.jobs; job != NULL && job->id != request_id; job = job->next )
+		;
+
+	if( job == NULL && request_id > 0 && (op = _nfc_pending_unlink(request_id)) != NULL ){
+		if( op->job == NULL ){
+			pthread_mutex_unlock(&g_nfc_pending.lock);
+			_nfc_callback_pool_free(op);
+			return NFC_ERROR_NONE;
+		}
+
+		/* step ids do not leave the library, still one stands for its whole job */
+		job = op->job;
+		op->hash_next = NULL;
+		cancelled = op;
+	}
+
+	if( job == NULL || (job->cancelled && cancelled == NULL) ){
+		pthread_mutex_unlock(&g_nfc_pending.lock);
+		NFC_LOGE("[%s] request %d is not pending", __func__, request_id);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	job->cancelled = true;
+	cancelled = _nfc_pending_unlink_job(job, cancelled);
+
+	pthread_mutex_unlock(&g_nfc_pending.lock);
+
+	/* the job finishes through the completions of its steps */
+	_nfc_pending_complete_list(cancelled, NFC_ERROR_OPERATION_FAILED);
+	return NFC_ERROR_NONE;
+}
@@ -0,0 +1,218 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <nfc.h>
+#include <nfc_private.h>
+
+/*
+ * Fixed-capacity free list of _async_callback_data.
+ *
+ * The head word packs a 16 bit generation counter above a 16 bit
+ * (index + 1) so that the list can be popped and pushed with a single
+ * 32 bit compare-and-swap without suffering from ABA, also on ARM targets
+ * lacking 64 bit atomics. Slots are returned in whatever order the
+ * daemon completes the requests; nothing depends on LIFO pairing.
+ */
+
+#define _NFC_POOL_INDEX_MASK		0xffffU
+#define _NFC_POOL_GENERATION_SHIFT	16
+#define _NFC_POOL_NIL			0
+
+typedef struct {
+	_async_callback_data data;	/* must be first */
+	unsigned int next;
+} _nfc_callback_slot;
+
+typedef struct {
+	_nfc_callback_slot *slots;
+	int capacity;
+	volatile unsigned int head;
+	volatile int in_use;
+	volatile int high_water;
+	volatile unsigned int exhausted;
+} _nfc_callback_pool;
+
+static _nfc_callback_pool *g_nfc_callback_pool;
+
+static _nfc_callback_pool *_nfc_callback_pool_create(int capacity)
+{
+	int i;
+	_nfc_callback_pool *pool;
+
+	pool = (_nfc_callback_pool *)calloc(1, sizeof(_nfc_callback_pool));
+	if( pool == NULL )
+		return NULL;
+
+	pool->slots = (_nfc_callback_slot *)calloc(capacity, sizeof(_nfc_callback_slot));
+	if( pool->slots == NULL ){
+		free(pool);
+		return NULL;
+	}
+
+	for( i = 0; i < capacity; i++ )
+		pool->slots[i].next = (i + 1 < capacity) ? i + 2 : _NFC_POOL_NIL;
+
+	pool->capacity = capacity;
+	pool->head = 1;
+
+	return pool;
+}
+
+static void _nfc_callback_pool_destroy(_nfc_callback_pool *pool)
+{
+	if( pool == NULL )
+		return;
+	free(pool->slots);
+	free(pool);
+}
+
+static _nfc_callback_pool *_nfc_callback_pool_get(void)
+{
+	_nfc_callback_pool *pool = g_nfc_callback_pool;
+
+	if( pool != NULL )
+		return pool;
+
+	pool = _nfc_callback_pool_create(NFC_CALLBACK_POOL_DEFAULT_SIZE);
+	if( pool == NULL )
+		return NULL;
+
+	if( !__sync_bool_compare_and_swap(&g_nfc_callback_pool, NULL, pool) ){
+		/* another thread published its pool first */
+		_nfc_callback_pool_destroy(pool);
+		pool = g_nfc_callback_pool;
+	}
+
+	return pool;
+}
+
+static bool _nfc_callback_pool_owns(_nfc_callback_pool *pool, _async_callback_data *data)
+{
+	_nfc_callback_slot *slot = (_nfc_callback_slot *)data;
+
+	return pool != NULL && slot >= pool->slots && slot < pool->slots + pool->capacity;
+}
+
+_async_callback_data *_nfc_callback_pool_alloc(void)
+{
+	_nfc_callback_pool *pool = _nfc_callback_pool_get();
+	unsigned int old_head, new_head, index;
+	int in_use, high_water;
+	_nfc_callback_slot *slot;
+
+	if( pool == NULL )
+		return (_async_callback_data *)calloc(1, sizeof(_async_callback_data));
+
+	do {
+		old_head = pool->head;
+		index = old_head & _NFC_POOL_INDEX_MASK;
+		if( index == _NFC_POOL_NIL ){
+			__sync_fetch_and_add(&pool->exhausted, 1);
+			return (_async_callback_data *)calloc(1, sizeof(_async_callback_data));
+		}
+		slot = &pool->slots[index - 1];
+		new_head = (((old_head >> _NFC_POOL_GENERATION_SHIFT) + 1) << _NFC_POOL_GENERATION_SHIFT) | slot->next;
+	} while( !__sync_bool_compare_and_swap(&pool->head, old_head, new_head) );
+
+	in_use = __sync_add_and_fetch(&pool->in_use, 1);
+	do {
+		high_water = pool->high_water;
+		if( in_use <= high_water )
+			break;
+	} while( !__sync_bool_compare_and_swap(&pool->high_water, high_water, in_use) );
+
+	memset(&slot->data, 0, sizeof(slot->data));
+	return &slot->data;
+}
+
+void _nfc_callback_pool_free(_async_callback_data *data)
+{
+	_nfc_callback_pool *pool = g_nfc_callback_pool;
+	_nfc_callback_slot *slot = (_nfc_callback_slot *)data;
+	unsigned int old_head, new_head, index;
+
+	if( data == NULL )
+		return;
+
+	if( !_nfc_callback_pool_owns(pool, data) ){
+		free(data);
+		return;
+	}
+
+	/* drop the count first so in_use never exceeds the capacity */
+	__sync_sub_and_fetch(&pool->in_use, 1);
+
+	index = (slot - pool->slots) + 1;
+	do {
+		old_head = pool->head;
+		slot->next = old_head & _NFC_POOL_INDEX_MASK;
+		new_head = (((old_head >> _NFC_POOL_GENERATION_SHIFT) + 1) << _NFC_POOL_GENERATION_SHIFT) | index;
+	} while( !__sync_bool_compare_and_swap(&pool->head, old_head, new_head) );
+}
+
+int nfc_manager_set_callback_pool_size(int size)
+{
+	_nfc_callback_pool *old_pool;
+	_nfc_callback_pool *new_pool;
+
+	if( size <= 0 || size > NFC_CALLBACK_POOL_MAX_SIZE ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	old_pool = g_nfc_callback_pool;
+	if( old_pool != NULL && old_pool->in_use != 0 ){
+		NFC_LOGE("[%s] %d contexts still in flight", __func__, old_pool->in_use);
+		return NFC_ERROR_DEVICE_BUSY;
+	}
+
+	new_pool = _nfc_callback_pool_create(size);
+	if( new_pool == NULL ){
+		NFC_LOGE("[%s] OUT_OF_MEMORY (0x%08x)", __func__, NFC_ERROR_OUT_OF_MEMORY);
+		return NFC_ERROR_OUT_OF_MEMORY;
+	}
+
+	if( !__sync_bool_compare_and_swap(&g_nfc_callback_pool, old_pool, new_pool) ){
+		_nfc_callback_pool_destroy(new_pool);
+		return NFC_ERROR_DEVICE_BUSY;
+	}
+
+	_nfc_callback_pool_destroy(old_pool);
+	return NFC_ERROR_NONE;
+}
+
+int nfc_manager_get_callback_pool_stats(nfc_callback_pool_stats_s *stats)
+{
+	_nfc_callback_pool *pool;
+
+	if( stats == NULL ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	pool = _nfc_callback_pool_get();
+	if( pool == NULL )
+		return NFC_ERROR_OUT_OF_MEMORY;
+
+	stats->capacity = pool->capacity;
+	stats->in_use = pool->in_use;
+	stats->high_water = pool->high_water;
+	stats->exhausted = pool->exhausted;
+
+	return NFC_ERROR_NONE;
+}
@@ -0,0 +1,283 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <nfc.h>
+#include <nfc_private.h>
+
+/*
+ * Table of the tags currently attached, keyed by target handle. The most
+ * recently attached tag is at the head and is the one reported by
+ * nfc_manager_get_connected_tag(). Pending operations stay in the pending
+ * table keyed by the same handle and are failed when the session detaches.
+ */
+
+typedef struct {
+	pthread_mutex_t lock;
+	_nfc_tag_session_s *head;
+} _nfc_tag_session_table;
+
+static _nfc_tag_session_table g_nfc_tag_sessions = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static int _nfc_tag_info_compare(const void *a, const void *b)
+{
+	const net_nfc_tag_info_s *left = *(const net_nfc_tag_info_s * const *)a;
+	const net_nfc_tag_info_s *right = *(const net_nfc_tag_info_s * const *)b;
+	int diff = strcmp(left->key, right->key);
+
+	/* keep duplicated keys in list order, the lookup returns the first one */
+	if( diff == 0 )
+		diff = (left > right) - (left < right);
+	return diff;
+}
+
+/*
+ * Packs a tag information list into one allocation: the list itself, a
+ * data_s for every value, the lookup index sorted by key, then the key
+ * strings and value bytes. The list the daemon hands out is only valid
+ * during the event callback, so it has to be copied there, but the copy
+ * costs one allocation and one free.
+ */
+static net_nfc_tag_info_s * _nfc_tag_info_list_pack(const net_nfc_tag_info_s *list, int count, net_nfc_tag_info_s ***index, int *index_size)
+{
+	net_nfc_tag_info_s *packed;
+	net_nfc_tag_info_s **sorted;
+	data_s *values;
+	char *cursor;
+	size_t size;
+	int i, keys = 0;
+
+	*index = NULL;
+	*index_size = 0;
+
+	if( list == NULL || count <= 0 )
+		return NULL;
+
+	size = count * (sizeof(net_nfc_tag_info_s) + sizeof(data_s) + sizeof(net_nfc_tag_info_s *));
+	for( i = 0; i < count; i++ ){
+		if( list[i].key )
+			size += strlen(list[i].key) + 1;
+		if( list[i].value )
+			size += ((data_s*)list[i].value)->length;
+	}
+
+	packed = (net_nfc_tag_info_s *)malloc(size);
+	if( packed == NULL )
+		return NULL;
+
+	values = (data_s *)(packed + count);
+	sorted = (net_nfc_tag_info_s **)(values + count);
+	cursor = (char *)(sorted + count);
+
+	for( i = 0; i < count; i++ ){
+		packed[i].key = NULL;
+		packed[i].value = NULL;
+
+		if( list[i].key ){
+			size_t length = strlen(list[i].key) + 1;
+
+			memcpy(cursor, list[i].key, length);
+			packed[i].key = cursor;
+			cursor += length;
+			sorted[keys++] = &packed[i];
+		}
+
+		if( list[i].value ){
+			data_s *value = (data_s*)list[i].value;
+
+			values[i].buffer = (uint8_t *)cursor;
+			values[i].length = value->length;
+			if( value->length > 0 )
+				memcpy(cursor, value->buffer, value->length);
+			cursor += value->length;
+			packed[i].value = (data_h)&values[i];
+		}
+	}
+
+	qsort(sorted, keys, sizeof(net_nfc_tag_info_s *), _nfc_tag_info_compare);
+	*index = sorted;
+	*index_size = keys;
+
+	return packed;
+}
+
+/* called with the table locked */
+static _nfc_tag_session_s * _nfc_tag_session_unlink(net_nfc_target_handle_h handle)
+{
+	_nfc_tag_session_s **link;
+	_nfc_tag_session_s *session;
+
+	for( link = &g_nfc_tag_sessions.head; *link != NULL; link = &(*link)->next ){
+		if( (*link)->info.handle == handle ){
+			session = *link;
+			*link = session->next;
+			session->next = NULL;
+			session->attached = false;
+			return session;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * Creates the session of a newly attached tag. GET_CURRENT_TAG_INFO may
+ * report a tag which is already attached, its old session is then
+ * replaced; handles retained on it stay valid but are detached.
+ */
+_nfc_tag_session_s * _nfc_tag_session_attach(const net_nfc_target_info_s *target_info)
+{
+	_nfc_tag_session_s *session;
+	_nfc_tag_session_s *old;
+
+	session = (_nfc_tag_session_s *)calloc(1, sizeof(_nfc_tag_session_s));
+	if( session == NULL ){
+		NFC_LOGE("[%s] OUT_OF_MEMORY (0x%08x)", __func__, NFC_ERROR_OUT_OF_MEMORY);
+		return NULL;
+	}
+
+	session->info = *target_info;
+	session->info.keylist = NULL;
+	session->info.tag_info_list = _nfc_tag_info_list_pack(target_info->tag_info_list, target_info->number_of_keys,
+			&session->index, &session->index_size);
+	if( session->info.tag_info_list == NULL )
+		session->info.number_of_keys = 0;
+	session->refcount = 1;
+	session->attached = true;
+
+	pthread_mutex_lock(&g_nfc_tag_sessions.lock);
+	old = _nfc_tag_session_unlink(target_info->handle);
+	session->next = g_nfc_tag_sessions.head;
+	g_nfc_tag_sessions.head = session;
+	pthread_mutex_unlock(&g_nfc_tag_sessions.lock);
+
+	if( old != NULL )
+		_nfc_tag_session_unref(old);
+
+	return session;
+}
+
+/*
+ * Removes a session from the table and hands the table's reference to the
+ * caller. The detach event of a daemon which does not report the handle
+ * removes the most recently attached tag.
+ */
+_nfc_tag_session_s * _nfc_tag_session_detach(net_nfc_target_handle_h handle)
+{
+	_nfc_tag_session_s *session = NULL;
+
+	pthread_mutex_lock(&g_nfc_tag_sessions.lock);
+	if( handle != NULL )
+		session = _nfc_tag_session_unlink(handle);
+	if( session == NULL && g_nfc_tag_sessions.head != NULL )
+		session = _nfc_tag_session_unlink(g_nfc_tag_sessions.head->info.handle);
+	pthread_mutex_unlock(&g_nfc_tag_sessions.lock);
+
+	return session;
+}
+
+void _nfc_tag_session_detach_all(void)
+{
+	_nfc_tag_session_s *session;
+	_nfc_tag_session_s *next;
+
+	pthread_mutex_lock(&g_nfc_tag_sessions.lock);
+	session = g_nfc_tag_sessions.head;
+	g_nfc_tag_sessions.head = NULL;
+	pthread_mutex_unlock(&g_nfc_tag_sessions.lock);
+
+	for( ; session != NULL; session = next ){
+		next = session->next;
+		session->next = NULL;
+		session->attached = false;
+		_nfc_tag_session_unref(session);
+	}
+}
+
+/* returns a reference, the session could otherwise be freed by a detach as soon as the lock is released */
+_nfc_tag_session_s * _nfc_tag_session_current(void)
+{
+	_nfc_tag_session_s *session;
+
+	pthread_mutex_lock(&g_nfc_tag_sessions.lock);
+	session = g_nfc_tag_sessions.head;
+	if( session != NULL )
+		__sync_fetch_and_add(&session->refcount, 1);
+	pthread_mutex_unlock(&g_nfc_tag_sessions.lock);
+
+	return session;
+}
+
+void _nfc_tag_session_unref(_nfc_tag_session_s *session)
+{
+	if( __sync_sub_and_fetch(&session->refcount, 1) != 0 )
+		return;
+
+	free(session->info.tag_info_list);
+	if( session->info.keylist != NULL )
+		free(session->info.keylist);
+	free(session);
+}
+
+/* lower bound on the sorted keys, so duplicated keys resolve to the first one in list order */
+const net_nfc_tag_info_s * _nfc_tag_session_lookup(const _nfc_tag_session_s *session, const char *key)
+{
+	int low = 0, high = session->index_size;
+
+	while( low < high ){
+		int mid = low + (high - low) / 2;
+
+		if( strcmp(session->index[mid]->key, key) < 0 )
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	if( low < session->index_size && strcmp(session->index[low]->key, key) == 0 )
+		return session->index[low];
+
+	return NULL;
+}
+
+int nfc_tag_retain(nfc_tag_h tag)
+{
+	_nfc_tag_session_s *session = (_nfc_tag_session_s *)tag;
+
+	if( session == NULL ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	__sync_fetch_and_add(&session->refcount, 1);
+	return NFC_ERROR_NONE;
+}
+
+int nfc_tag_release(nfc_tag_h tag)
+{
+	_nfc_tag_session_s *session = (_nfc_tag_session_s *)tag;
+
+	if( session == NULL ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	_nfc_tag_session_unref(session);
+	return NFC_ERROR_NONE;
+}
@@ -0,0 +1,425 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <nfc.h>
+#include <nfc_private.h>
+
+/*
+ * Latency histograms per daemon message.
+ *
+ * The response handler stamps the arrival of every message on its thread;
+ * a response to a tag operation adds the time the operation was issued.
+ * Closures carry the stamp when they are deferred, so the callback stage
+ * is measured wherever the callback runs.
+ *
+ * Buckets are log-linear like HDR histograms: 16 per power of two, which
+ * keeps every value within 1/16 of its bucket. Writers only increment
+ * counters atomically. Readers never clear them; reset and the periodic
+ * snapshot keep a copy of the counters as their base and report the
+ * difference, so no sample is lost or counted twice while events arrive.
+ */
+
+#define _NFC_STATS_MESSAGE_MAX	64
+#define _NFC_STATS_SUB_BITS	4
+#define _NFC_STATS_SUB_COUNT	(1 << _NFC_STATS_SUB_BITS)
+#define _NFC_STATS_MAX_EXPONENT	40	/* about 18 minutes, longer samples go to the last bucket */
+#define _NFC_STATS_BUCKETS	((_NFC_STATS_MAX_EXPONENT - _NFC_STATS_SUB_BITS + 2) * _NFC_STATS_SUB_COUNT)
+
+enum {
+	_NFC_STATS_RESPONSE,
+	_NFC_STATS_DISPATCH,
+	_NFC_STATS_CALLBACK,
+	_NFC_STATS_STAGES
+};
+
+typedef struct {
+	volatile unsigned int counts[_NFC_STATS_BUCKETS];
+	volatile unsigned long long sum;
+} _nfc_stats_histogram_s;
+
+typedef struct {
+	_nfc_stats_histogram_s stages[_NFC_STATS_STAGES];
+} _nfc_stats_message_s;
+
+static struct {
+	_nfc_stats_message_s * volatile messages[_NFC_STATS_MESSAGE_MAX];
+
+	pthread_mutex_t lock;	/* the bases and the snapshot timer */
+	_nfc_stats_message_s *reset_base[_NFC_STATS_MESSAGE_MAX];
+	_nfc_stats_message_s *snapshot_base[_NFC_STATS_MESSAGE_MAX];
+	_nfc_callback_cell on_snapshot;
+} g_nfc_stats = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static __thread _nfc_stats_stamp_s g_nfc_stats_current = { .message = -1 };
+
+static const char * const _nfc_stats_names[] = {
+	[NET_NFC_MESSAGE_TRANSCEIVE] = "TRANSCEIVE",
+	[NET_NFC_MESSAGE_READ_NDEF] = "READ_NDEF",
+	[NET_NFC_MESSAGE_WRITE_NDEF] = "WRITE_NDEF",
+	[NET_NFC_MESSAGE_TAG_DISCOVERED] = "TAG_DISCOVERED",
+	[NET_NFC_MESSAGE_TAG_DETACHED] = "TAG_DETACHED",
+	[NET_NFC_MESSAGE_P2P_DISCOVERED] = "P2P_DISCOVERED",
+	[NET_NFC_MESSAGE_P2P_DETACHED] = "P2P_DETACHED",
+	[NET_NFC_MESSAGE_P2P_SEND] = "P2P_SEND",
+	[NET_NFC_MESSAGE_P2P_RECEIVE] = "P2P_RECEIVE",
+	[NET_NFC_MESSAGE_FORMAT_NDEF] = "FORMAT_NDEF",
+	[NET_NFC_MESSAGE_CONNECTION_HANDOVER] = "CONNECTION_HANDOVER",
+	[NET_NFC_MESSAGE_IS_TAG_CONNECTED] = "IS_TAG_CONNECTED",
+	[NET_NFC_MESSAGE_GET_CURRENT_TAG_INFO] = "GET_CURRENT_TAG_INFO",
+	[NET_NFC_MESSAGE_GET_CURRENT_TARGET_HANDLE] = "GET_CURRENT_TARGET_HANDLE",
+	[NET_NFC_MESSAGE_INIT] = "INIT",
+	[NET_NFC_MESSAGE_DEINIT] = "DEINIT",
+	[NET_NFC_MESSAGE_SE_START_TRANSACTION] = "SE_START_TRANSACTION",
+	[NET_NFC_MESSAGE_SE_END_TRANSACTION] = "SE_END_TRANSACTION",
+	[NET_NFC_MESSAGE_SE_TYPE_TRANSACTION] = "SE_TYPE_TRANSACTION",
+	[NET_NFC_MESSAGE_SE_CONNECTIVITY] = "SE_CONNECTIVITY",
+	[NET_NFC_MESSAGE_SE_FIELD_ON] = "SE_FIELD_ON",
+	[NET_NFC_MESSAGE_SE_FIELD_OFF] = "SE_FIELD_OFF",
+};
+
+unsigned long long _nfc_stats_now(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long long)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static int _nfc_stats_bucket(unsigned long long ns)
+{
+	int exponent;
+
+	if( ns < _NFC_STATS_SUB_COUNT )
+		return (int)ns;
+
+	exponent = 63 - __builtin_clzll(ns);
+	if( exponent > _NFC_STATS_MAX_EXPONENT )
+		return _NFC_STATS_BUCKETS - 1;
+
+	return (exponent - _NFC_STATS_SUB_BITS + 1) * _NFC_STATS_SUB_COUNT + (int)((ns >> (exponent - _NFC_STATS_SUB_BITS)) & (_NFC_STATS_SUB_COUNT - 1));
+}
+
+/* the smallest value of the bucket */
+static unsigned long long _nfc_stats_bucket_low(int bucket)
+{
+	int shift;
+
+	if( bucket < _NFC_STATS_SUB_COUNT )
+		return bucket;
+
+	shift = bucket / _NFC_STATS_SUB_COUNT - 1;
+	return (unsigned long long)(_NFC_STATS_SUB_COUNT + bucket % _NFC_STATS_SUB_COUNT) << shift;
+}
+
+/* the largest value of the bucket */
+static unsigned long long _nfc_stats_bucket_high(int bucket)
+{
+	if( bucket < _NFC_STATS_SUB_COUNT )
+		return bucket;
+
+	return _nfc_stats_bucket_low(bucket) + (1ULL << (bucket / _NFC_STATS_SUB_COUNT - 1)) - 1;
+}
+
+static _nfc_stats_message_s * _nfc_stats_message(int message)
+{
+	_nfc_stats_message_s *stats = g_nfc_stats.messages[message];
+
+	if( stats != NULL )
+		return stats;
+
+	/* installed on first use, the loser of a race frees its copy */
+	stats = (_nfc_stats_message_s *)calloc(1, sizeof(_nfc_stats_message_s));
+	if( stats == NULL )
+		return NULL;
+
+	if( !__sync_bool_compare_and_swap(&g_nfc_stats.messages[message], NULL, stats) ){
+		free(stats);
+		stats = g_nfc_stats.messages[message];
+	}
+	return stats;
+}
+
+static void _nfc_stats_record(int message, int stage, unsigned long long ns)
+{
+	_nfc_stats_message_s *stats;
+
+	if( message < 0 || message >= _NFC_STATS_MESSAGE_MAX )
+		return;
+
+	stats = _nfc_stats_message(message);
+	if( stats == NULL )
+		return;
+
+	__sync_fetch_and_add(&stats->stages[stage].counts[_nfc_stats_bucket(ns)], 1);
+	__sync_fetch_and_add(&stats->stages[stage].sum, ns);
+}
+
+void _nfc_stats_event_begin(int message, _nfc_stats_stamp_s *saved)
+{
+	*saved = g_nfc_stats_current;
+
+	g_nfc_stats_current.message = message;
+	g_nfc_stats_current.arrived = _nfc_stats_now();
+	g_nfc_stats_current.issued = 0;
+}
+
+void _nfc_stats_event_end(const _nfc_stats_stamp_s *saved)
+{
+	_nfc_stats_record(g_nfc_stats_current.message, _NFC_STATS_DISPATCH, _nfc_stats_now() - g_nfc_stats_current.arrived);
+	g_nfc_stats_current = *saved;
+}
+
+void _nfc_stats_request_answered(unsigned long long issued)
+{
+	if( g_nfc_stats_current.message < 0 || issued == 0 )
+		return;
+
+	g_nfc_stats_current.issued = issued;
+	_nfc_stats_record(g_nfc_stats_current.message, _NFC_STATS_RESPONSE, g_nfc_stats_current.arrived - issued);
+}
+
+void _nfc_stats_stamp_get(_nfc_stats_stamp_s *stamp)
+{
+	*stamp = g_nfc_stats_current;
+}
+
+void _nfc_stats_callback_done(const _nfc_stats_stamp_s *stamp)
+{
+	if( stamp == NULL )
+		stamp = &g_nfc_stats_current;
+	if( stamp->message < 0 )
+		return;
+
+	_nfc_stats_record(stamp->message, _NFC_STATS_CALLBACK, _nfc_stats_now() - (stamp->issued != 0 ? stamp->issued : stamp->arrived));
+}
+
+/* called with the lock held, a base is kept for every message which has counters */
+static bool _nfc_stats_base_get(_nfc_stats_message_s **bases, int message, _nfc_stats_message_s **base)
+{
+	if( bases[message] == NULL ){
+		bases[message] = (_nfc_stats_message_s *)calloc(1, sizeof(_nfc_stats_message_s));
+		if( bases[message] == NULL )
+			return false;
+	}
+
+	*base = bases[message];
+	return true;
+}
+
+static void _nfc_stats_summarize(const _nfc_stats_histogram_s *histogram, _nfc_stats_histogram_s *base, bool advance, nfc_latency_stats_s *latency)
+{
+	unsigned int counts[_NFC_STATS_BUCKETS];
+	unsigned long long count = 0, seen = 0, sum;
+	unsigned long long p50, p90, p99, p999;
+	int i;
+
+	memset(latency, 0, sizeof(*latency));
+
+	for( i = 0; i < _NFC_STATS_BUCKETS; i++ ){
+		counts[i] = histogram->counts[i] - base->counts[i];
+		count += counts[i];
+	}
+	sum = histogram->sum - base->sum;
+
+	if( advance ){
+		for( i = 0; i < _NFC_STATS_BUCKETS; i++ )
+			base->counts[i] += counts[i];
+		base->sum += sum;
+	}
+
+	if( count == 0 )
+		return;
+
+	latency->count = count;
+	latency->mean_ns = sum / count;
+
+	/* the rank of each percentile, rounded up so that p999 of a small count is its maximum */
+	p50 = (count * 500 + 999) / 1000;
+	p90 = (count * 900 + 999) / 1000;
+	p99 = (count * 990 + 999) / 1000;
+	p999 = (count * 999 + 999) / 1000;
+
+	for( i = 0; i < _NFC_STATS_BUCKETS; i++ ){
+		if( counts[i] == 0 )
+			continue;
+
+		if( seen == 0 )
+			latency->min_ns = _nfc_stats_bucket_low(i);
+		seen += counts[i];
+
+		if( latency->p50_ns == 0 && seen >= p50 )
+			latency->p50_ns = _nfc_stats_bucket_high(i);
+		if( latency->p90_ns == 0 && seen >= p90 )
+			latency->p90_ns = _nfc_stats_bucket_high(i);
+		if( latency->p99_ns == 0 && seen >= p99 )
+			latency->p99_ns = _nfc_stats_bucket_high(i);
+		if( latency->p999_ns == 0 && seen >= p999 )
+			latency->p999_ns = _nfc_stats_bucket_high(i);
+		latency->max_ns = _nfc_stats_bucket_high(i);
+	}
+}
+
+/* called with the lock held, fills the messages with samples since their base and returns their number */
+static int _nfc_stats_collect(_nfc_stats_message_s **bases, bool advance, nfc_message_stats_s *stats)
+{
+	_nfc_stats_message_s *message_stats;
+	_nfc_stats_message_s *base;
+	int message, count = 0;
+
+	for( message = 0; message < _NFC_STATS_MESSAGE_MAX; message++ ){
+		message_stats = g_nfc_stats.messages[message];
+		if( message_stats == NULL || !_nfc_stats_base_get(bases, message, &base) )
+			continue;
+
+		stats[count].message = message;
+		stats[count].name = message < (int)(sizeof(_nfc_stats_names) / sizeof(_nfc_stats_names[0])) && _nfc_stats_names[message] != NULL ?
+			_nfc_stats_names[message] : "UNKNOWN";
+		_nfc_stats_summarize(&message_stats->stages[_NFC_STATS_RESPONSE], &base->stages[_NFC_STATS_RESPONSE], advance, &stats[count].response);
+		_nfc_stats_summarize(&message_stats->stages[_NFC_STATS_DISPATCH], &base->stages[_NFC_STATS_DISPATCH], advance, &stats[count].dispatch);
+		_nfc_stats_summarize(&message_stats->stages[_NFC_STATS_CALLBACK], &base->stages[_NFC_STATS_CALLBACK], advance, &stats[count].callback);
+		count++;
+	}
+
+	return count;
+}
+
+int nfc_manager_get_stats(nfc_message_stats_s **stats, int *count)
+{
+	nfc_message_stats_s *collected;
+
+	if( stats == NULL || count == NULL ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	collected = (nfc_message_stats_s *)calloc(_NFC_STATS_MESSAGE_MAX, sizeof(nfc_message_stats_s));
+	if( collected == NULL ){
+		NFC_LOGE("[%s] OUT_OF_MEMORY (0x%08x)", __func__, NFC_ERROR_OUT_OF_MEMORY);
+		return NFC_ERROR_OUT_OF_MEMORY;
+	}
+
+	pthread_mutex_lock(&g_nfc_stats.lock);
+	*count = _nfc_stats_collect(g_nfc_stats.reset_base, false, collected);
+	pthread_mutex_unlock(&g_nfc_stats.lock);
+
+	*stats = collected;
+	return NFC_ERROR_NONE;
+}
+
+int nfc_manager_reset_stats(void)
+{
+	nfc_message_stats_s *discarded;
+
+	discarded = (nfc_message_stats_s *)calloc(_NFC_STATS_MESSAGE_MAX, sizeof(nfc_message_stats_s));
+	if( discarded == NULL ){
+		NFC_LOGE("[%s] OUT_OF_MEMORY (0x%08x)", __func__, NFC_ERROR_OUT_OF_MEMORY);
+		return NFC_ERROR_OUT_OF_MEMORY;
+	}
+
+	pthread_mutex_lock(&g_nfc_stats.lock);
+	_nfc_stats_collect(g_nfc_stats.reset_base, true, discarded);
+	pthread_mutex_unlock(&g_nfc_stats.lock);
+
+	free(discarded);
+	return NFC_ERROR_NONE;
+}
+
+static void _nfc_stats_snapshot_run(const _nfc_closure_s *closure)
+{
+	((nfc_stats_snapshot_cb)closure->callback)((const nfc_message_stats_s *)closure->buffer, closure->arg, closure->user_data);
+}
+
+/* on the timer thread, the callback is delivered like the callbacks of events */
+static void _nfc_stats_snapshot_tick(void)
+{
+	nfc_message_stats_s stats[_NFC_STATS_MESSAGE_MAX];
+	const _nfc_callback_s *cb;
+	_nfc_closure_s closure;
+	unsigned int epoch;
+	int count;
+
+	pthread_mutex_lock(&g_nfc_stats.lock);
+	count = _nfc_stats_collect(g_nfc_stats.snapshot_base, true, stats);
+	pthread_mutex_unlock(&g_nfc_stats.lock);
+
+	epoch = _nfc_callback_read_lock();
+	cb = _nfc_callback_get(&g_nfc_stats.on_snapshot);
+	if( cb != NULL ){
+		memset(&closure, 0, sizeof(closure));
+		closure.run = _nfc_stats_snapshot_run;
+		closure.callback = cb->callback;
+		closure.user_data = cb->user_data;
+		closure.arg = count;
+		closure.buffer = (const unsigned char *)stats;
+		closure.buffer_size = count * sizeof(nfc_message_stats_s);
+		_nfc_executor_dispatch(NULL, &closure);
+	}
+	_nfc_callback_read_unlock(epoch);
+}
+
+static _nfc_timer_s g_nfc_stats_snapshot_timer = {
+	.run = _nfc_stats_snapshot_tick,
+};
+
+int nfc_manager_set_stats_snapshot_cb(int interval_ms, nfc_stats_snapshot_cb callback, void *user_data)
+{
+	nfc_message_stats_s *discarded;
+	int ret;
+
+	if( interval_ms <= 0 || callback == NULL ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	discarded = (nfc_message_stats_s *)calloc(_NFC_STATS_MESSAGE_MAX, sizeof(nfc_message_stats_s));
+	if( discarded == NULL ){
+		NFC_LOGE("[%s] OUT_OF_MEMORY (0x%08x)", __func__, NFC_ERROR_OUT_OF_MEMORY);
+		return NFC_ERROR_OUT_OF_MEMORY;
+	}
+
+	ret = _nfc_callback_set(&g_nfc_stats.on_snapshot, callback, user_data);
+	if( ret != NFC_ERROR_NONE ){
+		free(discarded);
+		return ret;
+	}
+
+	pthread_mutex_lock(&g_nfc_stats.lock);
+	/* the first interval starts now */
+	_nfc_stats_collect(g_nfc_stats.snapshot_base, true, discarded);
+	ret = _nfc_timer_arm(&g_nfc_stats_snapshot_timer, interval_ms);
+	pthread_mutex_unlock(&g_nfc_stats.lock);
+
+	free(discarded);
+	if( ret != NFC_ERROR_NONE )
+		_nfc_callback_set(&g_nfc_stats.on_snapshot, NULL, NULL);
+	return ret;
+}
+
+void nfc_manager_unset_stats_snapshot_cb(void)
+{
+	pthread_mutex_lock(&g_nfc_stats.lock);
+	_nfc_timer_disarm(&g_nfc_stats_snapshot_timer);
+	pthread_mutex_unlock(&g_nfc_stats.lock);
+
+	_nfc_callback_set(&g_nfc_stats.on_snapshot, NULL, NULL);
+}
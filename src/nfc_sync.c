@@ -0,0 +1,321 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <nfc.h>
+#include <nfc_private.h>
+
+/*
+ * Blocking variants of the tag operations.
+ *
+ * The caller sleeps on the done word of the request with a futex until
+ * the completion callback sets it. A caller whose deadline passes cancels
+ * the operation; when that succeeds the callback will never run. When it
+ * fails the completion is already on its way, but it may be queued to a
+ * thread which does not get to run it, so it is only waited for a little
+ * longer before the caller gives up.
+ *
+ * The request is therefore allocated and held by the caller and by the
+ * callback, the last of them to let go frees it along with a response
+ * nobody took.
+ */
+
+/* how long a completion that could not be cancelled is waited for past the deadline */
+#define _NFC_SYNC_GRACE_MS	100
+
+typedef struct {
+	volatile int done;	/* futex word, 1 once the callback has run */
+	volatile int refcount;	/* the caller and the callback */
+	int result;
+	unsigned char *buffer;
+	int buffer_size;
+	nfc_ndef_message_h message;
+} _nfc_sync_request_s;
+
+static _nfc_sync_request_s * _nfc_sync_request_new(void)
+{
+	_nfc_sync_request_s *request;
+
+	request = (_nfc_sync_request_s *)calloc(1, sizeof(_nfc_sync_request_s));
+	if( request == NULL ){
+		NFC_LOGE("[%s] OUT_OF_MEMORY (0x%08x)", __func__, NFC_ERROR_OUT_OF_MEMORY);
+		return NULL;
+	}
+
+	request->refcount = 2;
+	return request;
+}
+
+static void _nfc_sync_request_release(_nfc_sync_request_s *request)
+{
+	if( __sync_sub_and_fetch(&request->refcount, 1) != 0 )
+		return;
+
+	free(request->buffer);
+	if( request->message != NULL )
+		_nfc_closure_ndef_message_free(request->message);
+	free(request);
+}
+
+/* the operation was not issued or was cancelled, the callback will never run */
+static void _nfc_sync_request_free(_nfc_sync_request_s *request)
+{
+	request->refcount = 1;
+	_nfc_sync_request_release(request);
+}
+
+static void _nfc_sync_complete(_nfc_sync_request_s *request, int result)
+{
+	request->result = result;
+	__sync_synchronize();
+	request->done = 1;
+
+	/* the waiter still holds its reference, the request is there to wake */
+	syscall(SYS_futex, &request->done, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+	_nfc_sync_request_release(request);
+}
+
+static void _nfc_sync_futex_wait(_nfc_sync_request_s *request, const struct timespec *timeout)
+{
+	syscall(SYS_futex, &request->done, FUTEX_WAIT_PRIVATE, 0, timeout, NULL, 0);
+}
+
+static void _nfc_sync_deadline(struct timespec *deadline, int timeout_ms)
+{
+	clock_gettime(CLOCK_MONOTONIC, deadline);
+	deadline->tv_sec += timeout_ms / 1000;
+	deadline->tv_nsec += (timeout_ms % 1000) * 1000000L;
+	if( deadline->tv_nsec >= 1000000000L ){
+		deadline->tv_sec++;
+		deadline->tv_nsec -= 1000000000L;
+	}
+}
+
+/* false once the deadline has passed */
+static bool _nfc_sync_wait_until(_nfc_sync_request_s *request, const struct timespec *deadline)
+{
+	struct timespec now, remaining;
+
+	while( !request->done ){
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		remaining.tv_sec = deadline->tv_sec - now.tv_sec;
+		remaining.tv_nsec = deadline->tv_nsec - now.tv_nsec;
+		if( remaining.tv_nsec < 0 ){
+			remaining.tv_sec--;
+			remaining.tv_nsec += 1000000000L;
+		}
+
+		if( remaining.tv_sec < 0 )
+			return false;
+
+		_nfc_sync_futex_wait(request, &remaining);
+	}
+
+	return true;
+}
+
+/*
+ * On NFC_ERROR_NONE the response of the request belongs to the caller,
+ * who releases the request in any case. On NFC_ERROR_TIMED_OUT a late
+ * completion frees what it delivers.
+ */
+static int _nfc_sync_wait(_nfc_sync_request_s *request, int timeout_ms)
+{
+	struct timespec deadline;
+	int request_id = -1;
+
+	nfc_tag_get_last_request_id(&request_id);
+
+	_nfc_sync_deadline(&deadline, timeout_ms);
+	if( !_nfc_sync_wait_until(request, &deadline) ){
+		if( nfc_tag_cancel(request_id) == NFC_ERROR_NONE ){
+			/* drops the reference of the callback, it will not run */
+			_nfc_sync_request_release(request);
+			NFC_LOGW("[%s] request %d timed out (0x%08x)", __func__, request_id, NFC_ERROR_TIMED_OUT);
+			return NFC_ERROR_TIMED_OUT;
+		}
+
+		_nfc_sync_deadline(&deadline, _NFC_SYNC_GRACE_MS);
+		if( !_nfc_sync_wait_until(request, &deadline) ){
+			NFC_LOGW("[%s] request %d timed out, its completion is left behind (0x%08x)", __func__, request_id, NFC_ERROR_TIMED_OUT);
+			return NFC_ERROR_TIMED_OUT;
+		}
+	}
+
+	__sync_synchronize();
+	return request->result;
+}
+
+static int _nfc_sync_check(const char *func, nfc_tag_h tag, int timeout_ms)
+{
+	if( tag == NULL || timeout_ms <= 0 ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", func, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	/* the completion would have to be delivered by the thread waiting for it */
+	if( _nfc_is_dispatch_thread() ){
+		NFC_LOGE("[%s] called from a callback (0x%08x)", func, NFC_ERROR_OPERATION_FAILED);
+		return NFC_ERROR_OPERATION_FAILED;
+	}
+
+	return NFC_ERROR_NONE;
+}
+
+static void _nfc_sync_on_transceive(nfc_error_e result, unsigned char *buffer, int buffer_size, void *user_data)
+{
+	_nfc_sync_request_s *request = (_nfc_sync_request_s *)user_data;
+
+	if( result == NFC_ERROR_NONE && buffer != NULL && buffer_size > 0 ){
+		request->buffer = (unsigned char *)malloc(buffer_size);
+		if( request->buffer == NULL )
+			result = NFC_ERROR_OUT_OF_MEMORY;
+		else {
+			memcpy(request->buffer, buffer, buffer_size);
+			request->buffer_size = buffer_size;
+		}
+	}
+
+	_nfc_sync_complete(request, result);
+}
+
+static void _nfc_sync_on_read(nfc_error_e result, nfc_ndef_message_h message, void *user_data)
+{
+	_nfc_sync_request_s *request = (_nfc_sync_request_s *)user_data;
+
+	/* the message of the callback only lives until it returns */
+	if( result == NFC_ERROR_NONE && message != NULL ){
+		request->message = (nfc_ndef_message_h)_nfc_closure_ndef_message_copy(message);
+		if( request->message == NULL )
+			result = NFC_ERROR_OUT_OF_MEMORY;
+	}
+
+	_nfc_sync_complete(request, result);
+}
+
+static void _nfc_sync_on_result(nfc_error_e result, void *user_data)
+{
+	_nfc_sync_complete((_nfc_sync_request_s *)user_data, result);
+}
+
+int nfc_tag_transceive_sync(nfc_tag_h tag, unsigned char *buffer, int buffer_size, int timeout_ms, unsigned char **response, int *response_size)
+{
+	_nfc_sync_request_s *request;
+	int ret;
+
+	if( response == NULL || response_size == NULL ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	ret = _nfc_sync_check(__func__, tag, timeout_ms);
+	if( ret != NFC_ERROR_NONE )
+		return ret;
+
+	request = _nfc_sync_request_new();
+	if( request == NULL )
+		return NFC_ERROR_OUT_OF_MEMORY;
+
+	ret = nfc_tag_transceive(tag, buffer, buffer_size, _nfc_sync_on_transceive, request);
+	if( ret != NFC_ERROR_NONE ){
+		_nfc_sync_request_free(request);
+		return ret;
+	}
+
+	ret = _nfc_sync_wait(request, timeout_ms);
+	if( ret == NFC_ERROR_NONE ){
+		*response = request->buffer;
+		*response_size = request->buffer_size;
+		request->buffer = NULL;
+	}
+
+	_nfc_sync_request_release(request);
+	return ret;
+}
+
+int nfc_tag_read_ndef_sync(nfc_tag_h tag, int timeout_ms, nfc_ndef_message_h *ndef_message)
+{
+	_nfc_sync_request_s *request;
+	int ret;
+
+	if( ndef_message == NULL ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	ret = _nfc_sync_check(__func__, tag, timeout_ms);
+	if( ret != NFC_ERROR_NONE )
+		return ret;
+
+	request = _nfc_sync_request_new();
+	if( request == NULL )
+		return NFC_ERROR_OUT_OF_MEMORY;
+
+	ret = nfc_tag_read_ndef(tag, _nfc_sync_on_read, request);
+	if( ret != NFC_ERROR_NONE ){
+		_nfc_sync_request_free(request);
+		return ret;
+	}
+
+	ret = _nfc_sync_wait(request, timeout_ms);
+	if( ret == NFC_ERROR_NONE ){
+		if( request->message == NULL ){
+			ret = NFC_ERROR_NO_NDEF_MESSAGE;
+		}
+		else {
+			*ndef_message = request->message;
+			request->message = NULL;
+		}
+	}
+
+	_nfc_sync_request_release(request);
+	return ret;
+}
+
+int nfc_tag_write_ndef_sync(nfc_tag_h tag, nfc_ndef_message_h msg, int timeout_ms)
+{
+	_nfc_sync_request_s *request;
+	int ret;
+
+	if( msg == NULL ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	ret = _nfc_sync_check(__func__, tag, timeout_ms);
+	if( ret != NFC_ERROR_NONE )
+		return ret;
+
+	request = _nfc_sync_request_new();
+	if( request == NULL )
+		return NFC_ERROR_OUT_OF_MEMORY;
+
+	ret = nfc_tag_write_ndef(tag, msg, _nfc_sync_on_result, request);
+	if( ret != NFC_ERROR_NONE ){
+		_nfc_sync_request_free(request);
+		return ret;
+	}
+
+	ret = _nfc_sync_wait(request, timeout_ms);
+	_nfc_sync_request_release(request);
+	return ret;
+}
@@ -0,0 +1,163 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <nfc.h>
+#include <nfc_private.h>
+
+/*
+ * Periodic timers of the library.
+ *
+ * They run on a thread of the library, so request timeouts and stats
+ * snapshots do not depend on anyone iterating the default GLib main
+ * context: a service polling nfc_manager_get_event_fd() or delivering
+ * callbacks to a context of its own may never do that. What the timers
+ * complete still goes through _nfc_executor_dispatch() like any event.
+ *
+ * The thread only exists while a timer is armed. There are few timers,
+ * all static, so they stay on the list once armed and the thread scans
+ * it for the next one due.
+ */
+
+static struct {
+	pthread_mutex_t lock;
+	pthread_cond_t changed;
+	pthread_once_t once;
+	_nfc_timer_s *timers;
+	bool running;
+} g_nfc_timers = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.once = PTHREAD_ONCE_INIT,
+};
+
+/* waits on CLOCK_MONOTONIC, like the deadlines */
+static void _nfc_timer_cond_init(void)
+{
+	pthread_condattr_t attr;
+
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&g_nfc_timers.changed, &attr);
+	pthread_condattr_destroy(&attr);
+}
+
+/* called with the lock held */
+static _nfc_timer_s * _nfc_timer_next(void)
+{
+	_nfc_timer_s *timer;
+	_nfc_timer_s *next = NULL;
+
+	for( timer = g_nfc_timers.timers; timer != NULL; timer = timer->next ){
+		if( timer->armed && (next == NULL || timer->due < next->due) )
+			next = timer;
+	}
+	return next;
+}
+
+static void * _nfc_timer_thread(void *arg)
+{
+	struct timespec due;
+	_nfc_timer_s *timer;
+	unsigned long long now;
+
+	pthread_mutex_lock(&g_nfc_timers.lock);
+
+	while( (timer = _nfc_timer_next()) != NULL ){
+		now = _nfc_stats_now();
+		if( timer->due > now ){
+			due.tv_sec = timer->due / 1000000000ULL;
+			due.tv_nsec = timer->due % 1000000000ULL;
+			pthread_cond_timedwait(&g_nfc_timers.changed, &g_nfc_timers.lock, &due);
+			continue;
+		}
+
+		/* a late tick is not repeated, the next one keeps the period from now */
+		timer->due = now + timer->interval;
+
+		/* callbacks run inline here block the timers, as on the event thread */
+		pthread_mutex_unlock(&g_nfc_timers.lock);
+		_nfc_dispatch_enter();
+		timer->run();
+		_nfc_dispatch_leave();
+		pthread_mutex_lock(&g_nfc_timers.lock);
+	}
+
+	g_nfc_timers.running = false;
+	pthread_mutex_unlock(&g_nfc_timers.lock);
+
+	return NULL;
+}
+
+int _nfc_timer_arm(_nfc_timer_s *timer, int interval_ms)
+{
+	_nfc_timer_s *each;
+	pthread_attr_t attr;
+	pthread_t thread;
+	int ret = NFC_ERROR_NONE;
+
+	pthread_once(&g_nfc_timers.once, _nfc_timer_cond_init);
+
+	pthread_mutex_lock(&g_nfc_timers.lock);
+
+	for( each = g_nfc_timers.timers; each != NULL && each != timer; each = each->next )
+		;
+	if( each == NULL ){
+		timer->next = g_nfc_timers.timers;
+		g_nfc_timers.timers = timer;
+	}
+
+	timer->interval = (unsigned long long)interval_ms * 1000000ULL;
+	timer->due = _nfc_stats_now() + timer->interval;
+	timer->armed = true;
+
+	if( g_nfc_timers.running ){
+		pthread_cond_signal(&g_nfc_timers.changed);
+	}
+	else {
+		pthread_attr_init(&attr);
+		pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+		if( pthread_create(&thread, &attr, _nfc_timer_thread, NULL) == 0 ){
+			g_nfc_timers.running = true;
+		}
+		else {
+			timer->armed = false;
+			ret = NFC_ERROR_OPERATION_FAILED;
+		}
+		pthread_attr_destroy(&attr);
+	}
+
+	pthread_mutex_unlock(&g_nfc_timers.lock);
+
+	if( ret != NFC_ERROR_NONE )
+		NFC_LOGE("[%s] OPERATION_FAILED (0x%08x) starting the timer thread", __func__, ret);
+	return ret;
+}
+
+void _nfc_timer_disarm(_nfc_timer_s *timer)
+{
+	pthread_once(&g_nfc_timers.once, _nfc_timer_cond_init);
+
+	pthread_mutex_lock(&g_nfc_timers.lock);
+	if( timer->armed ){
+		timer->armed = false;
+		/* lets the thread exit when it was the last one */
+		pthread_cond_signal(&g_nfc_timers.changed);
+	}
+	pthread_mutex_unlock(&g_nfc_timers.lock);
+}
@@ -0,0 +1,268 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <nfc.h>
+#include <nfc_private.h>
+
+/*
+ * Session trace.
+ *
+ * Records go to a file mapped shared, so they reach the file without a
+ * system call and survive a crash of the process. A writer takes a slot
+ * with one atomic add and marks the record complete by storing its
+ * sequence last; a reader skips records whose sequence does not match
+ * their position, they were being written or were overwritten meanwhile.
+ *
+ * Without a trace the call sites cost a load and a compare. Writers are
+ * counted while they use the mapping, stopping waits for them before it
+ * unmaps the file.
+ */
+
+#define _NFC_TRACE_RECORD_MAX	(1 << 24)
+
+_nfc_trace_header_s * volatile g_nfc_trace_ring;
+
+static struct {
+	pthread_mutex_t lock;	/* start and stop */
+	volatile int writers;
+	int fd;
+	size_t size;
+} g_nfc_trace = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.fd = -1,
+};
+
+/* takes the next slot, NULL when the trace stopped, _nfc_trace_commit() has to follow otherwise */
+static _nfc_trace_record_s * _nfc_trace_append(int kind, int id, unsigned long long *position)
+{
+	_nfc_trace_header_s *ring;
+	_nfc_trace_record_s *record;
+
+	__sync_fetch_and_add(&g_nfc_trace.writers, 1);
+
+	ring = g_nfc_trace_ring;
+	if( ring == NULL ){
+		__sync_fetch_and_sub(&g_nfc_trace.writers, 1);
+		return NULL;
+	}
+
+	*position = __sync_fetch_and_add(&ring->written, 1);
+	record = (_nfc_trace_record_s *)(ring + 1) + *position % ring->record_count;
+
+	record->sequence = 0;
+	__sync_synchronize();
+
+	memset(record, 0, sizeof(*record));
+	record->time = _nfc_stats_now();
+	record->kind = kind;
+	record->id = id;
+
+	return record;
+}
+
+static void _nfc_trace_commit(_nfc_trace_record_s *record, unsigned long long position)
+{
+	__sync_synchronize();
+	record->sequence = (unsigned int)(position + 1);
+	__sync_fetch_and_sub(&g_nfc_trace.writers, 1);
+}
+
+static void _nfc_trace_payload(_nfc_trace_record_s *record, const unsigned char *buffer, int size)
+{
+	record->length = size;
+	if( buffer != NULL && size > 0 ){
+		record->kept = size < _NFC_TRACE_PAYLOAD ? size : _NFC_TRACE_PAYLOAD;
+		memcpy(record->payload, buffer, record->kept);
+	}
+}
+
+void _nfc_trace_event(net_nfc_message_e message, net_nfc_error_e result, void *data, void *trans_data)
+{
+	_nfc_trace_record_s *record;
+	unsigned long long position;
+	int size;
+
+	record = _nfc_trace_append(_NFC_TRACE_EVENT, message, &position);
+	if( record == NULL )
+		return;
+
+	record->result = result;
+	record->request_id = (int)(intptr_t)trans_data;
+
+	switch( message ){
+		case NET_NFC_MESSAGE_TRANSCEIVE:
+		case NET_NFC_MESSAGE_P2P_RECEIVE:
+			if( data != NULL )
+				_nfc_trace_payload(record, ((data_s *)data)->buffer, ((data_s *)data)->length);
+			break;
+
+		/* the message is not serialized here, only its size is kept */
+		case NET_NFC_MESSAGE_READ_NDEF:
+			if( data != NULL && net_nfc_get_ndef_message_byte_length((ndef_message_h)data, &size) == NET_NFC_OK )
+				record->length = size;
+			break;
+
+		case NET_NFC_MESSAGE_TAG_DISCOVERED:
+		case NET_NFC_MESSAGE_GET_CURRENT_TAG_INFO:
+			if( data != NULL ){
+				net_nfc_target_info_s *target_info = (net_nfc_target_info_s *)data;
+				record->handle = (uintptr_t)target_info->handle;
+				record->arg = target_info->devType;
+				_nfc_trace_payload(record, target_info->raw_data.buffer, target_info->raw_data.length);
+			}
+			break;
+
+		case NET_NFC_MESSAGE_TAG_DETACHED:
+		case NET_NFC_MESSAGE_P2P_DISCOVERED:
+		case NET_NFC_MESSAGE_GET_CURRENT_TARGET_HANDLE:
+			record->handle = (uintptr_t)data;
+			break;
+
+		case NET_NFC_MESSAGE_IS_TAG_CONNECTED:
+			if( data != NULL )
+				record->arg = *(net_nfc_target_type_e *)data;
+			break;
+
+		/* the aid is the payload, arg the size of the parameter */
+		case NET_NFC_MESSAGE_SE_TYPE_TRANSACTION:
+			if( data != NULL ){
+				net_nfc_se_event_info_s *event_info = (net_nfc_se_event_info_s *)data;
+				_nfc_trace_payload(record, event_info->aid.buffer, event_info->aid.length);
+				record->arg = event_info->param.length;
+			}
+			break;
+
+		default:
+			break;
+	}
+
+	_nfc_trace_commit(record, position);
+}
+
+void _nfc_trace_event_end(net_nfc_message_e message)
+{
+	_nfc_trace_record_s *record;
+	unsigned long long position;
+
+	record = _nfc_trace_append(_NFC_TRACE_EVENT_END, message, &position);
+	if( record != NULL )
+		_nfc_trace_commit(record, position);
+}
+
+void _nfc_trace_call(_nfc_trace_call_e call, net_nfc_target_handle_h handle, int arg, void *trans_data,
+	const unsigned char *buffer, int buffer_size, int result)
+{
+	_nfc_trace_record_s *record;
+	unsigned long long position;
+
+	record = _nfc_trace_append(_NFC_TRACE_CALL, call, &position);
+	if( record == NULL )
+		return;
+
+	record->result = result;
+	record->request_id = (int)(intptr_t)trans_data;
+	record->handle = (uintptr_t)handle;
+	record->arg = arg;
+	_nfc_trace_payload(record, buffer, buffer_size);
+
+	_nfc_trace_commit(record, position);
+}
+
+/* called with the lock held */
+static void _nfc_trace_close(void)
+{
+	_nfc_trace_header_s *ring = g_nfc_trace_ring;
+
+	if( ring == NULL )
+		return;
+
+	g_nfc_trace_ring = NULL;
+	__sync_synchronize();
+	while( g_nfc_trace.writers != 0 )
+		sched_yield();
+
+	munmap(ring, g_nfc_trace.size);
+	close(g_nfc_trace.fd);
+	g_nfc_trace.fd = -1;
+	g_nfc_trace.size = 0;
+}
+
+int nfc_manager_start_trace(const char *path, int record_count)
+{
+	_nfc_trace_header_s *ring;
+	size_t size;
+	int fd;
+
+	if( path == NULL || record_count <= 0 || record_count > _NFC_TRACE_RECORD_MAX ){
+		NFC_LOGE("[%s] INVALID_PARAMETER (0x%08x)", __func__, NFC_ERROR_INVALID_PARAMETER);
+		return NFC_ERROR_INVALID_PARAMETER;
+	}
+
+	size = sizeof(_nfc_trace_header_s) + (size_t)record_count * sizeof(_nfc_trace_record_s);
+
+	pthread_mutex_lock(&g_nfc_trace.lock);
+
+	_nfc_trace_close();
+
+	fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+	if( fd < 0 ){
+		pthread_mutex_unlock(&g_nfc_trace.lock);
+		NFC_LOGE("[%s] OPERATION_FAILED (0x%08x) opening %s", __func__, NFC_ERROR_OPERATION_FAILED, path);
+		return NFC_ERROR_OPERATION_FAILED;
+	}
+
+	/* allocated up front, a full disk must not turn stores to the mapping into SIGBUS */
+	ring = MAP_FAILED;
+	if( posix_fallocate(fd, 0, size) == 0 )
+		ring = (_nfc_trace_header_s *)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if( ring == MAP_FAILED ){
+		close(fd);
+		pthread_mutex_unlock(&g_nfc_trace.lock);
+		NFC_LOGE("[%s] OPERATION_FAILED (0x%08x) mapping %s", __func__, NFC_ERROR_OPERATION_FAILED, path);
+		return NFC_ERROR_OPERATION_FAILED;
+	}
+
+	memcpy(ring->magic, _NFC_TRACE_MAGIC, sizeof(ring->magic));
+	ring->version = _NFC_TRACE_VERSION;
+	ring->record_size = sizeof(_nfc_trace_record_s);
+	ring->record_count = record_count;
+	ring->written = 0;
+	ring->started = _nfc_stats_now();
+
+	g_nfc_trace.fd = fd;
+	g_nfc_trace.size = size;
+	__sync_synchronize();
+	g_nfc_trace_ring = ring;
+
+	pthread_mutex_unlock(&g_nfc_trace.lock);
+
+	return NFC_ERROR_NONE;
+}
+
+void nfc_manager_stop_trace(void)
+{
+	pthread_mutex_lock(&g_nfc_trace.lock);
+	_nfc_trace_close();
+	pthread_mutex_unlock(&g_nfc_trace.lock);
+}
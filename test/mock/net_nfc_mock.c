@@ -0,0 +1,1219 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <net_nfc.h>
+#include <net_nfc_exchanger.h>
+#include <net_nfc_typedef_private.h>
+#include "net_nfc_mock.h"
+
+/*
+ * The simulated daemon. Every response and event becomes a record in a
+ * heap ordered by the time it is due, and the simulation thread delivers
+ * the records in that order through the response callback. Due times never
+ * go backwards: the daemon answers over a single socket, so a record is
+ * due its latency after the previous one, which also keeps a detach from
+ * overtaking the events of its tag.
+ *
+ * The data of a record is freed after the callback returns, as the daemon
+ * client library does.
+ */
+
+#define MOCK_MESSAGE_MAX	64
+#define MOCK_MIFARE_BLOCKS	64
+#define MOCK_MIFARE_BLOCK_SIZE	16
+#define MOCK_TRANSCEIVE_HEADROOM	1024
+
+typedef struct {
+	unsigned long long due;	/* ns on CLOCK_MONOTONIC */
+	unsigned long long seq;
+	net_nfc_message_e message;
+	net_nfc_error_e result;
+	void *data;
+	void (*free_data)(void *data);
+	void *trans_data;
+} mock_event_s;
+
+typedef struct {
+	net_nfc_target_handle_s handle;
+	net_nfc_target_info_s info;	/* as reported when the tag was discovered */
+	net_nfc_tag_info_s keys[1];
+	data_s uid;
+	uint8_t uid_bytes[7];
+	uint8_t *ndef;	/* the current content */
+	uint32_t ndef_size;
+	uint8_t mifare[MOCK_MIFARE_BLOCKS][MOCK_MIFARE_BLOCK_SIZE];
+} mock_tag_s;
+
+typedef struct {
+	net_nfc_target_handle_s handle;
+	bool echo;
+} mock_peer_s;
+
+static struct {
+	pthread_mutex_t lock;
+	pthread_cond_t wakeup;	/* the simulation thread waits on it */
+	pthread_cond_t idle;
+	pthread_t thread;
+	bool running;
+	bool delivering;
+
+	net_nfc_response_cb callback;
+	void *user_param;
+
+	mock_event_s *heap;
+	int heap_size;
+	int heap_capacity;
+	unsigned long long seq;
+	unsigned long long last_due;
+	unsigned long long delivered;
+
+	net_nfc_mock_latency_s latency[MOCK_MESSAGE_MAX];
+	net_nfc_error_e result[MOCK_MESSAGE_MAX];
+	unsigned int seed;
+
+	net_nfc_mock_transceive_cb transceive;
+	void *transceive_data;
+
+	int activated;
+	int tag_filter;
+	bool popup;
+	mock_tag_s *tag;
+	mock_peer_s *peer;
+	uint32_t connection_id;
+} g_mock = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.seed = 1,
+	.popup = true,
+};
+
+static const struct {
+	const char *name;
+	net_nfc_message_e message;
+} mock_message_names[] = {
+	{ "TRANSCEIVE", NET_NFC_MESSAGE_TRANSCEIVE },
+	{ "READ_NDEF", NET_NFC_MESSAGE_READ_NDEF },
+	{ "WRITE_NDEF", NET_NFC_MESSAGE_WRITE_NDEF },
+	{ "IS_TAG_CONNECTED", NET_NFC_MESSAGE_IS_TAG_CONNECTED },
+	{ "GET_CURRENT_TAG_INFO", NET_NFC_MESSAGE_GET_CURRENT_TAG_INFO },
+	{ "GET_CURRENT_TARGET_HANDLE", NET_NFC_MESSAGE_GET_CURRENT_TARGET_HANDLE },
+	{ "TAG_DISCOVERED", NET_NFC_MESSAGE_TAG_DISCOVERED },
+	{ "TAG_DETACHED", NET_NFC_MESSAGE_TAG_DETACHED },
+	{ "FORMAT_NDEF", NET_NFC_MESSAGE_FORMAT_NDEF },
+	{ "P2P_DISCOVERED", NET_NFC_MESSAGE_P2P_DISCOVERED },
+	{ "P2P_DETACHED", NET_NFC_MESSAGE_P2P_DETACHED },
+	{ "P2P_SEND", NET_NFC_MESSAGE_P2P_SEND },
+	{ "P2P_RECEIVE", NET_NFC_MESSAGE_P2P_RECEIVE },
+	{ "SE_START_TRANSACTION", NET_NFC_MESSAGE_SE_START_TRANSACTION },
+	{ "SE_END_TRANSACTION", NET_NFC_MESSAGE_SE_END_TRANSACTION },
+	{ "SE_TYPE_TRANSACTION", NET_NFC_MESSAGE_SE_TYPE_TRANSACTION },
+	{ "SE_CONNECTIVITY", NET_NFC_MESSAGE_SE_CONNECTIVITY },
+	{ "SE_FIELD_ON", NET_NFC_MESSAGE_SE_FIELD_ON },
+	{ "SE_FIELD_OFF", NET_NFC_MESSAGE_SE_FIELD_OFF },
+	{ "CONNECTION_HANDOVER", NET_NFC_MESSAGE_CONNECTION_HANDOVER },
+	{ "INIT", NET_NFC_MESSAGE_INIT },
+	{ "DEINIT", NET_NFC_MESSAGE_DEINIT },
+};
+
+static unsigned long long mock_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void mock_deadline(unsigned long long ns, struct timespec *ts)
+{
+	ts->tv_sec = ns / 1000000000ULL;
+	ts->tv_nsec = ns % 1000000000ULL;
+}
+
+static bool mock_event_before(const mock_event_s *a, const mock_event_s *b)
+{
+	return a->due < b->due || (a->due == b->due && a->seq < b->seq);
+}
+
+static bool mock_heap_push(const mock_event_s *event)
+{
+	mock_event_s *heap;
+	mock_event_s tmp;
+	int i, parent;
+
+	if( g_mock.heap_size == g_mock.heap_capacity ){
+		heap = (mock_event_s *)realloc(g_mock.heap, (g_mock.heap_capacity ? g_mock.heap_capacity * 2 : 64) * sizeof(mock_event_s));
+		if( heap == NULL )
+			return false;
+		g_mock.heap = heap;
+		g_mock.heap_capacity = g_mock.heap_capacity ? g_mock.heap_capacity * 2 : 64;
+	}
+
+	i = g_mock.heap_size++;
+	g_mock.heap[i] = *event;
+	while( i > 0 ){
+		parent = (i - 1) / 2;
+		if( !mock_event_before(&g_mock.heap[i], &g_mock.heap[parent]) )
+			break;
+		tmp = g_mock.heap[i];
+		g_mock.heap[i] = g_mock.heap[parent];
+		g_mock.heap[parent] = tmp;
+		i = parent;
+	}
+	return true;
+}
+
+static void mock_heap_pop(mock_event_s *event)
+{
+	mock_event_s tmp;
+	int i = 0, child;
+
+	*event = g_mock.heap[0];
+	g_mock.heap[0] = g_mock.heap[--g_mock.heap_size];
+
+	while( (child = 2 * i + 1) < g_mock.heap_size ){
+		if( child + 1 < g_mock.heap_size && mock_event_before(&g_mock.heap[child + 1], &g_mock.heap[child]) )
+			child++;
+		if( !mock_event_before(&g_mock.heap[child], &g_mock.heap[i]) )
+			break;
+		tmp = g_mock.heap[i];
+		g_mock.heap[i] = g_mock.heap[child];
+		g_mock.heap[child] = tmp;
+		i = child;
+	}
+}
+
+/* called with the lock held */
+static unsigned long long mock_latency_ns(net_nfc_message_e message, size_t bytes)
+{
+	const net_nfc_mock_latency_s *latency;
+	unsigned long long ns;
+
+	if( (unsigned int)message >= MOCK_MESSAGE_MAX )
+		return 0;
+
+	latency = &g_mock.latency[message];
+	ns = (unsigned long long)latency->base_us * 1000ULL + (unsigned long long)latency->per_byte_ns * bytes;
+	if( latency->jitter_us > 0 )
+		ns += (unsigned long long)(rand_r(&g_mock.seed) % latency->jitter_us) * 1000ULL;
+	return ns;
+}
+
+/* queues a response or event, its data is freed with free_data once it is delivered or dropped */
+static void mock_post(net_nfc_message_e message, net_nfc_error_e result, void *data, void (*free_data)(void *data),
+	size_t bytes, void *trans_data)
+{
+	mock_event_s event;
+	unsigned long long now = mock_now();
+
+	pthread_mutex_lock(&g_mock.lock);
+
+	if( !g_mock.running ){
+		pthread_mutex_unlock(&g_mock.lock);
+		if( data != NULL && free_data != NULL )
+			free_data(data);
+		return;
+	}
+
+	if( (unsigned int)message < MOCK_MESSAGE_MAX && g_mock.result[message] != NET_NFC_OK )
+		result = g_mock.result[message];
+
+	event.due = (g_mock.last_due > now ? g_mock.last_due : now) + mock_latency_ns(message, bytes);
+	event.seq = g_mock.seq++;
+	event.message = message;
+	event.result = result;
+	event.data = data;
+	event.free_data = free_data;
+	event.trans_data = trans_data;
+
+	if( !mock_heap_push(&event) ){
+		pthread_mutex_unlock(&g_mock.lock);
+		if( data != NULL && free_data != NULL )
+			free_data(data);
+		return;
+	}
+
+	g_mock.last_due = event.due;
+	pthread_cond_signal(&g_mock.wakeup);
+	pthread_mutex_unlock(&g_mock.lock);
+}
+
+static void * mock_thread(void *arg)
+{
+	mock_event_s event;
+	struct timespec deadline;
+	net_nfc_response_cb callback;
+	void *user_param;
+
+	pthread_mutex_lock(&g_mock.lock);
+	while( g_mock.running ){
+		if( g_mock.heap_size == 0 ){
+			pthread_cond_wait(&g_mock.wakeup, &g_mock.lock);
+			continue;
+		}
+
+		if( g_mock.heap[0].due > mock_now() ){
+			mock_deadline(g_mock.heap[0].due, &deadline);
+			pthread_cond_timedwait(&g_mock.wakeup, &g_mock.lock, &deadline);
+			continue;
+		}
+
+		mock_heap_pop(&event);
+		callback = g_mock.callback;
+		user_param = g_mock.user_param;
+		g_mock.delivering = true;
+		pthread_mutex_unlock(&g_mock.lock);
+
+		if( callback != NULL )
+			callback(event.message, event.result, event.data, user_param, event.trans_data);
+		if( event.data != NULL && event.free_data != NULL )
+			event.free_data(event.data);
+
+		pthread_mutex_lock(&g_mock.lock);
+		g_mock.delivering = false;
+		g_mock.delivered++;
+		if( g_mock.heap_size == 0 )
+			pthread_cond_broadcast(&g_mock.idle);
+	}
+	pthread_mutex_unlock(&g_mock.lock);
+
+	return NULL;
+}
+
+static void mock_free_tag(void *data)
+{
+	mock_tag_s *tag = (mock_tag_s *)data;
+
+	free(tag->info.raw_data.buffer);
+	free(tag->ndef);
+	free(tag);
+}
+
+static void mock_free_data(void *data)
+{
+	net_nfc_free_data((data_h)data);
+}
+
+static void mock_free_message(void *data)
+{
+	net_nfc_free_ndef_message((ndef_message_h)data);
+}
+
+static void mock_free_se_event(void *data)
+{
+	net_nfc_se_event_info_s *info = (net_nfc_se_event_info_s *)data;
+
+	free(info->aid.buffer);
+	free(info->param.buffer);
+	free(info);
+}
+
+static data_s * mock_data_copy(const uint8_t *bytes, uint32_t size)
+{
+	data_h data = NULL;
+
+	if( net_nfc_create_data(&data, bytes, size) != NET_NFC_OK )
+		return NULL;
+	return (data_s *)data;
+}
+
+int net_nfc_mock_set_latency(net_nfc_message_e message, const net_nfc_mock_latency_s *latency)
+{
+	if( (unsigned int)message >= MOCK_MESSAGE_MAX )
+		return -1;
+
+	pthread_mutex_lock(&g_mock.lock);
+	if( latency != NULL )
+		g_mock.latency[message] = *latency;
+	else
+		memset(&g_mock.latency[message], 0, sizeof(g_mock.latency[message]));
+	pthread_mutex_unlock(&g_mock.lock);
+
+	return 0;
+}
+
+int net_nfc_mock_load_latency(const char *spec)
+{
+	net_nfc_mock_latency_s latency;
+	const char *p = spec;
+	char *end;
+	size_t name_size;
+	unsigned int i;
+	int m;
+	bool found;
+
+	if( spec == NULL )
+		return -1;
+
+	while( *p != '\0' ){
+		name_size = strcspn(p, "=");
+		if( p[name_size] != '=' )
+			return -1;
+
+		memset(&latency, 0, sizeof(latency));
+		end = (char *)p + name_size + 1;
+		latency.base_us = strtoul(end, &end, 10);
+		if( *end == '+' )
+			latency.jitter_us = strtoul(end + 1, &end, 10);
+		if( *end == '/' )
+			latency.per_byte_ns = strtoul(end + 1, &end, 10);
+		if( *end != ',' && *end != '\0' )
+			return -1;
+
+		found = false;
+		if( name_size == 1 && *p == '*' ){
+			for( m = 0; m < MOCK_MESSAGE_MAX; m++ )
+				net_nfc_mock_set_latency((net_nfc_message_e)m, &latency);
+			found = true;
+		}
+		for( i = 0; !found && i < sizeof(mock_message_names) / sizeof(mock_message_names[0]); i++ ){
+			if( strlen(mock_message_names[i].name) == name_size && strncmp(mock_message_names[i].name, p, name_size) == 0 ){
+				net_nfc_mock_set_latency(mock_message_names[i].message, &latency);
+				found = true;
+			}
+		}
+		if( !found )
+			return -1;
+
+		p = *end == ',' ? end + 1 : end;
+	}
+
+	return 0;
+}
+
+void net_nfc_mock_set_seed(unsigned int seed)
+{
+	pthread_mutex_lock(&g_mock.lock);
+	g_mock.seed = seed;
+	pthread_mutex_unlock(&g_mock.lock);
+}
+
+int net_nfc_mock_set_result(net_nfc_message_e message, net_nfc_error_e result)
+{
+	if( (unsigned int)message >= MOCK_MESSAGE_MAX )
+		return -1;
+
+	pthread_mutex_lock(&g_mock.lock);
+	g_mock.result[message] = result;
+	pthread_mutex_unlock(&g_mock.lock);
+
+	return 0;
+}
+
+void net_nfc_mock_set_transceive_cb(net_nfc_mock_transceive_cb callback, void *user_data)
+{
+	pthread_mutex_lock(&g_mock.lock);
+	g_mock.transceive = callback;
+	g_mock.transceive_data = user_data;
+	pthread_mutex_unlock(&g_mock.lock);
+}
+
+/* called with the lock held, the detach event frees the tag once it is delivered */
+static mock_tag_s * mock_take_tag(void)
+{
+	mock_tag_s *tag = g_mock.tag;
+
+	g_mock.tag = NULL;
+	return tag;
+}
+
+net_nfc_target_handle_h net_nfc_mock_tag_attach(net_nfc_target_type_e type, const uint8_t *ndef, uint32_t ndef_size)
+{
+	mock_tag_s *tag;
+	mock_tag_s *old;
+
+	tag = (mock_tag_s *)calloc(1, sizeof(mock_tag_s));
+	if( tag == NULL )
+		return NULL;
+
+	if( ndef != NULL && ndef_size > 0 ){
+		tag->ndef = (uint8_t *)malloc(ndef_size);
+		tag->info.raw_data.buffer = (uint8_t *)malloc(ndef_size);
+		if( tag->ndef == NULL || tag->info.raw_data.buffer == NULL ){
+			mock_free_tag(tag);
+			return NULL;
+		}
+		memcpy(tag->ndef, ndef, ndef_size);
+		memcpy(tag->info.raw_data.buffer, ndef, ndef_size);
+		tag->ndef_size = ndef_size;
+		tag->info.raw_data.length = ndef_size;
+	}
+
+	pthread_mutex_lock(&g_mock.lock);
+	tag->handle.connection_id = ++g_mock.connection_id;
+	pthread_mutex_unlock(&g_mock.lock);
+
+	tag->handle.target_type = type;
+	tag->uid_bytes[0] = 0x04;
+	memcpy(tag->uid_bytes + 1, &tag->handle.connection_id, sizeof(tag->handle.connection_id));
+	tag->uid.buffer = tag->uid_bytes;
+	tag->uid.length = sizeof(tag->uid_bytes);
+	tag->keys[0].key = "UID";
+	tag->keys[0].value = (data_h)&tag->uid;
+
+	tag->info.handle = &tag->handle;
+	tag->info.devType = type;
+	tag->info.is_ndef_supported = 1;
+	tag->info.ndefCardState = NET_NFC_NDEF_CARD_READ_WRITE;
+	tag->info.maxDataSize = 4096;
+	tag->info.actualDataSize = ndef_size;
+	tag->info.number_of_keys = 1;
+	tag->info.tag_info_list = tag->keys;
+
+	pthread_mutex_lock(&g_mock.lock);
+	old = mock_take_tag();
+	g_mock.tag = tag;
+	pthread_mutex_unlock(&g_mock.lock);
+
+	if( old != NULL )
+		mock_post(NET_NFC_MESSAGE_TAG_DETACHED, NET_NFC_OK, old, mock_free_tag, 0, NULL);
+	mock_post(NET_NFC_MESSAGE_TAG_DISCOVERED, NET_NFC_OK, &tag->info, NULL, ndef_size, NULL);
+
+	return &tag->handle;
+}
+
+void net_nfc_mock_tag_detach(void)
+{
+	mock_tag_s *tag;
+
+	pthread_mutex_lock(&g_mock.lock);
+	tag = mock_take_tag();
+	pthread_mutex_unlock(&g_mock.lock);
+
+	if( tag != NULL )
+		mock_post(NET_NFC_MESSAGE_TAG_DETACHED, NET_NFC_OK, tag, mock_free_tag, 0, NULL);
+}
+
+net_nfc_target_handle_h net_nfc_mock_p2p_attach(bool echo)
+{
+	mock_peer_s *peer;
+
+	peer = (mock_peer_s *)calloc(1, sizeof(mock_peer_s));
+	if( peer == NULL )
+		return NULL;
+
+	net_nfc_mock_p2p_detach();
+
+	pthread_mutex_lock(&g_mock.lock);
+	peer->handle.connection_id = ++g_mock.connection_id;
+	peer->handle.target_type = NET_NFC_NFCIP1_TARGET;
+	peer->echo = echo;
+	g_mock.peer = peer;
+	pthread_mutex_unlock(&g_mock.lock);
+
+	mock_post(NET_NFC_MESSAGE_P2P_DISCOVERED, NET_NFC_OK, &peer->handle, NULL, 0, NULL);
+	return &peer->handle;
+}
+
+void net_nfc_mock_p2p_detach(void)
+{
+	mock_peer_s *peer;
+
+	pthread_mutex_lock(&g_mock.lock);
+	peer = g_mock.peer;
+	g_mock.peer = NULL;
+	pthread_mutex_unlock(&g_mock.lock);
+
+	if( peer != NULL )
+		mock_post(NET_NFC_MESSAGE_P2P_DETACHED, NET_NFC_OK, &peer->handle, free, 0, NULL);
+}
+
+int net_nfc_mock_p2p_receive(const uint8_t *data, uint32_t size)
+{
+	data_s *copy = mock_data_copy(data, size);
+
+	if( copy == NULL )
+		return -1;
+
+	mock_post(NET_NFC_MESSAGE_P2P_RECEIVE, NET_NFC_OK, copy, mock_free_data, size, NULL);
+	return 0;
+}
+
+int net_nfc_mock_se_event(net_nfc_message_e event, const uint8_t *aid, uint32_t aid_size, const uint8_t *param, uint32_t param_size)
+{
+	net_nfc_se_event_info_s *info = NULL;
+
+	if( event == NET_NFC_MESSAGE_SE_TYPE_TRANSACTION ){
+		info = (net_nfc_se_event_info_s *)calloc(1, sizeof(net_nfc_se_event_info_s));
+		if( info == NULL )
+			return -1;
+		if( aid != NULL && aid_size > 0 ){
+			info->aid.buffer = (uint8_t *)malloc(aid_size);
+			if( info->aid.buffer != NULL ){
+				memcpy(info->aid.buffer, aid, aid_size);
+				info->aid.length = aid_size;
+			}
+		}
+		if( param != NULL && param_size > 0 ){
+			info->param.buffer = (uint8_t *)malloc(param_size);
+			if( info->param.buffer != NULL ){
+				memcpy(info->param.buffer, param, param_size);
+				info->param.length = param_size;
+			}
+		}
+	}
+
+	mock_post(event, NET_NFC_OK, info, info != NULL ? mock_free_se_event : NULL, aid_size + param_size, NULL);
+	return 0;
+}
+
+bool net_nfc_mock_wait_idle(int timeout_ms)
+{
+	struct timespec deadline;
+	bool idle;
+	int ret = 0;
+
+	mock_deadline(mock_now() + (unsigned long long)timeout_ms * 1000000ULL, &deadline);
+
+	pthread_mutex_lock(&g_mock.lock);
+	while( g_mock.running && (g_mock.heap_size > 0 || g_mock.delivering) && ret == 0 )
+		ret = pthread_cond_timedwait(&g_mock.idle, &g_mock.lock, &deadline);
+	idle = g_mock.heap_size == 0 && !g_mock.delivering;
+	pthread_mutex_unlock(&g_mock.lock);
+
+	return idle;
+}
+
+unsigned long long net_nfc_mock_get_delivered_count(void)
+{
+	unsigned long long delivered;
+
+	pthread_mutex_lock(&g_mock.lock);
+	delivered = g_mock.delivered;
+	pthread_mutex_unlock(&g_mock.lock);
+
+	return delivered;
+}
+
+/* client library */
+
+net_nfc_error_e net_nfc_initialize(void)
+{
+	pthread_condattr_t attr;
+	const char *spec;
+
+	pthread_mutex_lock(&g_mock.lock);
+	if( g_mock.running ){
+		pthread_mutex_unlock(&g_mock.lock);
+		return NET_NFC_ALREADY_INITIALIZED;
+	}
+
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&g_mock.wakeup, &attr);
+	pthread_cond_init(&g_mock.idle, &attr);
+	pthread_condattr_destroy(&attr);
+
+	g_mock.running = true;
+	g_mock.activated = 1;
+	g_mock.last_due = 0;
+	g_mock.delivered = 0;
+	if( pthread_create(&g_mock.thread, NULL, mock_thread, NULL) != 0 ){
+		g_mock.running = false;
+		pthread_mutex_unlock(&g_mock.lock);
+		return NET_NFC_THREAD_CREATE_FAIL;
+	}
+	pthread_mutex_unlock(&g_mock.lock);
+
+	spec = getenv("NET_NFC_MOCK_LATENCY");
+	if( spec != NULL )
+		net_nfc_mock_load_latency(spec);
+
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_deinitialize(void)
+{
+	mock_event_s event;
+	mock_tag_s *tag;
+	mock_peer_s *peer;
+
+	pthread_mutex_lock(&g_mock.lock);
+	if( !g_mock.running ){
+		pthread_mutex_unlock(&g_mock.lock);
+		return NET_NFC_NOT_INITIALIZED;
+	}
+	g_mock.running = false;
+	pthread_cond_signal(&g_mock.wakeup);
+	pthread_cond_broadcast(&g_mock.idle);
+	pthread_mutex_unlock(&g_mock.lock);
+
+	/* a callback deinitializing leaves its own thread behind */
+	if( pthread_equal(pthread_self(), g_mock.thread) )
+		pthread_detach(g_mock.thread);
+	else
+		pthread_join(g_mock.thread, NULL);
+
+	pthread_mutex_lock(&g_mock.lock);
+	while( g_mock.heap_size > 0 ){
+		mock_heap_pop(&event);
+		if( event.data != NULL && event.free_data != NULL )
+			event.free_data(event.data);
+	}
+	tag = mock_take_tag();
+	peer = g_mock.peer;
+	g_mock.peer = NULL;
+	pthread_mutex_unlock(&g_mock.lock);
+
+	if( tag != NULL )
+		mock_free_tag(tag);
+	free(peer);
+
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_set_response_callback(net_nfc_response_cb cb, void *user_param)
+{
+	pthread_mutex_lock(&g_mock.lock);
+	g_mock.callback = cb;
+	g_mock.user_param = user_param;
+	pthread_mutex_unlock(&g_mock.lock);
+
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_unset_response_callback(void)
+{
+	return net_nfc_set_response_callback(NULL, NULL);
+}
+
+net_nfc_error_e net_nfc_state_activate(int flag)
+{
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_state_deactivate(void)
+{
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_is_supported(int *state)
+{
+	if( state == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	*state = 1;
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_get_state(int *state)
+{
+	if( state == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	pthread_mutex_lock(&g_mock.lock);
+	*state = g_mock.activated;
+	pthread_mutex_unlock(&g_mock.lock);
+
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_set_state(int state, void *cb)
+{
+	pthread_mutex_lock(&g_mock.lock);
+	g_mock.activated = state ? 1 : 0;
+	pthread_mutex_unlock(&g_mock.lock);
+
+	mock_post(state ? NET_NFC_MESSAGE_INIT : NET_NFC_MESSAGE_DEINIT, NET_NFC_OK, NULL, NULL, 0, NULL);
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_set_tag_filter(int filter)
+{
+	pthread_mutex_lock(&g_mock.lock);
+	g_mock.tag_filter = filter;
+	pthread_mutex_unlock(&g_mock.lock);
+
+	return NET_NFC_OK;
+}
+
+int net_nfc_get_tag_filter(void)
+{
+	return g_mock.tag_filter;
+}
+
+net_nfc_error_e net_nfc_set_launch_popup_state(int enable)
+{
+	g_mock.popup = enable != 0;
+	return NET_NFC_OK;
+}
+
+bool net_nfc_get_launch_popup_state(void)
+{
+	return g_mock.popup;
+}
+
+net_nfc_error_e net_nfc_is_tag_connected(void *trans_param)
+{
+	net_nfc_target_type_e *type;
+	net_nfc_error_e result = NET_NFC_OK;
+
+	type = (net_nfc_target_type_e *)malloc(sizeof(net_nfc_target_type_e));
+	if( type == NULL )
+		return NET_NFC_ALLOC_FAIL;
+
+	pthread_mutex_lock(&g_mock.lock);
+	if( g_mock.tag != NULL )
+		*type = g_mock.tag->info.devType;
+	else if( g_mock.peer != NULL )
+		*type = NET_NFC_NFCIP1_TARGET;
+	else {
+		*type = NET_NFC_UNKNOWN_TARGET;
+		result = NET_NFC_NOT_CONNECTED;
+	}
+	pthread_mutex_unlock(&g_mock.lock);
+
+	mock_post(NET_NFC_MESSAGE_IS_TAG_CONNECTED, result, type, free, 0, trans_param);
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_get_current_tag_info(void *trans_param)
+{
+	void *info = NULL;
+
+	pthread_mutex_lock(&g_mock.lock);
+	if( g_mock.tag != NULL )
+		info = &g_mock.tag->info;
+	pthread_mutex_unlock(&g_mock.lock);
+
+	mock_post(NET_NFC_MESSAGE_GET_CURRENT_TAG_INFO, info != NULL ? NET_NFC_OK : NET_NFC_NOT_CONNECTED, info, NULL, 0, trans_param);
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_get_current_target_handle(void *trans_param)
+{
+	void *handle = NULL;
+
+	pthread_mutex_lock(&g_mock.lock);
+	if( g_mock.peer != NULL )
+		handle = &g_mock.peer->handle;
+	pthread_mutex_unlock(&g_mock.lock);
+
+	mock_post(NET_NFC_MESSAGE_GET_CURRENT_TARGET_HANDLE, handle != NULL ? NET_NFC_OK : NET_NFC_NOT_CONNECTED, handle, NULL, 0, trans_param);
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_retrieve_current_ndef_message(ndef_message_h *ndef_message)
+{
+	data_s *ndef = NULL;
+	net_nfc_error_e ret;
+
+	if( ndef_message == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	pthread_mutex_lock(&g_mock.lock);
+	if( g_mock.tag != NULL && g_mock.tag->ndef_size > 0 )
+		ndef = mock_data_copy(g_mock.tag->ndef, g_mock.tag->ndef_size);
+	pthread_mutex_unlock(&g_mock.lock);
+
+	if( ndef == NULL )
+		return NET_NFC_NO_NDEF_MESSAGE;
+
+	ret = net_nfc_create_ndef_message_from_rawdata(ndef_message, (data_h)ndef);
+	net_nfc_free_data((data_h)ndef);
+	return ret;
+}
+
+net_nfc_error_e net_nfc_get_tag_type(void *target_info, net_nfc_target_type_e *type)
+{
+	if( target_info == NULL || type == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	*type = ((net_nfc_target_info_s *)target_info)->devType;
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_get_tag_ndef_support(void *target_info, bool *is_support)
+{
+	if( target_info == NULL || is_support == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	*is_support = ((net_nfc_target_info_s *)target_info)->is_ndef_supported;
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_get_tag_max_data_size(void *target_info, uint32_t *max_size)
+{
+	if( target_info == NULL || max_size == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	*max_size = ((net_nfc_target_info_s *)target_info)->maxDataSize;
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_get_tag_actual_data_size(void *target_info, uint32_t *actual_data)
+{
+	if( target_info == NULL || actual_data == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	*actual_data = ((net_nfc_target_info_s *)target_info)->actualDataSize;
+	return NET_NFC_OK;
+}
+
+/* called with the lock held, a request against a tag which left is answered with an error */
+static bool mock_tag_is(net_nfc_target_handle_h handle)
+{
+	return g_mock.tag != NULL && &g_mock.tag->handle == (net_nfc_target_handle_s *)handle;
+}
+
+static net_nfc_error_e mock_default_transceive(const uint8_t *command, uint32_t command_size,
+	uint8_t *response, uint32_t *response_size, void *user_data)
+{
+	memcpy(response, command, command_size);
+	response[command_size] = 0x90;
+	response[command_size + 1] = 0x00;
+	*response_size = command_size + 2;
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_transceive(net_nfc_target_handle_h handle, data_h rawdata, void *trans_param)
+{
+	data_s *command = (data_s *)rawdata;
+	data_s *response;
+	net_nfc_mock_transceive_cb callback;
+	void *user_data;
+	uint32_t capacity;
+	net_nfc_error_e result;
+	bool attached;
+
+	if( handle == NULL || command == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	pthread_mutex_lock(&g_mock.lock);
+	attached = mock_tag_is(handle);
+	callback = g_mock.transceive != NULL ? g_mock.transceive : mock_default_transceive;
+	user_data = g_mock.transceive_data;
+	pthread_mutex_unlock(&g_mock.lock);
+
+	if( !attached ){
+		mock_post(NET_NFC_MESSAGE_TRANSCEIVE, NET_NFC_NOT_CONNECTED, NULL, NULL, 0, trans_param);
+		return NET_NFC_OK;
+	}
+
+	capacity = command->length + MOCK_TRANSCEIVE_HEADROOM;
+	response = mock_data_copy(NULL, capacity);
+	if( response == NULL )
+		return NET_NFC_ALLOC_FAIL;
+
+	result = callback(command->buffer, command->length, response->buffer, &capacity, user_data);
+	response->length = capacity;
+
+	mock_post(NET_NFC_MESSAGE_TRANSCEIVE, result, response, mock_free_data, command->length + response->length, trans_param);
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_read_tag(net_nfc_target_handle_h handle, void *trans_param)
+{
+	ndef_message_h message = NULL;
+	net_nfc_error_e result;
+	data_s ndef;
+	uint32_t size = 0;
+
+	if( handle == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	pthread_mutex_lock(&g_mock.lock);
+	if( !mock_tag_is(handle) )
+		result = NET_NFC_NOT_CONNECTED;
+	else if( g_mock.tag->ndef_size == 0 )
+		result = NET_NFC_NO_NDEF_MESSAGE;
+	else {
+		ndef.buffer = g_mock.tag->ndef;
+		ndef.length = size = g_mock.tag->ndef_size;
+		result = net_nfc_create_ndef_message_from_rawdata(&message, (data_h)&ndef);
+	}
+	pthread_mutex_unlock(&g_mock.lock);
+
+	mock_post(NET_NFC_MESSAGE_READ_NDEF, result, message, mock_free_message, size, trans_param);
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_write_ndef(net_nfc_target_handle_h handle, ndef_message_h msg, void *trans_param)
+{
+	data_s *rawdata = NULL;
+	net_nfc_error_e result;
+	uint32_t size = 0;
+
+	if( handle == NULL || msg == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	result = net_nfc_create_rawdata_from_ndef_message(msg, (data_h *)&rawdata);
+
+	pthread_mutex_lock(&g_mock.lock);
+	if( !mock_tag_is(handle) )
+		result = NET_NFC_NOT_CONNECTED;
+	else if( result == NET_NFC_OK ){
+		free(g_mock.tag->ndef);
+		g_mock.tag->ndef = rawdata->buffer;
+		g_mock.tag->ndef_size = size = rawdata->length;
+		rawdata->buffer = NULL;
+	}
+	pthread_mutex_unlock(&g_mock.lock);
+
+	if( rawdata != NULL )
+		net_nfc_free_data((data_h)rawdata);
+
+	mock_post(NET_NFC_MESSAGE_WRITE_NDEF, result, NULL, NULL, size, trans_param);
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_format_ndef(net_nfc_target_handle_h handle, data_h key, void *trans_param)
+{
+	net_nfc_error_e result = NET_NFC_OK;
+
+	if( handle == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	pthread_mutex_lock(&g_mock.lock);
+	if( !mock_tag_is(handle) )
+		result = NET_NFC_NOT_CONNECTED;
+	else {
+		free(g_mock.tag->ndef);
+		g_mock.tag->ndef = NULL;
+		g_mock.tag->ndef_size = 0;
+	}
+	pthread_mutex_unlock(&g_mock.lock);
+
+	mock_post(NET_NFC_MESSAGE_FORMAT_NDEF, result, NULL, NULL, 0, trans_param);
+	return NET_NFC_OK;
+}
+
+/*
+ * MIFARE commands go through transceive on the daemon side as well, so
+ * they are answered with NET_NFC_MESSAGE_TRANSCEIVE. The card is a 1K
+ * card whose blocks all accept every command.
+ */
+static net_nfc_error_e mock_mifare(net_nfc_target_handle_h handle, uint8_t addr, const uint8_t *write, uint32_t write_size,
+	int add, bool read, void *trans_param)
+{
+	data_s *response = NULL;
+	net_nfc_error_e result = NET_NFC_OK;
+	uint8_t *block;
+	int32_t value;
+
+	if( handle == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	pthread_mutex_lock(&g_mock.lock);
+	if( !mock_tag_is(handle) )
+		result = NET_NFC_NOT_CONNECTED;
+	else if( addr >= MOCK_MIFARE_BLOCKS )
+		result = NET_NFC_OUT_OF_BOUND;
+	else {
+		block = g_mock.tag->mifare[addr];
+		if( write != NULL )
+			memcpy(block, write, write_size < MOCK_MIFARE_BLOCK_SIZE ? write_size : MOCK_MIFARE_BLOCK_SIZE);
+		if( add != 0 ){
+			memcpy(&value, block, sizeof(value));
+			value += add;
+			memcpy(block, &value, sizeof(value));
+		}
+		if( read ){
+			response = mock_data_copy(block, MOCK_MIFARE_BLOCK_SIZE);
+			if( response == NULL )
+				result = NET_NFC_ALLOC_FAIL;
+		}
+	}
+	pthread_mutex_unlock(&g_mock.lock);
+
+	mock_post(NET_NFC_MESSAGE_TRANSCEIVE, result, response, mock_free_data, read ? MOCK_MIFARE_BLOCK_SIZE : write_size, trans_param);
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_mifare_authenticate_with_keyA(net_nfc_target_handle_h handle, uint8_t sector, data_h auth_key, void *trans_param)
+{
+	return mock_mifare(handle, sector * 4, NULL, 0, 0, false, trans_param);
+}
+
+net_nfc_error_e net_nfc_mifare_authenticate_with_keyB(net_nfc_target_handle_h handle, uint8_t sector, data_h auth_key, void *trans_param)
+{
+	return mock_mifare(handle, sector * 4, NULL, 0, 0, false, trans_param);
+}
+
+net_nfc_error_e net_nfc_mifare_read(net_nfc_target_handle_h handle, uint8_t addr, void *trans_param)
+{
+	return mock_mifare(handle, addr, NULL, 0, 0, true, trans_param);
+}
+
+net_nfc_error_e net_nfc_mifare_write_block(net_nfc_target_handle_h handle, uint8_t addr, data_h data, void *trans_param)
+{
+	if( data == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	return mock_mifare(handle, addr, ((data_s *)data)->buffer, ((data_s *)data)->length, 0, false, trans_param);
+}
+
+net_nfc_error_e net_nfc_mifare_write_page(net_nfc_target_handle_h handle, uint8_t addr, data_h data, void *trans_param)
+{
+	if( data == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	return mock_mifare(handle, addr, ((data_s *)data)->buffer, ((data_s *)data)->length, 0, false, trans_param);
+}
+
+net_nfc_error_e net_nfc_mifare_increment(net_nfc_target_handle_h handle, uint8_t addr, int value, void *trans_param)
+{
+	return mock_mifare(handle, addr, NULL, 0, value, false, trans_param);
+}
+
+net_nfc_error_e net_nfc_mifare_decrement(net_nfc_target_handle_h handle, uint8_t addr, int value, void *trans_param)
+{
+	return mock_mifare(handle, addr, NULL, 0, -value, false, trans_param);
+}
+
+net_nfc_error_e net_nfc_mifare_transfer(net_nfc_target_handle_h handle, uint8_t addr, void *trans_param)
+{
+	return mock_mifare(handle, addr, NULL, 0, 0, false, trans_param);
+}
+
+net_nfc_error_e net_nfc_mifare_restore(net_nfc_target_handle_h handle, uint8_t addr, void *trans_param)
+{
+	return mock_mifare(handle, addr, NULL, 0, 0, false, trans_param);
+}
+
+/* exchanger */
+
+net_nfc_error_e net_nfc_create_exchanger_data(net_nfc_exchanger_data_h *ex_data, data_h payload)
+{
+	net_nfc_exchanger_data_s *exchanger;
+	data_s *p = (data_s *)payload;
+
+	if( ex_data == NULL || p == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	exchanger = (net_nfc_exchanger_data_s *)calloc(1, sizeof(net_nfc_exchanger_data_s));
+	if( exchanger == NULL )
+		return NET_NFC_ALLOC_FAIL;
+
+	if( p->length > 0 ){
+		exchanger->binary_data.buffer = (uint8_t *)malloc(p->length);
+		if( exchanger->binary_data.buffer == NULL ){
+			free(exchanger);
+			return NET_NFC_ALLOC_FAIL;
+		}
+		memcpy(exchanger->binary_data.buffer, p->buffer, p->length);
+		exchanger->binary_data.length = p->length;
+	}
+	exchanger->type = NET_NFC_EXCHANGER_RAW;
+
+	*ex_data = (net_nfc_exchanger_data_h)exchanger;
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_free_exchanger_data(net_nfc_exchanger_data_h ex_data)
+{
+	net_nfc_exchanger_data_s *exchanger = (net_nfc_exchanger_data_s *)ex_data;
+
+	if( exchanger == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	free(exchanger->binary_data.buffer);
+	free(exchanger);
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_send_exchanger_data(net_nfc_exchanger_data_h ex_handle, net_nfc_target_handle_h target_handle)
+{
+	net_nfc_exchanger_data_s *exchanger = (net_nfc_exchanger_data_s *)ex_handle;
+	data_s *echo = NULL;
+	net_nfc_error_e result = NET_NFC_OK;
+	uint32_t size;
+
+	if( exchanger == NULL || target_handle == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	pthread_mutex_lock(&g_mock.lock);
+	if( g_mock.peer == NULL || &g_mock.peer->handle != (net_nfc_target_handle_s *)target_handle )
+		result = NET_NFC_NOT_CONNECTED;
+	else if( g_mock.peer->echo )
+		echo = mock_data_copy(exchanger->binary_data.buffer, exchanger->binary_data.length);
+	pthread_mutex_unlock(&g_mock.lock);
+
+	/* accepted data belongs to the daemon from here on */
+	size = exchanger->binary_data.length;
+	net_nfc_free_exchanger_data(ex_handle);
+
+	mock_post(NET_NFC_MESSAGE_P2P_SEND, result, NULL, NULL, size, NULL);
+	if( echo != NULL )
+		mock_post(NET_NFC_MESSAGE_P2P_RECEIVE, NET_NFC_OK, echo, mock_free_data, echo->length, NULL);
+
+	return NET_NFC_OK;
+}
+
+/* the handover info is released by the library with net_nfc_exchanger_free_alternative_carrier_data() */
+net_nfc_error_e net_nfc_exchanger_request_connection_handover(net_nfc_target_handle_h target_handle, net_nfc_conn_handover_carrier_type_e type)
+{
+	static const uint8_t address[] = { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55 };
+	net_nfc_connection_handover_info_s *info;
+	net_nfc_error_e result = NET_NFC_OK;
+
+	if( target_handle == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	info = (net_nfc_connection_handover_info_s *)calloc(1, sizeof(net_nfc_connection_handover_info_s));
+	if( info == NULL )
+		return NET_NFC_ALLOC_FAIL;
+
+	info->type = type;
+	if( type == NET_NFC_CONN_HANDOVER_CARRIER_BT ){
+		info->data.buffer = (uint8_t *)malloc(sizeof(address));
+		if( info->data.buffer != NULL ){
+			memcpy(info->data.buffer, address, sizeof(address));
+			info->data.length = sizeof(address);
+		}
+	}
+
+	pthread_mutex_lock(&g_mock.lock);
+	if( g_mock.peer == NULL || &g_mock.peer->handle != (net_nfc_target_handle_s *)target_handle )
+		result = NET_NFC_NOT_CONNECTED;
+	pthread_mutex_unlock(&g_mock.lock);
+
+	mock_post(NET_NFC_MESSAGE_CONNECTION_HANDOVER, result, info, NULL, 0, NULL);
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_exchanger_get_alternative_carrier_type(net_nfc_connection_handover_info_h info_handle, net_nfc_conn_handover_carrier_type_e *type)
+{
+	if( info_handle == NULL || type == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	*type = ((net_nfc_connection_handover_info_s *)info_handle)->type;
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_exchanger_get_alternative_carrier_data(net_nfc_connection_handover_info_h info_handle, data_h *data)
+{
+	net_nfc_connection_handover_info_s *info = (net_nfc_connection_handover_info_s *)info_handle;
+
+	if( info == NULL || data == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	return net_nfc_create_data(data, info->data.buffer, info->data.length);
+}
+
+net_nfc_error_e net_nfc_exchanger_free_alternative_carrier_data(net_nfc_connection_handover_info_h info_handle)
+{
+	net_nfc_connection_handover_info_s *info = (net_nfc_connection_handover_info_s *)info_handle;
+
+	if( info == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	free(info->data.buffer);
+	free(info);
+	return NET_NFC_OK;
+}
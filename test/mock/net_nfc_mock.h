@@ -0,0 +1,99 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef __NET_NFC_MOCK_H__
+#define __NET_NFC_MOCK_H__
+
+#include <net_nfc.h>
+#include <net_nfc_typedef_private.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * In-process stand-in for the net_nfc client library. Linking a program
+ * against the mock instead of libnfc runs the C API without a daemon: a
+ * simulation thread delivers every response and event through the
+ * callback given to net_nfc_set_response_callback(), after the latency
+ * configured for its message.
+ *
+ * Responses and events share one timeline like on the daemon socket: each
+ * is delivered its latency after the one before it, or after it was
+ * posted when nothing is pending, and never out of order. Events are
+ * scripted with the functions below.
+ *
+ * The script functions may be called from any thread once
+ * net_nfc_initialize() has been called.
+ */
+
+/* the delay of a message: base + per_byte_ns for each byte it carries + [0, jitter) */
+typedef struct {
+	unsigned int base_us;
+	unsigned int jitter_us;
+	unsigned int per_byte_ns;
+} net_nfc_mock_latency_s;
+
+/* NULL resets the message to no latency */
+int net_nfc_mock_set_latency(net_nfc_message_e message, const net_nfc_mock_latency_s *latency);
+
+/*
+ * Parses "NAME=base[+jitter][/per_byte_ns],..." with the message names of
+ * net_nfc_message_e without the NET_NFC_MESSAGE_ prefix, or "*" for all of
+ * them. The NET_NFC_MOCK_LATENCY environment variable is loaded this way
+ * by net_nfc_initialize(). Returns 0, or -1 at the first bad entry.
+ */
+int net_nfc_mock_load_latency(const char *spec);
+
+/* seeds the jitter, the default seed is 1 */
+void net_nfc_mock_set_seed(unsigned int seed);
+
+/* every later response of the message carries result, NET_NFC_OK restores normal operation */
+int net_nfc_mock_set_result(net_nfc_message_e message, net_nfc_error_e result);
+
+/*
+ * Answers a transceive. response holds *response_size bytes on entry and
+ * the callback stores the size of its answer. The default echoes the
+ * command followed by 90 00.
+ */
+typedef net_nfc_error_e (*net_nfc_mock_transceive_cb)(const uint8_t *command, uint32_t command_size,
+	uint8_t *response, uint32_t *response_size, void *user_data);
+
+void net_nfc_mock_set_transceive_cb(net_nfc_mock_transceive_cb callback, void *user_data);
+
+/* a tag enters the field, holding ndef (may be NULL) as its NDEF message */
+net_nfc_target_handle_h net_nfc_mock_tag_attach(net_nfc_target_type_e type, const uint8_t *ndef, uint32_t ndef_size);
+void net_nfc_mock_tag_detach(void);
+
+/* a peer enters the field, with echo every message sent to it comes back as received data */
+net_nfc_target_handle_h net_nfc_mock_p2p_attach(bool echo);
+void net_nfc_mock_p2p_detach(void);
+int net_nfc_mock_p2p_receive(const uint8_t *data, uint32_t size);
+
+/* one of the NET_NFC_MESSAGE_SE_* events, aid and param are only used by SE_TYPE_TRANSACTION */
+int net_nfc_mock_se_event(net_nfc_message_e event, const uint8_t *aid, uint32_t aid_size, const uint8_t *param, uint32_t param_size);
+
+/* waits until nothing is queued or being delivered, false on timeout */
+bool net_nfc_mock_wait_idle(int timeout_ms);
+
+/* responses and events delivered since net_nfc_initialize() */
+unsigned long long net_nfc_mock_get_delivered_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __NET_NFC_MOCK_H__ */
@@ -0,0 +1,618 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <net_nfc.h>
+#include <net_nfc_typedef_private.h>
+
+/*
+ * NDEF data functions of the mock. Records and messages use the structures
+ * of net_nfc_typedef_private.h, as the library does, and are encoded and
+ * decoded the way the daemon library does: every field is a copy, SR is
+ * set for payloads below 256 bytes and IL whenever there is an id.
+ */
+
+#define MOCK_NDEF_FLAG_MB	0x80
+#define MOCK_NDEF_FLAG_ME	0x40
+#define MOCK_NDEF_FLAG_CF	0x20
+#define MOCK_NDEF_FLAG_SR	0x10
+#define MOCK_NDEF_FLAG_IL	0x08
+#define MOCK_NDEF_TNF_MASK	0x07
+
+#define MOCK_TEXT_UTF16		0x80
+#define MOCK_TEXT_LANG_MASK	0x3f
+
+static const char *mock_uri_prefixes[] = {
+	"", "http://www.", "https://www.", "http://", "https://", "tel:", "mailto:",
+	"ftp://anonymous:anonymous@", "ftp://ftp.", "ftps://", "sftp://", "smb://",
+	"nfs://", "ftp://", "dav://", "news:", "telnet://", "imap:", "rtsp://",
+	"urn:", "pop:", "sip:", "sips:", "tftp:", "btspp://", "btl2cap://",
+	"btgoep://", "tcpobex://", "irdaobex://", "file://", "urn:epc:id:",
+	"urn:epc:tag:", "urn:epc:pat:", "urn:epc:raw:", "urn:epc:", "urn:nfc:",
+};
+
+static bool mock_data_set(data_s *data, const uint8_t *bytes, uint32_t length)
+{
+	data->buffer = NULL;
+	data->length = 0;
+
+	if( bytes == NULL || length == 0 )
+		return true;
+
+	data->buffer = (uint8_t *)malloc(length);
+	if( data->buffer == NULL )
+		return false;
+
+	memcpy(data->buffer, bytes, length);
+	data->length = length;
+	return true;
+}
+
+net_nfc_error_e net_nfc_create_data(data_h *data, const uint8_t *bytes, uint32_t length)
+{
+	data_s *d;
+
+	if( data == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	d = (data_s *)calloc(1, sizeof(data_s));
+	if( d == NULL )
+		return NET_NFC_ALLOC_FAIL;
+
+	if( length > 0 ){
+		d->buffer = (uint8_t *)calloc(1, length);
+		if( d->buffer == NULL ){
+			free(d);
+			return NET_NFC_ALLOC_FAIL;
+		}
+		if( bytes != NULL )
+			memcpy(d->buffer, bytes, length);
+		d->length = length;
+	}
+
+	*data = (data_h)d;
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_free_data(data_h data)
+{
+	data_s *d = (data_s *)data;
+
+	if( d == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	free(d->buffer);
+	free(d);
+	return NET_NFC_OK;
+}
+
+uint8_t *net_nfc_get_data_buffer(data_h data)
+{
+	return data != NULL ? ((data_s *)data)->buffer : NULL;
+}
+
+uint32_t net_nfc_get_data_length(data_h data)
+{
+	return data != NULL ? ((data_s *)data)->length : 0;
+}
+
+static net_nfc_error_e mock_record_create(ndef_record_s **record, int tnf, const uint8_t *type, uint32_t type_size,
+	const uint8_t *id, uint32_t id_size, const uint8_t *payload, uint32_t payload_size)
+{
+	ndef_record_s *r;
+
+	if( type_size > 0xff )
+		return NET_NFC_NDEF_TYPE_LENGTH_IS_NOT_OK;
+	if( id_size > 0xff )
+		return NET_NFC_NDEF_ID_LENGTH_IS_NOT_OK;
+
+	r = (ndef_record_s *)calloc(1, sizeof(ndef_record_s));
+	if( r == NULL )
+		return NET_NFC_ALLOC_FAIL;
+
+	if( !mock_data_set(&r->type_s, type, type_size) || !mock_data_set(&r->id_s, id, id_size)
+			|| !mock_data_set(&r->payload_s, payload, payload_size) ){
+		net_nfc_free_record((ndef_record_h)r);
+		return NET_NFC_ALLOC_FAIL;
+	}
+
+	r->TNF = tnf & MOCK_NDEF_TNF_MASK;
+	r->SR = payload_size < 256;
+	r->IL = id_size > 0;
+	*record = r;
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_create_record(ndef_record_h *record, net_nfc_record_tnf_e tnf, data_h typeName, data_h id, data_h payload)
+{
+	data_s *t = (data_s *)typeName, *i = (data_s *)id, *p = (data_s *)payload;
+
+	if( record == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	return mock_record_create((ndef_record_s **)record, tnf,
+		t ? t->buffer : NULL, t ? t->length : 0,
+		i ? i->buffer : NULL, i ? i->length : 0,
+		p ? p->buffer : NULL, p ? p->length : 0);
+}
+
+net_nfc_error_e net_nfc_create_text_type_record(ndef_record_h *record, const char *text, const char *language_code_str, net_nfc_encode_type_e encode)
+{
+	static const uint8_t type[] = { 'T' };
+	size_t lang_size, text_size;
+	uint8_t *payload;
+	net_nfc_error_e ret;
+
+	if( record == NULL || text == NULL || language_code_str == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	lang_size = strlen(language_code_str);
+	text_size = strlen(text);
+	if( lang_size > MOCK_TEXT_LANG_MASK )
+		return NET_NFC_OUT_OF_BOUND;
+
+	payload = (uint8_t *)malloc(1 + lang_size + text_size);
+	if( payload == NULL )
+		return NET_NFC_ALLOC_FAIL;
+
+	payload[0] = lang_size | (encode == NET_NFC_ENCODE_UTF_16 ? MOCK_TEXT_UTF16 : 0);
+	memcpy(payload + 1, language_code_str, lang_size);
+	memcpy(payload + 1 + lang_size, text, text_size);
+
+	ret = mock_record_create((ndef_record_s **)record, NET_NFC_RECORD_WELL_KNOWN_TYPE, type, sizeof(type), NULL, 0, payload, 1 + lang_size + text_size);
+	free(payload);
+	return ret;
+}
+
+net_nfc_error_e net_nfc_create_uri_type_record(ndef_record_h *record, const char *uri, net_nfc_schema_type_e protocol_schema)
+{
+	static const uint8_t type[] = { 'U' };
+	size_t uri_size;
+	uint8_t *payload;
+	net_nfc_error_e ret;
+
+	if( record == NULL || uri == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	uri_size = strlen(uri);
+	payload = (uint8_t *)malloc(1 + uri_size);
+	if( payload == NULL )
+		return NET_NFC_ALLOC_FAIL;
+
+	payload[0] = (uint8_t)protocol_schema;
+	memcpy(payload + 1, uri, uri_size);
+
+	ret = mock_record_create((ndef_record_s **)record, NET_NFC_RECORD_WELL_KNOWN_TYPE, type, sizeof(type), NULL, 0, payload, 1 + uri_size);
+	free(payload);
+	return ret;
+}
+
+net_nfc_error_e net_nfc_free_record(ndef_record_h record)
+{
+	ndef_record_s *r = (ndef_record_s *)record;
+
+	if( r == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	free(r->type_s.buffer);
+	free(r->id_s.buffer);
+	free(r->payload_s.buffer);
+	free(r);
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_set_record_id(ndef_record_h record, data_h id)
+{
+	ndef_record_s *r = (ndef_record_s *)record;
+	data_s *i = (data_s *)id;
+	data_s copy;
+
+	if( r == NULL || i == NULL )
+		return NET_NFC_NULL_PARAMETER;
+	if( i->length > 0xff )
+		return NET_NFC_NDEF_ID_LENGTH_IS_NOT_OK;
+	if( !mock_data_set(&copy, i->buffer, i->length) )
+		return NET_NFC_ALLOC_FAIL;
+
+	free(r->id_s.buffer);
+	r->id_s = copy;
+	r->IL = copy.length > 0;
+	return NET_NFC_OK;
+}
+
+/* the record fields are handed out in place, like the daemon library does */
+net_nfc_error_e net_nfc_get_record_payload(ndef_record_h record, data_h *payload)
+{
+	if( record == NULL || payload == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	*payload = (data_h)&((ndef_record_s *)record)->payload_s;
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_get_record_type(ndef_record_h record, data_h *type)
+{
+	if( record == NULL || type == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	*type = (data_h)&((ndef_record_s *)record)->type_s;
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_get_record_id(ndef_record_h record, data_h *id)
+{
+	if( record == NULL || id == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	*id = (data_h)&((ndef_record_s *)record)->id_s;
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_get_record_tnf(ndef_record_h record, net_nfc_record_tnf_e *TNF)
+{
+	if( record == NULL || TNF == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	*TNF = (net_nfc_record_tnf_e)((ndef_record_s *)record)->TNF;
+	return NET_NFC_OK;
+}
+
+static bool mock_record_is(const ndef_record_s *r, char type)
+{
+	return r->TNF == NET_NFC_RECORD_WELL_KNOWN_TYPE && r->type_s.length == 1 && r->type_s.buffer[0] == (uint8_t)type
+		&& r->payload_s.length > 0;
+}
+
+static char * mock_strndup(const uint8_t *bytes, size_t size)
+{
+	char *s = (char *)malloc(size + 1);
+
+	if( s != NULL ){
+		memcpy(s, bytes, size);
+		s[size] = '\0';
+	}
+	return s;
+}
+
+net_nfc_error_e net_nfc_create_text_string_from_text_record(ndef_record_h record, char **buffer)
+{
+	ndef_record_s *r = (ndef_record_s *)record;
+	uint32_t lang_size;
+
+	if( r == NULL || buffer == NULL )
+		return NET_NFC_NULL_PARAMETER;
+	if( !mock_record_is(r, 'T') )
+		return NET_NFC_NDEF_RECORD_IS_NOT_EXPECTED_TYPE;
+
+	lang_size = r->payload_s.buffer[0] & MOCK_TEXT_LANG_MASK;
+	if( 1 + lang_size > r->payload_s.length )
+		return NET_NFC_INVALID_FORMAT;
+
+	*buffer = mock_strndup(r->payload_s.buffer + 1 + lang_size, r->payload_s.length - 1 - lang_size);
+	return *buffer != NULL ? NET_NFC_OK : NET_NFC_ALLOC_FAIL;
+}
+
+net_nfc_error_e net_nfc_get_languange_code_string_from_text_record(ndef_record_h record, char **lang_code_str)
+{
+	ndef_record_s *r = (ndef_record_s *)record;
+	uint32_t lang_size;
+
+	if( r == NULL || lang_code_str == NULL )
+		return NET_NFC_NULL_PARAMETER;
+	if( !mock_record_is(r, 'T') )
+		return NET_NFC_NDEF_RECORD_IS_NOT_EXPECTED_TYPE;
+
+	lang_size = r->payload_s.buffer[0] & MOCK_TEXT_LANG_MASK;
+	if( 1 + lang_size > r->payload_s.length )
+		return NET_NFC_INVALID_FORMAT;
+
+	*lang_code_str = mock_strndup(r->payload_s.buffer + 1, lang_size);
+	return *lang_code_str != NULL ? NET_NFC_OK : NET_NFC_ALLOC_FAIL;
+}
+
+net_nfc_error_e net_nfc_get_encoding_type_from_text_record(ndef_record_h record, net_nfc_encode_type_e *encoding)
+{
+	ndef_record_s *r = (ndef_record_s *)record;
+
+	if( r == NULL || encoding == NULL )
+		return NET_NFC_NULL_PARAMETER;
+	if( !mock_record_is(r, 'T') )
+		return NET_NFC_NDEF_RECORD_IS_NOT_EXPECTED_TYPE;
+
+	*encoding = (r->payload_s.buffer[0] & MOCK_TEXT_UTF16) ? NET_NFC_ENCODE_UTF_16 : NET_NFC_ENCODE_UTF_8;
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_create_uri_string_from_uri_record(ndef_record_h record, char **uri)
+{
+	ndef_record_s *r = (ndef_record_s *)record;
+	const char *prefix = "";
+	size_t prefix_size;
+	uint8_t code;
+
+	if( r == NULL || uri == NULL )
+		return NET_NFC_NULL_PARAMETER;
+	if( !mock_record_is(r, 'U') )
+		return NET_NFC_NDEF_RECORD_IS_NOT_EXPECTED_TYPE;
+
+	code = r->payload_s.buffer[0];
+	if( code < sizeof(mock_uri_prefixes) / sizeof(mock_uri_prefixes[0]) )
+		prefix = mock_uri_prefixes[code];
+	prefix_size = strlen(prefix);
+
+	*uri = (char *)malloc(prefix_size + r->payload_s.length);
+	if( *uri == NULL )
+		return NET_NFC_ALLOC_FAIL;
+
+	memcpy(*uri, prefix, prefix_size);
+	memcpy(*uri + prefix_size, r->payload_s.buffer + 1, r->payload_s.length - 1);
+	(*uri)[prefix_size + r->payload_s.length - 1] = '\0';
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_create_ndef_message(ndef_message_h *ndef_message)
+{
+	if( ndef_message == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	*ndef_message = (ndef_message_h)calloc(1, sizeof(ndef_message_s));
+	return *ndef_message != NULL ? NET_NFC_OK : NET_NFC_ALLOC_FAIL;
+}
+
+net_nfc_error_e net_nfc_free_ndef_message(ndef_message_h ndef_message)
+{
+	ndef_message_s *m = (ndef_message_s *)ndef_message;
+	ndef_record_s *r, *next;
+
+	if( m == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	for( r = m->records; r != NULL; r = next ){
+		next = r->next;
+		net_nfc_free_record((ndef_record_h)r);
+	}
+	free(m);
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_get_ndef_message_record_count(ndef_message_h ndef_message, int *count)
+{
+	if( ndef_message == NULL || count == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	*count = ((ndef_message_s *)ndef_message)->recordCount;
+	return NET_NFC_OK;
+}
+
+static uint32_t mock_record_size(const ndef_record_s *r)
+{
+	return 2 + (r->SR ? 1 : 4) + (r->IL ? 1 : 0) + r->type_s.length + r->id_s.length + r->payload_s.length;
+}
+
+net_nfc_error_e net_nfc_get_ndef_message_byte_length(ndef_message_h ndef_message, int *length)
+{
+	ndef_message_s *m = (ndef_message_s *)ndef_message;
+	ndef_record_s *r;
+	uint32_t size = 0;
+
+	if( m == NULL || length == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	for( r = m->records; r != NULL; r = r->next )
+		size += mock_record_size(r);
+
+	*length = size;
+	return NET_NFC_OK;
+}
+
+static uint8_t * mock_field(uint8_t *p, const data_s *data)
+{
+	if( data->length > 0 )
+		memcpy(p, data->buffer, data->length);
+	return p + data->length;
+}
+
+net_nfc_error_e net_nfc_create_rawdata_from_ndef_message(ndef_message_h ndef_message, data_h *rawdata)
+{
+	ndef_message_s *m = (ndef_message_s *)ndef_message;
+	ndef_record_s *r;
+	data_s *d;
+	uint8_t *p;
+	int size;
+	net_nfc_error_e ret;
+
+	if( m == NULL || rawdata == NULL )
+		return NET_NFC_NULL_PARAMETER;
+	if( m->records == NULL )
+		return NET_NFC_NO_NDEF_MESSAGE;
+
+	net_nfc_get_ndef_message_byte_length(ndef_message, &size);
+	ret = net_nfc_create_data((data_h *)&d, NULL, size);
+	if( ret != NET_NFC_OK )
+		return ret;
+
+	p = d->buffer;
+	for( r = m->records; r != NULL; r = r->next ){
+		*p++ = (r == m->records ? MOCK_NDEF_FLAG_MB : 0) | (r->next == NULL ? MOCK_NDEF_FLAG_ME : 0)
+			| (r->CF ? MOCK_NDEF_FLAG_CF : 0) | (r->SR ? MOCK_NDEF_FLAG_SR : 0) | (r->IL ? MOCK_NDEF_FLAG_IL : 0) | r->TNF;
+		*p++ = r->type_s.length;
+		if( r->SR ){
+			*p++ = r->payload_s.length;
+		}
+		else {
+			*p++ = r->payload_s.length >> 24;
+			*p++ = r->payload_s.length >> 16;
+			*p++ = r->payload_s.length >> 8;
+			*p++ = r->payload_s.length;
+		}
+		if( r->IL )
+			*p++ = r->id_s.length;
+		p = mock_field(p, &r->type_s);
+		p = mock_field(p, &r->id_s);
+		p = mock_field(p, &r->payload_s);
+	}
+
+	*rawdata = (data_h)d;
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_create_ndef_message_from_rawdata(ndef_message_h *ndef_message, data_h rawdata)
+{
+	data_s *d = (data_s *)rawdata;
+	ndef_message_s *m;
+	ndef_record_s *r, **tail;
+	const uint8_t *p, *end;
+	uint32_t type_size, id_size, payload_size;
+	uint8_t flags = 0;
+	net_nfc_error_e ret;
+
+	if( ndef_message == NULL || d == NULL || d->buffer == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	ret = net_nfc_create_ndef_message((ndef_message_h *)&m);
+	if( ret != NET_NFC_OK )
+		return ret;
+
+	tail = &m->records;
+	p = d->buffer;
+	end = d->buffer + d->length;
+	do {
+		if( end - p < 3 || (p == d->buffer) != ((p[0] & MOCK_NDEF_FLAG_MB) != 0) ){
+			ret = p == end ? NET_NFC_NDEF_BUF_END_WITHOUT_ME : NET_NFC_INVALID_FORMAT;
+			break;
+		}
+
+		flags = *p++;
+		type_size = *p++;
+		if( flags & MOCK_NDEF_FLAG_SR ){
+			payload_size = *p++;
+		}
+		else {
+			if( end - p < 4 ){
+				ret = NET_NFC_INVALID_FORMAT;
+				break;
+			}
+			payload_size = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+			p += 4;
+		}
+		id_size = 0;
+		if( flags & MOCK_NDEF_FLAG_IL ){
+			if( p == end ){
+				ret = NET_NFC_INVALID_FORMAT;
+				break;
+			}
+			id_size = *p++;
+		}
+
+		if( (uint32_t)(end - p) < type_size + id_size || (uint32_t)(end - p) - type_size - id_size < payload_size ){
+			ret = NET_NFC_INVALID_FORMAT;
+			break;
+		}
+
+		ret = mock_record_create(&r, flags & MOCK_NDEF_TNF_MASK, p, type_size, p + type_size, id_size,
+			p + type_size + id_size, payload_size);
+		if( ret != NET_NFC_OK )
+			break;
+
+		/* the flags are kept as they were encoded */
+		r->CF = (flags & MOCK_NDEF_FLAG_CF) != 0;
+		r->SR = (flags & MOCK_NDEF_FLAG_SR) != 0;
+		r->IL = (flags & MOCK_NDEF_FLAG_IL) != 0;
+		r->MB = (flags & MOCK_NDEF_FLAG_MB) != 0;
+		r->ME = (flags & MOCK_NDEF_FLAG_ME) != 0;
+		*tail = r;
+		tail = &r->next;
+		m->recordCount++;
+		p += type_size + id_size + payload_size;
+	} while( !(flags & MOCK_NDEF_FLAG_ME) );
+
+	if( ret != NET_NFC_OK ){
+		net_nfc_free_ndef_message((ndef_message_h)m);
+		return ret;
+	}
+
+	*ndef_message = (ndef_message_h)m;
+	return NET_NFC_OK;
+}
+
+static ndef_record_s ** mock_record_slot(ndef_message_s *m, int index)
+{
+	ndef_record_s **slot = &m->records;
+
+	while( index-- > 0 && *slot != NULL )
+		slot = &(*slot)->next;
+	return slot;
+}
+
+net_nfc_error_e net_nfc_append_record_to_ndef_message(ndef_message_h ndef_message, ndef_record_h record)
+{
+	ndef_message_s *m = (ndef_message_s *)ndef_message;
+
+	if( m == NULL || record == NULL )
+		return NET_NFC_NULL_PARAMETER;
+
+	return net_nfc_append_record_by_index(ndef_message, m->recordCount, record);
+}
+
+net_nfc_error_e net_nfc_append_record_by_index(ndef_message_h ndef_message, int index, ndef_record_h record)
+{
+	ndef_message_s *m = (ndef_message_s *)ndef_message;
+	ndef_record_s *r = (ndef_record_s *)record;
+	ndef_record_s **slot;
+
+	if( m == NULL || r == NULL )
+		return NET_NFC_NULL_PARAMETER;
+	if( index < 0 || index > (int)m->recordCount )
+		return NET_NFC_OUT_OF_BOUND;
+
+	slot = mock_record_slot(m, index);
+	r->next = *slot;
+	*slot = r;
+	m->recordCount++;
+	return NET_NFC_OK;
+}
+
+net_nfc_error_e net_nfc_remove_record_by_index(ndef_message_h ndef_message, int index)
+{
+	ndef_message_s *m = (ndef_message_s *)ndef_message;
+	ndef_record_s **slot;
+	ndef_record_s *r;
+
+	if( m == NULL )
+		return NET_NFC_NULL_PARAMETER;
+	if( index < 0 || index >= (int)m->recordCount )
+		return NET_NFC_OUT_OF_BOUND;
+
+	slot = mock_record_slot(m, index);
+	r = *slot;
+	*slot = r->next;
+	m->recordCount--;
+	return net_nfc_free_record((ndef_record_h)r);
+}
+
+net_nfc_error_e net_nfc_get_record_by_index(ndef_message_h ndef_message, int index, ndef_record_h *record)
+{
+	ndef_message_s *m = (ndef_message_s *)ndef_message;
+
+	if( m == NULL || record == NULL )
+		return NET_NFC_NULL_PARAMETER;
+	if( index < 0 || index >= (int)m->recordCount )
+		return NET_NFC_OUT_OF_BOUND;
+
+	*record = (ndef_record_h)*mock_record_slot(m, index);
+	return NET_NFC_OK;
+}
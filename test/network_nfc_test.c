@@ -312,6 +312,7 @@ void write_ndef_to_tag(nfc_error_e error, void *user_data){
 		timeout_counter = 30;
 		nfc_tag_write_ndef(tag, message , _write_completed_cb , NULL);
 		nfc_ndef_message_destroy(message);
+		nfc_tag_release(tag);
 	}
 	else
 	{
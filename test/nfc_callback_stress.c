@@ -0,0 +1,131 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+/*
+ * Dispatches SE events from several threads while other threads keep
+ * replacing and removing the SE event callback, some of them from inside
+ * the callback. Every callback checks that it was handed its own user
+ * data, so a torn or freed callback/user data pair shows up as a mismatch
+ * (or as a use after free when built with -fsanitize=address). No daemon
+ * is needed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <nfc.h>
+#include <nfc_private.h>
+
+#define DEFAULT_SECONDS		5
+#define DISPATCH_THREADS	4
+#define REGISTER_THREADS	4
+
+#define TOKEN_A	0x41414141
+#define TOKEN_B	0x42424242
+
+typedef struct {
+	int token;
+} stress_user_data_s;
+
+static stress_user_data_s user_data_a = { TOKEN_A };
+static stress_user_data_s user_data_b = { TOKEN_B };
+
+static volatile int running = 1;
+static volatile unsigned long delivered;
+static volatile unsigned long mismatched;
+static volatile unsigned long registered;
+
+static void se_event_a(nfc_se_event_e event, void *user_data)
+{
+	__sync_fetch_and_add(&delivered, 1);
+	if( ((stress_user_data_s *)user_data)->token != TOKEN_A )
+		__sync_fetch_and_add(&mismatched, 1);
+}
+
+static void se_event_b(nfc_se_event_e event, void *user_data)
+{
+	__sync_fetch_and_add(&delivered, 1);
+	if( ((stress_user_data_s *)user_data)->token != TOKEN_B )
+		__sync_fetch_and_add(&mismatched, 1);
+
+	/* replacing the callback which is running must not free it under us */
+	if( (delivered & 0xff) == 0 )
+		nfc_manager_set_se_event_cb(se_event_a, &user_data_a);
+}
+
+static void *dispatch_thread(void *arg)
+{
+	while( running )
+		_nfc_response_handler(NET_NFC_MESSAGE_SE_FIELD_ON, NET_NFC_OK, NULL, NULL, NULL);
+
+	return NULL;
+}
+
+static void *register_thread(void *arg)
+{
+	unsigned int n = (unsigned int)(unsigned long)arg;
+
+	while( running ){
+		switch( n++ % 3 ){
+			case 0:
+				nfc_manager_set_se_event_cb(se_event_a, &user_data_a);
+				break;
+			case 1:
+				nfc_manager_set_se_event_cb(se_event_b, &user_data_b);
+				break;
+			default:
+				nfc_manager_unset_se_event_cb();
+				break;
+		}
+		__sync_fetch_and_add(&registered, 1);
+	}
+
+	return NULL;
+}
+
+int main(int argc, char **argv)
+{
+	pthread_t dispatchers[DISPATCH_THREADS];
+	pthread_t registrars[REGISTER_THREADS];
+	int seconds = DEFAULT_SECONDS;
+	int i;
+
+	if( argc > 1 )
+		seconds = atoi(argv[1]);
+	if( seconds <= 0 )
+		seconds = DEFAULT_SECONDS;
+
+	for( i = 0; i < DISPATCH_THREADS; i++ )
+		pthread_create(&dispatchers[i], NULL, dispatch_thread, NULL);
+	for( i = 0; i < REGISTER_THREADS; i++ )
+		pthread_create(&registrars[i], NULL, register_thread, (void *)(unsigned long)i);
+
+	sleep(seconds);
+	running = 0;
+
+	for( i = 0; i < DISPATCH_THREADS; i++ )
+		pthread_join(dispatchers[i], NULL);
+	for( i = 0; i < REGISTER_THREADS; i++ )
+		pthread_join(registrars[i], NULL);
+
+	nfc_manager_unset_se_event_cb();
+
+	printf("seconds\tdelivered\tregistered\tmismatched\n");
+	printf("%d\t%lu\t%lu\t%lu\n", seconds, delivered, registered, mismatched);
+
+	return mismatched == 0 ? 0 : 1;
+}
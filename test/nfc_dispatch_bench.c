@@ -0,0 +1,88 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+/*
+ * Measures the cost of routing one daemon event through
+ * _nfc_response_handler() with no application callback registered, so
+ * only the dispatch and error mapping are timed. No daemon is needed.
+ *
+ * Build and run it against two revisions of the library to compare them.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <nfc.h>
+#include <nfc_private.h>
+
+#define DEFAULT_ITERATIONS	1000000
+
+typedef struct {
+	const char *name;
+	net_nfc_message_e message;
+	net_nfc_error_e result;
+	void *trans_data;
+} bench_case_s;
+
+static const bench_case_s bench_cases[] = {
+	{ "SE_FIELD_ON", NET_NFC_MESSAGE_SE_FIELD_ON, NET_NFC_OK, NULL },
+	{ "SE_FIELD_OFF", NET_NFC_MESSAGE_SE_FIELD_OFF, NET_NFC_OK, NULL },
+	{ "P2P_SEND", NET_NFC_MESSAGE_P2P_SEND, NET_NFC_OK, NULL },
+	{ "TRANSCEIVE(stale)", NET_NFC_MESSAGE_TRANSCEIVE, NET_NFC_OK, (void *)(intptr_t)0x7ffffff0 },
+	{ "NOTIFY", NET_NFC_MESSAGE_NOTIFY, NET_NFC_OK, NULL },
+	{ "SE_FIELD_ON(RF_TIMEOUT)", NET_NFC_MESSAGE_SE_FIELD_ON, NET_NFC_RF_TIMEOUT, NULL },
+};
+
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+	int iterations = DEFAULT_ITERATIONS;
+	unsigned int i;
+	int n;
+
+	if( argc > 1 )
+		iterations = atoi(argv[1]);
+	if( iterations <= 0 )
+		iterations = DEFAULT_ITERATIONS;
+
+	printf("event\titerations\tns_per_event\n");
+
+	for( i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); i++ ){
+		const bench_case_s *c = &bench_cases[i];
+		double start, elapsed;
+
+		/* warm up caches and branch predictors */
+		for( n = 0; n < iterations / 10; n++ )
+			_nfc_response_handler(c->message, c->result, NULL, NULL, c->trans_data);
+
+		start = now_ns();
+		for( n = 0; n < iterations; n++ )
+			_nfc_response_handler(c->message, c->result, NULL, NULL, c->trans_data);
+		elapsed = now_ns() - start;
+
+		printf("%s\t%d\t%.1f\n", c->name, iterations, elapsed / iterations);
+	}
+
+	return 0;
+}
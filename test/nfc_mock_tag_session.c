@@ -0,0 +1,386 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+/*
+ * Checks the lifetime of tag handles against the mock backend: what a
+ * handle kept past the detach of its tag still allows, that requests
+ * expire without a main loop and that blocking calls keep their deadline.
+ * Prints the failed checks and exits with 1 if there was any.
+ *
+ *	./nfc_mock_tag_session
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <glib.h>
+#include <nfc.h>
+#include <net_nfc_mock.h>
+
+#define TIMEOUT_MS	5000
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t changed = PTHREAD_COND_INITIALIZER;
+static nfc_tag_h current_tag;
+static int initialized;
+static int failures;
+
+#define CHECK(expression) \
+	do { \
+		if( !(expression) ){ \
+			fprintf(stderr, "%s:%d: %s failed\n", __func__, __LINE__, #expression); \
+			failures++; \
+		} \
+	} while(0)
+
+static void on_initialized(nfc_error_e error, void *user_data)
+{
+	pthread_mutex_lock(&lock);
+	initialized = 1;
+	pthread_cond_broadcast(&changed);
+	pthread_mutex_unlock(&lock);
+}
+
+static void on_tag_discovered(nfc_discovered_type_e type, nfc_tag_h tag, void *user_data)
+{
+	pthread_mutex_lock(&lock);
+	current_tag = type == NFC_DISCOVERED_TYPE_ATTACHED ? tag : NULL;
+	pthread_cond_broadcast(&changed);
+	pthread_mutex_unlock(&lock);
+}
+
+static nfc_tag_h wait_tag(bool attached)
+{
+	nfc_tag_h tag;
+
+	pthread_mutex_lock(&lock);
+	while( (current_tag != NULL) != attached )
+		pthread_cond_wait(&changed, &lock);
+	tag = current_tag;
+	pthread_mutex_unlock(&lock);
+
+	return tag;
+}
+
+static void on_transceived(nfc_error_e result, unsigned char *buffer, int buffer_size, void *user_data)
+{
+}
+
+static void on_completed(nfc_error_e result, unsigned char *buffer, int buffer_size, void *user_data)
+{
+	pthread_mutex_lock(&lock);
+	*(int *)user_data = result;
+	pthread_cond_broadcast(&changed);
+	pthread_mutex_unlock(&lock);
+}
+
+static void on_snapshot(const nfc_message_stats_s *stats, int count, void *user_data)
+{
+	pthread_mutex_lock(&lock);
+	(*(int *)user_data)++;
+	pthread_cond_broadcast(&changed);
+	pthread_mutex_unlock(&lock);
+}
+
+/* waits until *value differs from initial, false after TIMEOUT_MS */
+static bool wait_change(volatile int *value, int initial)
+{
+	struct timespec deadline;
+	bool changed_in_time;
+
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += TIMEOUT_MS / 1000;
+
+	pthread_mutex_lock(&lock);
+	while( *value == initial && pthread_cond_timedwait(&changed, &lock, &deadline) == 0 )
+		;
+	changed_in_time = *value != initial;
+	pthread_mutex_unlock(&lock);
+
+	return changed_in_time;
+}
+
+static void on_mifare_result(nfc_error_e result, void *user_data)
+{
+}
+
+/* a retained tag keeps its information but no longer reaches the daemon */
+static void check_detached_retained_tag(void)
+{
+	unsigned char command[] = { 0x90, 0x60, 0x00, 0x00, 0x00 };
+	unsigned char key[6] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+	unsigned char *response;
+	int response_size;
+	nfc_tag_type_e type;
+	nfc_tag_h tag;
+
+	net_nfc_mock_tag_attach(NET_NFC_MIFARE_DESFIRE_PICC, NULL, 0);
+	tag = wait_tag(true);
+	CHECK(nfc_tag_retain(tag) == NFC_ERROR_NONE);
+	CHECK(nfc_tag_transceive_sync(tag, command, sizeof(command), TIMEOUT_MS, &response, &response_size) == NFC_ERROR_NONE);
+	free(response);
+
+	net_nfc_mock_tag_detach();
+	wait_tag(false);
+
+	CHECK(nfc_tag_get_type(tag, &type) == NFC_ERROR_NONE);
+	CHECK(nfc_tag_transceive(tag, command, sizeof(command), on_transceived, NULL) == NFC_ERROR_NO_DEVICE);
+	CHECK(nfc_tag_transceive_sync(tag, command, sizeof(command), TIMEOUT_MS, &response, &response_size) == NFC_ERROR_NO_DEVICE);
+	CHECK(nfc_tag_read_ndef(tag, NULL, NULL) == NFC_ERROR_NO_DEVICE);
+	CHECK(nfc_tag_format_ndef(tag, NULL, 0, NULL, NULL) == NFC_ERROR_NO_DEVICE);
+	CHECK(nfc_mifare_authenticate_with_keyA(tag, 0, key, on_mifare_result, NULL) == NFC_ERROR_NO_DEVICE);
+	CHECK(nfc_mifare_increment(tag, 4, 1, on_mifare_result, NULL) == NFC_ERROR_NO_DEVICE);
+
+	/* a new tag may get the same target handle, the old one must not reach it */
+	net_nfc_mock_tag_attach(NET_NFC_MIFARE_DESFIRE_PICC, NULL, 0);
+	CHECK(wait_tag(true) != tag);
+	CHECK(nfc_tag_transceive(tag, command, sizeof(command), on_transceived, NULL) == NFC_ERROR_NO_DEVICE);
+	net_nfc_mock_tag_detach();
+	wait_tag(false);
+
+	CHECK(nfc_tag_release(tag) == NFC_ERROR_NONE);
+}
+
+/* the connected tag is handed out retained, so it stays readable across a detach */
+static void check_connected_tag(void)
+{
+	nfc_tag_type_e type;
+	nfc_tag_h tag;
+	nfc_tag_h connected;
+
+	CHECK(nfc_manager_get_connected_tag(&connected) == NFC_ERROR_NO_DEVICE);
+
+	net_nfc_mock_tag_attach(NET_NFC_MIFARE_DESFIRE_PICC, NULL, 0);
+	tag = wait_tag(true);
+	CHECK(nfc_manager_get_connected_tag(&connected) == NFC_ERROR_NONE);
+	CHECK(connected == tag);
+
+	net_nfc_mock_tag_detach();
+	wait_tag(false);
+
+	CHECK(nfc_tag_get_type(connected, &type) == NFC_ERROR_NONE);
+	CHECK(nfc_tag_read_ndef(connected, NULL, NULL) == NFC_ERROR_NO_DEVICE);
+	CHECK(nfc_tag_release(connected) == NFC_ERROR_NONE);
+}
+
+static void * get_last_request_id(void *result)
+{
+	int request_id;
+
+	*(int *)result = nfc_tag_get_last_request_id(&request_id);
+	return NULL;
+}
+
+/* the last request id belongs to the thread which issued the request */
+static void check_last_request_id(void)
+{
+	unsigned char command[] = { 0x90, 0x60, 0x00, 0x00, 0x00 };
+	int request_id = 0;
+	int result = NFC_ERROR_NONE;
+	pthread_t thread;
+	nfc_tag_h tag;
+
+	net_nfc_mock_tag_attach(NET_NFC_MIFARE_DESFIRE_PICC, NULL, 0);
+	tag = wait_tag(true);
+
+	CHECK(nfc_tag_transceive(tag, command, sizeof(command), on_transceived, NULL) == NFC_ERROR_NONE);
+	CHECK(nfc_tag_get_last_request_id(&request_id) == NFC_ERROR_NONE);
+	CHECK(request_id > 0);
+
+	pthread_create(&thread, NULL, get_last_request_id, &result);
+	pthread_join(thread, NULL);
+	CHECK(result == NFC_ERROR_OPERATION_FAILED);
+
+	net_nfc_mock_wait_idle(TIMEOUT_MS);
+	net_nfc_mock_tag_detach();
+	wait_tag(false);
+}
+
+static void on_dumped(nfc_error_e result, unsigned char *buffer, int buffer_size, void *user_data)
+{
+	pthread_mutex_lock(&lock);
+	*(int *)user_data = result;
+	pthread_cond_broadcast(&changed);
+	pthread_mutex_unlock(&lock);
+}
+
+static void on_batch(nfc_error_e result, int response_count, unsigned char *responses, int responses_size, void *user_data)
+{
+	pthread_mutex_lock(&lock);
+	*(int *)user_data = result;
+	pthread_cond_broadcast(&changed);
+	pthread_mutex_unlock(&lock);
+}
+
+/* a sector job or an APDU script cancels as a whole and still completes */
+static void check_job_cancel(void)
+{
+	net_nfc_mock_latency_s slow = { .base_us = 20000 };
+	unsigned char key[6] = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+	unsigned char select[] = { 0x00, 0xa4, 0x04, 0x00, 0x00 };
+	nfc_tag_apdu_s commands[3] = { { select, sizeof(select) }, { select, sizeof(select) }, { select, sizeof(select) } };
+	volatile int result = NFC_ERROR_NONE;
+	int request_id = 0;
+	nfc_tag_h tag;
+
+	net_nfc_mock_tag_attach(NET_NFC_MIFARE_1K_PICC, NULL, 0);
+	tag = wait_tag(true);
+	net_nfc_mock_set_latency(NET_NFC_MESSAGE_TRANSCEIVE, &slow);
+
+	CHECK(nfc_mifare_dump(tag, NFC_MIFARE_KEY_A, key, on_dumped, (void *)&result) == NFC_ERROR_NONE);
+	CHECK(nfc_tag_get_last_request_id(&request_id) == NFC_ERROR_NONE);
+	CHECK(nfc_tag_cancel(request_id) == NFC_ERROR_NONE);
+	CHECK(wait_change(&result, NFC_ERROR_NONE));
+	CHECK(result == NFC_ERROR_OPERATION_FAILED);
+	CHECK(nfc_tag_cancel(request_id) == NFC_ERROR_INVALID_PARAMETER);
+
+	/* past the first command, whose id used to be the only one reported */
+	result = NFC_ERROR_NONE;
+	CHECK(nfc_tag_transceive_batch(tag, commands, 3, 0, on_batch, (void *)&result) == NFC_ERROR_NONE);
+	CHECK(nfc_tag_get_last_request_id(&request_id) == NFC_ERROR_NONE);
+	usleep(30000);
+	CHECK(nfc_tag_cancel(request_id) == NFC_ERROR_NONE);
+	CHECK(wait_change(&result, NFC_ERROR_NONE));
+	CHECK(result == NFC_ERROR_OPERATION_FAILED);
+
+	net_nfc_mock_wait_idle(TIMEOUT_MS);
+	net_nfc_mock_set_latency(NET_NFC_MESSAGE_TRANSCEIVE, NULL);
+	net_nfc_mock_tag_detach();
+	wait_tag(false);
+}
+
+/* nothing iterates a GLib main loop here, the timers of the library have to run anyway */
+static void check_timers(void)
+{
+	net_nfc_mock_latency_s slow = { .base_us = 1000000 };
+	unsigned char command[] = { 0x90, 0x60, 0x00, 0x00, 0x00 };
+	volatile int result = NFC_ERROR_NONE;
+	volatile int snapshots = 0;
+	nfc_tag_h tag;
+
+	net_nfc_mock_tag_attach(NET_NFC_MIFARE_DESFIRE_PICC, NULL, 0);
+	tag = wait_tag(true);
+
+	net_nfc_mock_set_latency(NET_NFC_MESSAGE_TRANSCEIVE, &slow);
+	CHECK(nfc_manager_set_request_timeout(200) == NFC_ERROR_NONE);
+	CHECK(nfc_tag_transceive(tag, command, sizeof(command), on_completed, (void *)&result) == NFC_ERROR_NONE);
+	CHECK(wait_change(&result, NFC_ERROR_NONE));
+	CHECK(result == NFC_ERROR_TIMED_OUT);
+	net_nfc_mock_wait_idle(TIMEOUT_MS);
+	net_nfc_mock_set_latency(NET_NFC_MESSAGE_TRANSCEIVE, NULL);
+	nfc_manager_set_request_timeout(10000);
+
+	CHECK(nfc_manager_set_stats_snapshot_cb(50, on_snapshot, (void *)&snapshots) == NFC_ERROR_NONE);
+	CHECK(wait_change(&snapshots, 0));
+	nfc_manager_unset_stats_snapshot_cb();
+
+	net_nfc_mock_tag_detach();
+	wait_tag(false);
+}
+
+/* the response is queued to a context nobody iterates, the blocking call must still return */
+static void check_sync_deadline(void)
+{
+	unsigned char command[] = { 0x90, 0x60, 0x00, 0x00, 0x00 };
+	unsigned char *response = NULL;
+	int response_size = 0;
+	struct timespec started, returned;
+	GMainContext *context;
+	nfc_tag_h tag;
+
+	net_nfc_mock_tag_attach(NET_NFC_MIFARE_DESFIRE_PICC, NULL, 0);
+	tag = wait_tag(true);
+
+	context = g_main_context_new();
+	CHECK(nfc_manager_set_callback_main_context(context) == NFC_ERROR_NONE);
+
+	clock_gettime(CLOCK_MONOTONIC, &started);
+	CHECK(nfc_tag_transceive_sync(tag, command, sizeof(command), 200, &response, &response_size) == NFC_ERROR_TIMED_OUT);
+	clock_gettime(CLOCK_MONOTONIC, &returned);
+	CHECK(returned.tv_sec - started.tv_sec < TIMEOUT_MS / 1000);
+	CHECK(response == NULL);
+
+	/* the late completion frees the request of the call which gave up */
+	while( g_main_context_iteration(context, FALSE) )
+		;
+	CHECK(nfc_manager_unset_callback_main_context() == NFC_ERROR_NONE);
+	g_main_context_unref(context);
+
+	net_nfc_mock_tag_detach();
+	wait_tag(false);
+}
+
+/* the owner of the callback context would have to deliver the response it waits for */
+static void check_sync_on_context_owner(void)
+{
+	unsigned char command[] = { 0x90, 0x60, 0x00, 0x00, 0x00 };
+	unsigned char *response = NULL;
+	int response_size = 0;
+	GMainContext *context;
+	nfc_tag_h tag;
+
+	net_nfc_mock_tag_attach(NET_NFC_MIFARE_DESFIRE_PICC, NULL, 0);
+	tag = wait_tag(true);
+
+	context = g_main_context_new();
+	CHECK(g_main_context_acquire(context));
+	CHECK(nfc_manager_set_callback_main_context(context) == NFC_ERROR_NONE);
+
+	CHECK(nfc_tag_transceive_sync(tag, command, sizeof(command), TIMEOUT_MS, &response, &response_size) == NFC_ERROR_OPERATION_FAILED);
+
+	g_main_context_release(context);
+	CHECK(nfc_manager_unset_callback_main_context() == NFC_ERROR_NONE);
+	g_main_context_unref(context);
+
+	net_nfc_mock_tag_detach();
+	wait_tag(false);
+}
+
+int main(int argc, char **argv)
+{
+	if( nfc_manager_initialize(on_initialized, NULL) != NFC_ERROR_NONE ){
+		fprintf(stderr, "nfc_manager_initialize failed\n");
+		return 1;
+	}
+
+	pthread_mutex_lock(&lock);
+	while( !initialized )
+		pthread_cond_wait(&changed, &lock);
+	pthread_mutex_unlock(&lock);
+
+	nfc_manager_set_tag_discovered_cb(on_tag_discovered, NULL);
+
+	check_detached_retained_tag();
+	check_connected_tag();
+	check_last_request_id();
+	check_job_cancel();
+	check_timers();
+	check_sync_deadline();
+	check_sync_on_context_owner();
+
+	nfc_manager_deinitialize();
+
+	if( failures != 0 ){
+		fprintf(stderr, "%d checks failed\n", failures);
+		return 1;
+	}
+
+	printf("all checks passed\n");
+	return 0;
+}
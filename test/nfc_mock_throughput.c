@@ -0,0 +1,166 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+/*
+ * Runs the C API against the mock backend: how long a tag takes from
+ * entering the field to the discovered callback, and the round trip and
+ * throughput of blocking transceives of a few command sizes. The chip is
+ * given the latency of NET_NFC_MOCK_LATENCY, by default none, so the
+ * numbers are the overhead of the library itself.
+ *
+ *	NET_NFC_MOCK_LATENCY="TRANSCEIVE=500+100/80" ./nfc_mock_throughput 2000
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <nfc.h>
+#include <net_nfc_mock.h>
+
+#define DEFAULT_ITERATIONS	10000
+#define DISCOVER_ROUNDS	1000
+#define TIMEOUT_MS	5000
+
+static const int command_sizes[] = { 4, 16, 64, 250 };
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t changed = PTHREAD_COND_INITIALIZER;
+static nfc_tag_h current_tag;
+static int initialized;
+
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void on_initialized(nfc_error_e error, void *user_data)
+{
+	pthread_mutex_lock(&lock);
+	initialized = 1;
+	pthread_cond_broadcast(&changed);
+	pthread_mutex_unlock(&lock);
+}
+
+static void on_tag_discovered(nfc_discovered_type_e type, nfc_tag_h tag, void *user_data)
+{
+	pthread_mutex_lock(&lock);
+	current_tag = type == NFC_DISCOVERED_TYPE_ATTACHED ? tag : NULL;
+	pthread_cond_broadcast(&changed);
+	pthread_mutex_unlock(&lock);
+}
+
+static nfc_tag_h wait_tag(bool attached)
+{
+	nfc_tag_h tag;
+
+	pthread_mutex_lock(&lock);
+	while( (current_tag != NULL) != attached )
+		pthread_cond_wait(&changed, &lock);
+	tag = current_tag;
+	pthread_mutex_unlock(&lock);
+
+	return tag;
+}
+
+static void run_discover(void)
+{
+	double start, elapsed = 0;
+	int n;
+
+	for( n = 0; n < DISCOVER_ROUNDS; n++ ){
+		start = now_ns();
+		net_nfc_mock_tag_attach(NET_NFC_MIFARE_DESFIRE_PICC, NULL, 0);
+		wait_tag(true);
+		elapsed += now_ns() - start;
+
+		net_nfc_mock_tag_detach();
+		wait_tag(false);
+	}
+
+	printf("discover\t0\t%d\t%.1f\t%.1f\n", DISCOVER_ROUNDS, elapsed / DISCOVER_ROUNDS, DISCOVER_ROUNDS * 1e9 / elapsed);
+}
+
+static int run_transceive(nfc_tag_h tag, int command_size, int iterations)
+{
+	unsigned char command[256];
+	unsigned char *response;
+	int response_size;
+	double start, elapsed;
+	int n;
+
+	memset(command, 0xa5, sizeof(command));
+
+	start = now_ns();
+	for( n = 0; n < iterations; n++ ){
+		if( nfc_tag_transceive_sync(tag, command, command_size, TIMEOUT_MS, &response, &response_size) != NFC_ERROR_NONE )
+			return -1;
+		free(response);
+	}
+	elapsed = now_ns() - start;
+
+	printf("transceive\t%d\t%d\t%.1f\t%.1f\n", command_size, iterations, elapsed / iterations, iterations * 1e9 / elapsed);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	int iterations = DEFAULT_ITERATIONS;
+	nfc_tag_h tag;
+	unsigned int i;
+
+	if( argc > 1 )
+		iterations = atoi(argv[1]);
+	if( iterations <= 0 )
+		iterations = DEFAULT_ITERATIONS;
+
+	if( nfc_manager_initialize(on_initialized, NULL) != NFC_ERROR_NONE ){
+		fprintf(stderr, "nfc_manager_initialize failed\n");
+		return 1;
+	}
+
+	pthread_mutex_lock(&lock);
+	while( !initialized )
+		pthread_cond_wait(&changed, &lock);
+	pthread_mutex_unlock(&lock);
+
+	nfc_manager_set_tag_discovered_cb(on_tag_discovered, NULL);
+
+	printf("operation\tcommand_size\titerations\tns_per_op\tops_per_sec\n");
+
+	run_discover();
+
+	net_nfc_mock_tag_attach(NET_NFC_MIFARE_DESFIRE_PICC, NULL, 0);
+	tag = wait_tag(true);
+
+	for( i = 0; i < sizeof(command_sizes) / sizeof(command_sizes[0]); i++ ){
+		if( run_transceive(tag, command_sizes[i], iterations) != 0 ){
+			fprintf(stderr, "transceive of %d bytes failed\n", command_sizes[i]);
+			nfc_manager_deinitialize();
+			return 1;
+		}
+	}
+
+	net_nfc_mock_tag_detach();
+	wait_tag(false);
+
+	nfc_manager_deinitialize();
+	return 0;
+}
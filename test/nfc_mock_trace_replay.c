@@ -0,0 +1,607 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+/*
+ * Replays a file of nfc_manager_start_trace() through
+ * _nfc_response_handler() of the library built over the mock backend.
+ *
+ *   nfc_mock_trace_replay FILE [SPEED]	replays, SPEED 1 keeps the recorded
+ *					pacing, 2 halves it, 0 runs back to back
+ *   nfc_mock_trace_replay -l FILE		lists the records
+ *
+ * Every requested operation becomes a pending request with a callback of
+ * this program, so its response runs the same path as in the recording.
+ * Messages are rebuilt from the records: data longer than the part kept
+ * is padded with zeros, NDEF data is replaced by one record of the
+ * recorded size. IS_TAG_CONNECTED is skipped, the mock answered it when
+ * the library was initialized.
+ *
+ * The replay prints one line per message with its count and mean
+ * handling time in the recording and the latencies of the replay as
+ * reported by nfc_manager_get_stats().
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <nfc.h>
+#include <nfc_private.h>
+#include <net_nfc_mock.h>
+
+#define MESSAGE_MAX	256
+#define REQUEST_MAX	4096	/* requests in flight, a power of 2 */
+#define LOOKAHEAD	64	/* records searched for a call recorded after its response */
+
+static const char *call_names[_NFC_TRACE_CALL_MAX] = {
+	"TRANSCEIVE", "READ_NDEF", "WRITE_NDEF", "FORMAT_NDEF",
+	"MIFARE_AUTHENTICATE_A", "MIFARE_AUTHENTICATE_B", "MIFARE_READ", "MIFARE_WRITE_BLOCK", "MIFARE_WRITE_PAGE",
+	"MIFARE_INCREMENT", "MIFARE_DECREMENT", "MIFARE_TRANSFER", "MIFARE_RESTORE", "P2P_SEND",
+};
+
+typedef struct {
+	unsigned long long count;
+	unsigned long long handling_ns;
+	unsigned long long handled;
+	unsigned long long entered;	/* time of the open EVENT record, 0 when none */
+} recorded_message_s;
+
+static const _nfc_trace_header_s *trace;
+static unsigned long long trace_end;
+
+static recorded_message_s recorded[MESSAGE_MAX];
+static unsigned long long callbacks;
+
+/*
+ * Recorded request id to the id of the replayed request, open addressing
+ * with 0 as the free key. A replayed id of 0 marks a call which was
+ * replayed early, its response was recorded first.
+ */
+static struct {
+	int recorded;
+	int replayed;
+} requests[REQUEST_MAX];
+static int request_count;
+
+/* the raw data of replayed tags, sessions point at it until the library is deinitialized */
+typedef struct tag_buffer_s {
+	struct tag_buffer_s *next;
+	unsigned char data[];
+} tag_buffer_s;
+
+static tag_buffer_s *tag_buffers;
+
+static const _nfc_trace_header_s * trace_open(const char *path, size_t *size)
+{
+	const _nfc_trace_header_s *header;
+	struct stat st;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if( fd < 0 || fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(_nfc_trace_header_s) ){
+		fprintf(stderr, "%s: can not read\n", path);
+		if( fd >= 0 )
+			close(fd);
+		return NULL;
+	}
+
+	header = (const _nfc_trace_header_s *)mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if( header == MAP_FAILED ){
+		fprintf(stderr, "%s: can not map\n", path);
+		return NULL;
+	}
+	*size = st.st_size;
+
+	if( memcmp(header->magic, _NFC_TRACE_MAGIC, sizeof(header->magic)) != 0
+			|| header->version != _NFC_TRACE_VERSION
+			|| header->record_size != sizeof(_nfc_trace_record_s)
+			|| header->record_count == 0
+			|| sizeof(_nfc_trace_header_s) + (size_t)header->record_count * sizeof(_nfc_trace_record_s) > *size ){
+		fprintf(stderr, "%s: not a trace of this version\n", path);
+		munmap((void *)header, *size);
+		return NULL;
+	}
+
+	return header;
+}
+
+/* the record at position, NULL when it was torn or overwritten */
+static const _nfc_trace_record_s * trace_record(const _nfc_trace_header_s *header, unsigned long long position)
+{
+	const _nfc_trace_record_s *record = (const _nfc_trace_record_s *)(header + 1) + position % header->record_count;
+
+	return record->sequence == (unsigned int)(position + 1) ? record : NULL;
+}
+
+static void list_record(const _nfc_trace_header_s *header, const _nfc_trace_record_s *record)
+{
+	static const char *kinds[] = { "?", "EVENT", "END", "CALL" };
+	unsigned int i;
+
+	printf("%u\t%.3f\t%s\t", record->sequence, (record->time - header->started) / 1e6,
+		record->kind <= _NFC_TRACE_CALL ? kinds[record->kind] : kinds[0]);
+	if( record->kind == _NFC_TRACE_CALL && record->id < _NFC_TRACE_CALL_MAX )
+		printf("%s", call_names[record->id]);
+	else
+		printf("%u", record->id);
+	printf("\t%d\t%d\t0x%llx\t%u\t%d\t", record->result, record->request_id, record->handle, record->length, record->arg);
+	for( i = 0; i < record->kept; i++ )
+		printf("%02x", record->payload[i]);
+	printf("\n");
+}
+
+/* a buffer of the recorded size starting with the bytes kept */
+static unsigned char * replay_buffer(const _nfc_trace_record_s *record)
+{
+	unsigned char *buffer = (unsigned char *)calloc(1, record->length + 1);
+
+	if( buffer != NULL )
+		memcpy(buffer, record->payload, record->kept);
+	return buffer;
+}
+
+/* the recorded NDEF data if it was kept whole, otherwise one record of TNF unknown with the recorded size */
+static unsigned char * replay_ndef(const _nfc_trace_record_s *record, uint32_t *length)
+{
+	unsigned char *buffer;
+	uint32_t size = record->length < 3 ? 3 : record->length;
+	uint32_t payload;
+
+	if( record->length > 0 && record->kept == record->length ){
+		*length = record->length;
+		return replay_buffer(record);
+	}
+
+	buffer = (unsigned char *)calloc(1, size + 6);
+	if( buffer == NULL )
+		return NULL;
+
+	if( size - 3 <= 0xff ){
+		buffer[0] = 0xd5;	/* MB ME SR, TNF unknown */
+		buffer[2] = size - 3;
+	}
+	else {
+		payload = size - 6;
+		buffer[0] = 0xc5;
+		buffer[2] = payload >> 24;
+		buffer[3] = payload >> 16;
+		buffer[4] = payload >> 8;
+		buffer[5] = payload;
+	}
+	*length = size;
+	return buffer;
+}
+
+static int request_slot(int recorded)
+{
+	unsigned int slot = ((unsigned int)recorded * 2654435761u) & (REQUEST_MAX - 1);
+
+	while( requests[slot].recorded != 0 && requests[slot].recorded != recorded )
+		slot = (slot + 1) & (REQUEST_MAX - 1);
+	return slot;
+}
+
+/* removes the entry at slot, moving back the entries after it */
+static void request_remove(int slot)
+{
+	int next = slot, home;
+
+	requests[slot].recorded = 0;
+	request_count--;
+
+	for( ;; ){
+		next = (next + 1) & (REQUEST_MAX - 1);
+		if( requests[next].recorded == 0 )
+			return;
+		home = ((unsigned int)requests[next].recorded * 2654435761u) & (REQUEST_MAX - 1);
+		if( ((next - home) & (REQUEST_MAX - 1)) >= ((next - slot) & (REQUEST_MAX - 1)) ){
+			requests[slot] = requests[next];
+			requests[next].recorded = 0;
+			slot = next;
+		}
+	}
+}
+
+static void on_result(nfc_error_e result, void *user_data)
+{
+	callbacks++;
+}
+
+static void on_data(nfc_error_e result, unsigned char *buffer, int buffer_size, void *user_data)
+{
+	callbacks++;
+}
+
+static void on_message(nfc_error_e result, nfc_ndef_message_h message, void *user_data)
+{
+	callbacks++;
+}
+
+static void on_tag_discovered(nfc_discovered_type_e type, nfc_tag_h tag, void *user_data)
+{
+	callbacks++;
+}
+
+static void on_ndef_discovered(nfc_ndef_message_h message, void *user_data)
+{
+	callbacks++;
+}
+
+static void on_p2p_data_received(nfc_p2p_target_h target, nfc_ndef_message_h message, void *user_data)
+{
+	callbacks++;
+}
+
+static void on_p2p_discovered(nfc_discovered_type_e type, nfc_p2p_target_h target, void *user_data)
+{
+	if( type == NFC_DISCOVERED_TYPE_ATTACHED )
+		nfc_p2p_set_data_received_cb(target, on_p2p_data_received, NULL);
+	callbacks++;
+}
+
+static void on_se_event(nfc_se_event_e event, void *user_data)
+{
+	callbacks++;
+}
+
+static void on_se_transaction(unsigned char *aid, int aid_size, unsigned char *param, int param_size, void *user_data)
+{
+	callbacks++;
+}
+
+static void request_insert(int recorded, int replayed)
+{
+	int slot = request_slot(recorded);
+
+	if( requests[slot].recorded == 0 )
+		request_count++;
+	requests[slot].recorded = recorded;
+	requests[slot].replayed = replayed;
+}
+
+/* a pending request in place of the recorded one, 0 if the call has no response to wait for */
+static int replay_request(const _nfc_trace_record_s *record)
+{
+	_async_callback_data *op;
+
+	if( record->request_id == 0 || record->result != NFC_ERROR_NONE || request_count >= REQUEST_MAX / 2 )
+		return 0;
+
+	op = _nfc_callback_pool_alloc();
+	if( op == NULL )
+		return 0;
+
+	switch( record->id ){
+		case _NFC_TRACE_CALL_TRANSCEIVE:
+		case _NFC_TRACE_CALL_MIFARE_READ:
+			op->callback = (void *)on_data;
+			op->callback_type = _NFC_CALLBACK_TYPE_DATA;
+			break;
+		case _NFC_TRACE_CALL_READ_NDEF:
+			op->callback = (void *)on_message;
+			op->callback_type = _NFC_CALLBACK_TYPE_MESSAGE;
+			break;
+		default:
+			op->callback = (void *)on_result;
+			op->callback_type = _NFC_CALLBACK_TYPE_RESULT;
+			break;
+	}
+	op->user_data = NULL;
+	op->handle = (net_nfc_target_handle_h)(uintptr_t)record->handle;
+
+	return _nfc_pending_register(op);
+}
+
+static void replay_call(const _nfc_trace_record_s *record)
+{
+	int slot = request_slot(record->request_id);
+	int request_id;
+
+	if( record->request_id != 0 && requests[slot].recorded != 0 && requests[slot].replayed == 0 ){
+		request_remove(slot);
+		return;
+	}
+
+	request_id = replay_request(record);
+	if( request_id != 0 )
+		request_insert(record->request_id, request_id);
+}
+
+/* the id of the request a response answers, replaying its call if that was recorded later */
+static void * replay_answered(const _nfc_trace_record_s *record, unsigned long long position)
+{
+	const _nfc_trace_record_s *call;
+	unsigned long long end = position + LOOKAHEAD < trace_end ? position + LOOKAHEAD : trace_end;
+	int slot = request_slot(record->request_id);
+	int request_id;
+
+	if( requests[slot].recorded != 0 ){
+		request_id = requests[slot].replayed;
+		request_remove(slot);
+		return (void *)(intptr_t)request_id;
+	}
+
+	for( position++; position < end; position++ ){
+		call = trace_record(trace, position);
+		if( call != NULL && call->kind == _NFC_TRACE_CALL && call->request_id == record->request_id ){
+			request_id = replay_request(call);
+			if( request_id == 0 )
+				break;
+			request_insert(record->request_id, 0);
+			return (void *)(intptr_t)request_id;
+		}
+	}
+
+	/* stale, as it was when recorded */
+	return (void *)(intptr_t)record->request_id;
+}
+
+static void replay_event(const _nfc_trace_record_s *record, unsigned long long position)
+{
+	net_nfc_message_e message = (net_nfc_message_e)record->id;
+	net_nfc_target_info_s target_info;
+	net_nfc_se_event_info_s event_info;
+	ndef_message_h ndef_message = NULL;
+	data_s rawdata = { NULL, 0 };
+	void *data = NULL;
+	void *trans_data = (void *)(intptr_t)record->request_id;
+	tag_buffer_s *tag_buffer;
+
+	if( record->request_id != 0 && message != NET_NFC_MESSAGE_IS_TAG_CONNECTED )
+		trans_data = replay_answered(record, position);
+
+	switch( message ){
+		case NET_NFC_MESSAGE_IS_TAG_CONNECTED:
+			return;
+
+		case NET_NFC_MESSAGE_TRANSCEIVE:
+			if( record->result == NET_NFC_OK ){
+				rawdata.buffer = replay_buffer(record);
+				rawdata.length = record->length;
+				data = &rawdata;
+			}
+			break;
+
+		case NET_NFC_MESSAGE_P2P_RECEIVE:
+			rawdata.buffer = replay_ndef(record, &rawdata.length);
+			data = &rawdata;
+			break;
+
+		case NET_NFC_MESSAGE_READ_NDEF:
+			if( record->result == NET_NFC_OK && record->length > 0 ){
+				rawdata.buffer = replay_ndef(record, &rawdata.length);
+				if( rawdata.buffer != NULL && net_nfc_create_ndef_message_from_rawdata(&ndef_message, (data_h)&rawdata) == NET_NFC_OK )
+					data = ndef_message;
+			}
+			break;
+
+		case NET_NFC_MESSAGE_TAG_DISCOVERED:
+		case NET_NFC_MESSAGE_GET_CURRENT_TAG_INFO:
+			memset(&target_info, 0, sizeof(target_info));
+			target_info.handle = (net_nfc_target_handle_h)(uintptr_t)record->handle;
+			target_info.devType = (net_nfc_target_type_e)record->arg;
+			rawdata.buffer = record->length > 0 ? replay_ndef(record, &rawdata.length) : NULL;
+			tag_buffer = rawdata.buffer != NULL ? (tag_buffer_s *)malloc(sizeof(tag_buffer_s) + rawdata.length) : NULL;
+			if( tag_buffer != NULL ){
+				memcpy(tag_buffer->data, rawdata.buffer, rawdata.length);
+				tag_buffer->next = tag_buffers;
+				tag_buffers = tag_buffer;
+				target_info.raw_data.buffer = tag_buffer->data;
+				target_info.raw_data.length = rawdata.length;
+				target_info.is_ndef_supported = 1;
+				target_info.actualDataSize = target_info.raw_data.length;
+				target_info.maxDataSize = target_info.raw_data.length;
+			}
+			data = &target_info;
+			break;
+
+		case NET_NFC_MESSAGE_TAG_DETACHED:
+		case NET_NFC_MESSAGE_P2P_DISCOVERED:
+		case NET_NFC_MESSAGE_GET_CURRENT_TARGET_HANDLE:
+			data = (void *)(uintptr_t)record->handle;
+			break;
+
+		case NET_NFC_MESSAGE_SE_TYPE_TRANSACTION:
+			event_info.aid.buffer = replay_buffer(record);
+			event_info.aid.length = record->length;
+			event_info.param.buffer = (uint8_t *)calloc(1, record->arg > 0 ? record->arg : 1);
+			event_info.param.length = record->arg > 0 ? record->arg : 0;
+			data = &event_info;
+			break;
+
+		default:
+			break;
+	}
+
+	_nfc_response_handler(message, (net_nfc_error_e)record->result, data, NULL, trans_data);
+
+	if( ndef_message != NULL )
+		net_nfc_free_ndef_message(ndef_message);
+	if( message == NET_NFC_MESSAGE_SE_TYPE_TRANSACTION ){
+		free(event_info.aid.buffer);
+		free(event_info.param.buffer);
+	}
+	free(rawdata.buffer);
+}
+
+static void wait_until(const struct timespec *start, double offset_ns)
+{
+	struct timespec due;
+	long long ns = (long long)offset_ns;
+
+	due.tv_sec = start->tv_sec + ns / 1000000000LL;
+	due.tv_nsec = start->tv_nsec + ns % 1000000000LL;
+	if( due.tv_nsec >= 1000000000L ){
+		due.tv_sec++;
+		due.tv_nsec -= 1000000000L;
+	}
+	clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL);
+}
+
+static void record_seen(const _nfc_trace_record_s *record)
+{
+	recorded_message_s *m;
+
+	if( record->id >= MESSAGE_MAX )
+		return;
+
+	m = &recorded[record->id];
+	if( record->kind == _NFC_TRACE_EVENT ){
+		m->count++;
+		m->entered = record->time;
+	}
+	else if( record->kind == _NFC_TRACE_EVENT_END && m->entered != 0 ){
+		m->handling_ns += record->time - m->entered;
+		m->handled++;
+		m->entered = 0;
+	}
+}
+
+static void report(void)
+{
+	nfc_message_stats_s *stats = NULL;
+	int count = 0;
+	int i, message;
+	const nfc_message_stats_s *s;
+
+	nfc_manager_get_stats(&stats, &count);
+
+	printf("message\trecorded\trecorded_mean_ns\treplayed\tdispatch_p50_ns\tdispatch_p99_ns\tcallback_p50_ns\tcallback_p99_ns\n");
+	for( message = 0; message < MESSAGE_MAX; message++ ){
+		if( recorded[message].count == 0 )
+			continue;
+
+		for( s = NULL, i = 0; i < count; i++ ){
+			if( stats[i].message == message )
+				s = &stats[i];
+		}
+
+		printf("%s\t%llu\t%llu", s != NULL && s->name != NULL ? s->name : "-", recorded[message].count,
+			recorded[message].handled ? recorded[message].handling_ns / recorded[message].handled : 0);
+		if( s != NULL )
+			printf("\t%llu\t%llu\t%llu\t%llu\t%llu\n", s->dispatch.count, s->dispatch.p50_ns, s->dispatch.p99_ns,
+				s->callback.p50_ns, s->callback.p99_ns);
+		else
+			printf("\t0\t0\t0\t0\t0\n");
+	}
+
+	free(stats);
+}
+
+int main(int argc, char **argv)
+{
+	const _nfc_trace_header_s *header;
+	const _nfc_trace_record_s *record;
+	const _nfc_trace_record_s *first = NULL;
+	tag_buffer_s *tag_buffer;
+	struct timespec start;
+	unsigned long long position, end, skipped = 0, replayed = 0;
+	bool list = false;
+	double speed = 1;
+	size_t size;
+
+	if( argc > 1 && strcmp(argv[1], "-l") == 0 ){
+		list = true;
+		argv++;
+		argc--;
+	}
+	if( argc < 2 ){
+		fprintf(stderr, "usage: %s FILE [SPEED] | -l FILE\n", argv[0]);
+		return 2;
+	}
+	if( argc > 2 )
+		speed = atof(argv[2]);
+
+	header = trace_open(argv[1], &size);
+	if( header == NULL )
+		return 1;
+
+	end = header->written;
+	position = end > header->record_count ? end - header->record_count : 0;
+	trace = header;
+	trace_end = end;
+
+	if( list ){
+		printf("sequence\ttime_ms\tkind\tid\tresult\trequest_id\thandle\tlength\targ\tpayload\n");
+		for( ; position < end; position++ ){
+			record = trace_record(header, position);
+			if( record != NULL )
+				list_record(header, record);
+		}
+		munmap((void *)header, size);
+		return 0;
+	}
+
+	if( nfc_manager_initialize(NULL, NULL) != NFC_ERROR_NONE ){
+		fprintf(stderr, "nfc_manager_initialize failed\n");
+		munmap((void *)header, size);
+		return 1;
+	}
+	net_nfc_mock_wait_idle(1000);
+
+	nfc_manager_set_tag_discovered_cb(on_tag_discovered, NULL);
+	nfc_manager_set_ndef_discovered_cb(on_ndef_discovered, NULL);
+	nfc_manager_set_p2p_target_discovered_cb(on_p2p_discovered, NULL);
+	nfc_manager_set_se_event_cb(on_se_event, NULL);
+	nfc_manager_set_se_transaction_event_cb(on_se_transaction, NULL);
+	nfc_manager_reset_stats();
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	for( ; position < end; position++ ){
+		record = trace_record(header, position);
+		if( record == NULL ){
+			skipped++;
+			continue;
+		}
+		if( first == NULL )
+			first = record;
+
+		if( speed > 0 && record->kind != _NFC_TRACE_EVENT_END )
+			wait_until(&start, (record->time - first->time) / speed);
+
+		record_seen(record);
+		if( record->kind == _NFC_TRACE_CALL )
+			replay_call(record);
+		else if( record->kind == _NFC_TRACE_EVENT )
+			replay_event(record, position);
+		else
+			continue;
+		replayed++;
+	}
+
+	net_nfc_mock_wait_idle(1000);
+
+	report();
+	fprintf(stderr, "replayed %llu records, skipped %llu, %llu callbacks, %d requests unanswered\n",
+		replayed, skipped, callbacks, request_count);
+
+	/* requests left unanswered are failed by the deinitialization */
+	nfc_manager_deinitialize();
+	for( ; tag_buffers != NULL; tag_buffers = tag_buffer ){
+		tag_buffer = tag_buffers->next;
+		free(tag_buffers);
+	}
+	munmap((void *)header, size);
+
+	return 0;
+}
@@ -0,0 +1,304 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+/*
+ * Measures the NDEF build, serialize and parse paths: creating records,
+ * appending them to messages of 1 to 1000 records, and converting those
+ * messages to and from raw data. Each line is one operation at one message
+ * size with its time, rate, and the calls to and bytes from the allocator
+ * per operation, counted by wrapping malloc, calloc and realloc.
+ *
+ * An operation includes releasing what it produced, except for appends,
+ * whose message is destroyed outside of the measurement. Appends are timed
+ * per record, so a cost growing with the message shows as ns_per_op
+ * growing with records.
+ *
+ * The optional argument is the number of records every line processes,
+ * which sets its iterations. nfc_mock_ndef_bench is the same program over
+ * the NDEF code of the mock backend.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <nfc.h>
+
+#define DEFAULT_WORK	200000
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static unsigned long long allocations;
+static unsigned long long allocated_bytes;
+
+void *malloc(size_t size)
+{
+	allocations++;
+	allocated_bytes += size;
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+	allocations++;
+	allocated_bytes += nmemb * size;
+	return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+	allocations++;
+	allocated_bytes += size;
+	return __libc_realloc(ptr, size);
+}
+
+static const int message_sizes[] = { 1, 10, 100, 1000 };
+
+static const unsigned char mime_data[] = {
+	0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff,
+};
+
+typedef struct {
+	double start;
+	unsigned long long allocations;
+	unsigned long long allocated_bytes;
+} bench_mark_s;
+
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void bench_start(bench_mark_s *mark)
+{
+	mark->allocations = allocations;
+	mark->allocated_bytes = allocated_bytes;
+	mark->start = now_ns();
+}
+
+static void bench_report(const char *operation, int records, int ops, double elapsed, const bench_mark_s *mark)
+{
+	printf("%s\t%d\t%d\t%.1f\t%.0f\t%.2f\t%.1f\n", operation, records, ops, elapsed / ops, ops * 1e9 / elapsed,
+		(double)(allocations - mark->allocations) / ops, (double)(allocated_bytes - mark->allocated_bytes) / ops);
+}
+
+static int create_record(int kind, nfc_ndef_record_h *record)
+{
+	static const unsigned char type[] = { 'T' };
+	static const unsigned char id[] = { 'i', 'd' };
+
+	switch( kind ){
+		case 0:
+			return nfc_ndef_record_create(record, NFC_RECORD_TNF_WELL_KNOWN, type, sizeof(type), id, sizeof(id), mime_data, sizeof(mime_data));
+		case 1:
+			return nfc_ndef_record_create_text(record, "provisioning record", "en-US", NFC_ENCODE_UTF_8);
+		case 2:
+			return nfc_ndef_record_create_uri(record, "http://www.tizen.org/provisioning");
+		default:
+			return nfc_ndef_record_create_mime(record, "application/octet-stream", mime_data, sizeof(mime_data));
+	}
+}
+
+static int run_record_create(int work)
+{
+	static const char *names[] = { "record_create", "record_create_text", "record_create_uri", "record_create_mime" };
+	nfc_ndef_record_h record;
+	bench_mark_s mark;
+	double elapsed;
+	int kind, n;
+
+	for( kind = 0; kind < 4; kind++ ){
+		bench_start(&mark);
+		for( n = 0; n < work; n++ ){
+			if( create_record(kind, &record) != NFC_ERROR_NONE )
+				return -1;
+			nfc_ndef_record_destroy(record);
+		}
+		elapsed = now_ns() - mark.start;
+		bench_report(names[kind], 1, work, elapsed, &mark);
+	}
+
+	return 0;
+}
+
+/* a message of text records, NULL on failure */
+static nfc_ndef_message_h build_message(int records)
+{
+	nfc_ndef_message_h message;
+	nfc_ndef_record_h record;
+	int n;
+
+	if( nfc_ndef_message_create(&message) != NFC_ERROR_NONE )
+		return NULL;
+
+	for( n = 0; n < records; n++ ){
+		if( create_record(1, &record) != NFC_ERROR_NONE )
+			break;
+		if( nfc_ndef_message_append_record(message, record) != NFC_ERROR_NONE ){
+			nfc_ndef_record_destroy(record);
+			break;
+		}
+	}
+
+	if( n < records ){
+		nfc_ndef_message_destroy(message);
+		return NULL;
+	}
+	return message;
+}
+
+static int run_append(int records, int rounds)
+{
+	nfc_ndef_message_h message;
+	nfc_ndef_record_h *batch;
+	bench_mark_s mark;
+	unsigned long long calls = 0, bytes = 0;
+	double elapsed = 0;
+	int round, n;
+
+	batch = (nfc_ndef_record_h *)calloc(records, sizeof(nfc_ndef_record_h));
+	if( batch == NULL )
+		return -1;
+
+	for( round = 0; round < rounds; round++ ){
+		if( nfc_ndef_message_create(&message) != NFC_ERROR_NONE )
+			break;
+		for( n = 0; n < records && create_record(1, &batch[n]) == NFC_ERROR_NONE; n++ )
+			;
+
+		bench_start(&mark);
+		for( n = 0; n < records; n++ ){
+			if( nfc_ndef_message_append_record(message, batch[n]) != NFC_ERROR_NONE )
+				break;
+		}
+		elapsed += now_ns() - mark.start;
+		calls += allocations - mark.allocations;
+		bytes += allocated_bytes - mark.allocated_bytes;
+
+		nfc_ndef_message_destroy(message);
+		if( n < records )
+			break;
+	}
+	free(batch);
+
+	if( round < rounds )
+		return -1;
+
+	/* the report takes the allocations since the mark, so move it back by the totals */
+	mark.allocations = allocations - calls;
+	mark.allocated_bytes = allocated_bytes - bytes;
+	bench_report("message_append_record", records, records * rounds, elapsed, &mark);
+	return 0;
+}
+
+static int run_get_rawdata(nfc_ndef_message_h message, int records, int iterations)
+{
+	unsigned char *rawdata;
+	int rawdata_size;
+	bench_mark_s mark;
+	double elapsed;
+	int n;
+
+	bench_start(&mark);
+	for( n = 0; n < iterations; n++ ){
+		if( nfc_ndef_message_get_rawdata(message, &rawdata, &rawdata_size) != NFC_ERROR_NONE )
+			return -1;
+		free(rawdata);
+	}
+	elapsed = now_ns() - mark.start;
+	bench_report("message_get_rawdata", records, iterations, elapsed, &mark);
+
+	return 0;
+}
+
+static int run_create_from_rawdata(nfc_ndef_message_h message, int records, int iterations)
+{
+	nfc_ndef_message_h parsed;
+	unsigned char *rawdata;
+	int rawdata_size;
+	bench_mark_s mark;
+	double elapsed;
+	int n;
+
+	if( nfc_ndef_message_get_rawdata(message, &rawdata, &rawdata_size) != NFC_ERROR_NONE )
+		return -1;
+
+	bench_start(&mark);
+	for( n = 0; n < iterations; n++ ){
+		if( nfc_ndef_message_create_from_rawdata(&parsed, rawdata, rawdata_size) != NFC_ERROR_NONE ){
+			free(rawdata);
+			return -1;
+		}
+		nfc_ndef_message_destroy(parsed);
+	}
+	elapsed = now_ns() - mark.start;
+	bench_report("message_create_from_rawdata", records, iterations, elapsed, &mark);
+
+	free(rawdata);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	int work = DEFAULT_WORK;
+	nfc_ndef_message_h message;
+	unsigned int i;
+	int records, iterations;
+
+	if( argc > 1 )
+		work = atoi(argv[1]);
+	if( work <= 0 )
+		work = DEFAULT_WORK;
+
+	printf("operation\trecords\tops\tns_per_op\tops_per_sec\tallocs_per_op\tbytes_per_op\n");
+
+	if( run_record_create(work) != 0 ){
+		fprintf(stderr, "record create failed\n");
+		return 1;
+	}
+
+	for( i = 0; i < sizeof(message_sizes) / sizeof(message_sizes[0]); i++ ){
+		records = message_sizes[i];
+		iterations = work / records > 0 ? work / records : 1;
+
+		if( run_append(records, iterations) != 0 ){
+			fprintf(stderr, "append of %d records failed\n", records);
+			return 1;
+		}
+
+		message = build_message(records);
+		if( message == NULL ){
+			fprintf(stderr, "building a message of %d records failed\n", records);
+			return 1;
+		}
+
+		if( run_get_rawdata(message, records, iterations) != 0
+				|| run_create_from_rawdata(message, records, iterations) != 0 ){
+			fprintf(stderr, "conversion of %d records failed\n", records);
+			nfc_ndef_message_destroy(message);
+			return 1;
+		}
+
+		nfc_ndef_message_destroy(message);
+	}
+
+	return 0;
+}
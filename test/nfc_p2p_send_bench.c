@@ -0,0 +1,131 @@
+/*
+* Copyright (c) 2012 Samsung Electronics Co., Ltd All Rights Reserved
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+/*
+ * Compares building the exchanger data of a P2P send the old way, through
+ * an intermediate raw data copy, with _nfc_p2p_exchanger_data_create().
+ * Bytes allocated per send are counted by wrapping malloc, every one of
+ * them is also copied once. Nothing is sent, so no peer is needed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <nfc.h>
+#include <nfc_private.h>
+
+#define DEFAULT_ITERATIONS	100000
+
+extern void *__libc_malloc(size_t size);
+
+static unsigned long long allocated_bytes;
+
+void *malloc(size_t size)
+{
+	allocated_bytes += size;
+	return __libc_malloc(size);
+}
+
+static const int payload_sizes[] = { 16, 200, 1024, 8192, 65536 };
+
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int create_legacy(nfc_ndef_message_h message, net_nfc_exchanger_data_h *data)
+{
+	data_h rawdata;
+	int ret;
+
+	ret = net_nfc_create_rawdata_from_ndef_message((ndef_message_h)message, &rawdata);
+	if( ret != NET_NFC_OK )
+		return ret;
+
+	ret = net_nfc_create_exchanger_data(data, rawdata);
+	net_nfc_free_data(rawdata);
+	return ret;
+}
+
+static void run(const char *name, int (*create)(nfc_ndef_message_h, net_nfc_exchanger_data_h *),
+	nfc_ndef_message_h message, int payload_size, int iterations)
+{
+	net_nfc_exchanger_data_h data;
+	unsigned long long bytes;
+	double start, elapsed;
+	int n;
+
+	for( n = 0; n < iterations / 10; n++ ){
+		if( create(message, &data) == NET_NFC_OK )
+			net_nfc_free_exchanger_data(data);
+	}
+
+	bytes = allocated_bytes;
+	start = now_ns();
+	for( n = 0; n < iterations; n++ ){
+		if( create(message, &data) == NET_NFC_OK )
+			net_nfc_free_exchanger_data(data);
+	}
+	elapsed = now_ns() - start;
+	bytes = allocated_bytes - bytes;
+
+	printf("%s\t%d\t%d\t%.1f\t%.1f\n", name, payload_size, iterations, elapsed / iterations, (double)bytes / iterations);
+}
+
+int main(int argc, char **argv)
+{
+	static const unsigned char type[] = { 'T' };
+	int iterations = DEFAULT_ITERATIONS;
+	nfc_ndef_message_h message;
+	nfc_ndef_record_h record;
+	unsigned char *payload;
+	unsigned int i;
+
+	if( argc > 1 )
+		iterations = atoi(argv[1]);
+	if( iterations <= 0 )
+		iterations = DEFAULT_ITERATIONS;
+
+	printf("path\tpayload_size\titerations\tns_per_send\tbytes_per_send\n");
+
+	for( i = 0; i < sizeof(payload_sizes) / sizeof(payload_sizes[0]); i++ ){
+		payload = (unsigned char *)calloc(1, payload_sizes[i]);
+		if( payload == NULL
+				|| nfc_ndef_message_create(&message) != NFC_ERROR_NONE ){
+			free(payload);
+			return 1;
+		}
+
+		if( nfc_ndef_record_create(&record, NFC_RECORD_TNF_WELL_KNOWN, type, sizeof(type), NULL, 0, payload, payload_sizes[i]) != NFC_ERROR_NONE
+				|| nfc_ndef_message_append_record(message, record) != NFC_ERROR_NONE ){
+			nfc_ndef_message_destroy(message);
+			free(payload);
+			return 1;
+		}
+
+		run("legacy", create_legacy, message, payload_sizes[i], iterations);
+		run("direct", _nfc_p2p_exchanger_data_create, message, payload_sizes[i], iterations);
+
+		nfc_ndef_message_destroy(message);
+		free(payload);
+	}
+
+	return 0;
+}